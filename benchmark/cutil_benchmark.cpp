@@ -1,12 +1,427 @@
 #include "benchmark.hpp"
 
 #define CUTILS_VERBOSE
+#include "CFiber.h"
 #include "CLog.h"
+#include "DArray.h"
+#include "DConcurrentMap.h"
+#include "DContainers.hpp"
+#include "DInternPool.h"
+#include "DMpmcQueue.h"
+#include "DRope.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
 
 void test() { LOG("%d", 1); }
 
+/***********************************************************************************************************************
+Queue benchmark
+***********************************************************************************************************************/
+
+static constexpr size_t QueueCapacity = 1024;
+static constexpr uint64_t QueueItems = 1u << 20;
+
+/* The queue the MPMC queue replaces: a bounded FIFO of uint64_t on a DArrayT behind a mutex. */
+struct MutexQueue {
+    std::mutex mutex;
+    DArrayT* items = darr_create_generic(sizeof(uint64_t));
+    size_t first = 0;
+
+    MutexQueue() { darr_reserve(items, QueueCapacity); }
+
+    ~MutexQueue() { darr_destroy(items); }
+
+    bool TryPush(uint64_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (darr_length(items) - first >= QueueCapacity) { return false; }
+        if (first > 0 && darr_length(items) == darr_capacity(items))
+        {
+            size_t remaining = darr_length(items) - first;
+            memmove(items->data, &items->data[first * sizeof(uint64_t)], remaining * sizeof(uint64_t));
+            items->length = remaining;
+            first = 0;
+        }
+        darr_push_generic(items, &value);
+        return true;
+    }
+
+    bool TryPop(uint64_t* value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first == darr_length(items)) { return false; }
+        memcpy(value, &items->data[first * sizeof(uint64_t)], sizeof(uint64_t));
+        first++;
+        return true;
+    }
+};
+
+struct LockFreeQueue {
+    DMpmcQueueT* queue = mpmc_create_generic(sizeof(uint64_t), QueueCapacity);
+
+    ~LockFreeQueue() { mpmc_destroy(queue); }
+
+    bool TryPush(uint64_t value) { return mpmc_try_push(queue, &value); }
+
+    bool TryPop(uint64_t* value) { return mpmc_try_pop(queue, value); }
+};
+
+static uint64_t NowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+/* Moves QueueItems timestamps through the queue; the consumers record the age of every item they receive. */
+template<typename Queue>
+static void RunQueue(uint32_t producers, uint32_t consumers)
+{
+    Queue queue;
+    std::vector<std::vector<uint64_t>> latencies(consumers);
+    std::vector<std::thread> threads;
+    uint64_t perProducer = QueueItems / producers;
+    uint64_t total = perProducer * producers;
+    uint64_t received = 0;
+
+    uint64_t start = NowNanoseconds();
+    for (uint32_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 0; i < perProducer; i++)
+            {
+                while (!queue.TryPush(NowNanoseconds())) { std::this_thread::yield(); }
+            }
+        });
+    }
+    for (uint32_t c = 0; c < consumers; c++)
+    {
+        latencies[c].reserve(total / consumers + 1);
+        threads.emplace_back([&, c]() {
+            uint64_t stamp = 0;
+            while (__atomic_load_n(&received, __ATOMIC_RELAXED) < total)
+            {
+                if (queue.TryPop(&stamp))
+                {
+                    latencies[c].push_back(NowNanoseconds() - stamp);
+                    __atomic_fetch_add(&received, 1u, __ATOMIC_RELAXED);
+                }
+                else { std::this_thread::yield(); }
+            }
+        });
+    }
+    for (std::thread& thread: threads) { thread.join(); }
+    uint64_t elapsed = NowNanoseconds() - start;
+
+    std::vector<uint64_t> all;
+    for (std::vector<uint64_t>& latency: latencies) { all.insert(all.end(), latency.begin(), latency.end()); }
+    std::sort(all.begin(), all.end());
+    std::cout << producers << "P/" << consumers << "C: " << (total * 1000.0 / elapsed) << " Mitems/s, latency p50 "
+              << all[all.size() / 2] << "ns p99 " << all[all.size() * 99 / 100] << "ns p99.9 "
+              << all[all.size() * 999 / 1000] << "ns" << std::endl;
+}
+
+template<typename Queue>
+static void QueueBenchmark(std::string_view name)
+{
+    uint32_t maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    Benchmark::Run(name, [maxThreads]() {
+        for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) { RunQueue<Queue>(threads, threads); }
+    });
+}
+
+/***********************************************************************************************************************
+Concurrent map benchmark
+***********************************************************************************************************************/
+
+/* A parallel group-by: every thread counts the same stream of log keys into one map. */
+static void RunGroupBy(uint32_t shards, uint32_t threadCount, const std::vector<std::string>& lines)
+{
+    DConcurrentMapT* map = cmap_create(DCONCURRENT_MAP_STRING, shards);
+    std::vector<std::thread> threads;
+    uint64_t start = NowNanoseconds();
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (size_t i = t; i < lines.size(); i += threadCount)
+            {
+                CStringViewT key = {(const int8_t*) lines[i].data(), lines[i].size()};
+                cmap_increment_str(map, key, 1);
+            }
+        });
+    }
+    for (std::thread& thread: threads) { thread.join(); }
+    uint64_t elapsed = NowNanoseconds() - start;
+    std::cout << map->shardCount << " shard(s), " << threadCount << " thread(s): " << (lines.size() * 1000.0 / elapsed)
+              << " Mupdates/s, " << cmap_length(map) << " keys" << std::endl;
+    cmap_destroy(map);
+}
+
+static void ConcurrentMapBenchmark()
+{
+    std::vector<std::string> lines;
+    uint64_t state = 42;
+    for (uint32_t i = 0; i < (1u << 21); i++)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        lines.push_back("GET /api/v1/users/" + std::to_string((state >> 33) % 50000u));
+    }
+
+    uint32_t maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    /* One shard is a single global lock, the baseline the sharded map replaces. */
+    Benchmark::Run("Concurrent map group-by", [&]() {
+        for (uint32_t shards: {1u, 0u})
+        {
+            for (uint32_t threads = 1; threads <= maxThreads; threads *= 2) { RunGroupBy(shards, threads, lines); }
+        }
+    });
+}
+
+/***********************************************************************************************************************
+Fiber benchmark
+***********************************************************************************************************************/
+
+static constexpr uint32_t FiberYields = 1u << 20;
+static constexpr uint32_t ParkedFibers = 10000;
+
+static void FiberYieldLoop(void*)
+{
+    for (uint32_t i = 0; i < FiberYields; i++) { fiber_yield(); }
+}
+
+struct FiberParking {
+    std::vector<DFiberT*> fibers;
+    uint32_t count = 0;
+};
+
+static void FiberPublish(DFiberT* fiber, void* argument)
+{
+    FiberParking* parked = (FiberParking*) argument;
+    parked->fibers.push_back(fiber);
+    __atomic_store_n(&parked->count, (uint32_t) parked->fibers.size(), __ATOMIC_RELEASE);
+}
+
+static void FiberPark(void* argument) { fiber_suspend(FiberPublish, argument); }
+
+/* Resident set size in bytes, 0 where /proc is not available. */
+static uint64_t ResidentBytes()
+{
+    uint64_t pages = 0;
+    uint64_t resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * (uint64_t) sysconf(_SC_PAGESIZE);
+}
+
+static void FiberBenchmark()
+{
+    /* Two fibers on one worker: every yield is a switch to the worker and one to the other fiber. */
+    Benchmark::Run("Fiber context switch", []() {
+        DFiberSchedulerT* scheduler = fiber_scheduler_create(1, 0, 0);
+        uint64_t start = NowNanoseconds();
+        fiber_spawn(scheduler, FiberYieldLoop, NULL);
+        fiber_spawn(scheduler, FiberYieldLoop, NULL);
+        fiber_scheduler_wait_idle(scheduler);
+        uint64_t elapsed = NowNanoseconds() - start;
+        std::cout << (double) elapsed / (2.0 * FiberYields) << " ns per yield, "
+                  << (double) elapsed / (4.0 * FiberYields) << " ns per context switch" << std::endl;
+        fiber_scheduler_destroy(scheduler);
+    });
+
+    /* Thousands of fibers parked on I/O at once; one worker keeps the parked list single threaded. */
+    Benchmark::Run("Fiber memory", []() {
+        DFiberSchedulerT* scheduler = fiber_scheduler_create(1, 0, 0);
+        FiberParking parked;
+        parked.fibers.reserve(ParkedFibers);
+        uint64_t before = ResidentBytes();
+        uint64_t start = NowNanoseconds();
+        for (uint32_t i = 0; i < ParkedFibers; i++) { fiber_spawn(scheduler, FiberPark, &parked); }
+        while (__atomic_load_n(&parked.count, __ATOMIC_ACQUIRE) < ParkedFibers) { std::this_thread::yield(); }
+        uint64_t spawned = NowNanoseconds() - start;
+        uint64_t after = ResidentBytes();
+        std::cout << ParkedFibers << " parked fibers: " << (double) spawned / ParkedFibers << " ns per spawn, "
+                  << (after - before) / ParkedFibers << " resident bytes per fiber, "
+                  << scheduler->stacks.guardSize + scheduler->stacks.stackSize + sizeof(DFiberT)
+                  << " reserved bytes per fiber" << std::endl;
+        for (DFiberT* fiber: parked.fibers) { fiber_resume(fiber); }
+        fiber_scheduler_destroy(scheduler);
+    });
+}
+
+/***********************************************************************************************************************
+C++ wrapper benchmark
+***********************************************************************************************************************/
+
+static constexpr uint32_t WrapperItems = 1u << 22;
+
+/* The same push and sum loop through the C API and through cutils::DArray; the times should match. */
+static void WrapperBenchmark()
+{
+    uint64_t sink = 0;
+    Benchmark::Run("DArrayT push and sum", [&sink]() {
+        DArrayT* values = darr_create_u32();
+        for (uint32_t i = 0; i < WrapperItems; i++) { darr_push_u32(values, i); }
+        uint32_t* data = (uint32_t*) values->data;
+        sink += std::accumulate(data, data + darr_length(values), (uint64_t) 0);
+        darr_destroy(values);
+    });
+    Benchmark::Run("cutils::DArray push and sum", [&sink]() {
+        cutils::DArray<uint32_t> values;
+        for (uint32_t i = 0; i < WrapperItems; i++) { values.push_back(i); }
+        sink += std::accumulate(values.begin(), values.end(), (uint64_t) 0);
+    });
+    std::cout << "checksum " << sink << std::endl;
+}
+
+/***********************************************************************************************************************
+Short string benchmark
+***********************************************************************************************************************/
+
+/* Directory-entry sized names: created, appended to and destroyed, inline without a data allocation. */
+static void ShortStringBenchmark()
+{
+    Benchmark::Run("DString short strings", []() {
+        size_t total = 0;
+        for (uint32_t i = 0; i < (1u << 20); i++)
+        {
+            DStringT* name = str_create((const int8_t*) "entry_", 6);
+            str_append_cstring(name, (const int8_t*) ((0u == (i & 1u)) ? "file.txt" : "dir"));
+            total += name->length;
+            str_destroy(name);
+        }
+        std::cout << total << " bytes" << std::endl;
+    });
+}
+
+static void InternBenchmark()
+{
+    /* 64 distinct labels repeated: one copy per occurrence against one id per occurrence. */
+    const uint32_t count = 1u << 18;
+    Benchmark::Run("DString label copies", [count]() {
+        std::vector<DStringT*> labels;
+        size_t equal = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            std::string name = "label_" + std::to_string(i & 63u);
+            labels.push_back(str_create((const int8_t*) name.c_str(), name.size()));
+            equal += (0 == strcmp((const char*) labels[i]->data, (const char*) labels[i / 2u]->data)) ? 1u : 0u;
+        }
+        for (DStringT* label: labels) { str_destroy(label); }
+        std::cout << equal << " equal" << std::endl;
+    });
+    Benchmark::Run("Interned label ids", [count]() {
+        DInternPoolT* pool = intern_create(64);
+        std::vector<uint32_t> labels;
+        size_t equal = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            std::string name = "label_" + std::to_string(i & 63u);
+            CStringViewT view = {(const int8_t*) name.c_str(), name.size()};
+            labels.push_back(intern_add(pool, view));
+            equal += (labels[i] == labels[i / 2u]) ? 1u : 0u;
+        }
+        std::cout << equal << " equal, " << pool->arenaBytes << " arena bytes" << std::endl;
+        intern_destroy(pool);
+    });
+}
+
+static void RopeBenchmark()
+{
+    /* Small edits spread over a 4 MiB document. */
+    const size_t documentSize = 4u << 20;
+    const uint32_t edits = 2000;
+    std::string document(documentSize, 'x');
+    Benchmark::Run("DString insert edits", [&]() {
+        DStringT* str = str_create((const int8_t*) document.c_str(), document.size());
+        DStringT* edit = str_create((const int8_t*) "edit", 4);
+        for (uint32_t i = 0; i < edits; i++) { str_insert_dstring(str, edit, (i * 2654435761u) % str->length); }
+        std::cout << str->length << " bytes" << std::endl;
+        str_destroy(edit);
+        str_destroy(str);
+    });
+    Benchmark::Run("Rope insert edits", [&]() {
+        CStringViewT view = {(const int8_t*) document.c_str(), document.size()};
+        DRopeT* rope = rope_create_from(view);
+        CStringViewT edit = {(const int8_t*) "edit", 4};
+        for (uint32_t i = 0; i < edits; i++) { rope_insert(rope, (i * 2654435761u) % rope_length(rope), edit); }
+        DStringT* flat = rope_to_dstring(rope);
+        std::cout << flat->length << " bytes" << std::endl;
+        str_destroy(flat);
+        rope_destroy(rope);
+    });
+}
+
+static void Utf8Benchmark()
+{
+    /* 64 MiB of mixed one to four byte sequences. */
+    const char* symbols[] = {"a", "bc", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "log line "};
+    std::string text;
+    uint32_t seed = 1;
+    while (text.size() < (64u << 20))
+    {
+        seed = seed * 1103515245u + 12345u;
+        text += symbols[(seed >> 16) % 6u];
+    }
+    const uint32_t masks[] = {CPU_FEATURE_NONE, CPU_FEATURE_SSE42, CPU_FEATURE_AVX2, ~0u};
+    const char* names[] = {"UTF-8 validation scalar", "UTF-8 validation SSE4.2", "UTF-8 validation AVX2",
+                           "UTF-8 validation best"};
+    for (uint32_t i = 0; i < 4u; i++)
+    {
+        cpu_restrict_features(masks[i]);
+        Benchmark::Run(names[i], [&text]() {
+            uint64_t start = NowNanoseconds();
+            BOOL valid = cstr_is_valid_utf8((const int8_t*) text.data(), text.size());
+            double seconds = (double) (NowNanoseconds() - start) / 1e9;
+            std::cout << (int) valid << " valid, " << (double) text.size() / seconds / 1e9 << " GB/s" << std::endl;
+        });
+    }
+    cpu_restrict_features(~0u);
+}
+
+static void StringLengthBenchmark()
+{
+    /* Many short and a few long strings, as appended and viewed by the string paths. */
+    const uint32_t lengths[] = {7, 24, 100, 4096, 1u << 20};
+    for (uint32_t length: lengths)
+    {
+        std::string text(length, 'x');
+        const uint32_t iterations = (64u << 20) / (length + 16u);
+        size_t total = 0;
+        Benchmark::Run("strlen " + std::to_string(length) + " bytes", [&]() {
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                const char* volatile str = text.c_str();
+                total += strlen(str);
+            }
+        });
+        Benchmark::Run("cstr_length " + std::to_string(length) + " bytes", [&]() {
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                const int8_t* volatile str = (const int8_t*) text.c_str();
+                total += cstr_length(str);
+            }
+        });
+        std::cout << total << " bytes" << std::endl;
+    }
+}
+
 int main()
 {
     Benchmark::Run("TestBenchmark", &test, 10000);
+    QueueBenchmark<MutexQueue>("Mutex DArray queue");
+    QueueBenchmark<LockFreeQueue>("MPMC queue");
+    ConcurrentMapBenchmark();
+    FiberBenchmark();
+    WrapperBenchmark();
+    ShortStringBenchmark();
+    InternBenchmark();
+    RopeBenchmark();
+    Utf8Benchmark();
+    StringLengthBenchmark();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,186 @@
+#ifndef CATOMIC_HEADER
+#define CATOMIC_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CAtomic Header (atomic operations and futex style wait/wake)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "STDTypes.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <sched.h>
+#include <time.h>
+#endif
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def CATOMIC_CACHE_LINE
+ * @brief Cache line size in bytes, data written by different threads is kept this far apart.
+ */
+#define CATOMIC_CACHE_LINE 64u
+
+/**
+ * @brief Atomic operations on naturally aligned integers and pointers.
+ *
+ * Thin wrappers over the GCC/Clang __atomic builtins. Loads and stores come in
+ * relaxed, acquire/release and sequentially consistent flavours; read-modify-write
+ * operations are acquire-release, except the relaxed add meant for statistics, and
+ * return the previous value.
+ */
+#define CATOMIC_LOAD_RELAXED(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define CATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define CATOMIC_LOAD_SEQ_CST(ptr) __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define CATOMIC_STORE_RELAXED(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define CATOMIC_STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define CATOMIC_STORE_SEQ_CST(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_SEQ_CST)
+#define CATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#define CATOMIC_FETCH_ADD_RELAXED(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#define CATOMIC_FETCH_SUB(ptr, value) __atomic_fetch_sub((ptr), (value), __ATOMIC_ACQ_REL)
+#define CATOMIC_FETCH_OR(ptr, value) __atomic_fetch_or((ptr), (value), __ATOMIC_ACQ_REL)
+#define CATOMIC_FETCH_AND(ptr, value) __atomic_fetch_and((ptr), (value), __ATOMIC_ACQ_REL)
+#define CATOMIC_EXCHANGE(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+#define CATOMIC_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define CATOMIC_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define CATOMIC_FENCE_SEQ_CST() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/**
+ * @brief Compare and swap. *expectedPtr receives the current value on failure.
+ *
+ * The weak flavour may fail spuriously and belongs in retry loops. The seq_cst flavour also takes part in the single
+ * total order of seq_cst operations, which Chase-Lev style deques rely on.
+ */
+#define CATOMIC_CAS(ptr, expectedPtr, desired)                                                                         \
+    __atomic_compare_exchange_n((ptr), (expectedPtr), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define CATOMIC_CAS_WEAK(ptr, expectedPtr, desired)                                                                    \
+    __atomic_compare_exchange_n((ptr), (expectedPtr), (desired), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define CATOMIC_CAS_SEQ_CST(ptr, expectedPtr, desired)                                                                 \
+    __atomic_compare_exchange_n((ptr), (expectedPtr), (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)
+
+/**
+ * @def CATOMIC_PAUSE
+ * @brief Spin-wait hint, lets the sibling hyper-thread run and saves power.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define CATOMIC_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CATOMIC_PAUSE() __asm__ __volatile__("yield")
+#else
+#define CATOMIC_PAUSE()
+#endif
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Block while *address equals expected.
+ *
+ * Returns after a wake on address, a timeout or spuriously: callers re-check
+ * their condition in a loop. Futex on Linux, WaitOnAddress on Windows and a
+ * yield elsewhere.
+ *
+ * @param address[in] The watched word, shared only within the process.
+ * @param expected[in] The value that keeps the caller blocked.
+ * @param timeoutNs[in] The longest wait in nanoseconds, 0 to wait without a limit.
+ */
+static void catomic_wait(uint32_t* address, uint32_t expected, uint64_t timeoutNs);
+
+/**
+ * @brief Wake one thread blocked in catomic_wait on address.
+ * @param address[in] The watched word.
+ */
+static void catomic_wake_one(uint32_t* address);
+
+/**
+ * @brief Wake all threads blocked in catomic_wait on address.
+ * @param address[in] The watched word.
+ */
+static void catomic_wake_all(uint32_t* address);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+#if defined(__linux__)
+inline static void catomic_wait(uint32_t* address, uint32_t expected, uint64_t timeoutNs)
+{
+    struct timespec timeout;
+    timeout.tv_sec = (time_t) (timeoutNs / 1000000000u);
+    timeout.tv_nsec = (long) (timeoutNs % 1000000000u);
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, (0u == timeoutNs) ? NULL : &timeout, NULL, 0);
+}
+
+inline static void catomic_wake_one(uint32_t* address)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+inline static void catomic_wake_all(uint32_t* address)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, 0x7FFFFFFF, NULL, NULL, 0);
+}
+#elif defined(_WIN32)
+inline static void catomic_wait(uint32_t* address, uint32_t expected, uint64_t timeoutNs)
+{
+    DWORD milliseconds = (0u == timeoutNs) ? INFINITE : (DWORD) ((timeoutNs + 999999u) / 1000000u);
+    WaitOnAddress(address, &expected, sizeof(uint32_t), milliseconds);
+}
+
+inline static void catomic_wake_one(uint32_t* address) { WakeByAddressSingle(address); }
+
+inline static void catomic_wake_all(uint32_t* address) { WakeByAddressAll(address); }
+#else
+inline static void catomic_wait(uint32_t* address, uint32_t expected, uint64_t timeoutNs)
+{
+    if (expected == CATOMIC_LOAD_ACQUIRE(address)) { sched_yield(); }
+}
+
+inline static void catomic_wake_one(uint32_t* address) {}
+
+inline static void catomic_wake_all(uint32_t* address) {}
+#endif
+
+#endif// CATOMIC_HEADER
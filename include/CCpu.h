@@ -0,0 +1,234 @@
+#ifndef CCPU_HEADER
+#define CCPU_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CCpu Header (SIMD availability and runtime CPU feature dispatch)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "STDTypes.h"
+
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @brief SIMD code paths
+ *
+ * Vectorized kernels are compiled for x86 with GCC or Clang, using per-function
+ * target attributes so the rest of the program does not need -mavx2. The kernel
+ * is picked at runtime with cpu_has_feature(). Define NO_SIMD to build only the
+ * portable scalar paths.
+ *
+ * - `CUTILS_SIMD_X86`: defined when the x86 SIMD kernels are compiled in
+ * - `CPU_TARGET_SSE42`: function attribute enabling SSE4.2 code generation
+ * - `CPU_TARGET_AVX2`: function attribute enabling AVX2 (+BMI1/2, POPCNT) code generation
+ * - `CPU_TARGET_AVX512`: function attribute enabling AVX-512 F/BW/VL/DQ (+BMI1/2, POPCNT) code generation
+ */
+// clang-format off
+#if !defined(NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define CUTILS_SIMD_X86
+    #ifdef USE_SPECIFIC_STD_TYPES
+        #pragma push_macro("size_t")
+        #undef size_t
+    #endif
+    #include <immintrin.h>
+    #ifdef USE_SPECIFIC_STD_TYPES
+        #pragma pop_macro("size_t")
+    #endif
+    #define CPU_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+    #define CPU_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+    #define CPU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,bmi,bmi2,popcnt")))
+#endif
+// clang-format on
+
+/**
+ * @brief Kernels that read whole aligned blocks around a string, which never crosses a page,
+ * are not instrumented by AddressSanitizer.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define CPU_NO_SANITIZE_ADDRESS
+#endif
+
+/**
+ * @brief Bit counting helpers. CPU_CTZ32, CPU_CTZ64 and CPU_CLZ64 expect a non zero value.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_CTZ32(x) ((uint32_t) __builtin_ctz(x))
+#define CPU_CTZ64(x) ((uint32_t) __builtin_ctzll(x))
+#define CPU_CLZ64(x) ((uint32_t) __builtin_clzll(x))
+#define CPU_POPCOUNT32(x) ((uint32_t) __builtin_popcount(x))
+#define CPU_POPCOUNT64(x) ((uint32_t) __builtin_popcountll(x))
+#else
+#define CPU_CTZ32(x) cpu_ctz32_portable(x)
+#define CPU_CTZ64(x) cpu_ctz64_portable(x)
+#define CPU_CLZ64(x) cpu_clz64_portable(x)
+#define CPU_POPCOUNT32(x) cpu_popcount64_portable((uint64_t) (x))
+#define CPU_POPCOUNT64(x) cpu_popcount64_portable(x)
+#endif
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @enum CpuFeatureT
+ * @brief CPU features that select a SIMD kernel. Values are bit flags.
+ */
+typedef enum
+{
+    CPU_FEATURE_NONE = 0,
+    CPU_FEATURE_SSE42 = 1 << 0,
+    CPU_FEATURE_POPCNT = 1 << 1,
+    CPU_FEATURE_AVX2 = 1 << 2,
+    CPU_FEATURE_BMI2 = 1 << 3,
+    CPU_FEATURE_AVX512 = 1 << 4,
+    CPU_FEATURE_DETECTED = 1 << 30
+} CpuFeatureT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Get the SIMD features of the running CPU.
+ *
+ * Detection runs once, the result is cached. CPU_FEATURE_AVX512 is only
+ * reported when F, BW, VL and DQ are all available. Without CUTILS_SIMD_X86
+ * no feature is reported.
+ *
+ * @return Bitwise OR of CpuFeatureT values.
+ */
+static uint32_t cpu_get_features(void);
+
+/**
+ * @brief Check whether the running CPU supports all given features.
+ * @param features[in] Bitwise OR of CpuFeatureT values.
+ * @return TRUE if all features are supported, FALSE otherwise.
+ */
+static BOOL cpu_has_feature(uint32_t features);
+
+/**
+ * @brief Hide features from cpu_has_feature, e.g. to test or benchmark the scalar paths.
+ * @param mask[in] Bitwise OR of CpuFeatureT values that stay visible. ~0u restores detection.
+ */
+static void cpu_restrict_features(uint32_t mask);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static uint32_t cpu_ctz32_portable(uint32_t value)
+{
+    uint32_t count = 0;
+    while (0u == (value & 1u))
+    {
+        value >>= 1;
+        count++;
+    }
+    return count;
+}
+
+inline static uint32_t cpu_ctz64_portable(uint64_t value)
+{
+    uint32_t low = (uint32_t) value;
+    return (0u != low) ? cpu_ctz32_portable(low) : 32u + cpu_ctz32_portable((uint32_t) (value >> 32));
+}
+
+inline static uint32_t cpu_clz64_portable(uint64_t value)
+{
+    uint32_t count = 0;
+    while (0u == (value & 0x8000000000000000ull))
+    {
+        value <<= 1;
+        count++;
+    }
+    return count;
+}
+
+inline static uint32_t cpu_popcount64_portable(uint64_t value)
+{
+    value = value - ((value >> 1) & 0x5555555555555555ull);
+    value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (uint32_t) ((value * 0x0101010101010101ull) >> 56);
+}
+
+inline static uint32_t* cpu_feature_mask(void)
+{
+    static uint32_t mask = ~0u;
+    return &mask;
+}
+
+/* Every thread detects the same bits, so racing first calls only need the word itself to be atomic. */
+inline static uint32_t cpu_get_features(void)
+{
+    static uint32_t features = CPU_FEATURE_NONE;
+    uint32_t result = CATOMIC_LOAD_RELAXED(&features);
+
+    if (0u == (result & CPU_FEATURE_DETECTED))
+    {
+        uint32_t detected = CPU_FEATURE_DETECTED;
+#ifdef CUTILS_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) { detected |= CPU_FEATURE_SSE42; }
+        if (__builtin_cpu_supports("popcnt")) { detected |= CPU_FEATURE_POPCNT; }
+        if (__builtin_cpu_supports("avx2")) { detected |= CPU_FEATURE_AVX2; }
+        if (__builtin_cpu_supports("bmi2")) { detected |= CPU_FEATURE_BMI2; }
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq"))
+        {
+            detected |= CPU_FEATURE_AVX512;
+        }
+#endif
+        CATOMIC_STORE_RELAXED(&features, detected);
+        result = detected;
+    }
+
+    return result & CATOMIC_LOAD_RELAXED(cpu_feature_mask());
+}
+
+inline static BOOL cpu_has_feature(uint32_t features) { return ((cpu_get_features() & features) == features); }
+
+inline static void cpu_restrict_features(uint32_t mask)
+{
+    CATOMIC_STORE_RELAXED(cpu_feature_mask(), mask | CPU_FEATURE_DETECTED);
+}
+
+#endif// CCPU_HEADER
@@ -0,0 +1,367 @@
+#ifndef CEPOCH_HEADER
+#define CEPOCH_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CEpoch Header (epoch-based memory reclamation for lock-free readers)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "CSync.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def CEPOCH_RECLAIM_THRESHOLD
+ * @brief Retired blocks a participant collects before epoch_retire tries to reclaim some.
+ */
+#define CEPOCH_RECLAIM_THRESHOLD 64u
+
+/**
+ * @def CEPOCH_INACTIVE
+ * @brief The local epoch of a participant outside any read section.
+ */
+#define CEPOCH_INACTIVE 0u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DEpochRetiredT
+ * @brief A block waiting until no reader can reference it.
+ * @var pointer The block.
+ * @var size The size of the block.
+ * @var epoch The global epoch when it was retired.
+ * @var release The function that frees it.
+ */
+typedef struct {
+    void* pointer;
+    size_t size;
+    uint64_t epoch;
+    CFreeFunctionT release;
+} DEpochRetiredT;
+
+struct DEpochDomain;
+
+/**
+ * @struct DEpochParticipantT
+ * @brief A thread taking part in a domain, on its own cache line.
+ * @var epoch The global epoch seen on entering the current read section, CEPOCH_INACTIVE outside.
+ * @var inUse 1 while a thread owns this record.
+ * @var depth The nesting depth of read sections.
+ * @var domain The domain.
+ * @var retired Blocks this thread retired that are not freed yet, a DArrayT of DEpochRetiredT.
+ */
+typedef struct {
+    uint64_t epoch;
+    uint32_t inUse;
+    uint32_t depth;
+    struct DEpochDomain* domain;
+    DArrayT* retired;
+    int8_t padding[CATOMIC_CACHE_LINE - 2u * sizeof(uint64_t) - 2u * sizeof(void*)];
+} DEpochParticipantT;
+
+/**
+ * @struct DEpochDomainT
+ * @brief The shared state of epoch-based reclamation.
+ *
+ * Readers bracket every access to shared memory with epoch_enter and epoch_exit.
+ * Writers hand blocks that readers may still reference to epoch_retire instead
+ * of CFREE. The global epoch only advances once every reader inside a read
+ * section has seen the current one, so a block retired in epoch e is
+ * unreachable once the global epoch reaches e + 2.
+ *
+ * @var epoch The global epoch, starts at 1.
+ * @var participantCount The number of participant records.
+ * @var participants The participant records.
+ * @var orphanLock Guards orphans.
+ * @var orphans Blocks left behind by unregistered participants, a DArrayT of DEpochRetiredT.
+ */
+typedef struct DEpochDomain {
+    int8_t padding0[CATOMIC_CACHE_LINE];
+    uint64_t epoch;
+    int8_t padding1[CATOMIC_CACHE_LINE];
+    uint32_t participantCount;
+    DEpochParticipantT* participants;
+    CMutexT orphanLock;
+    DArrayT* orphans;
+} DEpochDomainT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a reclamation domain.
+ * @param maxParticipants[in] The most threads registered at the same time.
+ * @return A pointer to the new domain.
+ */
+static DEpochDomainT* epoch_domain_create(uint32_t maxParticipants);
+
+/**
+ * @brief Destroy a domain and free every retired block. No thread may be registered anymore.
+ * @param domain[in] The domain.
+ */
+static void epoch_domain_destroy(DEpochDomainT* domain);
+
+/**
+ * @brief Register the calling thread. Thread safe.
+ * @param domain[in] The domain.
+ * @return The participant record of the thread, NULL if all records are taken.
+ */
+static DEpochParticipantT* epoch_register(DEpochDomainT* domain);
+
+/**
+ * @brief Unregister a thread. Its retired blocks are handed to the domain, or stay with the record for its next
+ * owner if the domain can not take them.
+ * @param participant[in] The participant, outside any read section.
+ */
+static void epoch_unregister(DEpochParticipantT* participant);
+
+/**
+ * @brief Enter a read section. Read sections nest.
+ * @param participant[in] The participant of the calling thread.
+ */
+static void epoch_enter(DEpochParticipantT* participant);
+
+/**
+ * @brief Leave a read section.
+ * @param participant[in] The participant of the calling thread.
+ */
+static void epoch_exit(DEpochParticipantT* participant);
+
+/**
+ * @brief Free a block with CFREE once no reader can reference it anymore.
+ * @param participant[in] The participant of the calling thread.
+ * @param pointer[in] The block, may be NULL.
+ * @param size[in] The size of the block.
+ */
+static void epoch_retire(DEpochParticipantT* participant, void* pointer, size_t size);
+
+/**
+ * @brief Same as epoch_retire, with a custom function freeing the block.
+ * @param participant[in] The participant of the calling thread.
+ * @param pointer[in] The block, may be NULL.
+ * @param size[in] The size of the block.
+ * @param release[in] The function freeing the block.
+ */
+static void epoch_retire_with(DEpochParticipantT* participant, void* pointer, size_t size, CFreeFunctionT release);
+
+/**
+ * @brief Try to advance the global epoch and free the retired blocks of the calling thread that became unreachable.
+ * @param participant[in] The participant of the calling thread.
+ * @return The number of freed blocks.
+ */
+static size_t epoch_reclaim(DEpochParticipantT* participant);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DEpochDomainT* epoch_domain_create(uint32_t maxParticipants)
+{
+    DEpochDomainT* domain = (DEpochDomainT*) CCALLOC(1, sizeof(DEpochDomainT));
+    if (NULL != domain)
+    {
+        domain->participants = (DEpochParticipantT*) CCALLOC(maxParticipants, sizeof(DEpochParticipantT));
+        domain->orphans = darr_create_generic(sizeof(DEpochRetiredT));
+    }
+
+    if (NULL == domain) { LOG_ERROR("Can not allocate!\n"); }
+    else if ((NULL == domain->participants) || (NULL == domain->orphans))
+    {
+        LOG_ERROR("Can not allocate epoch domain!\n");
+        if (NULL != domain->participants) { CFREE(domain->participants, maxParticipants * sizeof(DEpochParticipantT)); }
+        if (NULL != domain->orphans) { darr_destroy(domain->orphans); }
+        CFREE(domain, sizeof(DEpochDomainT));
+        domain = NULL;
+    }
+    else
+    {
+        domain->epoch = 1;
+        domain->participantCount = maxParticipants;
+    }
+    return domain;
+}
+
+/* Frees the blocks of retired that are unreachable in epoch, keeping the others in order. */
+inline static size_t epoch_free_unreachable(DArrayT* retired, uint64_t epoch)
+{
+    DEpochRetiredT* blocks = (DEpochRetiredT*) retired->data;
+    size_t kept = 0;
+    size_t length = retired->length;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (blocks[i].epoch + 2u <= epoch) { blocks[i].release(blocks[i].pointer, blocks[i].size); }
+        else { blocks[kept++] = blocks[i]; }
+    }
+    retired->length = kept;
+    return length - kept;
+}
+
+inline static void epoch_domain_destroy(DEpochDomainT* domain)
+{
+    if (NULL != domain)
+    {
+        for (uint32_t i = 0; i < domain->participantCount; i++)
+        {
+            if (NULL != domain->participants[i].retired)
+            {
+                epoch_free_unreachable(domain->participants[i].retired, UINT64_MAX);
+                darr_destroy(domain->participants[i].retired);
+            }
+        }
+        epoch_free_unreachable(domain->orphans, UINT64_MAX);
+        darr_destroy(domain->orphans);
+        CFREE(domain->participants, domain->participantCount * sizeof(DEpochParticipantT));
+        CFREE(domain, sizeof(DEpochDomainT));
+    }
+}
+
+inline static DEpochParticipantT* epoch_register(DEpochDomainT* domain)
+{
+    DEpochParticipantT* result = NULL;
+    for (uint32_t i = 0; (NULL == result) && (i < domain->participantCount); i++)
+    {
+        uint32_t expected = 0;
+        if ((0u == CATOMIC_LOAD_RELAXED(&domain->participants[i].inUse)) &&
+            CATOMIC_CAS(&domain->participants[i].inUse, &expected, 1u))
+        {
+            result = &domain->participants[i];
+        }
+    }
+
+    if (NULL == result) { LOG_ERROR("Too many epoch participants!\n"); }
+    else
+    {
+        result->domain = domain;
+        result->depth = 0;
+        if (NULL == result->retired) { result->retired = darr_create_generic(sizeof(DEpochRetiredT)); }
+    }
+    return result;
+}
+
+inline static void epoch_unregister(DEpochParticipantT* participant)
+{
+    DEpochDomainT* domain = participant->domain;
+    epoch_reclaim(participant);
+    if (participant->retired->length > 0)
+    {
+        csync_mutex_lock(&domain->orphanLock);
+        size_t orphans = domain->orphans->length;
+        darr_resize(domain->orphans, orphans + participant->retired->length);
+        BOOL handed = (domain->orphans->length == orphans + participant->retired->length) ? TRUE : FALSE;
+        if (TRUE == handed)
+        {
+            CMEMCPY(&domain->orphans->data[orphans * sizeof(DEpochRetiredT)], participant->retired->data,
+                    participant->retired->length * sizeof(DEpochRetiredT));
+        }
+        csync_mutex_unlock(&domain->orphanLock);
+
+        if (TRUE == handed) { participant->retired->length = 0; }
+        else { LOG_ERROR("Can not hand retired blocks to the epoch domain!\n"); }
+    }
+    CATOMIC_STORE_RELEASE(&participant->epoch, (uint64_t) CEPOCH_INACTIVE);
+    CATOMIC_STORE_RELEASE(&participant->inUse, 0u);
+}
+
+inline static void epoch_enter(DEpochParticipantT* participant)
+{
+    if (0u == participant->depth++)
+    {
+        /* The seq_cst store orders the announcement before every load of shared memory in the section. */
+        CATOMIC_STORE_SEQ_CST(&participant->epoch, CATOMIC_LOAD_ACQUIRE(&participant->domain->epoch));
+        CATOMIC_FENCE_SEQ_CST();
+    }
+}
+
+inline static void epoch_exit(DEpochParticipantT* participant)
+{
+    if (0u == --participant->depth) { CATOMIC_STORE_RELEASE(&participant->epoch, (uint64_t) CEPOCH_INACTIVE); }
+}
+
+/* Advances the global epoch if every participant inside a read section has seen the current one. */
+inline static uint64_t epoch_try_advance(DEpochDomainT* domain)
+{
+    uint64_t epoch = CATOMIC_LOAD_SEQ_CST(&domain->epoch);
+    BOOL quiescent = TRUE;
+    CATOMIC_FENCE_SEQ_CST();
+    for (uint32_t i = 0; (TRUE == quiescent) && (i < domain->participantCount); i++)
+    {
+        uint64_t local = CATOMIC_LOAD_SEQ_CST(&domain->participants[i].epoch);
+        quiescent = ((CEPOCH_INACTIVE == local) || (epoch == local)) ? TRUE : FALSE;
+    }
+    if ((TRUE == quiescent) && CATOMIC_CAS_SEQ_CST(&domain->epoch, &epoch, epoch + 1u)) { epoch++; }
+    return epoch;
+}
+
+inline static size_t epoch_reclaim(DEpochParticipantT* participant)
+{
+    DEpochDomainT* domain = participant->domain;
+    uint64_t epoch = epoch_try_advance(domain);
+    size_t result = epoch_free_unreachable(participant->retired, epoch);
+    if (TRUE == csync_mutex_try_lock(&domain->orphanLock))
+    {
+        if (domain->orphans->length > 0) { result += epoch_free_unreachable(domain->orphans, epoch); }
+        csync_mutex_unlock(&domain->orphanLock);
+    }
+
+    return result;
+}
+
+inline static void epoch_retire_with(DEpochParticipantT* participant, void* pointer, size_t size,
+                                     CFreeFunctionT release)
+{
+    if (NULL != pointer)
+    {
+        DEpochRetiredT block = {pointer, size, CATOMIC_LOAD_SEQ_CST(&participant->domain->epoch), release};
+        darr_push_generic(participant->retired, &block);
+        if (participant->retired->length >= CEPOCH_RECLAIM_THRESHOLD) { epoch_reclaim(participant); }
+    }
+}
+
+inline static void epoch_retire(DEpochParticipantT* participant, void* pointer, size_t size)
+{
+    epoch_retire_with(participant, pointer, size, cmemory_free);
+}
+
+#endif// CEPOCH_HEADER
@@ -0,0 +1,939 @@
+#ifndef CFIBER_HEADER
+#define CFIBER_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CFiber Header (user-space fibers, stack pool and per-core fiber scheduler)
+ */
+
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "CSync.h"
+#include "CThread.h"
+#include "CThreadPool.h"
+#include "DMpmcQueue.h"
+#include "STDTypes.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#if !((defined(__x86_64__) || defined(__aarch64__)) && defined(__GNUC__))
+#include <ucontext.h>
+#endif
+#endif
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @brief The context switch implementation.
+ *
+ * CFIBER_BACKEND_ASM saves only the callee-saved registers and swaps stack pointers, CFIBER_BACKEND_UCONTEXT falls
+ * back to swapcontext on other POSIX targets and CFIBER_BACKEND_WINDOWS uses the native fiber API, which also owns
+ * the fiber stacks.
+ */
+#if defined(_WIN32)
+#define CFIBER_BACKEND_WINDOWS
+#elif (defined(__x86_64__) || defined(__aarch64__)) && defined(__GNUC__)
+#define CFIBER_BACKEND_ASM
+#else
+#define CFIBER_BACKEND_UCONTEXT
+#endif
+
+/**
+ * @def CFIBER_DEFAULT_STACK_SIZE
+ * @brief Usable stack bytes of a fiber when the scheduler is created with a stack size of 0.
+ */
+#define CFIBER_DEFAULT_STACK_SIZE (64u * 1024u)
+
+/**
+ * @def CFIBER_STACK_POOL_LIMIT
+ * @brief Released stacks the pool keeps for reuse, further stacks are unmapped.
+ */
+#define CFIBER_STACK_POOL_LIMIT 256u
+
+/**
+ * @def CFIBER_RUN_QUEUE_CAPACITY
+ * @brief Ready fibers one worker run queue holds.
+ */
+#define CFIBER_RUN_QUEUE_CAPACITY 16384u
+
+/**
+ * @def CFIBER_SPIN_COUNT
+ * @brief Failed searches for a ready fiber before an idle worker goes to sleep.
+ */
+#define CFIBER_SPIN_COUNT 64u
+
+/**
+ * @brief Fiber states. A fiber is READY while queued, RUNNING on a worker, and switches back to the worker with
+ * YIELDING, SUSPENDING or FINISHED. The worker turns SUSPENDING into SUSPENDED, unless fiber_resume got there first
+ * and left RESUMED behind.
+ */
+#define CFIBER_READY 0u
+#define CFIBER_RUNNING 1u
+#define CFIBER_YIELDING 2u
+#define CFIBER_SUSPENDING 3u
+#define CFIBER_SUSPENDED 4u
+#define CFIBER_RESUMED 5u
+#define CFIBER_FINISHED 6u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @typedef FiberFunctionT
+ * @brief The entry point of a fiber.
+ */
+typedef void (*FiberFunctionT)(void* argument);
+
+/**
+ * @struct DFiberContextT
+ * @brief The saved execution state of a fiber or of a worker thread.
+ */
+typedef struct {
+#if defined(CFIBER_BACKEND_ASM)
+    void* stackPointer;
+#elif defined(CFIBER_BACKEND_UCONTEXT)
+    ucontext_t context;
+#else
+    void* fiber;
+#endif
+} DFiberContextT;
+
+/**
+ * @struct DFiberT
+ * @brief A fiber.
+ * @var context The saved registers while the fiber is not running.
+ * @var function The entry point.
+ * @var argument The argument of function.
+ * @var stack The lowest address of the stack mapping, guard page included. NULL with the Windows backend.
+ * @var scheduler The scheduler running the fiber.
+ * @var state One of the CFIBER_ states.
+ * @var home The worker that ran the fiber last, it is resumed there.
+ */
+typedef struct DFiber {
+    DFiberContextT context;
+    FiberFunctionT function;
+    void* argument;
+    int8_t* stack;
+    struct DFiberScheduler* scheduler;
+    uint32_t state;
+    uint32_t home;
+} DFiberT;
+
+/**
+ * @typedef FiberPublishT
+ * @brief Called by fiber_suspend with the suspending fiber, hands the fiber to whoever will resume it.
+ */
+typedef void (*FiberPublishT)(DFiberT* fiber, void* argument);
+
+/**
+ * @struct DFiberStackPoolT
+ * @brief Fiber stacks with a guard page below each, released stacks are reused.
+ * @var stackSize Usable bytes per stack, a multiple of the page size.
+ * @var guardSize Bytes of the inaccessible guard below the stack.
+ * @var lock Protects the free list.
+ * @var free Released stacks, linked through their lowest usable word.
+ * @var freeCount The number of stacks on the free list.
+ * @var mapped The number of stacks currently mapped.
+ */
+typedef struct {
+    size_t stackSize;
+    size_t guardSize;
+    CMutexT lock;
+    int8_t* free;
+    uint32_t freeCount;
+    uint32_t mapped;
+} DFiberStackPoolT;
+
+/**
+ * @struct DFiberWorkerT
+ * @brief A worker thread and its run queue.
+ * @var scheduler The scheduler of the worker.
+ * @var index The worker index.
+ * @var context The worker thread's own context while a fiber runs.
+ * @var current The running fiber, NULL between fibers.
+ * @var runQueue The ready fibers, as DFiberT pointers. Any thread may push.
+ */
+typedef struct DFiberWorker {
+    struct DFiberScheduler* scheduler;
+    uint32_t index;
+    DFiberContextT context;
+    DFiberT* current;
+    DMpmcQueueT* runQueue;
+} DFiberWorkerT;
+
+/**
+ * @struct DFiberSchedulerT
+ * @brief Runs fibers on a fixed set of worker threads, one per core by default.
+ * @var workerCount The number of workers.
+ * @var threadCount The number of worker threads started.
+ * @var threads The worker threads.
+ * @var workers One worker, with its run queue, per thread.
+ * @var stacks The stack pool.
+ * @var blocking Threads for fiber_blocking_call, NULL to run blocking calls on the worker.
+ * @var nextWorker Round robin counter for fibers spawned from outside the scheduler.
+ * @var live The fibers spawned that did not finish yet.
+ * @var stop Set to 1 when the scheduler shuts down.
+ * @var signal Futex word sleeping workers wait on, bumped when a fiber becomes ready.
+ * @var sleepers The number of workers that are about to sleep or sleep.
+ */
+typedef struct DFiberScheduler {
+    uint32_t workerCount;
+    uint32_t threadCount;
+    CThreadT* threads;
+    DFiberWorkerT* workers;
+    DFiberStackPoolT stacks;
+    DThreadPoolT* blocking;
+    uint32_t nextWorker;
+    uint32_t live;
+    uint32_t stop;
+    uint32_t signal;
+    uint32_t sleepers;
+} DFiberSchedulerT;
+
+/**
+ * @struct DFiberBlockingCallT
+ * @brief A blocking call handed to the blocking threads, lives on the stack of the suspended fiber.
+ */
+typedef struct {
+    TaskFunctionT function;
+    void* argument;
+    DFiberT* fiber;
+} DFiberBlockingCallT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Initialize a stack pool.
+ * @param pool[in] The stack pool.
+ * @param stackSize[in] Usable bytes per stack, rounded up to whole pages.
+ */
+static void fiber_stack_pool_init(DFiberStackPoolT* pool, size_t stackSize);
+
+/**
+ * @brief Unmap every pooled stack. Stacks still in use must have been released.
+ * @param pool[in] The stack pool.
+ */
+static void fiber_stack_pool_destroy(DFiberStackPoolT* pool);
+
+/**
+ * @brief Take a stack from the pool, mapping a new one when the pool is empty.
+ * @param pool[in] The stack pool.
+ * @return The lowest address of the mapping, guard included, or NULL when mapping failed.
+ */
+static int8_t* fiber_stack_acquire(DFiberStackPoolT* pool);
+
+/**
+ * @brief Return a stack to the pool.
+ * @param pool[in] The stack pool.
+ * @param stack[in] A stack from fiber_stack_acquire.
+ */
+static void fiber_stack_release(DFiberStackPoolT* pool, int8_t* stack);
+
+/**
+ * @brief Create a fiber scheduler and start its workers.
+ * @param workerCount[in] The number of worker threads, 0 for one per processor.
+ * @param stackSize[in] Usable stack bytes per fiber, 0 for CFIBER_DEFAULT_STACK_SIZE.
+ * @param blockingThreads[in] Threads that run fiber_blocking_call, 0 to run blocking calls on the workers.
+ * @return A pointer to the new scheduler.
+ */
+static DFiberSchedulerT* fiber_scheduler_create(uint32_t workerCount, size_t stackSize, uint32_t blockingThreads);
+
+/**
+ * @brief Wait for every fiber to finish, then stop the workers and free the scheduler.
+ * @param scheduler[in] The scheduler.
+ */
+static void fiber_scheduler_destroy(DFiberSchedulerT* scheduler);
+
+/**
+ * @brief Block the calling thread until every spawned fiber finished. Must not be called from a fiber.
+ * @param scheduler[in] The scheduler.
+ */
+static void fiber_scheduler_wait_idle(DFiberSchedulerT* scheduler);
+
+/**
+ * @brief Get the number of workers.
+ * @param scheduler[in] The scheduler.
+ * @return The number of workers.
+ */
+static uint32_t fiber_scheduler_worker_count(DFiberSchedulerT* scheduler);
+
+/**
+ * @brief Start a fiber. Spawned from a fiber it is queued on the same worker, else workers take turns.
+ * @param scheduler[in] The scheduler.
+ * @param function[in] The entry point.
+ * @param argument[in] The argument passed to function.
+ * @return TRUE on success, FALSE when no stack could be mapped or every run queue is full.
+ */
+static BOOL fiber_spawn(DFiberSchedulerT* scheduler, FiberFunctionT function, void* argument);
+
+/**
+ * @brief Get the running fiber.
+ * @return The fiber, NULL when called outside of a fiber.
+ */
+static DFiberT* fiber_current(void);
+
+/**
+ * @brief Let the other ready fibers of the worker run, the calling fiber goes to the back of the run queue.
+ */
+static void fiber_yield(void);
+
+/**
+ * @brief Suspend the calling fiber until fiber_resume is called on it.
+ *
+ * This is the integration point for asynchronous I/O: publish registers the fiber with the completion source, for
+ * example stores it in the request, and the completion handler calls fiber_resume from any thread. Resuming before
+ * the fiber has switched out is fine, the fiber is then put straight back on its run queue.
+ *
+ * @param publish[in] Called with the fiber after it is marked as suspending, may be NULL.
+ * @param argument[in] The argument passed to publish.
+ */
+static void fiber_suspend(FiberPublishT publish, void* argument);
+
+/**
+ * @brief Make a suspended fiber ready again. Callable from any thread, once per fiber_suspend.
+ * @param fiber[in] The fiber.
+ */
+static void fiber_resume(DFiberT* fiber);
+
+/**
+ * @brief Run a blocking function, such as a file read, without blocking the worker.
+ *
+ * The calling fiber is suspended while function runs on the scheduler's blocking threads, the other fibers keep the
+ * worker busy. Runs function directly outside of a fiber or when the scheduler has no blocking threads.
+ *
+ * @param function[in] The blocking function.
+ * @param argument[in] The argument passed to function.
+ */
+static void fiber_blocking_call(TaskFunctionT function, void* argument);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+static CTHREAD_LOCAL DFiberWorkerT* fiber_self = NULL;
+
+/* A fiber may continue on another thread after a switch. Reading the thread-local through a call the compiler can
+ * neither inline nor merge keeps it from reusing a thread-local address computed before the switch. That is also
+ * why it is not declared inline, GCC rejects inline together with noinline. */
+#if defined(__GNUC__)
+__attribute__((noinline, unused))
+#endif
+static DFiberWorkerT* fiber_current_worker(void)
+{
+#if defined(__GNUC__)
+    __asm__ __volatile__("" ::: "memory");
+#endif
+    return fiber_self;
+}
+
+inline static void fiber_entry(void);
+
+#if defined(CFIBER_BACKEND_ASM) && defined(__x86_64__)
+/* Saves rbp, rbx, r12-r15 and the SSE/x87 control words on the current stack, stores the stack pointer in *from
+ * and continues on the stack of to. The frame is the one fiber_context_prepare builds. */
+__attribute__((naked, noinline, unused)) static void fiber_context_switch_asm(void** from __attribute__((unused)),
+                                                                              void* to __attribute__((unused)))
+{
+    __asm__ __volatile__("pushq %rbp\n\t"
+                         "pushq %rbx\n\t"
+                         "pushq %r12\n\t"
+                         "pushq %r13\n\t"
+                         "pushq %r14\n\t"
+                         "pushq %r15\n\t"
+                         "subq $8, %rsp\n\t"
+                         "stmxcsr (%rsp)\n\t"
+                         "fnstcw 4(%rsp)\n\t"
+                         "movq %rsp, (%rdi)\n\t"
+                         "movq %rsi, %rsp\n\t"
+                         "ldmxcsr (%rsp)\n\t"
+                         "fldcw 4(%rsp)\n\t"
+                         "addq $8, %rsp\n\t"
+                         "popq %r15\n\t"
+                         "popq %r14\n\t"
+                         "popq %r13\n\t"
+                         "popq %r12\n\t"
+                         "popq %rbx\n\t"
+                         "popq %rbp\n\t"
+                         "ret\n\t");
+}
+#elif defined(CFIBER_BACKEND_ASM) && defined(__aarch64__)
+/* Saves x19-x30 and d8-d15 on the current stack, stores the stack pointer in *from and continues on the stack of
+ * to. The frame is the one fiber_context_prepare builds. */
+__attribute__((naked, noinline, unused)) static void fiber_context_switch_asm(void** from __attribute__((unused)),
+                                                                              void* to __attribute__((unused)))
+{
+    __asm__ __volatile__("sub sp, sp, #160\n\t"
+                         "stp x19, x20, [sp, #0]\n\t"
+                         "stp x21, x22, [sp, #16]\n\t"
+                         "stp x23, x24, [sp, #32]\n\t"
+                         "stp x25, x26, [sp, #48]\n\t"
+                         "stp x27, x28, [sp, #64]\n\t"
+                         "stp x29, x30, [sp, #80]\n\t"
+                         "stp d8, d9, [sp, #96]\n\t"
+                         "stp d10, d11, [sp, #112]\n\t"
+                         "stp d12, d13, [sp, #128]\n\t"
+                         "stp d14, d15, [sp, #144]\n\t"
+                         "mov x9, sp\n\t"
+                         "str x9, [x0]\n\t"
+                         "mov sp, x1\n\t"
+                         "ldp x19, x20, [sp, #0]\n\t"
+                         "ldp x21, x22, [sp, #16]\n\t"
+                         "ldp x23, x24, [sp, #32]\n\t"
+                         "ldp x25, x26, [sp, #48]\n\t"
+                         "ldp x27, x28, [sp, #64]\n\t"
+                         "ldp x29, x30, [sp, #80]\n\t"
+                         "ldp d8, d9, [sp, #96]\n\t"
+                         "ldp d10, d11, [sp, #112]\n\t"
+                         "ldp d12, d13, [sp, #128]\n\t"
+                         "ldp d14, d15, [sp, #144]\n\t"
+                         "add sp, sp, #160\n\t"
+                         "ret\n\t");
+}
+#elif defined(CFIBER_BACKEND_WINDOWS)
+inline static VOID CALLBACK fiber_entry_windows(PVOID parameter)
+{
+    (void) parameter;
+    fiber_entry();
+}
+#endif
+
+inline static void fiber_context_switch(DFiberContextT* from, DFiberContextT* to)
+{
+#if defined(CFIBER_BACKEND_ASM)
+    fiber_context_switch_asm(&from->stackPointer, to->stackPointer);
+#elif defined(CFIBER_BACKEND_UCONTEXT)
+    swapcontext(&from->context, &to->context);
+#else
+    (void) from;
+    SwitchToFiber(to->fiber);
+#endif
+}
+
+/* Sets up a fiber so that the first switch to it enters fiber_entry at the top of its stack. */
+inline static BOOL fiber_context_prepare(DFiberT* fiber, DFiberStackPoolT* pool)
+{
+    BOOL result = TRUE;
+#if defined(CFIBER_BACKEND_ASM)
+    uintptr_t top = ((uintptr_t) (fiber->stack + pool->guardSize + pool->stackSize)) & ~(uintptr_t) 15u;
+#if defined(__x86_64__)
+    /* Control words, r15, r14, r13, r12, rbx, rbp, the return address and the slot fiber_entry sees as its own
+     * return address, which keeps the stack 16 byte aligned at its entry. */
+    uint64_t* frame = (uint64_t*) (top - 9u * sizeof(uint64_t));
+    CMEMSET(frame, 0, 9u * sizeof(uint64_t));
+    ((uint32_t*) frame)[0] = 0x1F80u;
+    ((uint16_t*) frame)[2] = 0x037Fu;
+    frame[7] = (uint64_t) (uintptr_t) fiber_entry;
+#else
+    /* x19-x30 and d8-d15, the link register x30 holds the entry point. */
+    uint64_t* frame = (uint64_t*) (top - 20u * sizeof(uint64_t));
+    CMEMSET(frame, 0, 20u * sizeof(uint64_t));
+    frame[11] = (uint64_t) (uintptr_t) fiber_entry;
+#endif
+    fiber->context.stackPointer = frame;
+#elif defined(CFIBER_BACKEND_UCONTEXT)
+    if (0 != getcontext(&fiber->context.context))
+    {
+        LOG_ERROR("Can not get context!\n");
+        result = FALSE;
+    }
+    else
+    {
+        fiber->context.context.uc_stack.ss_sp = fiber->stack + pool->guardSize;
+        fiber->context.context.uc_stack.ss_size = pool->stackSize;
+        fiber->context.context.uc_link = NULL;
+        makecontext(&fiber->context.context, fiber_entry, 0);
+    }
+#else
+    fiber->context.fiber = CreateFiber(pool->stackSize, fiber_entry_windows, NULL);
+    if (NULL == fiber->context.fiber)
+    {
+        LOG_ERROR("Can not create fiber!\n");
+        result = FALSE;
+    }
+#endif
+    return result;
+}
+
+inline static void fiber_stack_pool_init(DFiberStackPoolT* pool, size_t stackSize)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t page = (size_t) info.dwPageSize;
+#else
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t page = (pageSize > 0) ? (size_t) pageSize : 4096u;
+#endif
+    size_t size = (0u == stackSize) ? CFIBER_DEFAULT_STACK_SIZE : stackSize;
+    pool->stackSize = ((size + page - 1u) / page) * page;
+    pool->guardSize = page;
+    csync_mutex_init(&pool->lock);
+    pool->free = NULL;
+    pool->freeCount = 0;
+    pool->mapped = 0;
+}
+
+inline static void fiber_stack_unmap(DFiberStackPoolT* pool, int8_t* stack)
+{
+#if defined(_WIN32)
+    (void) pool;
+    VirtualFree(stack, 0, MEM_RELEASE);
+#else
+    munmap(stack, pool->guardSize + pool->stackSize);
+#endif
+}
+
+inline static void fiber_stack_pool_destroy(DFiberStackPoolT* pool)
+{
+    csync_mutex_lock(&pool->lock);
+    while (NULL != pool->free)
+    {
+        int8_t* stack = pool->free;
+        CMEMCPY(&pool->free, stack + pool->guardSize, sizeof(int8_t*));
+        fiber_stack_unmap(pool, stack);
+        pool->mapped--;
+    }
+    pool->freeCount = 0;
+    csync_mutex_unlock(&pool->lock);
+}
+
+inline static int8_t* fiber_stack_acquire(DFiberStackPoolT* pool)
+{
+    int8_t* stack = NULL;
+    csync_mutex_lock(&pool->lock);
+    if (NULL != pool->free)
+    {
+        stack = pool->free;
+        CMEMCPY(&pool->free, stack + pool->guardSize, sizeof(int8_t*));
+        pool->freeCount--;
+    }
+    csync_mutex_unlock(&pool->lock);
+
+    if (NULL == stack)
+    {
+        size_t size = pool->guardSize + pool->stackSize;
+#if defined(_WIN32)
+        DWORD previous;
+        stack = (int8_t*) VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if ((NULL != stack) && (0 == VirtualProtect(stack, pool->guardSize, PAGE_NOACCESS, &previous)))
+        {
+            VirtualFree(stack, 0, MEM_RELEASE);
+            stack = NULL;
+        }
+#else
+        void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        stack = (MAP_FAILED == mapping) ? NULL : (int8_t*) mapping;
+        if ((NULL != stack) && (0 != mprotect(stack, pool->guardSize, PROT_NONE)))
+        {
+            munmap(stack, size);
+            stack = NULL;
+        }
+#endif
+        if (NULL == stack) { LOG_ERROR("Can not map fiber stack!\n"); }
+        else { CATOMIC_FETCH_ADD(&pool->mapped, 1u); }
+    }
+    return stack;
+}
+
+inline static void fiber_stack_release(DFiberStackPoolT* pool, int8_t* stack)
+{
+    BOOL pooled = FALSE;
+    csync_mutex_lock(&pool->lock);
+    if (pool->freeCount < CFIBER_STACK_POOL_LIMIT)
+    {
+        CMEMCPY(stack + pool->guardSize, &pool->free, sizeof(int8_t*));
+        pool->free = stack;
+        pool->freeCount++;
+        pooled = TRUE;
+    }
+    csync_mutex_unlock(&pool->lock);
+
+    if (FALSE == pooled)
+    {
+        fiber_stack_unmap(pool, stack);
+        CATOMIC_FETCH_SUB(&pool->mapped, 1u);
+    }
+}
+
+/* Wakes one sleeping worker. Pairs with the seq_cst increment of sleepers in fiber_worker_main. */
+inline static void fiber_notify(DFiberSchedulerT* scheduler)
+{
+    CATOMIC_FENCE_SEQ_CST();
+    if (0u != CATOMIC_LOAD_RELAXED(&scheduler->sleepers))
+    {
+        CATOMIC_FETCH_ADD(&scheduler->signal, 1u);
+        catomic_wake_one(&scheduler->signal);
+    }
+}
+
+/* Queues a ready fiber on the run queue of worker start, or the next one with room. */
+inline static BOOL fiber_try_enqueue(DFiberSchedulerT* scheduler, DFiberT* fiber, uint32_t start)
+{
+    BOOL queued = FALSE;
+    for (uint32_t i = 0; (FALSE == queued) && (i < scheduler->workerCount); i++)
+    {
+        queued = mpmc_try_push(scheduler->workers[(start + i) % scheduler->workerCount].runQueue, &fiber);
+    }
+    if (TRUE == queued) { fiber_notify(scheduler); }
+    return queued;
+}
+
+/* Same as fiber_try_enqueue for fibers that already exist, waits for room instead of failing. */
+inline static void fiber_enqueue(DFiberSchedulerT* scheduler, DFiberT* fiber, uint32_t start)
+{
+    while (FALSE == fiber_try_enqueue(scheduler, fiber, start)) { cthread_yield(); }
+}
+
+/* Looks for a ready fiber: the own run queue first, then the other workers'. */
+inline static BOOL fiber_find(DFiberSchedulerT* scheduler, uint32_t self, DFiberT** fiber)
+{
+    BOOL found = FALSE;
+    for (uint32_t i = 0; (FALSE == found) && (i < scheduler->workerCount); i++)
+    {
+        found = mpmc_try_pop(scheduler->workers[(self + i) % scheduler->workerCount].runQueue, fiber);
+    }
+    return found;
+}
+
+inline static void fiber_free(DFiberSchedulerT* scheduler, DFiberT* fiber)
+{
+#if defined(CFIBER_BACKEND_WINDOWS)
+    if (NULL != fiber->context.fiber) { DeleteFiber(fiber->context.fiber); }
+#endif
+    if (NULL != fiber->stack) { fiber_stack_release(&scheduler->stacks, fiber->stack); }
+    CFREE(fiber, sizeof(DFiberT));
+}
+
+inline static void fiber_entry(void)
+{
+    DFiberT* fiber = fiber_current_worker()->current;
+    fiber->function(fiber->argument);
+
+    DFiberWorkerT* worker = fiber_current_worker();
+    CATOMIC_STORE_RELEASE(&fiber->state, CFIBER_FINISHED);
+    fiber_context_switch(&fiber->context, &worker->context);
+}
+
+/* Switches to a fiber and, once it switches back, does what its state asks for. */
+inline static void fiber_run(DFiberWorkerT* worker, DFiberT* fiber)
+{
+    DFiberSchedulerT* scheduler = worker->scheduler;
+    worker->current = fiber;
+    fiber->home = worker->index;
+    CATOMIC_STORE_RELAXED(&fiber->state, CFIBER_RUNNING);
+    fiber_context_switch(&worker->context, &fiber->context);
+    worker->current = NULL;
+
+    uint32_t state = CATOMIC_LOAD_ACQUIRE(&fiber->state);
+    if (CFIBER_FINISHED == state)
+    {
+        fiber_free(scheduler, fiber);
+        if (1u == CATOMIC_FETCH_SUB(&scheduler->live, 1u)) { catomic_wake_all(&scheduler->live); }
+    }
+    else if (CFIBER_YIELDING == state)
+    {
+        CATOMIC_STORE_RELAXED(&fiber->state, CFIBER_READY);
+        fiber_enqueue(scheduler, fiber, worker->index);
+    }
+    else if ((CFIBER_RESUMED == state) || (FALSE == CATOMIC_CAS(&fiber->state, &state, CFIBER_SUSPENDED)))
+    {
+        /* fiber_resume ran before the fiber was off its stack. */
+        CATOMIC_STORE_RELAXED(&fiber->state, CFIBER_READY);
+        fiber_enqueue(scheduler, fiber, worker->index);
+    }
+}
+
+inline static void fiber_worker_main(void* argument)
+{
+    DFiberWorkerT* worker = (DFiberWorkerT*) argument;
+    DFiberSchedulerT* scheduler = worker->scheduler;
+    DFiberT* fiber = NULL;
+    uint32_t idle = 0;
+    BOOL running = TRUE;
+    fiber_self = worker;
+#if defined(CFIBER_BACKEND_WINDOWS)
+    worker->context.fiber = ConvertThreadToFiber(NULL);
+#endif
+
+    while (TRUE == running)
+    {
+        if (TRUE == fiber_find(scheduler, worker->index, &fiber))
+        {
+            fiber_run(worker, fiber);
+            idle = 0;
+        }
+        else if (0u != CATOMIC_LOAD_ACQUIRE(&scheduler->stop)) { running = FALSE; }
+        else if (idle < CFIBER_SPIN_COUNT)
+        {
+            CATOMIC_PAUSE();
+            idle++;
+        }
+        else
+        {
+            uint32_t expected = CATOMIC_LOAD_ACQUIRE(&scheduler->signal);
+            CATOMIC_FETCH_ADD(&scheduler->sleepers, 1u);
+            CATOMIC_FENCE_SEQ_CST();
+            if (TRUE == fiber_find(scheduler, worker->index, &fiber))
+            {
+                CATOMIC_FETCH_SUB(&scheduler->sleepers, 1u);
+                fiber_run(worker, fiber);
+            }
+            else
+            {
+                if (0u == CATOMIC_LOAD_ACQUIRE(&scheduler->stop)) { catomic_wait(&scheduler->signal, expected, 0); }
+                CATOMIC_FETCH_SUB(&scheduler->sleepers, 1u);
+            }
+            idle = 0;
+        }
+    }
+#if defined(CFIBER_BACKEND_WINDOWS)
+    ConvertFiberToThread();
+#endif
+    fiber_self = NULL;
+}
+
+inline static DFiberSchedulerT* fiber_scheduler_create(uint32_t workerCount, size_t stackSize, uint32_t blockingThreads)
+{
+    DFiberSchedulerT* scheduler = (DFiberSchedulerT*) CCALLOC(1, sizeof(DFiberSchedulerT));
+    uint32_t workers = (0u == workerCount) ? cthread_hardware_concurrency() : workerCount;
+    if (NULL == scheduler) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        fiber_stack_pool_init(&scheduler->stacks, stackSize);
+        scheduler->threads = (CThreadT*) CCALLOC(workers, sizeof(CThreadT));
+        scheduler->workers = (DFiberWorkerT*) CCALLOC(workers, sizeof(DFiberWorkerT));
+        if (0u != blockingThreads) { scheduler->blocking = tpool_create(blockingThreads); }
+        if ((NULL == scheduler->threads) || (NULL == scheduler->workers) ||
+            ((0u != blockingThreads) && (NULL == scheduler->blocking)))
+        {
+            LOG_ERROR("Can not allocate fiber scheduler!\n");
+            fiber_scheduler_destroy(scheduler);
+            scheduler = NULL;
+        }
+        else { scheduler->workerCount = workers; }
+    }
+
+    for (uint32_t i = 0; (NULL != scheduler) && (i < workers); i++)
+    {
+        DFiberWorkerT* worker = &scheduler->workers[i];
+        worker->scheduler = scheduler;
+        worker->index = i;
+        worker->runQueue = mpmc_create_generic(sizeof(DFiberT*), CFIBER_RUN_QUEUE_CAPACITY);
+        if (NULL == worker->runQueue)
+        {
+            LOG_ERROR("Can not allocate run queue!\n");
+            fiber_scheduler_destroy(scheduler);
+            scheduler = NULL;
+        }
+    }
+
+    for (uint32_t i = 0; (NULL != scheduler) && (i < workers); i++)
+    {
+        if (TRUE == cthread_create(&scheduler->threads[i], fiber_worker_main, &scheduler->workers[i]))
+        {
+            scheduler->threadCount = i + 1u;
+        }
+        else
+        {
+            LOG_ERROR("Can not start worker thread!\n");
+            fiber_scheduler_destroy(scheduler);
+            scheduler = NULL;
+        }
+    }
+    return scheduler;
+}
+
+inline static void fiber_scheduler_destroy(DFiberSchedulerT* scheduler)
+{
+    if (NULL != scheduler)
+    {
+        if (0u != scheduler->threadCount) { fiber_scheduler_wait_idle(scheduler); }
+        CATOMIC_STORE_RELEASE(&scheduler->stop, 1u);
+        CATOMIC_FETCH_ADD(&scheduler->signal, 1u);
+        catomic_wake_all(&scheduler->signal);
+        for (uint32_t i = 0; i < scheduler->threadCount; i++) { cthread_join(scheduler->threads[i]); }
+
+        if (NULL != scheduler->workers)
+        {
+            for (uint32_t i = 0; i < scheduler->workerCount; i++) { mpmc_destroy(scheduler->workers[i].runQueue); }
+            CFREE(scheduler->workers, scheduler->workerCount * sizeof(DFiberWorkerT));
+        }
+        if (NULL != scheduler->threads) { CFREE(scheduler->threads, scheduler->workerCount * sizeof(CThreadT)); }
+        tpool_destroy(scheduler->blocking);
+        fiber_stack_pool_destroy(&scheduler->stacks);
+        CFREE(scheduler, sizeof(DFiberSchedulerT));
+    }
+}
+
+inline static void fiber_scheduler_wait_idle(DFiberSchedulerT* scheduler)
+{
+    uint32_t live = CATOMIC_LOAD_ACQUIRE(&scheduler->live);
+    while (0u != live)
+    {
+        catomic_wait(&scheduler->live, live, 0);
+        live = CATOMIC_LOAD_ACQUIRE(&scheduler->live);
+    }
+}
+
+inline static uint32_t fiber_scheduler_worker_count(DFiberSchedulerT* scheduler) { return scheduler->workerCount; }
+
+inline static BOOL fiber_spawn(DFiberSchedulerT* scheduler, FiberFunctionT function, void* argument)
+{
+    BOOL result = FALSE;
+    DFiberT* fiber = (DFiberT*) CCALLOC(1, sizeof(DFiberT));
+    if (NULL == fiber) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        fiber->function = function;
+        fiber->argument = argument;
+        fiber->scheduler = scheduler;
+        fiber->state = CFIBER_READY;
+#if !defined(CFIBER_BACKEND_WINDOWS)
+        fiber->stack = fiber_stack_acquire(&scheduler->stacks);
+        result = (NULL != fiber->stack) ? TRUE : FALSE;
+#else
+        result = TRUE;
+#endif
+        if (TRUE == result) { result = fiber_context_prepare(fiber, &scheduler->stacks); }
+    }
+
+    if (TRUE == result)
+    {
+        DFiberWorkerT* self = fiber_current_worker();
+        uint32_t start = ((NULL != self) && (scheduler == self->scheduler))
+                                 ? self->index
+                                 : CATOMIC_FETCH_ADD_RELAXED(&scheduler->nextWorker, 1u) % scheduler->workerCount;
+        CATOMIC_FETCH_ADD(&scheduler->live, 1u);
+        result = fiber_try_enqueue(scheduler, fiber, start);
+        if (FALSE == result)
+        {
+            LOG_ERROR("Run queues are full!\n");
+            CATOMIC_FETCH_SUB(&scheduler->live, 1u);
+        }
+    }
+    if ((FALSE == result) && (NULL != fiber)) { fiber_free(scheduler, fiber); }
+    return result;
+}
+
+inline static DFiberT* fiber_current(void)
+{
+    DFiberWorkerT* self = fiber_current_worker();
+    return (NULL != self) ? self->current : NULL;
+}
+
+inline static void fiber_yield(void)
+{
+    DFiberWorkerT* self = fiber_current_worker();
+    if ((NULL != self) && (NULL != self->current))
+    {
+        DFiberT* fiber = self->current;
+        CATOMIC_STORE_RELAXED(&fiber->state, CFIBER_YIELDING);
+        fiber_context_switch(&fiber->context, &self->context);
+    }
+}
+
+inline static void fiber_suspend(FiberPublishT publish, void* argument)
+{
+    DFiberWorkerT* self = fiber_current_worker();
+    if ((NULL == self) || (NULL == self->current)) { LOG_ERROR("Not called from a fiber!\n"); }
+    else
+    {
+        DFiberT* fiber = self->current;
+        CATOMIC_STORE_RELEASE(&fiber->state, CFIBER_SUSPENDING);
+        if (NULL != publish) { publish(fiber, argument); }
+        fiber_context_switch(&fiber->context, &self->context);
+    }
+}
+
+inline static void fiber_resume(DFiberT* fiber)
+{
+    BOOL done = FALSE;
+    while (FALSE == done)
+    {
+        uint32_t state = CATOMIC_LOAD_ACQUIRE(&fiber->state);
+        if (CFIBER_SUSPENDED == state)
+        {
+            if (TRUE == CATOMIC_CAS(&fiber->state, &state, CFIBER_READY))
+            {
+                fiber_enqueue(fiber->scheduler, fiber, fiber->home);
+                done = TRUE;
+            }
+        }
+        else if (CFIBER_SUSPENDING == state) { done = CATOMIC_CAS(&fiber->state, &state, CFIBER_RESUMED); }
+        else
+        {
+            LOG_ERROR("Fiber is not suspended!\n");
+            done = TRUE;
+        }
+    }
+}
+
+inline static void fiber_blocking_task(void* argument)
+{
+    DFiberBlockingCallT* call = (DFiberBlockingCallT*) argument;
+    DFiberT* fiber = call->fiber;
+    call->function(call->argument);
+    fiber_resume(fiber);
+}
+
+inline static void fiber_blocking_publish(DFiberT* fiber, void* argument)
+{
+    DFiberBlockingCallT* call = (DFiberBlockingCallT*) argument;
+    call->fiber = fiber;
+    tpool_submit(fiber->scheduler->blocking, NULL, fiber_blocking_task, call);
+}
+
+inline static void fiber_blocking_call(TaskFunctionT function, void* argument)
+{
+    DFiberT* fiber = fiber_current();
+    if ((NULL == fiber) || (NULL == fiber->scheduler->blocking)) { function(argument); }
+    else
+    {
+        DFiberBlockingCallT call = {function, argument, NULL};
+        fiber_suspend(fiber_blocking_publish, &call);
+    }
+}
+
+#endif// CFIBER_HEADER
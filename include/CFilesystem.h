@@ -101,6 +101,24 @@ typedef struct {
     size_t creationTime[2];
 } FileInfoT;
 
+/**
+ * @struct FileMappingT
+ * @brief A file mapped into memory.
+ *
+ * @var data The first byte of the mapping, NULL for empty files.
+ * @var size The size of the mapping in bytes.
+ * @var writable TRUE if writes through data reach the file.
+ * @var handle The file descriptor (POSIX) or file HANDLE (Windows).
+ * @var mappingHandle The file mapping HANDLE on Windows, unused on POSIX.
+ */
+typedef struct {
+    int8_t* data;
+    size_t size;
+    BOOL writable;
+    intptr_t handle;
+    intptr_t mappingHandle;
+} FileMappingT;
+
 /***********************************************************************************************************************
 Static functions implementation
 ***********************************************************************************************************************/
@@ -243,9 +261,11 @@ FileOpResultT file_read_utf8(const int8_t* filename, size_t* filesize, int8_t**
     if (FILE_READ_SUCCESFULLY == result)
     {
         if (cstr_contains_utf8_bom(*buffer) == FALSE) { LOG_INFO("File does not contain utf-8 BOM\n"); }
-        if (cstr_is_valid_utf8(*buffer, *filesize) == FALSE)
+        size_t errorOffset = 0;
+        if (cstr_validate_utf8(*buffer, *filesize, &errorOffset) == FALSE)
         {
-            LOG_ERROR("File is corrupted or does not use utf-8 encoding!\n");
+            LOG_ERROR("File is corrupted or does not use utf-8 encoding at byte %llu!\n",
+                      (unsigned long long) errorOffset);
             result = FILE_CORRUPTED_OR_WRONG_ENCODING;
         }
     }
@@ -510,4 +530,264 @@ inline static BOOL list_directory_contents(const int8_t* dir, FolderContentsT* c
 }
 #endif
 
+#ifdef _WIN32
+/**
+ * @brief Maps a whole file into memory
+ * @param path Path of the file
+ * @param writable TRUE to map the file for reading and writing, FALSE for reading only
+ * @param mapping Receives the mapping, release it with file_unmap
+ * @return File Operation Result
+ */
+inline static FileOpResultT file_map(const int8_t* path, BOOL writable, FileMappingT* mapping)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+    DWORD access = (TRUE == writable) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+    HANDLE file = CreateFileA((const char*) path, access, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+    LARGE_INTEGER fileSize;
+
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->writable = writable;
+    mapping->handle = (intptr_t) INVALID_HANDLE_VALUE;
+    mapping->mappingHandle = 0;
+
+    if (INVALID_HANDLE_VALUE == file)
+    {
+        LOG_ERROR("Can not open %s!\n", path);
+        result = FILE_OPEN_ERROR;
+    }
+    else if (FALSE == GetFileSizeEx(file, &fileSize))
+    {
+        LOG_ERROR("Can not get the size of %s!\n", path);
+        result = FILE_READ_ERROR;
+    }
+    else if (fileSize.QuadPart > 0)
+    {
+        DWORD protect = (TRUE == writable) ? PAGE_READWRITE : PAGE_READONLY;
+        HANDLE fileMapping = CreateFileMappingA(file, NULL, protect, 0, 0, NULL);
+        void* address = NULL;
+        if (NULL != fileMapping)
+        {
+            address = MapViewOfFile(fileMapping, (TRUE == writable) ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+        }
+        if (NULL == address)
+        {
+            LOG_ERROR("Can not map %s!\n", path);
+            if (NULL != fileMapping) { CloseHandle(fileMapping); }
+            result = FILE_READ_ERROR;
+        }
+        else
+        {
+            mapping->data = (int8_t*) address;
+            mapping->size = (size_t) fileSize.QuadPart;
+            mapping->mappingHandle = (intptr_t) fileMapping;
+        }
+    }
+
+    if (FILE_OPERATION_SUCCESS == result) { mapping->handle = (intptr_t) file; }
+    else if (INVALID_HANDLE_VALUE != file) { CloseHandle(file); }
+    return result;
+}
+
+/**
+ * @brief Releases a mapping created by file_map
+ * @param mapping The mapping
+ */
+inline static void file_unmap(FileMappingT* mapping)
+{
+    if (NULL != mapping->data) { UnmapViewOfFile(mapping->data); }
+    if (0 != mapping->mappingHandle) { CloseHandle((HANDLE) mapping->mappingHandle); }
+    if ((intptr_t) INVALID_HANDLE_VALUE != mapping->handle) { CloseHandle((HANDLE) mapping->handle); }
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->handle = (intptr_t) INVALID_HANDLE_VALUE;
+    mapping->mappingHandle = 0;
+}
+
+/**
+ * @brief Changes the size of a writable mapping and of its file
+ * @param mapping The mapping, its data may move
+ * @param newSize The new size in bytes
+ * @return File Operation Result
+ */
+inline static FileOpResultT file_map_resize(FileMappingT* mapping, size_t newSize)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+    LARGE_INTEGER fileSize;
+    fileSize.QuadPart = (LONGLONG) newSize;
+
+    if (NULL != mapping->data) { UnmapViewOfFile(mapping->data); }
+    if (0 != mapping->mappingHandle) { CloseHandle((HANDLE) mapping->mappingHandle); }
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->mappingHandle = 0;
+
+    if ((FALSE == SetFilePointerEx((HANDLE) mapping->handle, fileSize, NULL, FILE_BEGIN)) ||
+        (FALSE == SetEndOfFile((HANDLE) mapping->handle)))
+    {
+        LOG_ERROR("Can not resize mapped file!\n");
+        result = FILE_WRITE_ERROR;
+    }
+    else if (newSize > 0)
+    {
+        HANDLE fileMapping = CreateFileMappingA((HANDLE) mapping->handle, NULL, PAGE_READWRITE, 0, 0, NULL);
+        void* address = (NULL != fileMapping) ? MapViewOfFile(fileMapping, FILE_MAP_WRITE, 0, 0, 0) : NULL;
+        if (NULL == address)
+        {
+            LOG_ERROR("Can not map resized file!\n");
+            if (NULL != fileMapping) { CloseHandle(fileMapping); }
+            result = FILE_WRITE_ERROR;
+        }
+        else
+        {
+            mapping->data = (int8_t*) address;
+            mapping->size = newSize;
+            mapping->mappingHandle = (intptr_t) fileMapping;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Writes the modified pages of a writable mapping to its file
+ * @param mapping The mapping
+ * @param wait TRUE to return once the data is on disk, FALSE to only schedule the write
+ * @return File Operation Result
+ */
+inline static FileOpResultT file_map_sync(FileMappingT* mapping, BOOL wait)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+    if ((NULL != mapping->data) && (FALSE == FlushViewOfFile(mapping->data, mapping->size)))
+    {
+        result = FILE_WRITE_ERROR;
+    }
+    else if ((TRUE == wait) && (FALSE == FlushFileBuffers((HANDLE) mapping->handle))) { result = FILE_WRITE_ERROR; }
+    if (FILE_OPERATION_SUCCESS != result) { LOG_ERROR("Can not sync mapped file!\n"); }
+    return result;
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Maps a whole file into memory
+ * @param path Path of the file
+ * @param writable TRUE to map the file for reading and writing, FALSE for reading only
+ * @param mapping Receives the mapping, release it with file_unmap
+ * @return File Operation Result
+ */
+inline static FileOpResultT file_map(const int8_t* path, BOOL writable, FileMappingT* mapping)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+    int32_t fd = open((const char*) path, (TRUE == writable) ? O_RDWR : O_RDONLY);
+    struct stat fileStat;
+
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->writable = writable;
+    mapping->handle = -1;
+    mapping->mappingHandle = 0;
+
+    if (fd < 0)
+    {
+        LOG_ERROR("Can not open %s!\n", path);
+        result = FILE_OPEN_ERROR;
+    }
+    else if (0 != fstat(fd, &fileStat))
+    {
+        LOG_ERROR("Can not get file stat! \n%s\n", path);
+        result = FILE_READ_ERROR;
+    }
+    else if (fileStat.st_size > 0)
+    {
+        int32_t protection = (TRUE == writable) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* address = mmap(NULL, (size_t) fileStat.st_size, protection, MAP_SHARED, fd, 0);
+        if (MAP_FAILED == address)
+        {
+            LOG_ERROR("Can not map %s!\n", path);
+            result = FILE_READ_ERROR;
+        }
+        else
+        {
+            mapping->data = (int8_t*) address;
+            mapping->size = (size_t) fileStat.st_size;
+        }
+    }
+
+    if (FILE_OPERATION_SUCCESS == result) { mapping->handle = fd; }
+    else if (fd >= 0) { close(fd); }
+    return result;
+}
+
+/**
+ * @brief Releases a mapping created by file_map
+ * @param mapping The mapping
+ */
+inline static void file_unmap(FileMappingT* mapping)
+{
+    if (NULL != mapping->data) { munmap(mapping->data, mapping->size); }
+    if (mapping->handle >= 0) { close((int32_t) mapping->handle); }
+    mapping->data = NULL;
+    mapping->size = 0;
+    mapping->handle = -1;
+}
+
+/**
+
+ * @brief Changes the size of a writable mapping and of its file
+ * @param mapping The mapping, its data may move
+ * @param newSize The new size in bytes
+ * @return File Operation Result
+ */
+inline static FileOpResultT file_map_resize(FileMappingT* mapping, size_t newSize)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+
+    if (NULL != mapping->data) { munmap(mapping->data, mapping->size); }
+    mapping->data = NULL;
+    mapping->size = 0;
+
+    if (0 != ftruncate((int32_t) mapping->handle, (off_t) newSize))
+    {
+        LOG_ERROR("Can not resize mapped file!\n");
+        result = FILE_WRITE_ERROR;
+    }
+    else if (newSize > 0)
+    {
+        void* address = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, (int32_t) mapping->handle, 0);
+        if (MAP_FAILED == address)
+        {
+            LOG_ERROR("Can not map resized file!\n");
+            result = FILE_WRITE_ERROR;
+        }
+        else
+        {
+            mapping->data = (int8_t*) address;
+            mapping->size = newSize;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Writes the modified pages of a writable mapping to its file
+ * @param mapping The mapping
+ * @param wait TRUE to return once the data is on disk, FALSE to only schedule the write
+ * @return File Operation Result
+ */
+inline static FileOpResultT file_map_sync(FileMappingT* mapping, BOOL wait)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+    if ((NULL != mapping->data) && (0 != msync(mapping->data, mapping->size, (TRUE == wait) ? MS_SYNC : MS_ASYNC)))
+    {
+        LOG_ERROR("Can not sync mapped file!\n");
+        result = FILE_WRITE_ERROR;
+    }
+    return result;
+}
+#endif
+
 #endif// CFILESYSTEM_HEADER
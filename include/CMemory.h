@@ -57,6 +57,7 @@ Macro Definitions
  */
 #ifndef NO_STD_MALLOC
 #define CMEMCPY(dest, p, size) memcpy((void*) (dest), (void*) (p), size)
+#define CMEMMOVE(dest, p, size) memmove((void*) (dest), (void*) (p), size)
 #define CMALLOC(size) malloc(size)
 #define CCALLOC(num, size) calloc(num, size)
 #define CREALLOC(p, new_size) realloc((void*) (p), new_size)
@@ -64,14 +65,43 @@ Macro Definitions
 #define CMEMSET(p, value, size) memset((void*) (p), value, size)
 #else
 #define CMEMCPY(dest, p, size)
+#define CMEMMOVE(dest, p, size)
 #define CMALLOC(size)
 #define CCALLOC(size)
 #define CREALLOC(p, new_size)
 #define CFREE(p, size)
 #define CMEMSET(p, value, size)
 #endif
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @typedef CFreeFunctionT
+ * @brief A function releasing a block, for code that frees memory later or elsewhere than it was retired.
+ */
+typedef void (*CFreeFunctionT)(void* pointer, size_t size);
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief CFREE as a function, the default CFreeFunctionT.
+ * @param pointer[in] The block.
+ * @param size[in] The size of the block.
+ */
+static void cmemory_free(void* pointer, size_t size);
+
 /***********************************************************************************************************************
 Static functions implementation
 ***********************************************************************************************************************/
 
+inline static void cmemory_free(void* pointer, size_t size)
+{
+    (void) size;
+    CFREE(pointer, size);
+}
+
 #endif// CMEMORY_HEADER
\ No newline at end of file
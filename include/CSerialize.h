@@ -0,0 +1,442 @@
+#ifndef CSERIALIZE_HEADER
+#define CSERIALIZE_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CSerialize Header (versioned zero-copy file format for DArrayT and string arrays)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CFilesystem.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "CStringView.h"
+#include "DArray.h"
+#include "DString.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def CSERIALIZE_VERSION
+ * @brief Version of the file format, files of other versions are rejected.
+ */
+#define CSERIALIZE_VERSION 1u
+
+/**
+ * @def CSERIALIZE_ALIGNMENT
+ * @brief Alignment in bytes of every section of a file, relative to the start of the file.
+ */
+#define CSERIALIZE_ALIGNMENT 64u
+
+/**
+ * @def CSERIALIZE_BYTE_ORDER
+ * @brief Written in native byte order, a loader of the other byte order reads it swapped.
+ */
+#define CSERIALIZE_BYTE_ORDER 0x0102u
+
+/**
+ * @def CSERIALIZE_MAGIC_DARRAY
+ * @brief Magic of files written by darr_save.
+ */
+#define CSERIALIZE_MAGIC_DARRAY "CUDARRAY"
+
+/**
+ * @def CSERIALIZE_MAGIC_STRINGS
+ * @brief Magic of files written by str_arr_save.
+ */
+#define CSERIALIZE_MAGIC_STRINGS "CUSTRARR"
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct CSerializeHeaderT
+ * @brief The first CSERIALIZE_ALIGNMENT bytes of a file.
+ *
+ * A DArrayT file holds the elements at dataOffset. A string array file holds
+ * length + 1 uint64_t offsets into the blob at dataOffset and the null
+ * terminated strings at blobOffset.
+ *
+ * @var magic CSERIALIZE_MAGIC_DARRAY or CSERIALIZE_MAGIC_STRINGS, not null terminated.
+ * @var version CSERIALIZE_VERSION.
+ * @var byteOrder CSERIALIZE_BYTE_ORDER.
+ * @var headerSize sizeof(CSerializeHeaderT).
+ * @var elementSize The element size, sizeof(uint64_t) for string arrays.
+ * @var length The number of elements or strings.
+ * @var dataOffset Offset of the elements or string offsets.
+ * @var dataSize Size of the elements or string offsets in bytes.
+ * @var blobOffset Offset of the strings, 0 for DArrayT files.
+ * @var blobSize Size of the strings in bytes, 0 for DArrayT files.
+ */
+typedef struct {
+    int8_t magic[8];
+    uint16_t version;
+    uint16_t byteOrder;
+    uint32_t headerSize;
+    uint64_t elementSize;
+    uint64_t length;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint64_t blobOffset;
+    uint64_t blobSize;
+} CSerializeHeaderT;
+
+/**
+ * @struct CStringTableT
+ * @brief Read-only view of a string array file.
+ *
+ * @var length The number of strings.
+ * @var offsets length + 1 offsets of the strings in blob.
+ * @var blob The null terminated strings.
+ * @var mapping The mapped file.
+ */
+typedef struct {
+    size_t length;
+    const uint64_t* offsets;
+    const int8_t* blob;
+    FileMappingT mapping;
+} CStringTableT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Write a dynamic array to a file.
+ * @param path[in] Path of the file, replaced if it exists.
+ * @param darr[in] The dynamic array.
+ * @return FILE_WROTE_SUCCESFULLY, or the error.
+ */
+static FileOpResultT darr_save(const int8_t* path, DArrayT* darr);
+
+/**
+ * @brief Map a file written by darr_save as a read-only dynamic array.
+ *
+ * The elements are not copied, the array points into the mapping. Growing the
+ * array fails and writing elements faults, copy it to modify it. darr_destroy
+ * unmaps the file.
+ *
+ * @param path[in] Path of the file.
+ * @return A read-only dynamic array, or NULL if the file can not be mapped or is not valid.
+ */
+static DArrayT* darr_load_view(const int8_t* path);
+
+/**
+ * @brief Write a string array (see str_arr_create) to a file.
+ * @param path[in] Path of the file, replaced if it exists.
+ * @param strArray[in] The string array.
+ * @return FILE_WROTE_SUCCESFULLY, or the error.
+ */
+static FileOpResultT str_arr_save(const int8_t* path, DArrayT* strArray);
+
+/**
+ * @brief Map a file written by str_arr_save.
+ * @param path[in] Path of the file.
+ * @param table[out] Receives the view, release it with str_table_close.
+ * @return FILE_READ_SUCCESFULLY, or the error.
+ */
+static FileOpResultT str_table_load(const int8_t* path, CStringTableT* table);
+
+/**
+ * @brief Get a string of a string table.
+ * @param table[in] The string table.
+ * @param index[in] The index, must be in bounds.
+ * @return A view of the string, its data is null terminated.
+ */
+static CStringViewT str_table_get(CStringTableT* table, size_t index);
+
+/**
+ * @brief Get the number of strings of a string table.
+ * @param table[in] The string table.
+ * @return The number of strings.
+ */
+static size_t str_table_length(CStringTableT* table);
+
+/**
+ * @brief Unmap a string table.
+ * @param table[in] The string table.
+ */
+static void str_table_close(CStringTableT* table);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static uint64_t cserialize_align(uint64_t offset)
+{
+    return (offset + CSERIALIZE_ALIGNMENT - 1u) & ~((uint64_t) CSERIALIZE_ALIGNMENT - 1u);
+}
+
+inline static void cserialize_header_init(CSerializeHeaderT* header, const char* magic)
+{
+    CMEMSET(header, 0, sizeof(CSerializeHeaderT));
+    CMEMCPY(header->magic, magic, sizeof(header->magic));
+    header->version = CSERIALIZE_VERSION;
+    header->byteOrder = CSERIALIZE_BYTE_ORDER;
+    header->headerSize = sizeof(CSerializeHeaderT);
+    header->dataOffset = cserialize_align(sizeof(CSerializeHeaderT));
+}
+
+/* Writes zero bytes from offset up to the next section boundary. */
+inline static BOOL cserialize_write_padding(FILE* file, uint64_t offset)
+{
+    static const int8_t padding[CSERIALIZE_ALIGNMENT] = {0};
+    uint64_t paddingSize = cserialize_align(offset) - offset;
+    return ((0u == paddingSize) || (fwrite(padding, 1, (size_t) paddingSize, file) == paddingSize)) ? TRUE : FALSE;
+}
+
+inline static BOOL cserialize_write_section(FILE* file, const void* data, uint64_t count)
+{
+    BOOL result = TRUE;
+    if ((count > 0) && (fwrite(data, 1, (size_t) count, file) != (size_t) count)) { result = FALSE; }
+    return (TRUE == result) ? cserialize_write_padding(file, count) : FALSE;
+}
+
+/* Checks that the mapped file holds a complete file of the given magic and returns its header. */
+inline static const CSerializeHeaderT* cserialize_validate(FileMappingT* mapping, const char* magic)
+{
+    const CSerializeHeaderT* result = NULL;
+    const CSerializeHeaderT* header = (const CSerializeHeaderT*) mapping->data;
+    uint64_t size = mapping->size;
+
+    if (size < sizeof(CSerializeHeaderT)) {}
+    else if (0 != memcmp(header->magic, magic, sizeof(header->magic))) {}
+    else if ((CSERIALIZE_VERSION != header->version) || (CSERIALIZE_BYTE_ORDER != header->byteOrder)) {}
+    else if ((sizeof(CSerializeHeaderT) != header->headerSize) || (0u == header->elementSize)) {}
+    else if ((0u != header->dataOffset % CSERIALIZE_ALIGNMENT) || (header->dataOffset > size)) {}
+    else if (header->dataSize > size - header->dataOffset) {}
+    else if (header->length > header->dataSize / header->elementSize) {}
+    else if ((header->blobOffset > size) || (header->blobSize > size - header->blobOffset)) {}
+    else { result = header; }
+
+    return result;
+}
+
+inline static void darr_view_release(DArrayT* darr)
+{
+    FileMappingT* mapping = (FileMappingT*) darr->storageContext;
+    file_unmap(mapping);
+    CFREE(mapping, sizeof(FileMappingT));
+}
+
+static const DArrayStorageT darr_view_storage = {NULL, darr_view_release, NULL};
+
+inline static FileOpResultT darr_save(const int8_t* path, DArrayT* darr)
+{
+    FileOpResultT result = FILE_WROTE_SUCCESFULLY;
+    FILE* file = fopen((const char*) path, "wb");
+    CSerializeHeaderT header;
+
+    cserialize_header_init(&header, CSERIALIZE_MAGIC_DARRAY);
+    header.elementSize = darr->elementSize;
+    header.length = darr->length;
+    header.dataSize = (uint64_t) darr->length * darr->elementSize;
+
+    if (NULL == file)
+    {
+        LOG_ERROR("Cannot open %s for writing!\n", path);
+        result = FILE_OPEN_ERROR;
+    }
+    else
+    {
+        if ((FALSE == cserialize_write_section(file, &header, sizeof(header))) ||
+            (FALSE == cserialize_write_section(file, darr->data, header.dataSize)))
+        {
+            LOG_ERROR("Error writing to file %s!\n", path);
+            result = FILE_WRITE_ERROR;
+        }
+        fclose(file);
+    }
+
+    return result;
+}
+
+inline static DArrayT* darr_load_view(const int8_t* path)
+{
+    DArrayT* result = NULL;
+    FileMappingT* mapping = (FileMappingT*) CMALLOC(sizeof(FileMappingT));
+    const CSerializeHeaderT* header = NULL;
+
+    if (NULL == mapping) { LOG_ERROR("Can not allocate file mapping!\n"); }
+    else if (FILE_OPERATION_SUCCESS != file_map(path, FALSE, mapping))
+    {
+        CFREE(mapping, sizeof(FileMappingT));
+        mapping = NULL;
+    }
+    else if (NULL == (header = cserialize_validate(mapping, CSERIALIZE_MAGIC_DARRAY)))
+    {
+        LOG_ERROR("%s is not a valid dynamic array file!\n", path);
+    }
+    else if (NULL == (result = (DArrayT*) CMALLOC(sizeof(DArrayT))))
+    {
+        LOG_ERROR("Can not allocate dynamic darray!\n");
+    }
+    else
+    {
+        result->length = (size_t) header->length;
+        result->capacity = (size_t) header->length;
+        result->elementSize = (size_t) header->elementSize;
+        result->data = &mapping->data[header->dataOffset];
+        result->storage = &darr_view_storage;
+        result->storageContext = mapping;
+    }
+
+    if ((NULL == result) && (NULL != mapping))
+    {
+        file_unmap(mapping);
+        CFREE(mapping, sizeof(FileMappingT));
+    }
+    return result;
+}
+
+inline static FileOpResultT str_arr_save(const int8_t* path, DArrayT* strArray)
+{
+    FileOpResultT result = FILE_WROTE_SUCCESFULLY;
+    size_t count = darr_length(strArray);
+    uint64_t* offsets = (uint64_t*) CMALLOC((count + 1) * sizeof(uint64_t));
+    FILE* file = NULL;
+    CSerializeHeaderT header;
+
+    if (NULL == offsets)
+    {
+        LOG_ERROR("Can not allocate string offsets!\n");
+        result = FILE_BUFFER_ALLOCATION_ERROR;
+    }
+    else if (NULL == (file = fopen((const char*) path, "wb")))
+    {
+        LOG_ERROR("Cannot open %s for writing!\n", path);
+        result = FILE_OPEN_ERROR;
+    }
+    else
+    {
+        offsets[0] = 0;
+        for (size_t i = 0; i < count; i++) { offsets[i + 1] = offsets[i] + str_arr_get(strArray, i)->length + 1u; }
+
+        cserialize_header_init(&header, CSERIALIZE_MAGIC_STRINGS);
+        header.elementSize = sizeof(uint64_t);
+        header.length = count;
+        header.dataSize = (count + 1) * sizeof(uint64_t);
+        header.blobOffset = header.dataOffset + cserialize_align(header.dataSize);
+        header.blobSize = offsets[count];
+
+        BOOL written = cserialize_write_section(file, &header, sizeof(header)) &&
+                       cserialize_write_section(file, offsets, header.dataSize);
+        for (size_t i = 0; (TRUE == written) && (i < count); i++)
+        {
+            DStringT* str = str_arr_get(strArray, i);
+            written = ((str->length == fwrite(str->data, 1, str->length, file)) && (0 == fputc('\0', file)))
+                              ? TRUE
+                              : FALSE;
+        }
+        if ((FALSE == written) || (FALSE == cserialize_write_padding(file, header.blobSize)))
+        {
+            LOG_ERROR("Error writing to file %s!\n", path);
+            result = FILE_WRITE_ERROR;
+        }
+        fclose(file);
+    }
+
+    if (NULL != offsets) { CFREE(offsets, (count + 1) * sizeof(uint64_t)); }
+    return result;
+}
+
+inline static FileOpResultT str_table_load(const int8_t* path, CStringTableT* table)
+{
+    FileOpResultT result = file_map(path, FALSE, &table->mapping);
+    BOOL mapped = (FILE_OPERATION_SUCCESS == result) ? TRUE : FALSE;
+    const CSerializeHeaderT* header = NULL;
+
+    table->length = 0;
+    table->offsets = NULL;
+    table->blob = NULL;
+
+    if (FILE_OPERATION_SUCCESS != result) {}
+    else if ((NULL == (header = cserialize_validate(&table->mapping, CSERIALIZE_MAGIC_STRINGS))) ||
+             (header->length >= header->dataSize / sizeof(uint64_t)) || (header->length != (size_t) header->length) ||
+             (header->dataSize != (header->length + 1) * sizeof(uint64_t)))
+    {
+        LOG_ERROR("%s is not a valid string array file!\n", path);
+        result = FILE_CORRUPTED_OR_WRONG_ENCODING;
+    }
+    else
+    {
+        /* Every string ends with a terminator, so the offsets strictly increase and each one follows a '\0'. */
+        const uint64_t* offsets = (const uint64_t*) &table->mapping.data[header->dataOffset];
+        const int8_t* blob = &table->mapping.data[header->blobOffset];
+        BOOL valid = ((0u == offsets[0]) && (offsets[header->length] <= header->blobSize)) ? TRUE : FALSE;
+        for (uint64_t i = 0; (TRUE == valid) && (i < header->length); i++)
+        {
+            valid = ((offsets[i] < offsets[i + 1]) && ('\0' == blob[offsets[i + 1] - 1u])) ? TRUE : FALSE;
+        }
+        if (FALSE == valid)
+        {
+            LOG_ERROR("%s is not a valid string array file!\n", path);
+            result = FILE_CORRUPTED_OR_WRONG_ENCODING;
+        }
+        else
+        {
+            table->length = (size_t) header->length;
+            table->offsets = offsets;
+            table->blob = blob;
+            result = FILE_READ_SUCCESFULLY;
+        }
+    }
+
+    if ((FILE_READ_SUCCESFULLY != result) && (TRUE == mapped)) { file_unmap(&table->mapping); }
+    return result;
+}
+
+inline static CStringViewT str_table_get(CStringTableT* table, size_t index)
+{
+    CStringViewT result;
+    result.data = &table->blob[table->offsets[index]];
+    result.length = (size_t) (table->offsets[index + 1] - table->offsets[index] - 1u);
+    return result;
+}
+
+inline static size_t str_table_length(CStringTableT* table) { return table->length; }
+
+inline static void str_table_close(CStringTableT* table)
+{
+    file_unmap(&table->mapping);
+    table->length = 0;
+    table->offsets = NULL;
+    table->blob = NULL;
+}
+
+#endif// CSERIALIZE_HEADER
@@ -0,0 +1,580 @@
+#ifndef CSYNC_HEADER
+#define CSYNC_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CSync Header (futex based mutex, reader-writer lock, seqlock, barrier and event)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CThread.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def CSYNC_SPIN_MAX
+ * @brief The most polls of a lock before the mutex sleeps on it.
+ */
+#define CSYNC_SPIN_MAX 256u
+
+/**
+ * @def CSYNC_RWLOCK_SLOTS
+ * @brief Reader counters of a reader-writer lock, each on its own cache line.
+ */
+#define CSYNC_RWLOCK_SLOTS 16u
+
+/**
+ * @def CSYNC_COUNT
+ * @brief Add to a contention counter. Define CSYNC_NO_STATS to compile the counters out.
+ */
+#ifndef CSYNC_NO_STATS
+#define CSYNC_COUNT(stats, field, amount) CATOMIC_FETCH_ADD_RELAXED(&(stats)->field, (uint64_t) (amount))
+#else
+#define CSYNC_COUNT(stats, field, amount)
+#endif
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct CSyncStatsT
+ * @brief Contention counters every primitive keeps.
+ * @var acquisitions Successful lock, wait or read operations.
+ * @var contentions Operations that did not succeed at the first attempt.
+ * @var spins Polls while waiting.
+ * @var sleeps Times a thread went to sleep on the futex.
+ */
+typedef struct {
+    uint64_t acquisitions;
+    uint64_t contentions;
+    uint64_t spins;
+    uint64_t sleeps;
+} CSyncStatsT;
+
+/**
+ * @struct CMutexT
+ * @brief An adaptive mutex: spins for about as long as recent lock hand-overs took, then sleeps on a futex.
+ * @var state 0 when free, 1 when locked, 2 when locked and threads may sleep on it.
+ * @var spinEstimate Moving average of the polls successful spinning needed.
+ * @var stats The contention counters.
+ */
+typedef struct {
+    uint32_t state;
+    uint32_t spinEstimate;
+    CSyncStatsT stats;
+} CMutexT;
+
+/**
+ * @struct CRwLockSlotT
+ * @brief The readers inside a reader-writer lock that picked this slot.
+ */
+typedef struct {
+    uint32_t readers;
+    int8_t padding[CATOMIC_CACHE_LINE - sizeof(uint32_t)];
+} CRwLockSlotT;
+
+/**
+ * @struct CRwLockT
+ * @brief A reader-writer lock for read-mostly data.
+ *
+ * Readers count themselves on one of several cache lines chosen per thread, so
+ * readers on different cores do not bounce a shared counter. A writer raises
+ * the writer flag, which turns new readers away, and waits for every slot to
+ * drain. Writers take precedence over new readers.
+ *
+ * @var slots The reader counters.
+ * @var writer 1 while a writer holds or waits for the lock.
+ * @var writers Serializes writers.
+ * @var stats The contention counters of readers, writers count in writers.stats.
+ */
+typedef struct {
+    CRwLockSlotT slots[CSYNC_RWLOCK_SLOTS];
+    uint32_t writer;
+    CMutexT writers;
+    CSyncStatsT stats;
+} CRwLockT;
+
+/**
+ * @struct CSeqLockT
+ * @brief A sequence lock: readers never block writers and retry when a write overlapped their read.
+ * @var sequence Odd while a write is in progress.
+ * @var writers Serializes writers.
+ * @var stats Reads count as acquisitions, retried reads as contentions.
+ */
+typedef struct {
+    uint32_t sequence;
+    CMutexT writers;
+    CSyncStatsT stats;
+} CSeqLockT;
+
+/**
+ * @struct CBarrierT
+ * @brief A reusable barrier for a fixed number of threads.
+ * @var count The number of threads.
+ * @var arrived The threads that reached the barrier in the current generation.
+ * @var generation Incremented each time the barrier opens.
+ * @var stats The contention counters.
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t arrived;
+    uint32_t generation;
+    CSyncStatsT stats;
+} CBarrierT;
+
+/**
+ * @struct CEventT
+ * @brief A one-shot event: once set, every current and future wait returns at once.
+ * @var state 0 when not set, 1 when set, 2 when not set and threads may sleep on it.
+ * @var stats The contention counters.
+ */
+typedef struct {
+    uint32_t state;
+    CSyncStatsT stats;
+} CEventT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Reset contention counters.
+ * @param stats[in] The counters.
+ */
+static void csync_stats_reset(CSyncStatsT* stats);
+
+/**
+ * @brief Initialize an unlocked mutex. A zero filled CMutexT is unlocked too.
+ * @param mutex[in] The mutex.
+ */
+static void csync_mutex_init(CMutexT* mutex);
+
+/**
+ * @brief Lock a mutex without waiting.
+ * @param mutex[in] The mutex.
+ * @return TRUE if the mutex was locked, FALSE if another thread holds it.
+ */
+static BOOL csync_mutex_try_lock(CMutexT* mutex);
+
+/**
+ * @brief Lock a mutex. Not recursive.
+ * @param mutex[in] The mutex.
+ */
+static void csync_mutex_lock(CMutexT* mutex);
+
+/**
+ * @brief Unlock a mutex locked by the calling thread.
+ * @param mutex[in] The mutex.
+ */
+static void csync_mutex_unlock(CMutexT* mutex);
+
+/**
+ * @brief Initialize an unlocked reader-writer lock. A zero filled CRwLockT is unlocked too.
+ * @param lock[in] The reader-writer lock.
+ */
+static void csync_rwlock_init(CRwLockT* lock);
+
+/**
+ * @brief Lock for reading. Read locks of one thread nest as long as no writer waits.
+ * @param lock[in] The reader-writer lock.
+ */
+static void csync_rwlock_read_lock(CRwLockT* lock);
+
+/**
+ * @brief Release a read lock taken by the calling thread.
+ * @param lock[in] The reader-writer lock.
+ */
+static void csync_rwlock_read_unlock(CRwLockT* lock);
+
+/**
+ * @brief Lock for writing, excluding readers and other writers.
+ * @param lock[in] The reader-writer lock.
+ */
+static void csync_rwlock_write_lock(CRwLockT* lock);
+
+/**
+ * @brief Release a write lock.
+ * @param lock[in] The reader-writer lock.
+ */
+static void csync_rwlock_write_unlock(CRwLockT* lock);
+
+/**
+ * @brief Initialize a sequence lock. A zero filled CSeqLockT is ready too.
+ * @param lock[in] The sequence lock.
+ */
+static void csync_seqlock_init(CSeqLockT* lock);
+
+/**
+ * @brief Start a write, excluding other writers and invalidating concurrent reads.
+ * @param lock[in] The sequence lock.
+ */
+static void csync_seqlock_write_begin(CSeqLockT* lock);
+
+/**
+ * @brief Finish a write.
+ * @param lock[in] The sequence lock.
+ */
+static void csync_seqlock_write_end(CSeqLockT* lock);
+
+/**
+ * @brief Start a read, waiting for a write in progress.
+ *
+ * Copy the protected data with relaxed atomic loads between read_begin and
+ * read_retry, and only use the copy if read_retry returns FALSE.
+ *
+ * @param lock[in] The sequence lock.
+ * @return The sequence to pass to csync_seqlock_read_retry.
+ */
+static uint32_t csync_seqlock_read_begin(CSeqLockT* lock);
+
+/**
+ * @brief Check whether a write overlapped the read.
+ * @param lock[in] The sequence lock.
+ * @param sequence[in] The value returned by csync_seqlock_read_begin.
+ * @return TRUE if the read must be repeated, FALSE if the copy is consistent.
+ */
+static BOOL csync_seqlock_read_retry(CSeqLockT* lock, uint32_t sequence);
+
+/**
+ * @brief Initialize a barrier.
+ * @param barrier[in] The barrier.
+ * @param count[in] The number of threads that must arrive before it opens.
+ */
+static void csync_barrier_init(CBarrierT* barrier, uint32_t count);
+
+/**
+ * @brief Wait until count threads arrived. The barrier then resets for the next round.
+ * @param barrier[in] The barrier.
+ * @return TRUE for exactly one thread per round, the last one to arrive, FALSE for the others.
+ */
+static BOOL csync_barrier_wait(CBarrierT* barrier);
+
+/**
+ * @brief Initialize an event that is not set. A zero filled CEventT is not set too.
+ * @param event[in] The event.
+ */
+static void csync_event_init(CEventT* event);
+
+/**
+ * @brief Set the event and wake every waiter.
+ * @param event[in] The event.
+ */
+static void csync_event_set(CEventT* event);
+
+/**
+ * @brief Check whether the event is set.
+ * @param event[in] The event.
+ * @return TRUE if set, FALSE otherwise.
+ */
+static BOOL csync_event_is_set(CEventT* event);
+
+/**
+ * @brief Wait until the event is set.
+ * @param event[in] The event.
+ */
+static void csync_event_wait(CEventT* event);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static void csync_stats_reset(CSyncStatsT* stats)
+{
+    CATOMIC_STORE_RELAXED(&stats->acquisitions, 0u);
+    CATOMIC_STORE_RELAXED(&stats->contentions, 0u);
+    CATOMIC_STORE_RELAXED(&stats->spins, 0u);
+    CATOMIC_STORE_RELAXED(&stats->sleeps, 0u);
+}
+
+inline static void csync_mutex_init(CMutexT* mutex)
+{
+    mutex->state = 0;
+    mutex->spinEstimate = 0;
+    csync_stats_reset(&mutex->stats);
+}
+
+inline static BOOL csync_mutex_try_lock(CMutexT* mutex)
+{
+    uint32_t expected = 0;
+    BOOL result = CATOMIC_CAS(&mutex->state, &expected, 1u) ? TRUE : FALSE;
+    if (TRUE == result) { CSYNC_COUNT(&mutex->stats, acquisitions, 1); }
+    return result;
+}
+
+inline static void csync_mutex_lock(CMutexT* mutex)
+{
+    if (FALSE == csync_mutex_try_lock(mutex))
+    {
+        /* Spin up to twice the recent average, the estimate follows what spinning achieved. */
+        uint32_t estimate = CATOMIC_LOAD_RELAXED(&mutex->spinEstimate);
+        uint32_t limit = (2u * estimate + 16u < CSYNC_SPIN_MAX) ? 2u * estimate + 16u : CSYNC_SPIN_MAX;
+        uint32_t spins = 0;
+        BOOL locked = FALSE;
+        CSYNC_COUNT(&mutex->stats, contentions, 1);
+        while ((FALSE == locked) && (spins < limit))
+        {
+            CATOMIC_PAUSE();
+            spins++;
+            uint32_t expected = 0;
+            locked = (0u == CATOMIC_LOAD_RELAXED(&mutex->state)) && CATOMIC_CAS_WEAK(&mutex->state, &expected, 1u)
+                             ? TRUE
+                             : FALSE;
+        }
+        CSYNC_COUNT(&mutex->stats, spins, spins);
+        CATOMIC_STORE_RELAXED(&mutex->spinEstimate,
+                              estimate + ((TRUE == locked) ? spins : limit) / 8u - estimate / 8u);
+
+        while ((FALSE == locked) && (0u != CATOMIC_EXCHANGE(&mutex->state, 2u)))
+        {
+            CSYNC_COUNT(&mutex->stats, sleeps, 1);
+            catomic_wait(&mutex->state, 2u, 0);
+        }
+        CSYNC_COUNT(&mutex->stats, acquisitions, 1);
+    }
+}
+
+inline static void csync_mutex_unlock(CMutexT* mutex)
+{
+    if (2u == CATOMIC_EXCHANGE(&mutex->state, 0u)) { catomic_wake_one(&mutex->state); }
+}
+
+/* The reader slot of the calling thread, assigned round robin on first use. */
+static CTHREAD_LOCAL uint32_t csync_reader_slot = UINT32_MAX;
+static uint32_t csync_next_reader_slot = 0;
+
+inline static CRwLockSlotT* csync_rwlock_slot(CRwLockT* lock)
+{
+    if (UINT32_MAX == csync_reader_slot)
+    {
+        csync_reader_slot = CATOMIC_FETCH_ADD(&csync_next_reader_slot, 1u) % CSYNC_RWLOCK_SLOTS;
+    }
+    return &lock->slots[csync_reader_slot];
+}
+
+inline static void csync_rwlock_init(CRwLockT* lock)
+{
+    for (uint32_t i = 0; i < CSYNC_RWLOCK_SLOTS; i++) { lock->slots[i].readers = 0; }
+    lock->writer = 0;
+    csync_mutex_init(&lock->writers);
+    csync_stats_reset(&lock->stats);
+}
+
+inline static void csync_rwlock_read_lock(CRwLockT* lock)
+{
+    CRwLockSlotT* slot = csync_rwlock_slot(lock);
+    BOOL locked = FALSE;
+    BOOL contended = FALSE;
+    while (FALSE == locked)
+    {
+        /*
+         * Announce first, then check for a writer. The writer does the same in the opposite order. The acquire
+         * pairs with the release in csync_rwlock_write_unlock, so the last writer's stores are visible.
+         */
+        CATOMIC_FETCH_ADD(&slot->readers, 1u);
+        CATOMIC_FENCE_SEQ_CST();
+        if (0u == CATOMIC_LOAD_ACQUIRE(&lock->writer)) { locked = TRUE; }
+        else
+        {
+            if (1u == CATOMIC_FETCH_SUB(&slot->readers, 1u)) { catomic_wake_all(&slot->readers); }
+            contended = TRUE;
+            CSYNC_COUNT(&lock->stats, sleeps, 1);
+            catomic_wait(&lock->writer, 1u, 0);
+        }
+    }
+    CSYNC_COUNT(&lock->stats, acquisitions, 1);
+    if (TRUE == contended) { CSYNC_COUNT(&lock->stats, contentions, 1); }
+}
+
+inline static void csync_rwlock_read_unlock(CRwLockT* lock)
+{
+    CRwLockSlotT* slot = csync_rwlock_slot(lock);
+    if ((1u == CATOMIC_FETCH_SUB(&slot->readers, 1u)) && (0u != CATOMIC_LOAD_SEQ_CST(&lock->writer)))
+    {
+        catomic_wake_all(&slot->readers);
+    }
+}
+
+inline static void csync_rwlock_write_lock(CRwLockT* lock)
+{
+    csync_mutex_lock(&lock->writers);
+    CATOMIC_STORE_SEQ_CST(&lock->writer, 1u);
+    CATOMIC_FENCE_SEQ_CST();
+    for (uint32_t i = 0; i < CSYNC_RWLOCK_SLOTS; i++)
+    {
+        uint32_t spins = 0;
+        uint32_t readers = CATOMIC_LOAD_ACQUIRE(&lock->slots[i].readers);
+        while (0u != readers)
+        {
+            if (spins < CSYNC_SPIN_MAX)
+            {
+                CATOMIC_PAUSE();
+                spins++;
+            }
+            else
+            {
+                CSYNC_COUNT(&lock->writers.stats, sleeps, 1);
+                catomic_wait(&lock->slots[i].readers, readers, 0);
+            }
+            readers = CATOMIC_LOAD_ACQUIRE(&lock->slots[i].readers);
+        }
+        CSYNC_COUNT(&lock->writers.stats, spins, spins);
+    }
+}
+
+inline static void csync_rwlock_write_unlock(CRwLockT* lock)
+{
+    CATOMIC_STORE_RELEASE(&lock->writer, 0u);
+    catomic_wake_all(&lock->writer);
+    csync_mutex_unlock(&lock->writers);
+}
+
+inline static void csync_seqlock_init(CSeqLockT* lock)
+{
+    lock->sequence = 0;
+    csync_mutex_init(&lock->writers);
+    csync_stats_reset(&lock->stats);
+}
+
+inline static void csync_seqlock_write_begin(CSeqLockT* lock)
+{
+    csync_mutex_lock(&lock->writers);
+    CATOMIC_STORE_RELAXED(&lock->sequence, lock->sequence + 1u);
+    CATOMIC_FENCE_RELEASE();
+}
+
+inline static void csync_seqlock_write_end(CSeqLockT* lock)
+{
+    CATOMIC_STORE_RELEASE(&lock->sequence, lock->sequence + 1u);
+    csync_mutex_unlock(&lock->writers);
+}
+
+inline static uint32_t csync_seqlock_read_begin(CSeqLockT* lock)
+{
+    uint32_t sequence = CATOMIC_LOAD_ACQUIRE(&lock->sequence);
+    while (0u != (sequence & 1u))
+    {
+        CATOMIC_PAUSE();
+        CSYNC_COUNT(&lock->stats, spins, 1);
+        sequence = CATOMIC_LOAD_ACQUIRE(&lock->sequence);
+    }
+    CSYNC_COUNT(&lock->stats, acquisitions, 1);
+    return sequence;
+}
+
+inline static BOOL csync_seqlock_read_retry(CSeqLockT* lock, uint32_t sequence)
+{
+    CATOMIC_FENCE_ACQUIRE();
+    BOOL result = (sequence != CATOMIC_LOAD_RELAXED(&lock->sequence)) ? TRUE : FALSE;
+    if (TRUE == result) { CSYNC_COUNT(&lock->stats, contentions, 1); }
+    return result;
+}
+
+inline static void csync_barrier_init(CBarrierT* barrier, uint32_t count)
+{
+    barrier->count = count;
+    barrier->arrived = 0;
+    barrier->generation = 0;
+    csync_stats_reset(&barrier->stats);
+}
+
+inline static BOOL csync_barrier_wait(CBarrierT* barrier)
+{
+    BOOL last = FALSE;
+    uint32_t generation = CATOMIC_LOAD_ACQUIRE(&barrier->generation);
+    if (barrier->count == CATOMIC_FETCH_ADD(&barrier->arrived, 1u) + 1u)
+    {
+        CATOMIC_STORE_RELAXED(&barrier->arrived, 0u);
+        CATOMIC_FETCH_ADD(&barrier->generation, 1u);
+        catomic_wake_all(&barrier->generation);
+        last = TRUE;
+    }
+    else
+    {
+        uint32_t spins = 0;
+        CSYNC_COUNT(&barrier->stats, contentions, 1);
+        while (generation == CATOMIC_LOAD_ACQUIRE(&barrier->generation))
+        {
+            if (spins < CSYNC_SPIN_MAX)
+            {
+                CATOMIC_PAUSE();
+                spins++;
+            }
+            else
+            {
+                CSYNC_COUNT(&barrier->stats, sleeps, 1);
+                catomic_wait(&barrier->generation, generation, 0);
+            }
+        }
+        CSYNC_COUNT(&barrier->stats, spins, spins);
+    }
+    CSYNC_COUNT(&barrier->stats, acquisitions, 1);
+    return last;
+}
+
+inline static void csync_event_init(CEventT* event)
+{
+    event->state = 0;
+    csync_stats_reset(&event->stats);
+}
+
+inline static void csync_event_set(CEventT* event)
+{
+    if (2u == CATOMIC_EXCHANGE(&event->state, 1u)) { catomic_wake_all(&event->state); }
+}
+
+inline static BOOL csync_event_is_set(CEventT* event) { return 1u == CATOMIC_LOAD_ACQUIRE(&event->state); }
+
+inline static void csync_event_wait(CEventT* event)
+{
+    uint32_t state = CATOMIC_LOAD_ACQUIRE(&event->state);
+    if (1u != state) { CSYNC_COUNT(&event->stats, contentions, 1); }
+    while (1u != state)
+    {
+        uint32_t expected = 0;
+        if ((2u == state) || CATOMIC_CAS(&event->state, &expected, 2u))
+        {
+            CSYNC_COUNT(&event->stats, sleeps, 1);
+            catomic_wait(&event->state, 2u, 0);
+        }
+        state = CATOMIC_LOAD_ACQUIRE(&event->state);
+    }
+    CSYNC_COUNT(&event->stats, acquisitions, 1);
+}
+
+#endif// CSYNC_HEADER
@@ -0,0 +1,205 @@
+#ifndef CTHREAD_HEADER
+#define CTHREAD_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CThread Header (portable thread creation and thread-local storage)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CLog.h"
+#include "CMemory.h"
+#include "STDTypes.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def CTHREAD_LOCAL
+ * @brief Storage class for thread-local variables, usable from C and C++.
+ */
+#if defined(_MSC_VER)
+#define CTHREAD_LOCAL __declspec(thread)
+#else
+#define CTHREAD_LOCAL __thread
+#endif
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @typedef CThreadT
+ * @brief A native thread handle.
+ */
+#if defined(_WIN32)
+typedef HANDLE CThreadT;
+#else
+typedef pthread_t CThreadT;
+#endif
+
+/**
+ * @typedef CThreadFunctionT
+ * @brief The entry point of a thread.
+ */
+typedef void (*CThreadFunctionT)(void* argument);
+
+/**
+ * @struct CThreadStartT
+ * @brief The entry point and argument handed to a new thread.
+ */
+typedef struct {
+    CThreadFunctionT function;
+    void* argument;
+} CThreadStartT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Start a thread.
+ * @param thread[out] Receives the thread handle.
+ * @param function[in] The entry point.
+ * @param argument[in] The argument passed to function.
+ * @return TRUE on success, FALSE otherwise.
+ */
+static BOOL cthread_create(CThreadT* thread, CThreadFunctionT function, void* argument);
+
+/**
+ * @brief Wait for a thread to return and release its handle.
+ * @param thread[in] The thread handle.
+ */
+static void cthread_join(CThreadT thread);
+
+/**
+ * @brief Give up the rest of the time slice.
+ */
+static void cthread_yield(void);
+
+/**
+ * @brief Get the number of online logical processors.
+ * @return The number of processors, at least 1.
+ */
+static uint32_t cthread_hardware_concurrency(void);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+#if defined(_WIN32)
+inline static DWORD WINAPI cthread_entry(LPVOID start)
+{
+    CThreadStartT copy = *(CThreadStartT*) start;
+    CFREE(start, sizeof(CThreadStartT));
+    copy.function(copy.argument);
+    return 0;
+}
+#else
+inline static void* cthread_entry(void* start)
+{
+    CThreadStartT copy = *(CThreadStartT*) start;
+    CFREE(start, sizeof(CThreadStartT));
+    copy.function(copy.argument);
+    return NULL;
+}
+#endif
+
+inline static BOOL cthread_create(CThreadT* thread, CThreadFunctionT function, void* argument)
+{
+    BOOL result = FALSE;
+    CThreadStartT* start = (CThreadStartT*) CMALLOC(sizeof(CThreadStartT));
+    if (NULL == start) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        start->function = function;
+        start->argument = argument;
+#if defined(_WIN32)
+        *thread = CreateThread(NULL, 0, cthread_entry, start, 0, NULL);
+        result = (NULL != *thread) ? TRUE : FALSE;
+#else
+        result = (0 == pthread_create(thread, NULL, cthread_entry, start)) ? TRUE : FALSE;
+#endif
+        if (FALSE == result)
+        {
+            LOG_ERROR("Can not create thread!\n");
+            CFREE(start, sizeof(CThreadStartT));
+        }
+    }
+    return result;
+}
+
+inline static void cthread_join(CThreadT thread)
+{
+#if defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+inline static void cthread_yield(void)
+{
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+inline static uint32_t cthread_hardware_concurrency(void)
+{
+    uint32_t result = 1;
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    result = (uint32_t) info.dwNumberOfProcessors;
+#else
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    result = (online > 0) ? (uint32_t) online : 1u;
+#endif
+    return (0u == result) ? 1u : result;
+}
+
+#endif// CTHREAD_HEADER
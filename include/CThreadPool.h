@@ -0,0 +1,561 @@
+#ifndef CTHREAD_POOL_HEADER
+#define CTHREAD_POOL_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * CThreadPool Header (work-stealing thread pool, task groups and parallel for)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "CThread.h"
+#include "DMpmcQueue.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def CTHREAD_POOL_DEQUE_CAPACITY
+ * @brief Tasks a worker deque holds. A worker runs a task inline instead of pushing it into a full deque.
+ */
+#define CTHREAD_POOL_DEQUE_CAPACITY 4096u
+
+/**
+ * @def CTHREAD_POOL_INJECTION_CAPACITY
+ * @brief Tasks the queue for submissions from outside the pool holds. Submitters run the task inline when it is full.
+ */
+#define CTHREAD_POOL_INJECTION_CAPACITY 4096u
+
+/**
+ * @def CTHREAD_POOL_SPLIT_THRESHOLD
+ * @brief parallel_for keeps splitting its range while the worker deque has fewer tasks than this.
+ */
+#define CTHREAD_POOL_SPLIT_THRESHOLD 2u
+
+/**
+ * @def CTHREAD_POOL_CHUNKS_PER_WORKER
+ * @brief With an automatic grain size parallel_for aims at this many chunks per worker.
+ */
+#define CTHREAD_POOL_CHUNKS_PER_WORKER 8u
+
+/**
+ * @def CTHREAD_POOL_SPIN_COUNT
+ * @brief Failed searches for work before an idle worker goes to sleep.
+ */
+#define CTHREAD_POOL_SPIN_COUNT 64u
+
+/**
+ * @def CTHREAD_POOL_WAIT_NS
+ * @brief How long a task group waiter sleeps before it looks for work to help with again.
+ */
+#define CTHREAD_POOL_WAIT_NS 100000u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @typedef TaskFunctionT
+ * @brief A task submitted to the pool.
+ */
+typedef void (*TaskFunctionT)(void* argument);
+
+/**
+ * @typedef RangeFunctionT
+ * @brief The body of a parallel for, called for sub ranges [begin, end).
+ */
+typedef void (*RangeFunctionT)(size_t begin, size_t end, void* argument);
+
+/**
+ * @struct DTaskGroupT
+ * @brief A set of tasks that can be waited for. Initialize with tpool_group_init, it can live on the stack.
+ * @var pending The number of submitted tasks that did not finish yet.
+ */
+typedef struct {
+    uint32_t pending;
+} DTaskGroupT;
+
+/**
+ * @struct DTaskT
+ * @brief A task as stored in the deques, by value.
+ * @var function The task, NULL for a parallel for range.
+ * @var argument The argument of function, or the DParallelForT of a range.
+ * @var begin The first index of a range.
+ * @var end One past the last index of a range.
+ * @var group The group to signal when done, may be NULL.
+ */
+typedef struct {
+    TaskFunctionT function;
+    void* argument;
+    size_t begin;
+    size_t end;
+    DTaskGroupT* group;
+} DTaskT;
+
+/**
+ * @struct DParallelForT
+ * @brief The shared state of one parallel for, owned by the calling thread.
+ */
+typedef struct {
+    RangeFunctionT body;
+    void* argument;
+    size_t grain;
+} DParallelForT;
+
+/**
+ * @struct DWorkDequeT
+ * @brief A Chase-Lev deque: the owner pushes and takes at the bottom, thieves steal from the top.
+ */
+typedef struct {
+    int8_t padding0[CATOMIC_CACHE_LINE];
+    int64_t top;
+    int8_t padding1[CATOMIC_CACHE_LINE];
+    int64_t bottom;
+    int8_t padding2[CATOMIC_CACHE_LINE];
+    DTaskT tasks[CTHREAD_POOL_DEQUE_CAPACITY];
+} DWorkDequeT;
+
+/**
+ * @struct DThreadPoolT
+ * @brief A pool of worker threads that share work by stealing.
+ * @var workerCount The number of workers, and of deques.
+ * @var threadCount The number of worker threads started.
+ * @var threads The worker threads.
+ * @var deques One deque per worker.
+ * @var injection Tasks submitted from threads outside the pool.
+ * @var stop Set to 1 when the pool shuts down.
+ * @var signal Futex word sleeping workers wait on, bumped when work arrives.
+ * @var sleepers The number of workers that are about to sleep or sleep.
+ */
+typedef struct DThreadPool {
+    uint32_t workerCount;
+    uint32_t threadCount;
+    CThreadT* threads;
+    DWorkDequeT* deques;
+    DMpmcQueueT* injection;
+    uint32_t stop;
+    uint32_t signal;
+    uint32_t sleepers;
+} DThreadPoolT;
+
+/**
+ * @struct DThreadPoolWorkerT
+ * @brief What a worker thread knows about itself.
+ */
+typedef struct {
+    DThreadPoolT* pool;
+    uint32_t index;
+} DThreadPoolWorkerT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a thread pool.
+ * @param workerCount[in] The number of worker threads, 0 for one per processor.
+ * @return A pointer to the new thread pool.
+ */
+static DThreadPoolT* tpool_create(uint32_t workerCount);
+
+/**
+ * @brief Destroy a thread pool. Tasks already submitted run before the workers exit.
+ * @param pool[in] The thread pool.
+ */
+static void tpool_destroy(DThreadPoolT* pool);
+
+/**
+ * @brief Get the number of worker threads.
+ * @param pool[in] The thread pool.
+ * @return The number of workers.
+ */
+static uint32_t tpool_worker_count(DThreadPoolT* pool);
+
+/**
+ * @brief Get the index of the calling worker.
+ * @param pool[in] The thread pool.
+ * @return The worker index, or -1 if the calling thread is not a worker of pool.
+ */
+static int32_t tpool_current_worker(DThreadPoolT* pool);
+
+/**
+ * @brief Initialize an empty task group.
+ * @param group[in] The task group.
+ */
+static void tpool_group_init(DTaskGroupT* group);
+
+/**
+ * @brief Submit a task. Workers push to their own deque, other threads to the shared injection queue.
+ * @param pool[in] The thread pool.
+ * @param group[in] The group the task belongs to, may be NULL.
+ * @param function[in] The task.
+ * @param argument[in] The argument passed to function.
+ */
+static void tpool_submit(DThreadPoolT* pool, DTaskGroupT* group, TaskFunctionT function, void* argument);
+
+/**
+ * @brief Wait until every task of a group finished. The caller runs pending tasks meanwhile.
+ * @param pool[in] The thread pool.
+ * @param group[in] The task group.
+ */
+static void tpool_group_wait(DThreadPoolT* pool, DTaskGroupT* group);
+
+/**
+ * @brief Call body for sub ranges covering [begin, end) in parallel and wait for all of them.
+ *
+ * Ranges are split lazily: a worker halves its range and offers the upper half
+ * for stealing only while its own deque runs low (the injection queue for the
+ * calling thread), so idle workers get work without the overhead of splitting
+ * everything up front.
+ *
+ * @param pool[in] The thread pool.
+ * @param begin[in] The first index.
+ * @param end[in] One past the last index.
+ * @param grain[in] The largest range body is called with, 0 to derive it from the range and worker count.
+ * @param body[in] The loop body.
+ * @param argument[in] The argument passed to body.
+ */
+static void tpool_parallel_for(DThreadPoolT* pool, size_t begin, size_t end, size_t grain, RangeFunctionT body,
+                               void* argument);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+/* The worker running on this thread. Per translation unit, calls from other ones take the outside-the-pool path. */
+static CTHREAD_LOCAL DThreadPoolWorkerT* tpool_self = NULL;
+
+inline static void tpool_task_store(DTaskT* slot, const DTaskT* task)
+{
+    CATOMIC_STORE_RELAXED(&slot->function, task->function);
+    CATOMIC_STORE_RELAXED(&slot->argument, task->argument);
+    CATOMIC_STORE_RELAXED(&slot->begin, task->begin);
+    CATOMIC_STORE_RELAXED(&slot->end, task->end);
+    CATOMIC_STORE_RELAXED(&slot->group, task->group);
+}
+
+inline static void tpool_task_load(DTaskT* slot, DTaskT* task)
+{
+    task->function = CATOMIC_LOAD_RELAXED(&slot->function);
+    task->argument = CATOMIC_LOAD_RELAXED(&slot->argument);
+    task->begin = CATOMIC_LOAD_RELAXED(&slot->begin);
+    task->end = CATOMIC_LOAD_RELAXED(&slot->end);
+    task->group = CATOMIC_LOAD_RELAXED(&slot->group);
+}
+
+inline static BOOL tpool_deque_push(DWorkDequeT* deque, const DTaskT* task)
+{
+    BOOL result = FALSE;
+    int64_t bottom = CATOMIC_LOAD_RELAXED(&deque->bottom);
+    int64_t top = CATOMIC_LOAD_ACQUIRE(&deque->top);
+    if (bottom - top < (int64_t) CTHREAD_POOL_DEQUE_CAPACITY)
+    {
+        tpool_task_store(&deque->tasks[bottom & (CTHREAD_POOL_DEQUE_CAPACITY - 1u)], task);
+        CATOMIC_FENCE_RELEASE();
+        CATOMIC_STORE_RELAXED(&deque->bottom, bottom + 1);
+        result = TRUE;
+    }
+    return result;
+}
+
+inline static BOOL tpool_deque_take(DWorkDequeT* deque, DTaskT* task)
+{
+    BOOL result = FALSE;
+    int64_t bottom = CATOMIC_LOAD_RELAXED(&deque->bottom) - 1;
+    CATOMIC_STORE_RELAXED(&deque->bottom, bottom);
+    CATOMIC_FENCE_SEQ_CST();
+    int64_t top = CATOMIC_LOAD_RELAXED(&deque->top);
+    if (top <= bottom)
+    {
+        tpool_task_load(&deque->tasks[bottom & (CTHREAD_POOL_DEQUE_CAPACITY - 1u)], task);
+        result = TRUE;
+        if (top == bottom)
+        {
+            /* The last task, race the thieves for it. */
+            result = CATOMIC_CAS_SEQ_CST(&deque->top, &top, top + 1) ? TRUE : FALSE;
+            CATOMIC_STORE_RELAXED(&deque->bottom, bottom + 1);
+        }
+    }
+    else { CATOMIC_STORE_RELAXED(&deque->bottom, bottom + 1); }
+    return result;
+}
+
+inline static BOOL tpool_deque_steal(DWorkDequeT* deque, DTaskT* task)
+{
+    BOOL result = FALSE;
+    int64_t top = CATOMIC_LOAD_ACQUIRE(&deque->top);
+    CATOMIC_FENCE_SEQ_CST();
+    int64_t bottom = CATOMIC_LOAD_ACQUIRE(&deque->bottom);
+    if (top < bottom)
+    {
+        tpool_task_load(&deque->tasks[top & (CTHREAD_POOL_DEQUE_CAPACITY - 1u)], task);
+        result = CATOMIC_CAS_SEQ_CST(&deque->top, &top, top + 1) ? TRUE : FALSE;
+    }
+    return result;
+}
+
+inline static int64_t tpool_deque_length(DWorkDequeT* deque)
+{
+    int64_t length = CATOMIC_LOAD_RELAXED(&deque->bottom) - CATOMIC_LOAD_RELAXED(&deque->top);
+    return (length > 0) ? length : 0;
+}
+
+/* Wakes one sleeping worker. Pairs with the seq_cst increment of sleepers in tpool_worker_main. */
+inline static void tpool_notify(DThreadPoolT* pool)
+{
+    CATOMIC_FENCE_SEQ_CST();
+    if (0u != CATOMIC_LOAD_RELAXED(&pool->sleepers))
+    {
+        CATOMIC_FETCH_ADD(&pool->signal, 1u);
+        catomic_wake_one(&pool->signal);
+    }
+}
+
+/* Looks for a task: the own deque first, then the injection queue, then the other deques. */
+inline static BOOL tpool_find_task(DThreadPoolT* pool, int32_t self, DTaskT* task)
+{
+    BOOL found = (self >= 0) ? tpool_deque_take(&pool->deques[self], task) : FALSE;
+    if (FALSE == found) { found = mpmc_try_pop(pool->injection, task); }
+    uint32_t start = (self >= 0) ? (uint32_t) self + 1u : 0u;
+    for (uint32_t i = 0; (FALSE == found) && (i < pool->workerCount); i++)
+    {
+        uint32_t victim = (start + i) % pool->workerCount;
+        if ((int32_t) victim != self) { found = tpool_deque_steal(&pool->deques[victim], task); }
+    }
+    return found;
+}
+
+inline static void tpool_run_range(DThreadPoolT* pool, DTaskT* task);
+
+inline static void tpool_run(DThreadPoolT* pool, DTaskT* task)
+{
+    if (NULL != task->function) { task->function(task->argument); }
+    else { tpool_run_range(pool, task); }
+
+    if ((NULL != task->group) && (1u == CATOMIC_FETCH_SUB(&task->group->pending, 1u)))
+    {
+        catomic_wake_all(&task->group->pending);
+    }
+}
+
+inline static void tpool_enqueue(DThreadPoolT* pool, DTaskT* task)
+{
+    int32_t self = tpool_current_worker(pool);
+    BOOL queued = (self >= 0) ? tpool_deque_push(&pool->deques[self], task) : mpmc_try_push(pool->injection, task);
+    if (TRUE == queued) { tpool_notify(pool); }
+    else { tpool_run(pool, task); }
+}
+
+inline static void tpool_run_range(DThreadPoolT* pool, DTaskT* task)
+{
+    DParallelForT* loop = (DParallelForT*) task->argument;
+    int32_t self = tpool_current_worker(pool);
+    size_t begin = task->begin;
+    size_t end = task->end;
+    while (begin < end)
+    {
+        size_t queued = (self >= 0) ? (size_t) tpool_deque_length(&pool->deques[self]) : mpmc_length(pool->injection);
+        if ((end - begin > loop->grain) && (queued < CTHREAD_POOL_SPLIT_THRESHOLD))
+        {
+            DTaskT half = {NULL, loop, begin + (end - begin) / 2u, end, task->group};
+            CATOMIC_FETCH_ADD(&task->group->pending, 1u);
+            tpool_enqueue(pool, &half);
+            end = half.begin;
+        }
+        else
+        {
+            size_t chunkEnd = (end - begin > loop->grain) ? begin + loop->grain : end;
+            loop->body(begin, chunkEnd, loop->argument);
+            begin = chunkEnd;
+        }
+    }
+}
+
+inline static void tpool_worker_main(void* argument)
+{
+    DThreadPoolWorkerT* worker = (DThreadPoolWorkerT*) argument;
+    DThreadPoolT* pool = worker->pool;
+    DTaskT task;
+    uint32_t idle = 0;
+    BOOL running = TRUE;
+    tpool_self = worker;
+
+    while (TRUE == running)
+    {
+        if (TRUE == tpool_find_task(pool, (int32_t) worker->index, &task))
+        {
+            tpool_run(pool, &task);
+            idle = 0;
+        }
+        else if (0u != CATOMIC_LOAD_ACQUIRE(&pool->stop)) { running = FALSE; }
+        else if (idle < CTHREAD_POOL_SPIN_COUNT)
+        {
+            CATOMIC_PAUSE();
+            idle++;
+        }
+        else
+        {
+            uint32_t expected = CATOMIC_LOAD_ACQUIRE(&pool->signal);
+            CATOMIC_FETCH_ADD(&pool->sleepers, 1u);
+            CATOMIC_FENCE_SEQ_CST();
+            if (TRUE == tpool_find_task(pool, (int32_t) worker->index, &task))
+            {
+                CATOMIC_FETCH_SUB(&pool->sleepers, 1u);
+                tpool_run(pool, &task);
+            }
+            else
+            {
+                if (0u == CATOMIC_LOAD_ACQUIRE(&pool->stop)) { catomic_wait(&pool->signal, expected, 0); }
+                CATOMIC_FETCH_SUB(&pool->sleepers, 1u);
+            }
+            idle = 0;
+        }
+    }
+    tpool_self = NULL;
+    CFREE(worker, sizeof(DThreadPoolWorkerT));
+}
+
+inline static DThreadPoolT* tpool_create(uint32_t workerCount)
+{
+    DThreadPoolT* pool = (DThreadPoolT*) CCALLOC(1, sizeof(DThreadPoolT));
+    uint32_t workers = (0u == workerCount) ? cthread_hardware_concurrency() : workerCount;
+    if (NULL == pool) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        pool->threads = (CThreadT*) CCALLOC(workers, sizeof(CThreadT));
+        pool->deques = (DWorkDequeT*) CCALLOC(workers, sizeof(DWorkDequeT));
+        pool->injection = mpmc_create_generic(sizeof(DTaskT), CTHREAD_POOL_INJECTION_CAPACITY);
+        if ((NULL == pool->threads) || (NULL == pool->deques) || (NULL == pool->injection))
+        {
+            LOG_ERROR("Can not allocate thread pool!\n");
+            tpool_destroy(pool);
+            pool = NULL;
+        }
+        else { pool->workerCount = workers; }
+    }
+
+    for (uint32_t i = 0; (NULL != pool) && (i < workers); i++)
+    {
+        DThreadPoolWorkerT* worker = (DThreadPoolWorkerT*) CMALLOC(sizeof(DThreadPoolWorkerT));
+        BOOL started = FALSE;
+        if (NULL != worker)
+        {
+            worker->pool = pool;
+            worker->index = i;
+            started = cthread_create(&pool->threads[i], tpool_worker_main, worker);
+            if (FALSE == started) { CFREE(worker, sizeof(DThreadPoolWorkerT)); }
+        }
+        if (TRUE == started) { pool->threadCount = i + 1u; }
+        else
+        {
+            LOG_ERROR("Can not start worker thread!\n");
+            tpool_destroy(pool);
+            pool = NULL;
+        }
+    }
+    return pool;
+}
+
+inline static void tpool_destroy(DThreadPoolT* pool)
+{
+    if (NULL != pool)
+    {
+        CATOMIC_STORE_RELEASE(&pool->stop, 1u);
+        CATOMIC_FETCH_ADD(&pool->signal, 1u);
+        catomic_wake_all(&pool->signal);
+        for (uint32_t i = 0; i < pool->threadCount; i++) { cthread_join(pool->threads[i]); }
+
+        /* Tasks that arrived while the workers were exiting. */
+        DTaskT task;
+        while ((0u != pool->workerCount) && (TRUE == tpool_find_task(pool, -1, &task))) { tpool_run(pool, &task); }
+
+        mpmc_destroy(pool->injection);
+        if (NULL != pool->deques) { CFREE(pool->deques, pool->workerCount * sizeof(DWorkDequeT)); }
+        if (NULL != pool->threads) { CFREE(pool->threads, pool->workerCount * sizeof(CThreadT)); }
+        CFREE(pool, sizeof(DThreadPoolT));
+    }
+}
+
+inline static uint32_t tpool_worker_count(DThreadPoolT* pool) { return pool->workerCount; }
+
+inline static int32_t tpool_current_worker(DThreadPoolT* pool)
+{
+    return ((NULL != tpool_self) && (pool == tpool_self->pool)) ? (int32_t) tpool_self->index : -1;
+}
+
+inline static void tpool_group_init(DTaskGroupT* group) { group->pending = 0; }
+
+inline static void tpool_submit(DThreadPoolT* pool, DTaskGroupT* group, TaskFunctionT function, void* argument)
+{
+    DTaskT task = {function, argument, 0, 0, group};
+    if (NULL != group) { CATOMIC_FETCH_ADD(&group->pending, 1u); }
+    tpool_enqueue(pool, &task);
+}
+
+inline static void tpool_group_wait(DThreadPoolT* pool, DTaskGroupT* group)
+{
+    int32_t self = tpool_current_worker(pool);
+    DTaskT task;
+    uint32_t pending = CATOMIC_LOAD_ACQUIRE(&group->pending);
+    while (0u != pending)
+    {
+        if (TRUE == tpool_find_task(pool, self, &task)) { tpool_run(pool, &task); }
+        else { catomic_wait(&group->pending, pending, CTHREAD_POOL_WAIT_NS); }
+        pending = CATOMIC_LOAD_ACQUIRE(&group->pending);
+    }
+}
+
+inline static void tpool_parallel_for(DThreadPoolT* pool, size_t begin, size_t end, size_t grain, RangeFunctionT body,
+                                      void* argument)
+{
+    if (begin < end)
+    {
+        size_t chunks = (size_t) pool->workerCount * CTHREAD_POOL_CHUNKS_PER_WORKER;
+        DParallelForT loop = {body, argument, grain};
+        DTaskGroupT group;
+        if (0u == loop.grain) { loop.grain = ((end - begin) + chunks - 1u) / chunks; }
+        tpool_group_init(&group);
+
+        DTaskT task = {NULL, &loop, begin, end, &group};
+        CATOMIC_FETCH_ADD(&group.pending, 1u);
+        tpool_enqueue(pool, &task);
+        tpool_group_wait(pool, &group);
+    }
+}
+
+#endif// CTHREAD_POOL_HEADER
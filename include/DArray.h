@@ -76,14 +76,36 @@ Type definitions
  * @var capacity The maximum number of elements that the dynamic array can hold.
  * @var elementSize The size of each element in the dynamic array.
  * @var data The data of the dynamic array.
+ * @var storage Storage hooks, NULL when the data is a CMALLOC buffer.
+ * @var storageContext State of the storage hooks.
  */
-typedef struct {
+typedef struct DArray {
     size_t length;
     size_t capacity;
     size_t elementSize;
     int8_t* data;
+    const struct DArrayStorage* storage;
+    void* storageContext;
 } DArrayT;
 
+/**
+ * @struct DArrayStorageT
+ * @brief Storage hooks of a dynamic array whose data is not a CMALLOC buffer,
+ * e.g. a mapped file.
+ *
+ * @var reserve Grows the data to hold at least newCapacity elements and updates
+ * data and capacity. Returns FALSE if the data can not grow. NULL for read-only
+ * storage.
+ * @var release Releases the data when the dynamic array is destroyed.
+ * @var detach Gives the dynamic array a private copy of shared data before it
+ * is modified. NULL if the data is never shared.
+ */
+typedef struct DArrayStorage {
+    BOOL (*reserve)(struct DArray* darr, size_t newCapacity);
+    void (*release)(struct DArray* darr);
+    BOOL (*detach)(struct DArray* darr);
+} DArrayStorageT;
+
 /**
  * @typedef DArrayU32T
  * @brief A dynamic array of uint32_t.
@@ -660,6 +682,27 @@ static void* darr_pop(DArrayT* darr);
  */
 static void* darr_pop_safe(DArrayT* darr);
 
+/**
+ * @brief Clone a dynamic array without copying its data.
+ *
+ * The clone and the original share the data until one of them is modified
+ * through darr_resize, darr_push_*, darr_insert_*, darr_erase, darr_reserve or
+ * darr_shrink_to_fit, which gives the modified array a private copy. The
+ * reference count is atomic, clones may live in different threads. Call
+ * darr_make_unique before writing elements through pointers. The in-place
+ * kernels of DArraySelect.h, DArrayFilter.h and DHeap.h call it themselves.
+ *
+ * @param darr[in] The dynamic array.
+ * @return A pointer to the clone, destroy it with darr_destroy.
+ */
+static DArrayT* darr_clone(DArrayT* darr);
+
+/**
+ * @brief Give a dynamic array a private copy of data shared with clones.
+ * @param darr[in] The dynamic array.
+ */
+static void darr_make_unique(DArrayT* darr);
+
 /***********************************************************************************************************************
 Static functions implementation
 ***********************************************************************************************************************/
@@ -677,7 +720,7 @@ inline static void darr_insert_generic(DArrayT* darr, size_t index, void* valueP
                 size_t len = (darr->length) - (index + 1);
                 void* next = (void*) &darr->data[index * darr->elementSize + darr->elementSize];
                 void* current = &darr->data[index * darr->elementSize];
-                resultPtr = CMEMCPY(next, current, len * darr->elementSize);
+                resultPtr = CMEMMOVE(next, current, len * darr->elementSize);
                 if (NULL != resultPtr) { CMEMCPY(&darr->data[index * darr->elementSize], valuePtr, darr->elementSize); }
             }
         }
@@ -882,27 +925,50 @@ inline static void darr_push_i8(DArrayI8T* darr, int8_t value) { darr_push_gener
 
 inline static void darr_push_generic(DArrayT* darr, void* value)
 {
-    darr_resize(darr, darr->length + 1);
-    CMEMCPY(&darr->data[darr->length * darr->elementSize - darr->elementSize], value, darr->elementSize);
+    size_t length = darr->length;
+    darr_resize(darr, length + 1);
+    if (darr->length != length + 1) { LOG_ERROR("Can not push to dynamic array!\n"); }
+    else { CMEMCPY(&darr->data[length * darr->elementSize], value, darr->elementSize); }
 }
 
 inline static void darr_push_ptr(DArrayT* darr, void* value)
 {
-    darr_resize(darr, darr->length + 1);
-    CMEMCPY(&darr->data[darr->length * darr->elementSize - darr->elementSize], &value, darr->elementSize);
+    size_t length = darr->length;
+    darr_resize(darr, length + 1);
+    if (darr->length != length + 1) { LOG_ERROR("Can not push to dynamic array!\n"); }
+    else { CMEMCPY(&darr->data[length * darr->elementSize], &value, darr->elementSize); }
 }
 
+
 inline static BOOL darr_is_empty(DArrayT* darr) { return (0u == darr->length); }
 
 inline static size_t darr_length(DArrayT* darr) { return darr->length; }
 
 inline static size_t darr_capacity(DArrayT* darr) { return darr->capacity; }
 
+inline static void darr_prepare_write(DArrayT* darr)
+{
+    if ((NULL != darr->storage) && (NULL != darr->storage->detach)) { darr->storage->detach(darr); }
+}
+
+inline static BOOL darr_storage_reserve(DArrayT* darr, size_t newCapacity)
+{
+    BOOL result = FALSE;
+    if (NULL == darr->storage->reserve) { LOG_ERROR("Can not grow read-only dynamic array!\n"); }
+    else { result = darr->storage->reserve(darr, newCapacity); }
+    return result;
+}
+
 inline static void darr_resize(DArrayT* darr, size_t newLength)
 {
+    darr_prepare_write(darr);
     if (newLength > darr->length)
     {
-        if (newLength > darr->capacity)
+        if ((newLength > darr->capacity) && (NULL != darr->storage))
+        {
+            if (TRUE == darr_storage_reserve(darr, newLength * DARRAY_RESIZE_FACTOR)) { darr->length = newLength; }
+        }
+        else if (newLength > darr->capacity)
         {
             int8_t* resultPtr;
             size_t newCapacity = newLength * DARRAY_RESIZE_FACTOR;
@@ -924,7 +990,8 @@ inline static void darr_resize(DArrayT* darr, size_t newLength)
 
 inline static void darr_destroy(DArrayT* darr)
 {
-    CFREE(darr->data, darr->length);
+    if (NULL != darr->storage) { darr->storage->release(darr); }
+    else { CFREE(darr->data, darr->length); }
     CFREE(darr, sizeof(darr));
 }
 
@@ -951,6 +1018,8 @@ inline static DArrayT* darr_create_generic(size_t typeSize)
         result->length = 0;                        // set length to 0
         result->capacity = DARRAY_INITIAL_CAPACITY;// set capacity to DARRAY_INITIAL_CAPACITY
         result->elementSize = typeSize;            // set element size to stride
+        result->storage = NULL;
+        result->storageContext = NULL;
         int8_t* dataPtr = (int8_t*) CMALLOC(typeSize);
         if (NULL == dataPtr) { LOG_ERROR("Can not allocate darray data buffer!\n"); }
         else { result->data = dataPtr; }
@@ -961,15 +1030,13 @@ inline static DArrayT* darr_create_generic(size_t typeSize)
 
 inline static void darr_erase(DArrayT* darr, size_t index)
 {
-    int8_t* resultPtr = NULL;
-    if (NULL != darr->data)
+    darr_prepare_write(darr);
+    if ((NULL != darr->data) && (index < darr->length))
     {
-        void* dest = &(darr->data[index]);
-        void* src = &(darr->data[index + darr->elementSize]);
-        resultPtr = (int8_t*) CMEMCPY(dest, src, (darr->length - index));
-        if (NULL == resultPtr) { LOG_ERROR("Can not copy darray darrfer!\n"); }
+        int8_t* dest = &(darr->data[index * darr->elementSize]);
+        CMEMMOVE(dest, dest + darr->elementSize, (darr->length - index - 1) * darr->elementSize);
+        darr->length -= 1;
     }
-    if (NULL != resultPtr) { darr->length -= 1; }
 }
 
 inline static void darr_erase_safe(DArrayT* darr, size_t index)
@@ -980,7 +1047,9 @@ inline static void darr_erase_safe(DArrayT* darr, size_t index)
 
 inline static void darr_shrink_to_fit(DArrayT* darr)
 {
-    if (darr->capacity > darr->length)
+    darr_prepare_write(darr);
+    if (NULL != darr->storage) {}
+    else if (darr->capacity > darr->length)
     {
         int8_t* resultPtr = NULL;
         if (NULL != darr->data) { resultPtr = (int8_t*) CREALLOC(darr->data, darr->length * darr->elementSize); }
@@ -995,7 +1064,9 @@ inline static void darr_shrink_to_fit(DArrayT* darr)
 
 inline static void darr_reserve(DArrayT* darr, size_t newCapacity)
 {
-    if (newCapacity > darr->capacity)
+    darr_prepare_write(darr);
+    if ((newCapacity > darr->capacity) && (NULL != darr->storage)) { darr_storage_reserve(darr, newCapacity); }
+    else if (newCapacity > darr->capacity)
     {
         int8_t* resultPtr;
 
@@ -1027,4 +1098,97 @@ inline static void* darr_pop_safe(DArrayT* darr)
     else { LOG_ERROR("Can not pop from darray with size < 0!\n"); }
     return valuePtr;
 }
+
+inline static void darr_cow_release(DArrayT* darr)
+{
+    uint32_t* refCount = (uint32_t*) darr->storageContext;
+    if (0u == __atomic_sub_fetch(refCount, 1u, __ATOMIC_ACQ_REL))
+    {
+        CFREE(darr->data, darr->capacity * darr->elementSize);
+        CFREE(refCount, sizeof(uint32_t));
+    }
+}
+
+inline static BOOL darr_cow_detach(DArrayT* darr)
+{
+    BOOL result = TRUE;
+    uint32_t* refCount = (uint32_t*) darr->storageContext;
+
+    if (1u == __atomic_load_n(refCount, __ATOMIC_ACQUIRE)) { CFREE(refCount, sizeof(uint32_t)); }
+    else
+    {
+        size_t capacity = (darr->capacity > 0) ? darr->capacity : 1u;
+        int8_t* data = (int8_t*) CMALLOC(capacity * darr->elementSize);
+        if (NULL == data)
+        {
+            LOG_ERROR("Can not allocate darray darrfer!\n");
+            result = FALSE;
+        }
+        else
+        {
+            CMEMCPY(data, darr->data, darr->length * darr->elementSize);
+            darr_cow_release(darr);
+            darr->data = data;
+            darr->capacity = capacity;
+        }
+    }
+
+    if (TRUE == result)
+    {
+        darr->storage = NULL;
+        darr->storageContext = NULL;
+    }
+    return result;
+}
+
+static const DArrayStorageT darr_cow_storage = {NULL, darr_cow_release, darr_cow_detach};
+
+inline static DArrayT* darr_clone(DArrayT* darr)
+{
+    DArrayT* result = (DArrayT*) CMALLOC(sizeof(DArrayT));
+    if (NULL == result) { LOG_ERROR("Can not allocate dynamic darray!\n"); }
+    else if (NULL == darr->storage)
+    {
+        uint32_t* refCount = (uint32_t*) CMALLOC(sizeof(uint32_t));
+        if (NULL == refCount)
+        {
+            LOG_ERROR("Can not allocate reference count!\n");
+            CFREE(result, sizeof(DArrayT));
+            result = NULL;
+        }
+        else
+        {
+            *refCount = 2u;
+            darr->storage = &darr_cow_storage;
+            darr->storageContext = refCount;
+            *result = *darr;
+        }
+    }
+    else if (&darr_cow_storage == darr->storage)
+    {
+        __atomic_add_fetch((uint32_t*) darr->storageContext, 1u, __ATOMIC_RELAXED);
+        *result = *darr;
+    }
+    else
+    {
+        /* Mapped storage is not reference counted, clone it into a regular array. */
+        size_t capacity = (darr->length > 0) ? darr->length : 1u;
+        *result = *darr;
+        result->storage = NULL;
+        result->storageContext = NULL;
+        result->data = (int8_t*) CMALLOC(capacity * darr->elementSize);
+        result->capacity = capacity;
+        if (NULL == result->data)
+        {
+            LOG_ERROR("Can not allocate darray darrfer!\n");
+            CFREE(result, sizeof(DArrayT));
+            result = NULL;
+        }
+        else { CMEMCPY(result->data, darr->data, darr->length * darr->elementSize); }
+    }
+    return result;
+}
+
+inline static void darr_make_unique(DArrayT* darr) { darr_prepare_write(darr); }
+
 #endif// DARRAY_HEADER
@@ -0,0 +1,485 @@
+#ifndef DARRAY_FILTER_HEADER
+#define DARRAY_FILTER_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DArrayFilter Header (stream compaction, mask filtering and gather/scatter kernels)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CCpu.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DARRAY_MASK_WORDS
+ * @brief Number of uint64_t words of a bitmask covering count elements (bit i % 64 of word i / 64 selects element i).
+ */
+#define DARRAY_MASK_WORDS(count) (((count) + 63u) / 64u)
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @brief Predicate over one element of a dynamic array.
+ * @return TRUE if the element matches.
+ */
+typedef BOOL (*DArrayPredicateFn)(const void* element, void* userData);
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Copy the elements of src whose mask bit is set into dest, keeping their order.
+ *
+ * dest is grown once to the worst case size and its length is set to the number
+ * of selected elements, so no per element resize happens. 4 byte elements use
+ * AVX-512 or AVX2 compress kernels when available. dest may be src for an in
+ * place filter.
+ *
+ * @param dest[in] The destination array, same elementSize as src.
+ * @param src[in] The source array.
+ * @param mask[in] Bitmask with DARRAY_MASK_WORDS(src->length) words.
+ * @return The number of selected elements.
+ */
+static size_t darr_filter_by_mask(DArrayT* dest, DArrayT* src, const uint64_t* mask);
+
+/**
+ * @brief Remove every element for which the predicate returns TRUE, in a single pass.
+ * @param darr[in] The dynamic array.
+ * @param predicate[in] The removal predicate.
+ * @param userData[in] User pointer passed to the predicate.
+ * @return The number of removed elements.
+ */
+static size_t darr_compact(DArrayT* darr, DArrayPredicateFn predicate, void* userData);
+
+/**
+ * @brief Build a bitmask selecting the uint32_t elements in [low, high].
+ * @param src[in] The source array.
+ * @param low[in] The lowest selected value.
+ * @param high[in] The highest selected value.
+ * @param mask[out] Receives DARRAY_MASK_WORDS(src->length) words.
+ * @return The number of selected elements.
+ */
+static size_t darr_mask_range_u32(DArrayU32T* src, uint32_t low, uint32_t high, uint64_t* mask);
+
+/**
+ * @brief Set dest[i] = src[indices[i]] for i in [0, count).
+ *
+ * dest is resized to count. Indices are not bounds checked. 4 byte elements use
+ * AVX-512 or AVX2 hardware gathers when available.
+ *
+ * @param dest[in] The destination array, same elementSize as src and not src itself.
+ * @param src[in] The source array.
+ * @param indices[in] The source indices.
+ * @param count[in] The number of indices.
+ */
+static void darr_gather(DArrayT* dest, DArrayT* src, const uint32_t* indices, size_t count);
+
+/**
+ * @brief Set dest[indices[i]] = src[i] for every element of src.
+ *
+ * dest must be presized to cover every index, it is not resized. Indices are
+ * not bounds checked. When an index repeats, the last write wins. 4 byte
+ * elements use AVX-512 scatter when available.
+ *
+ * @param dest[in] The destination array, same elementSize as src and not src itself.
+ * @param src[in] The source array.
+ * @param indices[in] The destination indices, src->length of them.
+ */
+static void darr_scatter(DArrayT* dest, DArrayT* src, const uint32_t* indices);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static BOOL darr_mask_test(const uint64_t* mask, size_t index)
+{
+    return (0u != ((mask[index >> 6] >> (index & 63u)) & 1u));
+}
+
+inline static size_t darr_filter_by_mask_scalar(int8_t* dest, const int8_t* src, size_t elementSize,
+                                                const uint64_t* mask, size_t begin, size_t end, size_t out)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        if (darr_mask_test(mask, i))
+        {
+            if ((dest + out * elementSize) != (src + i * elementSize))
+            {
+                CMEMMOVE(dest + out * elementSize, src + i * elementSize, elementSize);
+            }
+            out++;
+        }
+    }
+    return out;
+}
+
+#ifdef CUTILS_SIMD_X86
+/* Kernels process whole 64 element mask words and return how many source elements they consumed. */
+CPU_TARGET_AVX512 inline static size_t darr_filter_u32_avx512(uint32_t* dest, const uint32_t* src, size_t count,
+                                                              const uint64_t* mask, size_t* outPtr)
+{
+    size_t out = *outPtr;
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+        uint64_t word = mask[i >> 6];
+        for (size_t lane = 0; lane < 64; lane += 16)
+        {
+            __mmask16 bits = (__mmask16) (word >> lane);
+            __m512i block = _mm512_loadu_si512((const void*) &src[i + lane]);
+            _mm512_storeu_si512((void*) &dest[out], _mm512_maskz_compress_epi32(bits, block));
+            out += CPU_POPCOUNT32((uint32_t) bits);
+        }
+    }
+    *outPtr = out;
+    return i;
+}
+
+CPU_TARGET_AVX2 inline static __m256i darr_compress_permutation_avx2(uint32_t bits)
+{
+    /* Spread the 8 bit mask to bytes, then pext the identity byte sequence to get the kept lane indices. */
+    uint64_t expanded = _pdep_u64((uint64_t) bits, 0x0101010101010101ull) * 0xFFu;
+    uint64_t lanes = _pext_u64(0x0706050403020100ull, expanded);
+    return _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long) lanes));
+}
+
+CPU_TARGET_AVX2 inline static size_t darr_filter_u32_avx2(uint32_t* dest, const uint32_t* src, size_t count,
+                                                          const uint64_t* mask, size_t* outPtr)
+{
+    size_t out = *outPtr;
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+        uint64_t word = mask[i >> 6];
+        for (size_t lane = 0; lane < 64; lane += 8)
+        {
+            uint32_t bits = (uint32_t) (word >> lane) & 0xFFu;
+            __m256i block = _mm256_loadu_si256((const __m256i*) &src[i + lane]);
+            block = _mm256_permutevar8x32_epi32(block, darr_compress_permutation_avx2(bits));
+            _mm256_storeu_si256((__m256i*) &dest[out], block);
+            out += CPU_POPCOUNT32(bits);
+        }
+    }
+    *outPtr = out;
+    return i;
+}
+
+CPU_TARGET_AVX512 inline static size_t darr_mask_range_u32_avx512(const uint32_t* src, size_t count, uint32_t low,
+                                                                  uint32_t high, uint64_t* mask)
+{
+    size_t i = 0;
+    const __m512i lowVec = _mm512_set1_epi32((int32_t) low);
+    const __m512i highVec = _mm512_set1_epi32((int32_t) high);
+    for (; i + 64 <= count; i += 64)
+    {
+        uint64_t word = 0;
+        for (size_t lane = 0; lane < 64; lane += 16)
+        {
+            __m512i block = _mm512_loadu_si512((const void*) &src[i + lane]);
+            __mmask16 bits = _mm512_mask_cmple_epu32_mask(_mm512_cmpge_epu32_mask(block, lowVec), block, highVec);
+            word |= ((uint64_t) bits) << lane;
+        }
+        mask[i >> 6] = word;
+    }
+    return i;
+}
+
+CPU_TARGET_AVX2 inline static size_t darr_mask_range_u32_avx2(const uint32_t* src, size_t count, uint32_t low,
+                                                              uint32_t high, uint64_t* mask)
+{
+    size_t i = 0;
+    /* Unsigned range check as a single unsigned compare: (value - low) <= (high - low), biased for signed cmpgt. */
+    const __m256i bias = _mm256_set1_epi32((int32_t) 0x80000000u);
+    const __m256i lowVec = _mm256_set1_epi32((int32_t) low);
+    const __m256i span = _mm256_set1_epi32((int32_t) ((high - low) ^ 0x80000000u));
+    for (; i + 64 <= count; i += 64)
+    {
+        uint64_t word = 0;
+        for (size_t lane = 0; lane < 64; lane += 8)
+        {
+            __m256i block = _mm256_loadu_si256((const __m256i*) &src[i + lane]);
+            __m256i offset = _mm256_xor_si256(_mm256_sub_epi32(block, lowVec), bias);
+            __m256i outside = _mm256_cmpgt_epi32(offset, span);
+            uint32_t bits = (~(uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xFFu;
+            word |= ((uint64_t) bits) << lane;
+        }
+        mask[i >> 6] = word;
+    }
+    return i;
+}
+
+CPU_TARGET_AVX512 inline static size_t darr_gather_u32_avx512(uint32_t* dest, const uint32_t* src,
+                                                              const uint32_t* indices, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i index = _mm512_loadu_si512((const void*) &indices[i]);
+        _mm512_storeu_si512((void*) &dest[i], _mm512_i32gather_epi32(index, (const void*) src, 4));
+    }
+    return i;
+}
+
+CPU_TARGET_AVX2 inline static size_t darr_gather_u32_avx2(uint32_t* dest, const uint32_t* src,
+                                                          const uint32_t* indices, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i index = _mm256_loadu_si256((const __m256i*) &indices[i]);
+        _mm256_storeu_si256((__m256i*) &dest[i], _mm256_i32gather_epi32((const int*) src, index, 4));
+    }
+    return i;
+}
+
+CPU_TARGET_AVX512 inline static size_t darr_scatter_u32_avx512(uint32_t* dest, const uint32_t* src,
+                                                               const uint32_t* indices, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512i index = _mm512_loadu_si512((const void*) &indices[i]);
+        _mm512_i32scatter_epi32((void*) dest, index, _mm512_loadu_si512((const void*) &src[i]), 4);
+    }
+    return i;
+}
+#endif
+
+inline static size_t darr_filter_by_mask(DArrayT* dest, DArrayT* src, const uint64_t* mask)
+{
+    size_t out = 0;
+    size_t count = src->length;
+
+    if (dest->elementSize != src->elementSize) { LOG_ERROR("Filter arrays have different element sizes!\n"); }
+    else
+    {
+        /* SIMD kernels store whole vectors, keep 16 elements of slack behind the worst case length. */
+        if (dest != src) { darr_reserve(dest, count + 16u); }
+        else { darr_make_unique(dest); }
+
+        if (dest->capacity >= count)
+        {
+            size_t i = 0;
+#ifdef CUTILS_SIMD_X86
+            if ((sizeof(uint32_t) == src->elementSize) && ((dest == src) || (dest->capacity >= count + 16u)))
+            {
+                if (cpu_has_feature(CPU_FEATURE_AVX512))
+                {
+                    i = darr_filter_u32_avx512((uint32_t*) dest->data, (const uint32_t*) src->data, count, mask, &out);
+                }
+                else if (cpu_has_feature(CPU_FEATURE_AVX2 | CPU_FEATURE_BMI2))
+                {
+                    i = darr_filter_u32_avx2((uint32_t*) dest->data, (const uint32_t*) src->data, count, mask, &out);
+                }
+            }
+#endif
+            out = darr_filter_by_mask_scalar(dest->data, src->data, src->elementSize, mask, i, count, out);
+            dest->length = out;
+        }
+        else { LOG_ERROR("Can not grow filter destination!\n"); }
+    }
+
+    return out;
+}
+
+inline static size_t darr_compact(DArrayT* darr, DArrayPredicateFn predicate, void* userData)
+{
+    size_t out = 0;
+    size_t elementSize = darr->elementSize;
+    size_t removed = 0;
+
+    darr_make_unique(darr);
+    switch (elementSize)
+    {
+        case sizeof(uint32_t): {
+            uint32_t* data = (uint32_t*) darr->data;
+            for (size_t i = 0; i < darr->length; i++)
+            {
+                uint32_t value = data[i];
+                data[out] = value;
+                out += (FALSE == predicate(&value, userData));
+            }
+            break;
+        }
+        case sizeof(uint64_t): {
+            uint64_t* data = (uint64_t*) darr->data;
+            for (size_t i = 0; i < darr->length; i++)
+            {
+                uint64_t value = data[i];
+                data[out] = value;
+                out += (FALSE == predicate(&value, userData));
+            }
+            break;
+        }
+        default:
+            for (size_t i = 0; i < darr->length; i++)
+            {
+                int8_t* element = &darr->data[i * elementSize];
+                if (FALSE == predicate(element, userData))
+                {
+                    if (out != i) { CMEMCPY(&darr->data[out * elementSize], element, elementSize); }
+                    out++;
+                }
+            }
+            break;
+    }
+
+    removed = darr->length - out;
+    darr->length = out;
+    return removed;
+}
+
+inline static size_t darr_mask_range_u32(DArrayU32T* src, uint32_t low, uint32_t high, uint64_t* mask)
+{
+    size_t selected = 0;
+    size_t count = src->length;
+    const uint32_t* values = (const uint32_t*) src->data;
+    size_t i = 0;
+
+    if (low <= high)
+    {
+#ifdef CUTILS_SIMD_X86
+        if (cpu_has_feature(CPU_FEATURE_AVX512)) { i = darr_mask_range_u32_avx512(values, count, low, high, mask); }
+        else if (cpu_has_feature(CPU_FEATURE_AVX2)) { i = darr_mask_range_u32_avx2(values, count, low, high, mask); }
+#endif
+    }
+    for (size_t word = i >> 6; word < DARRAY_MASK_WORDS(count); word++) { mask[word] = 0; }
+    for (; i < count; i++)
+    {
+        if ((values[i] >= low) && (values[i] <= high)) { mask[i >> 6] |= ((uint64_t) 1u) << (i & 63u); }
+    }
+    for (size_t word = 0; word < DARRAY_MASK_WORDS(count); word++) { selected += CPU_POPCOUNT64(mask[word]); }
+    return selected;
+}
+
+inline static void darr_gather(DArrayT* dest, DArrayT* src, const uint32_t* indices, size_t count)
+{
+    if ((dest->elementSize != src->elementSize) || (dest == src)) { LOG_ERROR("Invalid gather arrays!\n"); }
+    else
+    {
+        darr_reserve(dest, count);
+        darr_resize(dest, count);
+        if (dest->length == count)
+        {
+            size_t i = 0;
+            switch (src->elementSize)
+            {
+                case sizeof(uint32_t): {
+                    uint32_t* out = (uint32_t*) dest->data;
+                    const uint32_t* in = (const uint32_t*) src->data;
+#ifdef CUTILS_SIMD_X86
+                    /* Hardware gathers take signed 32 bit indices. */
+                    if (src->length <= 0x7FFFFFFFu)
+                    {
+                        if (cpu_has_feature(CPU_FEATURE_AVX512))
+                        {
+                            i = darr_gather_u32_avx512(out, in, indices, count);
+                        }
+                        else if (cpu_has_feature(CPU_FEATURE_AVX2))
+                        {
+                            i = darr_gather_u32_avx2(out, in, indices, count);
+                        }
+                    }
+#endif
+                    for (; i < count; i++) { out[i] = in[indices[i]]; }
+                    break;
+                }
+                case sizeof(uint64_t): {
+                    uint64_t* out = (uint64_t*) dest->data;
+                    const uint64_t* in = (const uint64_t*) src->data;
+                    for (; i < count; i++) { out[i] = in[indices[i]]; }
+                    break;
+                }
+                default:
+                    for (; i < count; i++)
+                    {
+                        CMEMCPY(&dest->data[i * dest->elementSize], &src->data[indices[i] * src->elementSize],
+                                src->elementSize);
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+inline static void darr_scatter(DArrayT* dest, DArrayT* src, const uint32_t* indices)
+{
+    if ((dest->elementSize != src->elementSize) || (dest == src)) { LOG_ERROR("Invalid scatter arrays!\n"); }
+    else
+    {
+        darr_make_unique(dest);
+        size_t i = 0;
+        size_t count = src->length;
+        switch (src->elementSize)
+        {
+            case sizeof(uint32_t): {
+                uint32_t* out = (uint32_t*) dest->data;
+                const uint32_t* in = (const uint32_t*) src->data;
+#ifdef CUTILS_SIMD_X86
+                if ((dest->length <= 0x7FFFFFFFu) && cpu_has_feature(CPU_FEATURE_AVX512))
+                {
+                    i = darr_scatter_u32_avx512(out, in, indices, count);
+                }
+#endif
+                for (; i < count; i++) { out[indices[i]] = in[i]; }
+                break;
+            }
+            case sizeof(uint64_t): {
+                uint64_t* out = (uint64_t*) dest->data;
+                const uint64_t* in = (const uint64_t*) src->data;
+                for (; i < count; i++) { out[indices[i]] = in[i]; }
+                break;
+            }
+            default:
+                for (; i < count; i++)
+                {
+                    CMEMCPY(&dest->data[indices[i] * dest->elementSize], &src->data[i * src->elementSize],
+                            src->elementSize);
+                }
+                break;
+        }
+    }
+}
+
+#endif// DARRAY_FILTER_HEADER
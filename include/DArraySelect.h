@@ -0,0 +1,713 @@
+#ifndef DARRAY_SELECT_HEADER
+#define DARRAY_SELECT_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DArraySelect Header (nth element, partial sort and top-k selection for typed arrays)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CCpu.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "DHeap.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DARRAY_SELECT_INSERTION_THRESHOLD
+ * @brief Ranges of at most this many elements are finished with insertion sort.
+ */
+#define DARRAY_SELECT_INSERTION_THRESHOLD 16u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DTopKT
+ * @brief Streaming accumulator of the k largest values seen so far.
+ *
+ * The kept values live in a typed min-heap, so the smallest kept value is the
+ * admission threshold. Batches are pre-filtered against the threshold with SIMD
+ * compares, and only the few candidates above it touch the heap.
+ *
+ * @var heap Typed min-heap of the kept values.
+ * @var k The number of values to keep.
+ */
+typedef struct {
+    DHeapT* heap;
+    size_t k;
+} DTopKT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Reorder the array so the element at nth is the one that would be there if the array was sorted
+ * ascending, all elements before it are not greater and all elements after it are not smaller.
+ *
+ * Introselect: quickselect with median of three pivots, falling back to heapsort
+ * of the remaining range when the recursion depth exceeds 2*log2(n). O(n) on average,
+ * O(n log n) worst case.
+ *
+ * @param darr[in] The dynamic array.
+ * @param nth[in] The index of the element to place. Nothing happens if it is out of bounds.
+ */
+static void darr_nth_element_u32(DArrayU32T* darr, size_t nth);
+
+/**
+ * @brief Same as darr_nth_element_u32 for int32_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param nth[in] The index of the element to place.
+ */
+static void darr_nth_element_i32(DArrayI32T* darr, size_t nth);
+
+/**
+ * @brief Same as darr_nth_element_u32 for uint16_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param nth[in] The index of the element to place.
+ */
+static void darr_nth_element_u16(DArrayU16T* darr, size_t nth);
+
+/**
+ * @brief Same as darr_nth_element_u32 for int16_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param nth[in] The index of the element to place.
+ */
+static void darr_nth_element_i16(DArrayI16T* darr, size_t nth);
+
+/**
+ * @brief Same as darr_nth_element_u32 for uint8_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param nth[in] The index of the element to place.
+ */
+static void darr_nth_element_u8(DArrayU8T* darr, size_t nth);
+
+/**
+ * @brief Same as darr_nth_element_u32 for int8_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param nth[in] The index of the element to place.
+ */
+static void darr_nth_element_i8(DArrayI8T* darr, size_t nth);
+
+/**
+ * @brief Sort the smallest count elements ascending into the front of the array.
+ *
+ * The order of the remaining elements is unspecified. Selects with introselect
+ * first, then sorts only the front, so the cost is O(n + count log count).
+ *
+ * @param darr[in] The dynamic array.
+ * @param count[in] The number of elements to sort, clamped to the array length.
+ */
+static void darr_partial_sort_u32(DArrayU32T* darr, size_t count);
+
+/**
+ * @brief Same as darr_partial_sort_u32 for int32_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param count[in] The number of elements to sort.
+ */
+static void darr_partial_sort_i32(DArrayI32T* darr, size_t count);
+
+/**
+ * @brief Same as darr_partial_sort_u32 for uint16_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param count[in] The number of elements to sort.
+ */
+static void darr_partial_sort_u16(DArrayU16T* darr, size_t count);
+
+/**
+ * @brief Same as darr_partial_sort_u32 for int16_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param count[in] The number of elements to sort.
+ */
+static void darr_partial_sort_i16(DArrayI16T* darr, size_t count);
+
+/**
+ * @brief Same as darr_partial_sort_u32 for uint8_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param count[in] The number of elements to sort.
+ */
+static void darr_partial_sort_u8(DArrayU8T* darr, size_t count);
+
+/**
+ * @brief Same as darr_partial_sort_u32 for int8_t arrays.
+ * @param darr[in] The dynamic array.
+ * @param count[in] The number of elements to sort.
+ */
+static void darr_partial_sort_i8(DArrayI8T* darr, size_t count);
+
+/**
+ * @brief Create a top-k accumulator of uint32_t values.
+ * @param k[in] The number of largest values to keep.
+ * @return A pointer to the new accumulator.
+ */
+static DTopKT* topk_create_u32(size_t k);
+
+/**
+ * @brief Create a top-k accumulator of int32_t values.
+ * @param k[in] The number of largest values to keep.
+ * @return A pointer to the new accumulator.
+ */
+static DTopKT* topk_create_i32(size_t k);
+
+/**
+ * @brief Destroy a top-k accumulator.
+ * @param topk[in] The accumulator.
+ */
+static void topk_destroy(DTopKT* topk);
+
+/**
+ * @brief Offer one value to a uint32_t accumulator.
+ * @param topk[in] The accumulator.
+ * @param value[in] The value.
+ */
+static void topk_push_u32(DTopKT* topk, uint32_t value);
+
+/**
+ * @brief Offer one value to an int32_t accumulator.
+ * @param topk[in] The accumulator.
+ * @param value[in] The value.
+ */
+static void topk_push_i32(DTopKT* topk, int32_t value);
+
+/**
+ * @brief Offer a batch of values to a uint32_t accumulator.
+ *
+ * Once k values are kept, blocks of 8 (AVX2) or 16 (AVX-512) values are compared
+ * against the threshold at once and blocks without a candidate are skipped.
+ *
+ * @param topk[in] The accumulator.
+ * @param values[in] The values.
+ * @param count[in] The number of values.
+ */
+static void topk_push_batch_u32(DTopKT* topk, const uint32_t* values, size_t count);
+
+/**
+ * @brief Offer a batch of values to an int32_t accumulator (see topk_push_batch_u32).
+ * @param topk[in] The accumulator.
+ * @param values[in] The values.
+ * @param count[in] The number of values.
+ */
+static void topk_push_batch_i32(DTopKT* topk, const int32_t* values, size_t count);
+
+/**
+ * @brief Get the smallest kept value of a uint32_t accumulator.
+ * @param topk[in] The accumulator.
+ * @return The admission threshold, or 0 while fewer than k values are kept.
+ */
+static uint32_t topk_threshold_u32(DTopKT* topk);
+
+/**
+ * @brief Get the smallest kept value of an int32_t accumulator.
+ * @param topk[in] The accumulator.
+ * @return The admission threshold, or INT32 minimum while fewer than k values are kept.
+ */
+static int32_t topk_threshold_i32(DTopKT* topk);
+
+/**
+ * @brief Copy the kept values of a uint32_t accumulator, largest first.
+ * @param topk[in] The accumulator.
+ * @return A new dynamic array with at most k values sorted descending.
+ */
+static DArrayU32T* topk_result_u32(DTopKT* topk);
+
+/**
+ * @brief Copy the kept values of an int32_t accumulator, largest first.
+ * @param topk[in] The accumulator.
+ * @return A new dynamic array with at most k values sorted descending.
+ */
+static DArrayI32T* topk_result_i32(DTopKT* topk);
+
+/**
+ * @brief Get the k largest values of an array without sorting it.
+ * @param darr[in] The dynamic array, left unchanged.
+ * @param k[in] The number of values.
+ * @return A new dynamic array with the k largest values sorted descending.
+ */
+static DArrayU32T* darr_top_k_u32(DArrayU32T* darr, size_t k);
+
+/**
+ * @brief Get the k largest values of an int32_t array without sorting it.
+ * @param darr[in] The dynamic array, left unchanged.
+ * @param k[in] The number of values.
+ * @return A new dynamic array with the k largest values sorted descending.
+ */
+static DArrayI32T* darr_top_k_i32(DArrayI32T* darr, size_t k);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static size_t darr_select_depth_limit(size_t length)
+{
+    size_t depth = 0;
+    while (length > 1)
+    {
+        length >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+/**
+ * @brief Generates the selection kernels of one element type.
+ *
+ * All ranges are [lo, hi). Partitioning is Hoare style around the median of
+ * three, which keeps runs of equal keys balanced.
+ */
+// clang-format off
+#define DARRAY_SELECT_IMPLEMENT(suffix, type)                                                                          \
+    inline static void darr_select_insertion_##suffix(type* a, size_t lo, size_t hi)                                   \
+    {                                                                                                                  \
+        for (size_t i = lo + 1; i < hi; i++)                                                                           \
+        {                                                                                                              \
+            type value = a[i];                                                                                         \
+            size_t j = i;                                                                                              \
+            while ((j > lo) && (a[j - 1] > value))                                                                     \
+            {                                                                                                          \
+                a[j] = a[j - 1];                                                                                       \
+                j--;                                                                                                   \
+            }                                                                                                          \
+            a[j] = value;                                                                                              \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static void darr_select_sift_##suffix(type* base, size_t root, size_t length)                               \
+    {                                                                                                                  \
+        type value = base[root];                                                                                       \
+        for (;;)                                                                                                       \
+        {                                                                                                              \
+            size_t child = root * 2 + 1;                                                                               \
+            if (child >= length) { break; }                                                                            \
+            if ((child + 1 < length) && (base[child + 1] > base[child])) { child++; }                                  \
+            if (base[child] <= value) { break; }                                                                       \
+            base[root] = base[child];                                                                                  \
+            root = child;                                                                                              \
+        }                                                                                                              \
+        base[root] = value;                                                                                            \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static void darr_select_heapsort_##suffix(type* a, size_t lo, size_t hi)                                    \
+    {                                                                                                                  \
+        type* base = &a[lo];                                                                                           \
+        size_t length = hi - lo;                                                                                       \
+        for (size_t i = length / 2; i-- > 0;) { darr_select_sift_##suffix(base, i, length); }                          \
+        while (length > 1)                                                                                             \
+        {                                                                                                              \
+            length--;                                                                                                  \
+            type top = base[0];                                                                                        \
+            base[0] = base[length];                                                                                    \
+            base[length] = top;                                                                                        \
+            darr_select_sift_##suffix(base, 0, length);                                                                \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static size_t darr_select_partition_##suffix(type* a, size_t lo, size_t hi)                                 \
+    {                                                                                                                  \
+        size_t mid = lo + (hi - 1 - lo) / 2;                                                                           \
+        type tmp;                                                                                                      \
+        if (a[mid] < a[lo]) { tmp = a[mid]; a[mid] = a[lo]; a[lo] = tmp; }                                             \
+        if (a[hi - 1] < a[lo]) { tmp = a[hi - 1]; a[hi - 1] = a[lo]; a[lo] = tmp; }                                    \
+        if (a[hi - 1] < a[mid]) { tmp = a[hi - 1]; a[hi - 1] = a[mid]; a[mid] = tmp; }                                 \
+        type pivot = a[mid];                                                                                           \
+        size_t i = lo - 1;                                                                                             \
+        size_t j = hi;                                                                                                 \
+        for (;;)                                                                                                       \
+        {                                                                                                              \
+            do { i++; } while (a[i] < pivot);                                                                          \
+            do { j--; } while (a[j] > pivot);                                                                          \
+            if (i >= j) { break; }                                                                                     \
+            tmp = a[i]; a[i] = a[j]; a[j] = tmp;                                                                       \
+        }                                                                                                              \
+        return j;                                                                                                      \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static void darr_select_introsort_##suffix(type* a, size_t lo, size_t hi, size_t depth)                     \
+    {                                                                                                                  \
+        while (hi - lo > DARRAY_SELECT_INSERTION_THRESHOLD)                                                            \
+        {                                                                                                              \
+            if (0u == depth)                                                                                           \
+            {                                                                                                          \
+                darr_select_heapsort_##suffix(a, lo, hi);                                                              \
+                return;                                                                                                \
+            }                                                                                                          \
+            depth--;                                                                                                   \
+            size_t split = darr_select_partition_##suffix(a, lo, hi) + 1;                                              \
+            if (split - lo < hi - split)                                                                               \
+            {                                                                                                          \
+                darr_select_introsort_##suffix(a, lo, split, depth);                                                   \
+                lo = split;                                                                                            \
+            }                                                                                                          \
+            else                                                                                                       \
+            {                                                                                                          \
+                darr_select_introsort_##suffix(a, split, hi, depth);                                                   \
+                hi = split;                                                                                            \
+            }                                                                                                          \
+        }                                                                                                              \
+        darr_select_insertion_##suffix(a, lo, hi);                                                                     \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static void darr_select_nth_##suffix(type* a, size_t lo, size_t hi, size_t nth)                             \
+    {                                                                                                                  \
+        size_t depth = darr_select_depth_limit(hi - lo);                                                               \
+        while (hi - lo > DARRAY_SELECT_INSERTION_THRESHOLD)                                                            \
+        {                                                                                                              \
+            if (0u == depth)                                                                                           \
+            {                                                                                                          \
+                darr_select_heapsort_##suffix(a, lo, hi);                                                              \
+                return;                                                                                                \
+            }                                                                                                          \
+            depth--;                                                                                                   \
+            size_t split = darr_select_partition_##suffix(a, lo, hi) + 1;                                              \
+            if (nth < split) { hi = split; }                                                                           \
+            else { lo = split; }                                                                                       \
+        }                                                                                                              \
+        darr_select_insertion_##suffix(a, lo, hi);                                                                     \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static void darr_nth_element_##suffix(DArrayT* darr, size_t nth)                                            \
+    {                                                                                                                  \
+        if (sizeof(type) != darr->elementSize) { LOG_ERROR("Element size does not match the array type!\n"); }         \
+        else if (nth < darr->length)                                                                                   \
+        {                                                                                                              \
+            darr_make_unique(darr);                                                                                    \
+            darr_select_nth_##suffix((type*) darr->data, 0, darr->length, nth);                                        \
+        }                                                                                                              \
+    }                                                                                                                  \
+                                                                                                                       \
+    inline static void darr_partial_sort_##suffix(DArrayT* darr, size_t count)                                         \
+    {                                                                                                                  \
+        if (sizeof(type) != darr->elementSize) { LOG_ERROR("Element size does not match the array type!\n"); }         \
+        else                                                                                                           \
+        {                                                                                                              \
+            darr_make_unique(darr);                                                                                    \
+            type* a = (type*) darr->data;                                                                              \
+            if (count > darr->length) { count = darr->length; }                                                        \
+            if ((count > 0) && (count < darr->length)) { darr_select_nth_##suffix(a, 0, darr->length, count - 1); }    \
+            if (count > 1) { darr_select_introsort_##suffix(a, 0, count, darr_select_depth_limit(count)); }            \
+        }                                                                                                              \
+    }
+// clang-format on
+
+DARRAY_SELECT_IMPLEMENT(u32, uint32_t)
+DARRAY_SELECT_IMPLEMENT(i32, int32_t)
+DARRAY_SELECT_IMPLEMENT(u16, uint16_t)
+DARRAY_SELECT_IMPLEMENT(i16, int16_t)
+DARRAY_SELECT_IMPLEMENT(u8, uint8_t)
+DARRAY_SELECT_IMPLEMENT(i8, int8_t)
+
+inline static DTopKT* topk_create_from_heap(DHeapT* heap, size_t k)
+{
+    DTopKT* result = NULL;
+    if (NULL != heap)
+    {
+        result = (DTopKT*) CMALLOC(sizeof(DTopKT));
+        if (NULL == result)
+        {
+            LOG_ERROR("Can not allocate top-k accumulator!\n");
+            heap_destroy(heap);
+        }
+        else
+        {
+            darr_reserve(heap->data, k);
+            result->heap = heap;
+            result->k = k;
+        }
+    }
+    return result;
+}
+
+inline static DTopKT* topk_create_u32(size_t k) { return topk_create_from_heap(heap_create_u32(DHEAP_QUATERNARY), k); }
+
+inline static DTopKT* topk_create_i32(size_t k) { return topk_create_from_heap(heap_create_i32(DHEAP_QUATERNARY), k); }
+
+inline static void topk_destroy(DTopKT* topk)
+{
+    if (NULL != topk)
+    {
+        heap_destroy(topk->heap);
+        CFREE(topk, sizeof(DTopKT));
+    }
+}
+
+inline static void topk_push_u32(DTopKT* topk, uint32_t value)
+{
+    if (heap_length(topk->heap) < topk->k) { heap_push_u32(topk->heap, value); }
+    else if ((topk->k > 0) && (value > heap_top_u32(topk->heap))) { heap_replace_top_u32(topk->heap, value); }
+}
+
+inline static void topk_push_i32(DTopKT* topk, int32_t value)
+{
+    if (heap_length(topk->heap) < topk->k) { heap_push_i32(topk->heap, value); }
+    else if ((topk->k > 0) && (value > heap_top_i32(topk->heap))) { heap_replace_top_i32(topk->heap, value); }
+}
+
+#ifdef CUTILS_SIMD_X86
+/* The SIMD filters assume the accumulator is full and return how many values they consumed. */
+CPU_TARGET_AVX2 inline static size_t topk_filter_u32_avx2(DTopKT* topk, const uint32_t* values, size_t count)
+{
+    size_t i = 0;
+    uint32_t threshold = heap_top_u32(topk->heap);
+    const __m256i bias = _mm256_set1_epi32((int32_t) 0x80000000u);
+    __m256i limit = _mm256_set1_epi32((int32_t) (threshold ^ 0x80000000u));
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i block = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) &values[i]), bias);
+        uint32_t mask = (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(block, limit)));
+        if (0u != mask)
+        {
+            while (0u != mask)
+            {
+                uint32_t value = values[i + CPU_CTZ32(mask)];
+                if (value > threshold)
+                {
+                    heap_replace_top_u32(topk->heap, value);
+                    threshold = heap_top_u32(topk->heap);
+                }
+                mask &= mask - 1;
+            }
+            limit = _mm256_set1_epi32((int32_t) (threshold ^ 0x80000000u));
+        }
+    }
+    return i;
+}
+
+CPU_TARGET_AVX512 inline static size_t topk_filter_u32_avx512(DTopKT* topk, const uint32_t* values, size_t count)
+{
+    size_t i = 0;
+    uint32_t threshold = heap_top_u32(topk->heap);
+    __m512i limit = _mm512_set1_epi32((int32_t) threshold);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint32_t mask = (uint32_t) _mm512_cmpgt_epu32_mask(_mm512_loadu_si512((const void*) &values[i]), limit);
+        if (0u != mask)
+        {
+            while (0u != mask)
+            {
+                uint32_t value = values[i + CPU_CTZ32(mask)];
+                if (value > threshold)
+                {
+                    heap_replace_top_u32(topk->heap, value);
+                    threshold = heap_top_u32(topk->heap);
+                }
+                mask &= mask - 1;
+            }
+            limit = _mm512_set1_epi32((int32_t) threshold);
+        }
+    }
+    return i;
+}
+
+CPU_TARGET_AVX2 inline static size_t topk_filter_i32_avx2(DTopKT* topk, const int32_t* values, size_t count)
+{
+    size_t i = 0;
+    int32_t threshold = heap_top_i32(topk->heap);
+    __m256i limit = _mm256_set1_epi32(threshold);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*) &values[i]);
+        uint32_t mask = (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(block, limit)));
+        if (0u != mask)
+        {
+            while (0u != mask)
+            {
+                int32_t value = values[i + CPU_CTZ32(mask)];
+                if (value > threshold)
+                {
+                    heap_replace_top_i32(topk->heap, value);
+                    threshold = heap_top_i32(topk->heap);
+                }
+                mask &= mask - 1;
+            }
+            limit = _mm256_set1_epi32(threshold);
+        }
+    }
+    return i;
+}
+
+CPU_TARGET_AVX512 inline static size_t topk_filter_i32_avx512(DTopKT* topk, const int32_t* values, size_t count)
+{
+    size_t i = 0;
+    int32_t threshold = heap_top_i32(topk->heap);
+    __m512i limit = _mm512_set1_epi32(threshold);
+
+    for (; i + 16 <= count; i += 16)
+    {
+        uint32_t mask = (uint32_t) _mm512_cmpgt_epi32_mask(_mm512_loadu_si512((const void*) &values[i]), limit);
+        if (0u != mask)
+        {
+            while (0u != mask)
+            {
+                int32_t value = values[i + CPU_CTZ32(mask)];
+                if (value > threshold)
+                {
+                    heap_replace_top_i32(topk->heap, value);
+                    threshold = heap_top_i32(topk->heap);
+                }
+                mask &= mask - 1;
+            }
+            limit = _mm512_set1_epi32(threshold);
+        }
+    }
+    return i;
+}
+#endif
+
+inline static void topk_push_batch_u32(DTopKT* topk, const uint32_t* values, size_t count)
+{
+    size_t i = 0;
+    for (; (i < count) && (heap_length(topk->heap) < topk->k); i++) { heap_push_u32(topk->heap, values[i]); }
+
+    if (topk->k > 0)
+    {
+#ifdef CUTILS_SIMD_X86
+        if (cpu_has_feature(CPU_FEATURE_AVX512)) { i += topk_filter_u32_avx512(topk, &values[i], count - i); }
+        else if (cpu_has_feature(CPU_FEATURE_AVX2)) { i += topk_filter_u32_avx2(topk, &values[i], count - i); }
+#endif
+        for (; i < count; i++) { topk_push_u32(topk, values[i]); }
+    }
+}
+
+inline static void topk_push_batch_i32(DTopKT* topk, const int32_t* values, size_t count)
+{
+    size_t i = 0;
+    for (; (i < count) && (heap_length(topk->heap) < topk->k); i++) { heap_push_i32(topk->heap, values[i]); }
+
+    if (topk->k > 0)
+    {
+#ifdef CUTILS_SIMD_X86
+        if (cpu_has_feature(CPU_FEATURE_AVX512)) { i += topk_filter_i32_avx512(topk, &values[i], count - i); }
+        else if (cpu_has_feature(CPU_FEATURE_AVX2)) { i += topk_filter_i32_avx2(topk, &values[i], count - i); }
+#endif
+        for (; i < count; i++) { topk_push_i32(topk, values[i]); }
+    }
+}
+
+inline static uint32_t topk_threshold_u32(DTopKT* topk)
+{
+    uint32_t result = 0;
+    if ((topk->k > 0) && (heap_length(topk->heap) == topk->k)) { result = heap_top_u32(topk->heap); }
+    return result;
+}
+
+inline static int32_t topk_threshold_i32(DTopKT* topk)
+{
+    int32_t result = (int32_t) 0x80000000u;
+    if ((topk->k > 0) && (heap_length(topk->heap) == topk->k)) { result = heap_top_i32(topk->heap); }
+    return result;
+}
+
+inline static DArrayT* topk_result_copy(DTopKT* topk)
+{
+    DArrayT* result = darr_create_generic(topk->heap->data->elementSize);
+    size_t length = heap_length(topk->heap);
+    if ((NULL != result) && (length > 0))
+    {
+        darr_reserve(result, length);
+        darr_resize(result, length);
+        if (result->length == length) { CMEMCPY(result->data, topk->heap->data->data, length * result->elementSize); }
+    }
+    return result;
+}
+
+inline static DArrayU32T* topk_result_u32(DTopKT* topk)
+{
+    DArrayU32T* result = topk_result_copy(topk);
+    if ((NULL != result) && (result->length > 1))
+    {
+        uint32_t* a = (uint32_t*) result->data;
+        darr_select_introsort_u32(a, 0, result->length, darr_select_depth_limit(result->length));
+        for (size_t i = 0, j = result->length - 1; i < j; i++, j--)
+        {
+            uint32_t tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+        }
+    }
+    return result;
+}
+
+inline static DArrayI32T* topk_result_i32(DTopKT* topk)
+{
+    DArrayI32T* result = topk_result_copy(topk);
+    if ((NULL != result) && (result->length > 1))
+    {
+        int32_t* a = (int32_t*) result->data;
+        darr_select_introsort_i32(a, 0, result->length, darr_select_depth_limit(result->length));
+        for (size_t i = 0, j = result->length - 1; i < j; i++, j--)
+        {
+            int32_t tmp = a[i];
+            a[i] = a[j];
+            a[j] = tmp;
+        }
+    }
+    return result;
+}
+
+inline static DArrayU32T* darr_top_k_u32(DArrayU32T* darr, size_t k)
+{
+    DArrayU32T* result = NULL;
+    DTopKT* topk = topk_create_u32(k);
+    if (NULL != topk)
+    {
+        topk_push_batch_u32(topk, (const uint32_t*) darr->data, darr->length);
+        result = topk_result_u32(topk);
+        topk_destroy(topk);
+    }
+    return result;
+}
+
+inline static DArrayI32T* darr_top_k_i32(DArrayI32T* darr, size_t k)
+{
+    DArrayI32T* result = NULL;
+    DTopKT* topk = topk_create_i32(k);
+    if (NULL != topk)
+    {
+        topk_push_batch_i32(topk, (const int32_t*) darr->data, darr->length);
+        result = topk_result_i32(topk);
+        topk_destroy(topk);
+    }
+    return result;
+}
+
+#endif// DARRAY_SELECT_HEADER
@@ -0,0 +1,524 @@
+#ifndef DARRAY_SET_HEADER
+#define DARRAY_SET_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DArraySet Header (set algebra over sorted uint32_t arrays)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CCpu.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "DArrayFilter.h"
+#include "DHeap.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DARRAY_SET_GALLOP_RATIO
+ * @brief When one input is this many times longer than the other, the short one
+ * drives an exponential (galloping) search through the long one instead of a linear merge.
+ */
+#define DARRAY_SET_GALLOP_RATIO 32u
+
+/**
+ * @def DARRAY_SET_SIMD_SLACK
+ * @brief Extra destination elements reserved for full vector stores.
+ */
+#define DARRAY_SET_SIMD_SLACK 8u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DArraySetCursorT
+ * @brief Read position of one input of a k-way union, ordered by its current value in a DHeap.
+ *
+ * @var value The current value of the input.
+ * @var list The index of the input.
+ */
+typedef struct {
+    uint32_t value;
+    uint32_t list;
+} DArraySetCursorT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Intersect two sorted sets.
+ *
+ * Inputs must be strictly increasing uint32_t arrays. Picks galloping search
+ * for skewed sizes, an AVX2 all-pairs block compare for similar sizes and a
+ * branchless merge otherwise.
+ *
+ * @param dest[in] The destination array, must not be an input. Its length is set to the result size.
+ * @param a[in] The first sorted array.
+ * @param b[in] The second sorted array.
+ * @return The number of elements in the intersection.
+ */
+static size_t darr_intersect_sorted(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b);
+
+/**
+ * @brief Unite two sorted sets (see darr_intersect_sorted for the input requirements).
+ * @param dest[in] The destination array, must not be an input.
+ * @param a[in] The first sorted array.
+ * @param b[in] The second sorted array.
+ * @return The number of elements in the union.
+ */
+static size_t darr_union_sorted(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b);
+
+/**
+ * @brief Compute the elements of a that are not in b (see darr_intersect_sorted for the input requirements).
+ * @param dest[in] The destination array, must not be an input.
+ * @param a[in] The sorted array to subtract from.
+ * @param b[in] The sorted array to subtract.
+ * @return The number of elements in the difference.
+ */
+static size_t darr_difference_sorted(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b);
+
+/**
+ * @brief Intersect many sorted sets.
+ *
+ * Inputs are intersected from the shortest to the longest, so the running
+ * result only shrinks and long inputs are mostly galloped over.
+ *
+ * @param dest[in] The destination array, must not be an input.
+ * @param arrays[in] The sorted arrays.
+ * @param count[in] The number of arrays.
+ * @return The number of elements in the intersection.
+ */
+static size_t darr_intersect_sorted_many(DArrayU32T* dest, DArrayU32T* const* arrays, size_t count);
+
+/**
+ * @brief Unite many sorted sets with a single k-way merge over a heap of input cursors.
+ * @param dest[in] The destination array, must not be an input.
+ * @param arrays[in] The sorted arrays.
+ * @param count[in] The number of arrays.
+ * @return The number of elements in the union.
+ */
+static size_t darr_union_sorted_many(DArrayU32T* dest, DArrayU32T* const* arrays, size_t count);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static size_t darr_set_gallop(const uint32_t* data, size_t begin, size_t length, uint32_t target)
+{
+    size_t low = begin;
+    size_t step = 1;
+    size_t high = begin;
+
+    while ((high < length) && (data[high] < target))
+    {
+        low = high + 1;
+        high = begin + step;
+        step <<= 1;
+    }
+    if (high > length) { high = length; }
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (data[mid] < target) { low = mid + 1; }
+        else { high = mid; }
+    }
+    return low;
+}
+
+inline static BOOL darr_set_prepare(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b, size_t capacity)
+{
+    BOOL result = FALSE;
+    if ((dest == a) || (dest == b)) { LOG_ERROR("Set destination must not be an input!\n"); }
+    else if ((sizeof(uint32_t) != a->elementSize) || (sizeof(uint32_t) != b->elementSize) ||
+             (sizeof(uint32_t) != dest->elementSize))
+    {
+        LOG_ERROR("Set operations need uint32_t arrays!\n");
+    }
+    else
+    {
+        darr_reserve(dest, capacity + DARRAY_SET_SIMD_SLACK);
+        result = (dest->capacity >= capacity + DARRAY_SET_SIMD_SLACK);
+        if (FALSE == result) { LOG_ERROR("Can not grow set destination!\n"); }
+    }
+    return result;
+}
+
+/* The checks of darr_set_prepare for the k-way operations. */
+inline static BOOL darr_set_check_many(DArrayU32T* dest, DArrayU32T* const* arrays, size_t count)
+{
+    BOOL typed = (sizeof(uint32_t) == dest->elementSize) ? TRUE : FALSE;
+    BOOL aliased = FALSE;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (sizeof(uint32_t) != arrays[i]->elementSize) { typed = FALSE; }
+        if (dest == arrays[i]) { aliased = TRUE; }
+    }
+
+    if (TRUE == aliased) { LOG_ERROR("Set destination must not be an input!\n"); }
+    else if (FALSE == typed) { LOG_ERROR("Set operations need uint32_t arrays!\n"); }
+    return ((TRUE == typed) && (FALSE == aliased)) ? TRUE : FALSE;
+}
+
+inline static size_t darr_intersect_merge(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out,
+                                          size_t i, size_t j, size_t k)
+{
+    while ((i < na) && (j < nb))
+    {
+        uint32_t x = a[i];
+        uint32_t y = b[j];
+        out[k] = x;
+        k += (x == y);
+        i += (x <= y);
+        j += (y <= x);
+    }
+    return k;
+}
+
+inline static size_t darr_intersect_gallop(const uint32_t* small, size_t ns, const uint32_t* large, size_t nl,
+                                           uint32_t* out)
+{
+    size_t k = 0;
+    size_t j = 0;
+    for (size_t i = 0; (i < ns) && (j < nl); i++)
+    {
+        j = darr_set_gallop(large, j, nl, small[i]);
+        if ((j < nl) && (large[j] == small[i])) { out[k++] = small[i]; }
+    }
+    return k;
+}
+
+#ifdef CUTILS_SIMD_X86
+CPU_TARGET_AVX2 inline static size_t darr_intersect_avx2(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                                                         uint32_t* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+
+    while ((i + 8 <= na) && (j + 8 <= nb))
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i*) &a[i]);
+        __m256i vb = _mm256_loadu_si256((const __m256i*) &b[j]);
+        __m256i swapped = _mm256_permute2x128_si256(vb, vb, 1);
+
+        /* All 8x8 pairs: 4 rotations inside each 128 bit half, for both half arrangements. */
+        __m256i match = _mm256_cmpeq_epi32(va, vb);
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, swapped));
+        match = _mm256_or_si256(match,
+                                _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(swapped, _MM_SHUFFLE(0, 3, 2, 1))));
+        match = _mm256_or_si256(match,
+                                _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(swapped, _MM_SHUFFLE(1, 0, 3, 2))));
+        match = _mm256_or_si256(match,
+                                _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(swapped, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        uint32_t bits = (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(match));
+        _mm256_storeu_si256((__m256i*) &out[k],
+                            _mm256_permutevar8x32_epi32(va, darr_compress_permutation_avx2(bits)));
+        k += CPU_POPCOUNT32(bits);
+
+        uint32_t lastA = a[i + 7];
+        uint32_t lastB = b[j + 7];
+        i += (lastA <= lastB) ? 8u : 0u;
+        j += (lastB <= lastA) ? 8u : 0u;
+    }
+
+    return darr_intersect_merge(a, na, b, nb, out, i, j, k);
+}
+#endif
+
+inline static size_t darr_intersect_sorted(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b)
+{
+    size_t k = 0;
+    size_t na = a->length;
+    size_t nb = b->length;
+
+    if (TRUE == darr_set_prepare(dest, a, b, (na < nb) ? na : nb))
+    {
+        const uint32_t* da = (const uint32_t*) a->data;
+        const uint32_t* db = (const uint32_t*) b->data;
+        uint32_t* out = (uint32_t*) dest->data;
+
+        if ((0u == na) || (0u == nb)) {}
+        else if (na / DARRAY_SET_GALLOP_RATIO > nb) { k = darr_intersect_gallop(db, nb, da, na, out); }
+        else if (nb / DARRAY_SET_GALLOP_RATIO > na) { k = darr_intersect_gallop(da, na, db, nb, out); }
+#ifdef CUTILS_SIMD_X86
+        else if (cpu_has_feature(CPU_FEATURE_AVX2 | CPU_FEATURE_BMI2)) { k = darr_intersect_avx2(da, na, db, nb, out); }
+#endif
+        else { k = darr_intersect_merge(da, na, db, nb, out, 0, 0, 0); }
+        dest->length = k;
+    }
+
+    return k;
+}
+
+inline static size_t darr_union_sorted(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b)
+{
+    size_t k = 0;
+    size_t na = a->length;
+    size_t nb = b->length;
+
+    if (TRUE == darr_set_prepare(dest, a, b, na + nb))
+    {
+        const uint32_t* small = (const uint32_t*) a->data;
+        const uint32_t* large = (const uint32_t*) b->data;
+        size_t ns = na;
+        size_t nl = nb;
+        uint32_t* out = (uint32_t*) dest->data;
+        size_t i = 0;
+        size_t j = 0;
+
+        if (ns > nl)
+        {
+            small = (const uint32_t*) b->data;
+            large = (const uint32_t*) a->data;
+            ns = nb;
+            nl = na;
+        }
+
+        if (nl / DARRAY_SET_GALLOP_RATIO > ns)
+        {
+            /* Bulk copy the runs of the long input between consecutive elements of the short one. */
+            for (; i < ns; i++)
+            {
+                size_t next = darr_set_gallop(large, j, nl, small[i]);
+                CMEMCPY(&out[k], &large[j], (next - j) * sizeof(uint32_t));
+                k += next - j;
+                j = next;
+                if ((j < nl) && (large[j] == small[i])) { j++; }
+                out[k++] = small[i];
+            }
+        }
+        else
+        {
+            while ((i < ns) && (j < nl))
+            {
+                uint32_t x = small[i];
+                uint32_t y = large[j];
+                out[k++] = (x <= y) ? x : y;
+                i += (x <= y);
+                j += (y <= x);
+            }
+            for (; i < ns; i++) { out[k++] = small[i]; }
+        }
+        CMEMCPY(&out[k], &large[j], (nl - j) * sizeof(uint32_t));
+        k += nl - j;
+        dest->length = k;
+    }
+
+    return k;
+}
+
+inline static size_t darr_difference_sorted(DArrayU32T* dest, DArrayU32T* a, DArrayU32T* b)
+{
+    size_t k = 0;
+    size_t na = a->length;
+    size_t nb = b->length;
+
+    if (TRUE == darr_set_prepare(dest, a, b, na))
+    {
+        const uint32_t* da = (const uint32_t*) a->data;
+        const uint32_t* db = (const uint32_t*) b->data;
+        uint32_t* out = (uint32_t*) dest->data;
+        size_t i = 0;
+        size_t j = 0;
+
+        if (nb / DARRAY_SET_GALLOP_RATIO > na)
+        {
+            for (; i < na; i++)
+            {
+                j = darr_set_gallop(db, j, nb, da[i]);
+                if ((j == nb) || (db[j] != da[i])) { out[k++] = da[i]; }
+            }
+        }
+        else if (na / DARRAY_SET_GALLOP_RATIO > nb)
+        {
+            for (; j < nb; j++)
+            {
+                size_t next = darr_set_gallop(da, i, na, db[j]);
+                CMEMCPY(&out[k], &da[i], (next - i) * sizeof(uint32_t));
+                k += next - i;
+                i = next;
+                if ((i < na) && (da[i] == db[j])) { i++; }
+            }
+        }
+        else
+        {
+            while ((i < na) && (j < nb))
+            {
+                uint32_t x = da[i];
+                uint32_t y = db[j];
+                out[k] = x;
+                k += (x < y);
+                i += (x <= y);
+                j += (y <= x);
+            }
+        }
+        if (i < na)
+        {
+            CMEMCPY(&out[k], &da[i], (na - i) * sizeof(uint32_t));
+            k += na - i;
+        }
+        dest->length = k;
+    }
+
+    return k;
+}
+
+inline static size_t darr_intersect_sorted_many(DArrayU32T* dest, DArrayU32T* const* arrays, size_t count)
+{
+    size_t result = 0;
+
+    if (FALSE == darr_set_check_many(dest, arrays, count)) {}
+    else if (0u == count) { dest->length = 0; }
+    else
+    {
+        DArrayU32T** order = (DArrayU32T**) CMALLOC(count * sizeof(DArrayU32T*));
+        DArrayU32T* scratch[2] = {darr_create_u32(), darr_create_u32()};
+
+        if ((NULL == order) || (NULL == scratch[0]) || (NULL == scratch[1]))
+        {
+            LOG_ERROR("Can not allocate k-way intersection buffers!\n");
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t j = i;
+                while ((j > 0) && (order[j - 1]->length > arrays[i]->length))
+                {
+                    order[j] = order[j - 1];
+                    j--;
+                }
+                order[j] = arrays[i];
+            }
+
+            DArrayU32T* current = order[0];
+            for (size_t i = 1; (i < count) && (current->length > 0); i++)
+            {
+                DArrayU32T* next = scratch[i & 1u];
+                darr_intersect_sorted(next, current, order[i]);
+                current = next;
+            }
+
+            darr_reserve(dest, current->length);
+            darr_resize(dest, current->length);
+            if ((dest->length == current->length) && (dest != current))
+            {
+                CMEMCPY(dest->data, current->data, current->length * sizeof(uint32_t));
+            }
+            result = dest->length;
+        }
+
+        if (NULL != order) { CFREE(order, count * sizeof(DArrayU32T*)); }
+        if (NULL != scratch[0]) { darr_destroy(scratch[0]); }
+        if (NULL != scratch[1]) { darr_destroy(scratch[1]); }
+    }
+
+    return result;
+}
+
+inline static int32_t darr_set_compare_cursor(const void* a, const void* b)
+{
+    uint32_t va = ((const DArraySetCursorT*) a)->value;
+    uint32_t vb = ((const DArraySetCursorT*) b)->value;
+    return (va < vb) ? -1 : ((va > vb) ? 1 : 0);
+}
+
+inline static size_t darr_union_sorted_many(DArrayU32T* dest, DArrayU32T* const* arrays, size_t count)
+{
+    size_t total = 0;
+    size_t k = 0;
+    DHeapT* heap = NULL;
+    size_t* positions = NULL;
+    BOOL valid = darr_set_check_many(dest, arrays, count);
+
+    if (TRUE == valid)
+    {
+        for (size_t i = 0; i < count; i++) { total += arrays[i]->length; }
+        heap = heap_create_generic(sizeof(DArraySetCursorT), DHEAP_QUATERNARY, darr_set_compare_cursor);
+        positions = (size_t*) CCALLOC(count + 1, sizeof(size_t));
+    }
+
+    if (FALSE == valid) {}
+    else if ((NULL == heap) || (NULL == positions)) { LOG_ERROR("Can not allocate k-way union buffers!\n"); }
+    else
+    {
+        darr_reserve(dest, total);
+        if (dest->capacity >= total)
+        {
+            uint32_t* out = (uint32_t*) dest->data;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (arrays[i]->length > 0)
+                {
+                    DArraySetCursorT cursor = {((const uint32_t*) arrays[i]->data)[0], (uint32_t) i};
+                    heap_push(heap, &cursor);
+                }
+            }
+
+            while (FALSE == heap_is_empty(heap))
+            {
+                DArraySetCursorT cursor = *(DArraySetCursorT*) heap_top(heap);
+                if ((0u == k) || (out[k - 1] != cursor.value)) { out[k++] = cursor.value; }
+
+                size_t position = ++positions[cursor.list];
+                if (position < arrays[cursor.list]->length)
+                {
+                    cursor.value = ((const uint32_t*) arrays[cursor.list]->data)[position];
+                    heap_replace_top(heap, &cursor);
+                }
+                else { heap_pop(heap, NULL); }
+            }
+            dest->length = k;
+        }
+        else { LOG_ERROR("Can not grow set destination!\n"); }
+    }
+
+    if (NULL != heap) { heap_destroy(heap); }
+    if (NULL != positions) { CFREE(positions, (count + 1) * sizeof(size_t)); }
+    return k;
+}
+
+#endif// DARRAY_SET_HEADER
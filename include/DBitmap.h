@@ -0,0 +1,1043 @@
+#ifndef DBITMAP_HEADER
+#define DBITMAP_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DBitmap Header (Roaring-style compressed bitmap of uint32_t)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CCpu.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DBITMAP_WORDS
+ * @brief Number of 64 bit words of a bitset container (one bit per value of a 64K chunk).
+ */
+#define DBITMAP_WORDS 1024u
+
+/**
+ * @def DBITMAP_ARRAY_MAX
+ * @brief Largest cardinality stored as a sorted array, above it a bitset is smaller.
+ */
+#define DBITMAP_ARRAY_MAX 4096u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @enum DBitmapContainerTypeT
+ * @brief Representation of the values of one 64K chunk.
+ *
+ * - `DBITMAP_ARRAY`: sorted uint16_t values, for sparse chunks
+ * - `DBITMAP_BITSET`: DBITMAP_WORDS words, for dense chunks
+ * - `DBITMAP_RUN`: sorted (start, length - 1) uint16_t pairs, for clustered chunks
+ */
+typedef enum
+{
+    DBITMAP_ARRAY = 0,
+    DBITMAP_BITSET,
+    DBITMAP_RUN
+} DBitmapContainerTypeT;
+
+/**
+ * @struct DBitmapContainerT
+ * @brief The values of one 64K chunk.
+ *
+ * @var key The upper 16 bits shared by the values of the chunk.
+ * @var type The representation.
+ * @var cardinality The number of values.
+ * @var values Array values or run pairs, NULL for bitsets.
+ * @var words Bitset words, NULL for arrays and runs.
+ */
+typedef struct {
+    uint32_t key;
+    DBitmapContainerTypeT type;
+    uint32_t cardinality;
+    DArrayU16T* values;
+    uint64_t* words;
+} DBitmapContainerT;
+
+/**
+ * @struct DBitmapT
+ * @brief A compressed set of uint32_t.
+ *
+ * @var containers Dynamic array of DBitmapContainerT sorted by key, empty chunks have no container.
+ */
+typedef struct {
+    DArrayT* containers;
+} DBitmapT;
+
+/**
+ * @struct DBitmapIteratorT
+ * @brief Ascending iteration over a bitmap.
+ *
+ * @var bitmap The iterated bitmap, must not change during the iteration.
+ * @var container The current container.
+ * @var index Position in the array, run pair or next bitset word.
+ * @var offset Position inside the current run.
+ * @var word The bits of the current bitset word not visited yet.
+ */
+typedef struct {
+    DBitmapT* bitmap;
+    size_t container;
+    size_t index;
+    uint32_t offset;
+    uint64_t word;
+} DBitmapIteratorT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create an empty bitmap.
+ * @return A pointer to the new bitmap.
+ */
+static DBitmapT* bitmap_create(void);
+
+/**
+ * @brief Build a bitmap from a sorted array.
+ *
+ * Each chunk gets the smallest of the array, bitset and run representations.
+ *
+ * @param darr[in] Dynamic array of uint32_t sorted ascending, duplicates are ignored.
+ * @return A pointer to the new bitmap.
+ */
+static DBitmapT* bitmap_create_from_darr(DArrayU32T* darr);
+
+/**
+ * @brief Destroy a bitmap.
+ * @param bitmap[in] The bitmap.
+ */
+static void bitmap_destroy(DBitmapT* bitmap);
+
+/**
+ * @brief Add a value.
+ * @param bitmap[in] The bitmap.
+ * @param value[in] The value.
+ * @return TRUE if the value was added, FALSE if it was present.
+ */
+static BOOL bitmap_add(DBitmapT* bitmap, uint32_t value);
+
+/**
+ * @brief Remove a value.
+ * @param bitmap[in] The bitmap.
+ * @param value[in] The value.
+ * @return TRUE if the value was removed, FALSE if it was absent.
+ */
+static BOOL bitmap_remove(DBitmapT* bitmap, uint32_t value);
+
+/**
+ * @brief Check whether a value is in the bitmap.
+ * @param bitmap[in] The bitmap.
+ * @param value[in] The value.
+ * @return TRUE if the value is present, FALSE otherwise.
+ */
+static BOOL bitmap_contains(DBitmapT* bitmap, uint32_t value);
+
+/**
+ * @brief Get the number of values.
+ * @param bitmap[in] The bitmap.
+ * @return The number of values.
+ */
+static size_t bitmap_cardinality(DBitmapT* bitmap);
+
+/**
+ * @brief Check whether the bitmap is empty.
+ * @param bitmap[in] The bitmap.
+ * @return TRUE if the bitmap has no values, FALSE otherwise.
+ */
+static BOOL bitmap_is_empty(DBitmapT* bitmap);
+
+/**
+ * @brief Intersect two bitmaps.
+ * @param a[in] The first bitmap.
+ * @param b[in] The second bitmap.
+ * @return A new bitmap with the values in both a and b.
+ */
+static DBitmapT* bitmap_and(DBitmapT* a, DBitmapT* b);
+
+/**
+ * @brief Unite two bitmaps.
+ * @param a[in] The first bitmap.
+ * @param b[in] The second bitmap.
+ * @return A new bitmap with the values in a or b.
+ */
+static DBitmapT* bitmap_or(DBitmapT* a, DBitmapT* b);
+
+/**
+ * @brief Subtract a bitmap from another.
+ * @param a[in] The first bitmap.
+ * @param b[in] The second bitmap.
+ * @return A new bitmap with the values in a and not in b.
+ */
+static DBitmapT* bitmap_andnot(DBitmapT* a, DBitmapT* b);
+
+/**
+ * @brief Convert the containers to runs where runs are smaller.
+ *
+ * Results of bitmap_add, bitmap_and, bitmap_or and bitmap_andnot only use arrays
+ * and bitsets, call this once a bitmap is built to compress clustered chunks.
+ *
+ * @param bitmap[in] The bitmap.
+ */
+static void bitmap_run_optimize(DBitmapT* bitmap);
+
+/**
+ * @brief Copy the values into a new dynamic array.
+ * @param bitmap[in] The bitmap.
+ * @return A new dynamic array of uint32_t sorted ascending.
+ */
+static DArrayU32T* bitmap_to_darr(DBitmapT* bitmap);
+
+/**
+ * @brief Start an iteration.
+ * @param iterator[out] The iterator.
+ * @param bitmap[in] The bitmap.
+ */
+static void bitmap_iterator_init(DBitmapIteratorT* iterator, DBitmapT* bitmap);
+
+/**
+ * @brief Get the next value of an iteration.
+ * @param iterator[in] The iterator.
+ * @param value[out] Receives the value.
+ * @return TRUE if a value was returned, FALSE at the end of the bitmap.
+ */
+static BOOL bitmap_iterator_next(DBitmapIteratorT* iterator, uint32_t* value);
+
+/**
+ * @brief Get the memory used by the bitmap, headers included.
+ * @param bitmap[in] The bitmap.
+ * @return The number of bytes.
+ */
+static size_t bitmap_memory_bytes(DBitmapT* bitmap);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+typedef enum
+{
+    DBITMAP_OP_AND = 0,
+    DBITMAP_OP_OR,
+    DBITMAP_OP_ANDNOT
+} DBitmapOpT;
+
+inline static DBitmapContainerT* bitmap_container(DBitmapT* bitmap, size_t index)
+{
+    return (DBitmapContainerT*) darr_get_ptr(bitmap->containers, index);
+}
+
+inline static uint16_t* bitmap_container_values(DBitmapContainerT* container)
+{
+    return (uint16_t*) container->values->data;
+}
+
+inline static size_t bitmap_u16_lower_bound(const uint16_t* values, size_t count, uint32_t target)
+{
+    size_t low = 0;
+    while (count > 0)
+    {
+        size_t half = count / 2;
+        if (values[low + half] < target)
+        {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else { count = half; }
+    }
+    return low;
+}
+
+inline static void bitmap_container_free(DBitmapContainerT* container)
+{
+    if (NULL != container->values) { darr_destroy(container->values); }
+    if (NULL != container->words) { CFREE(container->words, DBITMAP_WORDS * sizeof(uint64_t)); }
+    container->values = NULL;
+    container->words = NULL;
+    container->cardinality = 0;
+}
+
+inline static uint64_t* bitmap_words_alloc(void)
+{
+    uint64_t* words = (uint64_t*) CMALLOC(DBITMAP_WORDS * sizeof(uint64_t));
+    if (NULL == words) { LOG_ERROR("Can not allocate bitmap container!\n"); }
+    return words;
+}
+
+inline static void bitmap_words_set_range(uint64_t* words, uint32_t first, uint32_t last)
+{
+    uint32_t firstWord = first / 64;
+    uint32_t lastWord = last / 64;
+    uint64_t firstMask = ~0ull << (first % 64);
+    uint64_t lastMask = ~0ull >> (63u - last % 64);
+    if (firstWord == lastWord) { words[firstWord] |= firstMask & lastMask; }
+    else
+    {
+        words[firstWord] |= firstMask;
+        for (uint32_t w = firstWord + 1; w < lastWord; w++) { words[w] = ~0ull; }
+        words[lastWord] |= lastMask;
+    }
+}
+
+inline static void bitmap_container_to_words(DBitmapContainerT* container, uint64_t* words)
+{
+    if (DBITMAP_BITSET == container->type)
+    {
+        CMEMCPY(words, container->words, DBITMAP_WORDS * sizeof(uint64_t));
+    }
+    else
+    {
+        const uint16_t* values = bitmap_container_values(container);
+        CMEMSET(words, 0, DBITMAP_WORDS * sizeof(uint64_t));
+        if (DBITMAP_ARRAY == container->type)
+        {
+            for (size_t i = 0; i < container->cardinality; i++)
+            {
+                words[values[i] / 64] |= 1ull << (values[i] % 64);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < container->values->length; i += 2)
+            {
+                bitmap_words_set_range(words, values[i], (uint32_t) values[i] + values[i + 1]);
+            }
+        }
+    }
+}
+
+/* Makes words (owned by the caller until now) the content of the container, as an array if it is sparse. */
+inline static void bitmap_container_adopt_words(DBitmapContainerT* container, uint64_t* words, uint32_t cardinality)
+{
+    bitmap_container_free(container);
+    container->cardinality = cardinality;
+    if (cardinality > DBITMAP_ARRAY_MAX)
+    {
+        container->type = DBITMAP_BITSET;
+        container->words = words;
+    }
+    else
+    {
+        container->type = DBITMAP_ARRAY;
+        container->values = darr_create_u16();
+        darr_reserve(container->values, cardinality);
+        darr_resize(container->values, cardinality);
+        uint16_t* out = bitmap_container_values(container);
+        size_t count = 0;
+        for (uint32_t w = 0; w < DBITMAP_WORDS; w++)
+        {
+            for (uint64_t bits = words[w]; 0u != bits; bits &= bits - 1u)
+            {
+                out[count++] = (uint16_t) (w * 64 + CPU_CTZ64(bits));
+            }
+        }
+        CFREE(words, DBITMAP_WORDS * sizeof(uint64_t));
+    }
+}
+
+/* Replaces the container content by count sorted distinct values in the smallest representation. */
+inline static void bitmap_container_build(DBitmapContainerT* container, const uint16_t* values, size_t count)
+{
+    size_t runs = (count > 0) ? 1u : 0u;
+    for (size_t i = 1; i < count; i++) { runs += ((uint32_t) values[i] != (uint32_t) values[i - 1] + 1u) ? 1u : 0u; }
+
+    size_t runBytes = runs * 2 * sizeof(uint16_t);
+    size_t arrayBytes = count * sizeof(uint16_t);
+    size_t bitsetBytes = DBITMAP_WORDS * sizeof(uint64_t);
+
+    bitmap_container_free(container);
+    container->cardinality = (uint32_t) count;
+    if ((runBytes < arrayBytes) && (runBytes < bitsetBytes))
+    {
+        container->type = DBITMAP_RUN;
+        container->values = darr_create_u16();
+        darr_reserve(container->values, runs * 2);
+        for (size_t i = 0; i < count;)
+        {
+            size_t end = i + 1;
+            while ((end < count) && ((uint32_t) values[end] == (uint32_t) values[end - 1] + 1u)) { end++; }
+            darr_push_u16(container->values, values[i]);
+            darr_push_u16(container->values, (uint16_t) (end - i - 1));
+            i = end;
+        }
+    }
+    else if (count <= DBITMAP_ARRAY_MAX)
+    {
+        container->type = DBITMAP_ARRAY;
+        container->values = darr_create_u16();
+        darr_reserve(container->values, count);
+        darr_resize(container->values, count);
+        if (count > 0) { CMEMCPY(container->values->data, values, count * sizeof(uint16_t)); }
+    }
+    else
+    {
+        container->type = DBITMAP_BITSET;
+        container->words = bitmap_words_alloc();
+        if (NULL != container->words)
+        {
+            CMEMSET(container->words, 0, bitsetBytes);
+            for (size_t i = 0; i < count; i++) { container->words[values[i] / 64] |= 1ull << (values[i] % 64); }
+        }
+    }
+}
+
+inline static size_t bitmap_container_to_values(DBitmapContainerT* container, uint16_t* out)
+{
+    size_t count = 0;
+    if (DBITMAP_ARRAY == container->type)
+    {
+        count = container->cardinality;
+        CMEMCPY(out, container->values->data, count * sizeof(uint16_t));
+    }
+    else if (DBITMAP_RUN == container->type)
+    {
+        const uint16_t* runs = bitmap_container_values(container);
+        for (size_t i = 0; i < container->values->length; i += 2)
+        {
+            for (uint32_t v = runs[i]; v <= (uint32_t) runs[i] + runs[i + 1]; v++) { out[count++] = (uint16_t) v; }
+        }
+    }
+    else
+    {
+        for (uint32_t w = 0; w < DBITMAP_WORDS; w++)
+        {
+            for (uint64_t bits = container->words[w]; 0u != bits; bits &= bits - 1u)
+            {
+                out[count++] = (uint16_t) (w * 64 + CPU_CTZ64(bits));
+            }
+        }
+    }
+    return count;
+}
+
+inline static BOOL bitmap_container_contains(DBitmapContainerT* container, uint32_t low)
+{
+    BOOL result = FALSE;
+    if (DBITMAP_BITSET == container->type) { result = (0u != (container->words[low / 64] & (1ull << (low % 64)))); }
+    else if (DBITMAP_ARRAY == container->type)
+    {
+        const uint16_t* values = bitmap_container_values(container);
+        size_t index = bitmap_u16_lower_bound(values, container->cardinality, low);
+        result = (index < container->cardinality) && (values[index] == low);
+    }
+    else
+    {
+        /* Binary search the last run starting at or before low. */
+        const uint16_t* runs = bitmap_container_values(container);
+        size_t low_ = 0;
+        size_t high = container->values->length / 2;
+        while (low_ < high)
+        {
+            size_t mid = low_ + (high - low_) / 2;
+            if (runs[mid * 2] <= low) { low_ = mid + 1; }
+            else { high = mid; }
+        }
+        result = (low_ > 0) && (low <= (uint32_t) runs[(low_ - 1) * 2] + runs[(low_ - 1) * 2 + 1]);
+    }
+    return result;
+}
+
+/* Turns a run container into an array or bitset so it can be updated in place. */
+inline static void bitmap_container_unrun(DBitmapContainerT* container)
+{
+    if (DBITMAP_RUN == container->type)
+    {
+        uint64_t* words = bitmap_words_alloc();
+        if (NULL != words)
+        {
+            bitmap_container_to_words(container, words);
+            bitmap_container_adopt_words(container, words, container->cardinality);
+        }
+    }
+}
+
+inline static void bitmap_container_clone(DBitmapContainerT* dest, DBitmapContainerT* src)
+{
+    *dest = *src;
+    dest->values = NULL;
+    dest->words = NULL;
+    if (NULL != src->values)
+    {
+        dest->values = darr_create_u16();
+        darr_reserve(dest->values, src->values->length);
+        darr_resize(dest->values, src->values->length);
+        CMEMCPY(dest->values->data, src->values->data, src->values->length * sizeof(uint16_t));
+    }
+    if (NULL != src->words)
+    {
+        dest->words = bitmap_words_alloc();
+        if (NULL != dest->words) { CMEMCPY(dest->words, src->words, DBITMAP_WORDS * sizeof(uint64_t)); }
+    }
+}
+
+inline static uint32_t bitmap_words_op_scalar(uint64_t* dest, const uint64_t* a, const uint64_t* b, DBitmapOpT op,
+                                              size_t begin)
+{
+    uint32_t cardinality = 0;
+    for (size_t i = begin; i < DBITMAP_WORDS; i++)
+    {
+        uint64_t word = (DBITMAP_OP_AND == op) ? (a[i] & b[i])
+                                               : ((DBITMAP_OP_OR == op) ? (a[i] | b[i]) : (a[i] & ~b[i]));
+        dest[i] = word;
+        cardinality += CPU_POPCOUNT64(word);
+    }
+    return cardinality;
+}
+
+#ifdef CUTILS_SIMD_X86
+CPU_TARGET_AVX512 inline static uint32_t bitmap_words_op_avx512(uint64_t* dest, const uint64_t* a, const uint64_t* b,
+                                                                DBitmapOpT op)
+{
+    uint32_t cardinality = 0;
+    for (size_t i = 0; i < DBITMAP_WORDS; i += 8)
+    {
+        __m512i x = _mm512_loadu_si512((const void*) &a[i]);
+        __m512i y = _mm512_loadu_si512((const void*) &b[i]);
+        __m512i word = (DBITMAP_OP_AND == op)  ? _mm512_and_si512(x, y)
+                       : (DBITMAP_OP_OR == op) ? _mm512_or_si512(x, y)
+                                               : _mm512_andnot_si512(y, x);
+        _mm512_storeu_si512((void*) &dest[i], word);
+        for (size_t j = 0; j < 8; j++) { cardinality += CPU_POPCOUNT64(dest[i + j]); }
+    }
+    return cardinality;
+}
+
+CPU_TARGET_AVX2 inline static uint32_t bitmap_words_op_avx2(uint64_t* dest, const uint64_t* a, const uint64_t* b,
+                                                            DBitmapOpT op)
+{
+    uint32_t cardinality = 0;
+    for (size_t i = 0; i < DBITMAP_WORDS; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*) &a[i]);
+        __m256i y = _mm256_loadu_si256((const __m256i*) &b[i]);
+        __m256i word = (DBITMAP_OP_AND == op)  ? _mm256_and_si256(x, y)
+                       : (DBITMAP_OP_OR == op) ? _mm256_or_si256(x, y)
+                                               : _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i*) &dest[i], word);
+        for (size_t j = 0; j < 4; j++) { cardinality += CPU_POPCOUNT64(dest[i + j]); }
+    }
+    return cardinality;
+}
+#endif
+
+inline static uint32_t bitmap_words_op(uint64_t* dest, const uint64_t* a, const uint64_t* b, DBitmapOpT op)
+{
+    uint32_t cardinality = 0;
+    BOOL done = FALSE;
+#ifdef CUTILS_SIMD_X86
+    if (cpu_has_feature(CPU_FEATURE_AVX512))
+    {
+        cardinality = bitmap_words_op_avx512(dest, a, b, op);
+        done = TRUE;
+    }
+    else if (cpu_has_feature(CPU_FEATURE_AVX2))
+    {
+        cardinality = bitmap_words_op_avx2(dest, a, b, op);
+        done = TRUE;
+    }
+#endif
+    if (FALSE == done) { cardinality = bitmap_words_op_scalar(dest, a, b, op, 0); }
+    return cardinality;
+}
+
+inline static void bitmap_array_merge(DBitmapContainerT* dest, DBitmapContainerT* a, DBitmapContainerT* b)
+{
+    const uint16_t* x = bitmap_container_values(a);
+    const uint16_t* y = bitmap_container_values(b);
+    size_t i = 0;
+    size_t j = 0;
+    size_t count = 0;
+
+    dest->type = DBITMAP_ARRAY;
+    dest->values = darr_create_u16();
+    darr_reserve(dest->values, a->cardinality + b->cardinality);
+    darr_resize(dest->values, a->cardinality + b->cardinality);
+    uint16_t* out = bitmap_container_values(dest);
+
+    while ((i < a->cardinality) && (j < b->cardinality))
+    {
+        uint16_t next = (x[i] <= y[j]) ? x[i] : y[j];
+        i += (x[i] == next) ? 1u : 0u;
+        j += (y[j] == next) ? 1u : 0u;
+        out[count++] = next;
+    }
+    while (i < a->cardinality) { out[count++] = x[i++]; }
+    while (j < b->cardinality) { out[count++] = y[j++]; }
+
+    dest->values->length = count;
+    dest->cardinality = (uint32_t) count;
+    if (count > DBITMAP_ARRAY_MAX)
+    {
+        uint64_t* words = bitmap_words_alloc();
+        if (NULL != words)
+        {
+            bitmap_container_to_words(dest, words);
+            bitmap_container_adopt_words(dest, words, (uint32_t) count);
+        }
+    }
+}
+
+/* Keeps the array values of a that are (keep == TRUE) or are not (keep == FALSE) in b. */
+inline static void bitmap_array_filter(DBitmapContainerT* dest, DBitmapContainerT* a, DBitmapContainerT* b,
+                                       BOOL keep)
+{
+    const uint16_t* x = bitmap_container_values(a);
+    size_t count = 0;
+
+    dest->type = DBITMAP_ARRAY;
+    dest->values = darr_create_u16();
+    darr_reserve(dest->values, a->cardinality);
+    darr_resize(dest->values, a->cardinality);
+    uint16_t* out = bitmap_container_values(dest);
+
+    for (size_t i = 0; i < a->cardinality; i++)
+    {
+        out[count] = x[i];
+        count += (keep == bitmap_container_contains(b, x[i])) ? 1u : 0u;
+    }
+
+    dest->values->length = count;
+    dest->cardinality = (uint32_t) count;
+}
+
+inline static void bitmap_container_op(DBitmapContainerT* dest, DBitmapContainerT* a, DBitmapContainerT* b,
+                                       DBitmapOpT op)
+{
+    dest->key = a->key;
+    dest->values = NULL;
+    dest->words = NULL;
+    dest->cardinality = 0;
+
+    if ((DBITMAP_ARRAY == a->type) && (DBITMAP_ARRAY == b->type) && (DBITMAP_OP_OR == op))
+    {
+        bitmap_array_merge(dest, a, b);
+    }
+    else if ((DBITMAP_ARRAY == a->type) && (DBITMAP_OP_OR != op))
+    {
+        bitmap_array_filter(dest, a, b, (DBITMAP_OP_AND == op) ? TRUE : FALSE);
+    }
+    else if ((DBITMAP_ARRAY == b->type) && (DBITMAP_OP_AND == op)) { bitmap_array_filter(dest, b, a, TRUE); }
+    else
+    {
+        /* The result is computed in place of the first operand's words, only the second may need scratch. */
+        uint64_t* words = bitmap_words_alloc();
+        uint64_t* scratch = NULL;
+        if (NULL != words)
+        {
+            const uint64_t* x = a->words;
+            const uint64_t* y = b->words;
+            if (DBITMAP_BITSET != a->type)
+            {
+                bitmap_container_to_words(a, words);
+                x = words;
+            }
+            if ((DBITMAP_BITSET != b->type) && (NULL != (scratch = bitmap_words_alloc())))
+            {
+                bitmap_container_to_words(b, scratch);
+                y = scratch;
+            }
+            if (NULL != y) { bitmap_container_adopt_words(dest, words, bitmap_words_op(words, x, y, op)); }
+            else { CFREE(words, DBITMAP_WORDS * sizeof(uint64_t)); }
+        }
+        if (NULL != scratch) { CFREE(scratch, DBITMAP_WORDS * sizeof(uint64_t)); }
+    }
+}
+
+inline static void bitmap_push_container(DBitmapT* bitmap, DBitmapContainerT* container)
+{
+    if (container->cardinality > 0) { darr_push_generic(bitmap->containers, container); }
+    else { bitmap_container_free(container); }
+}
+
+inline static DBitmapT* bitmap_binary_op(DBitmapT* a, DBitmapT* b, DBitmapOpT op)
+{
+    DBitmapT* result = bitmap_create();
+    size_t i = 0;
+    size_t j = 0;
+    size_t countA = a->containers->length;
+    size_t countB = b->containers->length;
+
+    while ((NULL != result) && ((i < countA) || (j < countB)))
+    {
+        DBitmapContainerT* x = (i < countA) ? bitmap_container(a, i) : NULL;
+        DBitmapContainerT* y = (j < countB) ? bitmap_container(b, j) : NULL;
+        DBitmapContainerT out;
+
+        if ((NULL != x) && (NULL != y) && (x->key == y->key))
+        {
+            bitmap_container_op(&out, x, y, op);
+            bitmap_push_container(result, &out);
+            i++;
+            j++;
+        }
+        else if ((NULL != x) && ((NULL == y) || (x->key < y->key)))
+        {
+            if (DBITMAP_OP_AND != op)
+            {
+                bitmap_container_clone(&out, x);
+                bitmap_push_container(result, &out);
+            }
+            i++;
+        }
+        else
+        {
+            if (DBITMAP_OP_OR == op)
+            {
+                bitmap_container_clone(&out, y);
+                bitmap_push_container(result, &out);
+            }
+            j++;
+        }
+    }
+
+    return result;
+}
+
+inline static BOOL bitmap_find_container(DBitmapT* bitmap, uint32_t key, size_t* index)
+{
+    size_t low = 0;
+    size_t high = bitmap->containers->length;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (bitmap_container(bitmap, mid)->key < key) { low = mid + 1; }
+        else { high = mid; }
+    }
+    *index = low;
+    return (low < bitmap->containers->length) && (bitmap_container(bitmap, low)->key == key);
+}
+
+inline static DBitmapT* bitmap_create(void)
+{
+    DBitmapT* result = (DBitmapT*) CMALLOC(sizeof(DBitmapT));
+    if (NULL == result) { LOG_ERROR("Can not allocate bitmap!\n"); }
+    else
+    {
+        result->containers = darr_create_generic(sizeof(DBitmapContainerT));
+        if (NULL == result->containers)
+        {
+            CFREE(result, sizeof(DBitmapT));
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+inline static DBitmapT* bitmap_create_from_darr(DArrayU32T* darr)
+{
+    DBitmapT* result = NULL;
+    uint16_t* chunk = NULL;
+    if (sizeof(uint32_t) != darr->elementSize) { LOG_ERROR("Bitmaps are built from uint32_t arrays!\n"); }
+    else if (NULL == (chunk = (uint16_t*) CMALLOC(65536u * sizeof(uint16_t)))) { LOG_ERROR("Can not allocate!\n"); }
+    else { result = bitmap_create(); }
+
+    if (NULL != result)
+    {
+        const uint32_t* values = (const uint32_t*) darr->data;
+        size_t i = 0;
+        while (i < darr->length)
+        {
+            DBitmapContainerT container = {values[i] >> 16, DBITMAP_ARRAY, 0, NULL, NULL};
+            size_t count = 0;
+            for (; (i < darr->length) && ((values[i] >> 16) == container.key); i++)
+            {
+                uint16_t low = (uint16_t) values[i];
+                if ((0u == count) || (chunk[count - 1] != low)) { chunk[count++] = low; }
+            }
+            bitmap_container_build(&container, chunk, count);
+            darr_push_generic(result->containers, &container);
+        }
+    }
+
+    if (NULL != chunk) { CFREE(chunk, 65536u * sizeof(uint16_t)); }
+    return result;
+}
+
+inline static void bitmap_destroy(DBitmapT* bitmap)
+{
+    if (NULL != bitmap)
+    {
+        for (size_t i = 0; i < bitmap->containers->length; i++) { bitmap_container_free(bitmap_container(bitmap, i)); }
+        darr_destroy(bitmap->containers);
+        CFREE(bitmap, sizeof(DBitmapT));
+    }
+}
+
+inline static BOOL bitmap_add(DBitmapT* bitmap, uint32_t value)
+{
+    BOOL result = FALSE;
+    size_t index = 0;
+    uint32_t low = value & 0xFFFFu;
+
+    if (FALSE == bitmap_find_container(bitmap, value >> 16, &index))
+    {
+        DBitmapContainerT container = {value >> 16, DBITMAP_ARRAY, 0, darr_create_u16(), NULL};
+        darr_resize(bitmap->containers, bitmap->containers->length + 1);
+        DBitmapContainerT* slot = bitmap_container(bitmap, index);
+        CMEMMOVE(slot + 1, slot, (bitmap->containers->length - index - 1) * sizeof(DBitmapContainerT));
+        *slot = container;
+    }
+
+    DBitmapContainerT* container = bitmap_container(bitmap, index);
+    bitmap_container_unrun(container);
+
+    if (DBITMAP_BITSET == container->type)
+    {
+        uint64_t bit = 1ull << (low % 64);
+        result = (0u == (container->words[low / 64] & bit));
+        container->words[low / 64] |= bit;
+        container->cardinality += (TRUE == result) ? 1u : 0u;
+    }
+    else
+    {
+        size_t position = bitmap_u16_lower_bound(bitmap_container_values(container), container->cardinality, low);
+        result = (position == container->cardinality) || (bitmap_container_values(container)[position] != low);
+        if ((TRUE == result) && (container->cardinality < DBITMAP_ARRAY_MAX))
+        {
+            darr_resize(container->values, container->cardinality + 1);
+            uint16_t* values = bitmap_container_values(container);
+            CMEMMOVE(&values[position + 1], &values[position], (container->cardinality - position) * sizeof(uint16_t));
+            values[position] = (uint16_t) low;
+            container->cardinality++;
+        }
+        else if (TRUE == result)
+        {
+            uint64_t* words = bitmap_words_alloc();
+            if (NULL != words)
+            {
+                bitmap_container_to_words(container, words);
+                words[low / 64] |= 1ull << (low % 64);
+                bitmap_container_adopt_words(container, words, container->cardinality + 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+inline static BOOL bitmap_remove(DBitmapT* bitmap, uint32_t value)
+{
+    BOOL result = FALSE;
+    size_t index = 0;
+    uint32_t low = value & 0xFFFFu;
+
+    if (TRUE == bitmap_find_container(bitmap, value >> 16, &index))
+    {
+        DBitmapContainerT* container = bitmap_container(bitmap, index);
+        result = bitmap_container_contains(container, low);
+        if (TRUE == result)
+        {
+            bitmap_container_unrun(container);
+            if (DBITMAP_BITSET == container->type)
+            {
+                container->words[low / 64] &= ~(1ull << (low % 64));
+                container->cardinality--;
+                if (container->cardinality <= DBITMAP_ARRAY_MAX)
+                {
+                    uint64_t* words = container->words;
+                    container->words = NULL;
+                    bitmap_container_adopt_words(container, words, container->cardinality);
+                }
+            }
+            else
+            {
+                uint16_t* values = bitmap_container_values(container);
+                size_t position = bitmap_u16_lower_bound(values, container->cardinality, low);
+                CMEMMOVE(&values[position], &values[position + 1],
+                         (container->cardinality - position - 1) * sizeof(uint16_t));
+                container->cardinality--;
+                container->values->length--;
+            }
+
+            if (0u == container->cardinality)
+            {
+                bitmap_container_free(container);
+                CMEMMOVE(container, container + 1,
+                         (bitmap->containers->length - index - 1) * sizeof(DBitmapContainerT));
+                bitmap->containers->length--;
+            }
+        }
+    }
+
+    return result;
+}
+
+inline static BOOL bitmap_contains(DBitmapT* bitmap, uint32_t value)
+{
+    BOOL result = FALSE;
+    size_t index = 0;
+    if (TRUE == bitmap_find_container(bitmap, value >> 16, &index))
+    {
+        result = bitmap_container_contains(bitmap_container(bitmap, index), value & 0xFFFFu);
+    }
+    return result;
+}
+
+inline static size_t bitmap_cardinality(DBitmapT* bitmap)
+{
+    size_t result = 0;
+    for (size_t i = 0; i < bitmap->containers->length; i++) { result += bitmap_container(bitmap, i)->cardinality; }
+    return result;
+}
+
+inline static BOOL bitmap_is_empty(DBitmapT* bitmap) { return 0u == bitmap->containers->length; }
+
+inline static DBitmapT* bitmap_and(DBitmapT* a, DBitmapT* b) { return bitmap_binary_op(a, b, DBITMAP_OP_AND); }
+
+inline static DBitmapT* bitmap_or(DBitmapT* a, DBitmapT* b) { return bitmap_binary_op(a, b, DBITMAP_OP_OR); }
+
+inline static DBitmapT* bitmap_andnot(DBitmapT* a, DBitmapT* b) { return bitmap_binary_op(a, b, DBITMAP_OP_ANDNOT); }
+
+inline static void bitmap_run_optimize(DBitmapT* bitmap)
+{
+    uint16_t* chunk = (uint16_t*) CMALLOC(65536u * sizeof(uint16_t));
+    if (NULL == chunk) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        for (size_t i = 0; i < bitmap->containers->length; i++)
+        {
+            DBitmapContainerT* container = bitmap_container(bitmap, i);
+            size_t count = bitmap_container_to_values(container, chunk);
+            bitmap_container_build(container, chunk, count);
+        }
+        CFREE(chunk, 65536u * sizeof(uint16_t));
+    }
+}
+
+inline static DArrayU32T* bitmap_to_darr(DBitmapT* bitmap)
+{
+    DArrayU32T* result = darr_create_u32();
+    if (NULL != result)
+    {
+        size_t cardinality = bitmap_cardinality(bitmap);
+        darr_reserve(result, cardinality);
+        darr_resize(result, cardinality);
+
+        uint32_t* out = (uint32_t*) result->data;
+        DBitmapIteratorT iterator;
+        size_t count = 0;
+        bitmap_iterator_init(&iterator, bitmap);
+        while ((count < cardinality) && (TRUE == bitmap_iterator_next(&iterator, &out[count]))) { count++; }
+    }
+    return result;
+}
+
+inline static void bitmap_iterator_init(DBitmapIteratorT* iterator, DBitmapT* bitmap)
+{
+    iterator->bitmap = bitmap;
+    iterator->container = 0;
+    iterator->index = 0;
+    iterator->offset = 0;
+    iterator->word = 0;
+}
+
+inline static BOOL bitmap_iterator_next(DBitmapIteratorT* iterator, uint32_t* value)
+{
+    BOOL result = FALSE;
+    while ((FALSE == result) && (iterator->container < iterator->bitmap->containers->length))
+    {
+        DBitmapContainerT* container = bitmap_container(iterator->bitmap, iterator->container);
+        uint32_t high = container->key << 16;
+
+        if (DBITMAP_ARRAY == container->type)
+        {
+            if (iterator->index < container->cardinality)
+            {
+                *value = high | bitmap_container_values(container)[iterator->index++];
+                result = TRUE;
+            }
+        }
+        else if (DBITMAP_RUN == container->type)
+        {
+            if (iterator->index < container->values->length)
+            {
+                const uint16_t* runs = bitmap_container_values(container);
+                *value = high | (runs[iterator->index] + iterator->offset);
+                if (iterator->offset == runs[iterator->index + 1])
+                {
+                    iterator->index += 2;
+                    iterator->offset = 0;
+                }
+                else { iterator->offset++; }
+                result = TRUE;
+            }
+        }
+        else
+        {
+            while ((0u == iterator->word) && (iterator->index < DBITMAP_WORDS))
+            {
+                iterator->word = container->words[iterator->index++];
+            }
+            if (0u != iterator->word)
+            {
+                *value = high | (uint32_t) ((iterator->index - 1) * 64 + CPU_CTZ64(iterator->word));
+                iterator->word &= iterator->word - 1u;
+                result = TRUE;
+            }
+        }
+
+        if (FALSE == result)
+        {
+            iterator->container++;
+            iterator->index = 0;
+            iterator->offset = 0;
+            iterator->word = 0;
+        }
+    }
+    return result;
+}
+
+inline static size_t bitmap_memory_bytes(DBitmapT* bitmap)
+{
+    size_t result = sizeof(DBitmapT) + bitmap->containers->capacity * sizeof(DBitmapContainerT);
+    for (size_t i = 0; i < bitmap->containers->length; i++)
+    {
+        DBitmapContainerT* container = bitmap_container(bitmap, i);
+        if (NULL != container->values) { result += sizeof(DArrayT) + container->values->capacity * sizeof(uint16_t); }
+        if (NULL != container->words) { result += DBITMAP_WORDS * sizeof(uint64_t); }
+    }
+    return result;
+}
+
+#endif// DBITMAP_HEADER
@@ -0,0 +1,319 @@
+#ifndef DCONCURRENT_ARRAY_HEADER
+#define DCONCURRENT_ARRAY_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DConcurrentArray Header (dynamic array many threads can append to at once)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CCpu.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DCONCURRENT_ARRAY_SEGMENTS
+ * @brief The number of segments. Segment k holds firstSegment << k elements, so they never run out.
+ */
+#define DCONCURRENT_ARRAY_SEGMENTS 48u
+
+/**
+ * @def DCONCURRENT_ARRAY_MIN_SEGMENT
+ * @brief The smallest size of the first segment, in elements.
+ */
+#define DCONCURRENT_ARRAY_MIN_SEGMENT 64u
+
+/**
+ * @def DCONCURRENT_ARRAY_INVALID
+ * @brief The index returned when a segment could not be allocated.
+ */
+#define DCONCURRENT_ARRAY_INVALID ((size_t) -1)
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DConcurrentArrayT
+ * @brief An append-only array that many threads can append to without a lock.
+ *
+ * Appenders reserve index ranges with a fetch_add on reserved. Elements live in
+ * segments of doubling size that are allocated on first use and never move, so
+ * growing never invalidates a range another thread is still writing. After all
+ * appenders finished, carr_finalize turns the segments into a normal DArrayT.
+ *
+ * @var reserved The number of reserved elements, the length once all appenders finished.
+ * @var elementSize The size of each element.
+ * @var firstSegment The number of elements in segment 0, a power of two.
+ * @var segments The segments, NULL until first used.
+ */
+typedef struct {
+    int8_t padding0[CATOMIC_CACHE_LINE];
+    size_t reserved;
+    int8_t padding1[CATOMIC_CACHE_LINE];
+    size_t elementSize;
+    size_t firstSegment;
+    int8_t* segments[DCONCURRENT_ARRAY_SEGMENTS];
+} DConcurrentArrayT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a concurrent array.
+ * @param elementSize[in] The size of each element.
+ * @param expectedLength[in] The expected final length. Up to it appends land in one pre-grown segment that
+ * carr_finalize hands over without copying.
+ * @return A pointer to the new concurrent array.
+ */
+static DConcurrentArrayT* carr_create(size_t elementSize, size_t expectedLength);
+
+/**
+ * @brief Destroy a concurrent array and its elements.
+ * @param carr[in] The concurrent array.
+ */
+static void carr_destroy(DConcurrentArrayT* carr);
+
+/**
+ * @brief Reserve count consecutive elements for the calling thread. Thread safe.
+ *
+ * The segments backing the range exist when this returns; fill them through
+ * carr_get_ptr. A range can span two or more segments. If a segment can not be
+ * allocated the range is still used up but must not be written, and
+ * carr_finalize fills it with zeros.
+ *
+ * @param carr[in] The concurrent array.
+ * @param count[in] The number of elements.
+ * @return The index of the first reserved element, DCONCURRENT_ARRAY_INVALID on allocation failure.
+ */
+static size_t carr_reserve(DConcurrentArrayT* carr, size_t count);
+
+/**
+ * @brief Append count elements as one contiguous range. Thread safe.
+ * @param carr[in] The concurrent array.
+ * @param values[in] The elements.
+ * @param count[in] The number of elements.
+ * @return The index of the first appended element, DCONCURRENT_ARRAY_INVALID on allocation failure.
+ */
+static size_t carr_append(DConcurrentArrayT* carr, const void* values, size_t count);
+
+/**
+ * @brief Append one element. Thread safe.
+ * @param carr[in] The concurrent array.
+ * @param value[in] Pointer to the element.
+ * @return The index of the element, DCONCURRENT_ARRAY_INVALID on allocation failure.
+ */
+static size_t carr_push(DConcurrentArrayT* carr, const void* value);
+
+/**
+ * @brief Get a pointer to a reserved element.
+ * @param carr[in] The concurrent array.
+ * @param index[in] The index, below carr_length.
+ * @return A pointer to the element.
+ */
+static void* carr_get_ptr(DConcurrentArrayT* carr, size_t index);
+
+/**
+ * @brief Get the number of reserved elements.
+ * @param carr[in] The concurrent array.
+ * @return The number of elements.
+ */
+static size_t carr_length(DConcurrentArrayT* carr);
+
+/**
+ * @brief Turn the concurrent array into a DArrayT and destroy it. Every appender must have finished.
+ * @param carr[in] The concurrent array.
+ * @return The dynamic array with the elements in index order, NULL on allocation failure.
+ */
+static DArrayT* carr_finalize(DConcurrentArrayT* carr);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DConcurrentArrayT* carr_create(size_t elementSize, size_t expectedLength)
+{
+    DConcurrentArrayT* result = NULL;
+    if (0u == elementSize) { LOG_ERROR("Element size can not be 0!\n"); }
+    else if (NULL == (result = (DConcurrentArrayT*) CCALLOC(1, sizeof(DConcurrentArrayT))))
+    {
+        LOG_ERROR("Can not allocate!\n");
+    }
+    else
+    {
+        result->elementSize = elementSize;
+        result->firstSegment = DCONCURRENT_ARRAY_MIN_SEGMENT;
+        while (result->firstSegment < expectedLength) { result->firstSegment *= 2; }
+    }
+    return result;
+}
+
+inline static size_t carr_segment_length(DConcurrentArrayT* carr, uint32_t segment)
+{
+    return carr->firstSegment << segment;
+}
+
+/* Segment k starts at firstSegment * (2^k - 1), so k is the floor of log2(index / firstSegment + 1). */
+inline static uint32_t carr_segment_of(DConcurrentArrayT* carr, size_t index, size_t* offset)
+{
+    uint64_t scaled = (uint64_t) (index / carr->firstSegment) + 1u;
+    uint32_t segment = 63u - CPU_CLZ64(scaled);
+    *offset = index - carr->firstSegment * (((size_t) 1u << segment) - 1u);
+    return segment;
+}
+
+/* Allocates a segment unless another thread was faster, in which case its segment is kept. */
+inline static int8_t* carr_segment(DConcurrentArrayT* carr, uint32_t segment)
+{
+    int8_t* result = CATOMIC_LOAD_ACQUIRE(&carr->segments[segment]);
+    if (NULL == result)
+    {
+        size_t bytes = carr_segment_length(carr, segment) * carr->elementSize;
+        int8_t* fresh = (int8_t*) CMALLOC(bytes);
+        if (NULL == fresh) { LOG_ERROR("Can not allocate concurrent array segment!\n"); }
+        else if (CATOMIC_CAS(&carr->segments[segment], &result, fresh)) { result = fresh; }
+        else { CFREE(fresh, bytes); }
+    }
+    return result;
+}
+
+inline static void carr_destroy(DConcurrentArrayT* carr)
+{
+    if (NULL != carr)
+    {
+        for (uint32_t i = 0; i < DCONCURRENT_ARRAY_SEGMENTS; i++)
+        {
+            if (NULL != carr->segments[i])
+            {
+                CFREE(carr->segments[i], carr_segment_length(carr, i) * carr->elementSize);
+            }
+        }
+        CFREE(carr, sizeof(DConcurrentArrayT));
+    }
+}
+
+inline static size_t carr_reserve(DConcurrentArrayT* carr, size_t count)
+{
+    size_t first = CATOMIC_FETCH_ADD(&carr->reserved, count);
+    if (count > 0)
+    {
+        size_t offset = 0;
+        uint32_t from = carr_segment_of(carr, first, &offset);
+        uint32_t to = carr_segment_of(carr, first + count - 1u, &offset);
+        for (uint32_t segment = from; segment <= to; segment++)
+        {
+            if (NULL == carr_segment(carr, segment)) { first = DCONCURRENT_ARRAY_INVALID; }
+        }
+    }
+    return first;
+}
+
+inline static size_t carr_append(DConcurrentArrayT* carr, const void* values, size_t count)
+{
+    size_t first = carr_reserve(carr, count);
+    const int8_t* input = (const int8_t*) values;
+    size_t copied = 0;
+    while ((DCONCURRENT_ARRAY_INVALID != first) && (copied < count))
+    {
+        size_t offset = 0;
+        uint32_t segment = carr_segment_of(carr, first + copied, &offset);
+        size_t room = carr_segment_length(carr, segment) - offset;
+        size_t chunk = (count - copied < room) ? count - copied : room;
+        CMEMCPY(&carr_segment(carr, segment)[offset * carr->elementSize], &input[copied * carr->elementSize],
+                chunk * carr->elementSize);
+        copied += chunk;
+    }
+    return first;
+}
+
+inline static size_t carr_push(DConcurrentArrayT* carr, const void* value) { return carr_append(carr, value, 1); }
+
+inline static void* carr_get_ptr(DConcurrentArrayT* carr, size_t index)
+{
+    size_t offset = 0;
+    uint32_t segment = carr_segment_of(carr, index, &offset);
+    return &CATOMIC_LOAD_ACQUIRE(&carr->segments[segment])[offset * carr->elementSize];
+}
+
+inline static size_t carr_length(DConcurrentArrayT* carr) { return CATOMIC_LOAD_ACQUIRE(&carr->reserved); }
+
+inline static DArrayT* carr_finalize(DConcurrentArrayT* carr)
+{
+    DArrayT* result = darr_create_generic(carr->elementSize);
+    size_t length = carr_length(carr);
+    if (NULL == result) {}
+    else if ((length <= carr->firstSegment) && (NULL != carr->segments[0]))
+    {
+        /* Everything landed in the pre-grown segment, hand it over. */
+        CFREE(result->data, result->elementSize);
+        result->data = carr->segments[0];
+        result->capacity = carr->firstSegment;
+        result->length = length;
+        carr->segments[0] = NULL;
+    }
+
+    else
+    {
+        darr_reserve(result, length);
+        size_t copied = 0;
+        for (uint32_t segment = 0; (result->capacity >= length) && (copied < length); segment++)
+        {
+            size_t chunk = carr_segment_length(carr, segment);
+            chunk = (length - copied < chunk) ? length - copied : chunk;
+            int8_t* output = &result->data[copied * carr->elementSize];
+            /* A segment that failed to allocate was never written. */
+            if (NULL == carr->segments[segment]) { CMEMSET(output, 0, chunk * carr->elementSize); }
+            else { CMEMCPY(output, carr->segments[segment], chunk * carr->elementSize); }
+            copied += chunk;
+        }
+        if (result->capacity >= length) { result->length = length; }
+        else
+        {
+            darr_destroy(result);
+            result = NULL;
+        }
+    }
+    carr_destroy(carr);
+    return result;
+}
+
+#endif// DCONCURRENT_ARRAY_HEADER
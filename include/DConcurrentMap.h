@@ -0,0 +1,554 @@
+#ifndef DCONCURRENT_MAP_HEADER
+#define DCONCURRENT_MAP_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DConcurrentMap Header (sharded concurrent hash map for multi-threaded aggregation)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "CStringView.h"
+#include "CSync.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DCONCURRENT_MAP_DEFAULT_SHARDS
+ * @brief The number of shards when cmap_create gets 0.
+ */
+#define DCONCURRENT_MAP_DEFAULT_SHARDS 64u
+
+/**
+ * @def DCONCURRENT_MAP_INITIAL_SLOTS
+ * @brief The number of slots a shard starts with.
+ */
+#define DCONCURRENT_MAP_INITIAL_SLOTS 16u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @enum DConcurrentMapKeyT
+ * @brief The kind of keys a map holds.
+ */
+typedef enum {
+    DCONCURRENT_MAP_INTEGER = 0,
+    DCONCURRENT_MAP_STRING = 1,
+} DConcurrentMapKeyT;
+
+/**
+ * @struct DConcurrentMapSlotT
+ * @brief A slot of the open addressing table. Empty while hash is 0.
+ * @var hash The hash of the key, never 0 for a used slot. Published last.
+ * @var integer The key of an integer map.
+ * @var keyData A private copy of the key of a string map.
+ * @var keyLength The length of keyData.
+ * @var value The value.
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t integer;
+    int8_t* keyData;
+    size_t keyLength;
+    uint64_t value;
+} DConcurrentMapSlotT;
+
+/**
+ * @struct DConcurrentMapTableT
+ * @brief The slots of a shard. Replaced tables stay allocated until the map is destroyed, so lock-free readers
+ * holding them never touch freed memory.
+ */
+typedef struct DConcurrentMapTable {
+    size_t capacity;
+    size_t length;
+    DConcurrentMapSlotT* slots;
+    struct DConcurrentMapTable* previous;
+} DConcurrentMapTableT;
+
+/**
+ * @struct DConcurrentMapShardT
+ * @brief A part of the map with its own lock, on its own cache line.
+ * @var table The current table.
+ * @var lock Serializes updates of the shard, its counters tell how contended the shard is.
+ */
+typedef struct {
+    DConcurrentMapTableT* table;
+    CMutexT lock;
+    int8_t padding[CATOMIC_CACHE_LINE - sizeof(DConcurrentMapTableT*) - sizeof(CMutexT)];
+} DConcurrentMapShardT;
+
+/**
+ * @struct DConcurrentMapT
+ * @brief A hash map from integers or strings to uint64_t that many threads can update at once.
+ *
+ * Keys are spread over shards by the top bits of their hash. Updates take the
+ * shard lock; lookups take no lock at all and read the table of the shard as
+ * published by the last update.
+ */
+typedef struct {
+    DConcurrentMapKeyT keyType;
+    uint32_t shardCount;
+    uint32_t shardShift;
+    DConcurrentMapShardT* shards;
+} DConcurrentMapT;
+
+/**
+ * @struct DConcurrentMapEntryT
+ * @brief An entry as passed to cmap_for_each.
+ */
+typedef struct {
+    uint64_t integer;
+    CStringViewT key;
+    uint64_t value;
+} DConcurrentMapEntryT;
+
+/**
+ * @typedef DConcurrentMapVisitT
+ * @brief Called by cmap_for_each for every entry.
+ */
+typedef void (*DConcurrentMapVisitT)(const DConcurrentMapEntryT* entry, void* argument);
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a concurrent map.
+ * @param keyType[in] Whether the map is keyed by integers or by strings.
+ * @param shardCount[in] The number of shards, rounded up to a power of two, 0 for the default.
+ * @return A pointer to the new map.
+ */
+static DConcurrentMapT* cmap_create(DConcurrentMapKeyT keyType, uint32_t shardCount);
+
+/**
+ * @brief Destroy a concurrent map. No thread may use it anymore.
+ * @param map[in] The map.
+ */
+static void cmap_destroy(DConcurrentMapT* map);
+
+/**
+ * @brief Insert or overwrite the value of an integer key. Thread safe.
+ * @param map[in] The integer map.
+ * @param key[in] The key.
+ * @param value[in] The value.
+ * @return TRUE if the key was new, FALSE if its value was replaced.
+ */
+static BOOL cmap_upsert_int(DConcurrentMapT* map, uint64_t key, uint64_t value);
+
+/**
+ * @brief Insert or overwrite the value of a string key. The key is copied. Thread safe.
+ * @param map[in] The string map.
+ * @param key[in] The key.
+ * @param value[in] The value.
+ * @return TRUE if the key was new, FALSE if its value was replaced.
+ */
+static BOOL cmap_upsert_str(DConcurrentMapT* map, CStringViewT key, uint64_t value);
+
+/**
+ * @brief Add to the value of an integer key, inserting it with value 0 first if missing. Thread safe.
+ * @param map[in] The integer map.
+ * @param key[in] The key.
+ * @param delta[in] The amount to add.
+ * @return The new value.
+ */
+static uint64_t cmap_increment_int(DConcurrentMapT* map, uint64_t key, uint64_t delta);
+
+/**
+ * @brief Add to the value of a string key, inserting it with value 0 first if missing. Thread safe.
+ * @param map[in] The string map.
+ * @param key[in] The key.
+ * @param delta[in] The amount to add.
+ * @return The new value.
+ */
+static uint64_t cmap_increment_str(DConcurrentMapT* map, CStringViewT key, uint64_t delta);
+
+/**
+ * @brief Look up an integer key without locking. Thread safe.
+ * @param map[in] The integer map.
+ * @param key[in] The key.
+ * @param value[out] Receives the value if found, may be NULL.
+ * @return TRUE if the key is present, FALSE otherwise.
+ */
+static BOOL cmap_get_int(DConcurrentMapT* map, uint64_t key, uint64_t* value);
+
+/**
+ * @brief Look up a string key without locking. Thread safe.
+ * @param map[in] The string map.
+ * @param key[in] The key.
+ * @param value[out] Receives the value if found, may be NULL.
+ * @return TRUE if the key is present, FALSE otherwise.
+ */
+static BOOL cmap_get_str(DConcurrentMapT* map, CStringViewT key, uint64_t* value);
+
+/**
+ * @brief Get the number of keys. Only a snapshot while other threads insert.
+ * @param map[in] The map.
+ * @return The number of keys.
+ */
+static size_t cmap_length(DConcurrentMapT* map);
+
+/**
+ * @brief Call visit for every entry, one locked shard at a time.
+ * @param map[in] The map.
+ * @param visit[in] The callback. It must not update the map.
+ * @param argument[in] The argument passed to visit.
+ */
+static void cmap_for_each(DConcurrentMapT* map, DConcurrentMapVisitT visit, void* argument);
+
+/**
+ * @brief Hash an integer key.
+ * @param key[in] The key.
+ * @return The hash, never 0.
+ */
+static uint64_t cmap_hash_int(uint64_t key);
+
+/**
+ * @brief Hash a string key.
+ * @param key[in] The key.
+ * @return The hash, never 0.
+ */
+static uint64_t cmap_hash_str(CStringViewT key);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static uint64_t cmap_mix(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    value ^= value >> 31;
+    return value;
+}
+
+inline static uint64_t cmap_hash_int(uint64_t key)
+{
+    uint64_t hash = cmap_mix(key + 0x9E3779B97F4A7C15ull);
+    return (0u == hash) ? 1u : hash;
+}
+
+inline static uint64_t cmap_hash_str(CStringViewT key)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ ((uint64_t) key.length * 0xC2B2AE3D27D4EB4Full);
+    size_t index = 0;
+    for (; index + 8u <= key.length; index += 8u)
+    {
+        uint64_t word;
+        CMEMCPY(&word, &key.data[index], sizeof(uint64_t));
+        hash = (hash ^ cmap_mix(word)) * 0x9E3779B97F4A7C15ull;
+    }
+    uint64_t tail = 0;
+    for (size_t i = 0; index + i < key.length; i++) { tail |= (uint64_t) (uint8_t) key.data[index + i] << (8u * i); }
+    hash = cmap_mix(hash ^ tail);
+    return (0u == hash) ? 1u : hash;
+}
+
+inline static DConcurrentMapTableT* cmap_table_create(size_t capacity)
+{
+    DConcurrentMapTableT* table = (DConcurrentMapTableT*) CCALLOC(1, sizeof(DConcurrentMapTableT));
+    if (NULL == table) { LOG_ERROR("Can not allocate!\n"); }
+    else if (NULL == (table->slots = (DConcurrentMapSlotT*) CCALLOC(capacity, sizeof(DConcurrentMapSlotT))))
+    {
+        LOG_ERROR("Can not allocate concurrent map slots!\n");
+        CFREE(table, sizeof(DConcurrentMapTableT));
+        table = NULL;
+    }
+    else { table->capacity = capacity; }
+    return table;
+}
+
+inline static DConcurrentMapT* cmap_create(DConcurrentMapKeyT keyType, uint32_t shardCount)
+{
+    DConcurrentMapT* map = (DConcurrentMapT*) CCALLOC(1, sizeof(DConcurrentMapT));
+    uint32_t shards = 1;
+    uint32_t bits = 0;
+    while (shards < ((0u == shardCount) ? DCONCURRENT_MAP_DEFAULT_SHARDS : shardCount))
+    {
+        shards *= 2;
+        bits++;
+    }
+
+    if (NULL == map) { LOG_ERROR("Can not allocate!\n"); }
+    else if (NULL == (map->shards = (DConcurrentMapShardT*) CCALLOC(shards, sizeof(DConcurrentMapShardT))))
+    {
+        LOG_ERROR("Can not allocate concurrent map shards!\n");
+        CFREE(map, sizeof(DConcurrentMapT));
+        map = NULL;
+    }
+    else
+    {
+        map->keyType = keyType;
+        map->shardCount = shards;
+        map->shardShift = 64u - bits;
+        for (uint32_t i = 0; (NULL != map) && (i < shards); i++)
+        {
+            map->shards[i].table = cmap_table_create(DCONCURRENT_MAP_INITIAL_SLOTS);
+            if (NULL == map->shards[i].table)
+            {
+                cmap_destroy(map);
+                map = NULL;
+            }
+        }
+    }
+    return map;
+}
+
+inline static void cmap_destroy(DConcurrentMapT* map)
+{
+    if (NULL != map)
+    {
+        for (uint32_t i = 0; i < map->shardCount; i++)
+        {
+            DConcurrentMapTableT* table = map->shards[i].table;
+            for (size_t s = 0; (NULL != table) && (s < table->capacity); s++)
+            {
+                if (NULL != table->slots[s].keyData) { CFREE(table->slots[s].keyData, table->slots[s].keyLength); }
+            }
+            while (NULL != table)
+            {
+                DConcurrentMapTableT* previous = table->previous;
+                CFREE(table->slots, table->capacity * sizeof(DConcurrentMapSlotT));
+                CFREE(table, sizeof(DConcurrentMapTableT));
+                table = previous;
+            }
+        }
+        CFREE(map->shards, map->shardCount * sizeof(DConcurrentMapShardT));
+        CFREE(map, sizeof(DConcurrentMapT));
+    }
+}
+
+inline static DConcurrentMapShardT* cmap_shard(DConcurrentMapT* map, uint64_t hash)
+{
+    return &map->shards[(64u == map->shardShift) ? 0u : (hash >> map->shardShift)];
+}
+
+/* Returns the slot holding the key, or the empty slot ending its probe sequence. Safe without the shard lock. */
+inline static DConcurrentMapSlotT* cmap_probe(DConcurrentMapT* map, DConcurrentMapTableT* table, uint64_t hash,
+                                              uint64_t integer, CStringViewT key)
+{
+    DConcurrentMapSlotT* result = NULL;
+    for (size_t index = hash & (table->capacity - 1u); NULL == result; index = (index + 1u) & (table->capacity - 1u))
+    {
+        DConcurrentMapSlotT* slot = &table->slots[index];
+        uint64_t slotHash = CATOMIC_LOAD_ACQUIRE(&slot->hash);
+        if (0u == slotHash) { result = slot; }
+        else if (slotHash != hash) {}
+        else if (DCONCURRENT_MAP_INTEGER == map->keyType) { result = (slot->integer == integer) ? slot : NULL; }
+        else if ((slot->keyLength == key.length) && (0 == memcmp(slot->keyData, key.data, key.length)))
+        {
+            result = slot;
+        }
+    }
+    return result;
+}
+
+/* Moves the shard to a table twice the size. Called with the shard lock held. */
+inline static BOOL cmap_grow(DConcurrentMapShardT* shard)
+{
+    DConcurrentMapTableT* old = shard->table;
+    DConcurrentMapTableT* table = cmap_table_create(old->capacity * 2u);
+    if (NULL != table)
+    {
+        for (size_t i = 0; i < old->capacity; i++)
+        {
+            DConcurrentMapSlotT* from = &old->slots[i];
+            if (0u != from->hash)
+            {
+                size_t index = from->hash & (table->capacity - 1u);
+                while (0u != table->slots[index].hash) { index = (index + 1u) & (table->capacity - 1u); }
+                table->slots[index] = *from;
+                table->slots[index].value = CATOMIC_LOAD_RELAXED(&from->value);
+            }
+        }
+        table->length = old->length;
+        table->previous = old;
+        CATOMIC_STORE_RELEASE(&shard->table, table);
+    }
+    return (NULL != table) ? TRUE : FALSE;
+}
+
+/* Finds or inserts the key with the shard lock held. */
+inline static DConcurrentMapSlotT* cmap_find_or_insert(DConcurrentMapT* map, DConcurrentMapShardT* shard,
+                                                       uint64_t hash, uint64_t integer, CStringViewT key,
+                                                       BOOL* inserted)
+{
+    DConcurrentMapSlotT* slot = cmap_probe(map, shard->table, hash, integer, key);
+    *inserted = FALSE;
+    if ((0u == slot->hash) && ((shard->table->length + 1u) * 4u > shard->table->capacity * 3u))
+    {
+        if (TRUE == cmap_grow(shard)) { slot = cmap_probe(map, shard->table, hash, integer, key); }
+    }
+
+    if (0u != slot->hash) {}
+    else if (shard->table->length + 1u >= shard->table->capacity)
+    {
+        LOG_ERROR("Can not grow concurrent map shard!\n");
+        slot = NULL;
+    }
+    else
+    {
+        slot->integer = integer;
+        slot->keyLength = key.length;
+        slot->value = 0;
+        if (DCONCURRENT_MAP_STRING == map->keyType)
+        {
+            slot->keyData = (int8_t*) CMALLOC((0u == key.length) ? 1u : key.length);
+            if (NULL != slot->keyData) { CMEMCPY(slot->keyData, key.data, key.length); }
+        }
+        if ((DCONCURRENT_MAP_STRING == map->keyType) && (NULL == slot->keyData))
+        {
+            LOG_ERROR("Can not allocate concurrent map key!\n");
+            slot = NULL;
+        }
+        else
+        {
+            /* Publishes the key to lock-free readers. */
+            CATOMIC_STORE_RELEASE(&slot->hash, hash);
+            CATOMIC_STORE_RELAXED(&shard->table->length, shard->table->length + 1u);
+            *inserted = TRUE;
+        }
+    }
+    return slot;
+}
+
+inline static BOOL cmap_upsert(DConcurrentMapT* map, uint64_t hash, uint64_t integer, CStringViewT key,
+                               uint64_t value)
+{
+    DConcurrentMapShardT* shard = cmap_shard(map, hash);
+    BOOL inserted = FALSE;
+    csync_mutex_lock(&shard->lock);
+    DConcurrentMapSlotT* slot = cmap_find_or_insert(map, shard, hash, integer, key, &inserted);
+    if (NULL != slot) { CATOMIC_STORE_RELAXED(&slot->value, value); }
+    csync_mutex_unlock(&shard->lock);
+    return inserted;
+}
+
+inline static uint64_t cmap_increment(DConcurrentMapT* map, uint64_t hash, uint64_t integer, CStringViewT key,
+                                      uint64_t delta)
+{
+    DConcurrentMapShardT* shard = cmap_shard(map, hash);
+    BOOL inserted = FALSE;
+    uint64_t result = 0;
+    csync_mutex_lock(&shard->lock);
+    DConcurrentMapSlotT* slot = cmap_find_or_insert(map, shard, hash, integer, key, &inserted);
+    if (NULL != slot)
+    {
+        result = slot->value + delta;
+        CATOMIC_STORE_RELAXED(&slot->value, result);
+    }
+    csync_mutex_unlock(&shard->lock);
+    return result;
+}
+
+inline static BOOL cmap_get(DConcurrentMapT* map, uint64_t hash, uint64_t integer, CStringViewT key, uint64_t* value)
+{
+    DConcurrentMapTableT* table = CATOMIC_LOAD_ACQUIRE(&cmap_shard(map, hash)->table);
+    DConcurrentMapSlotT* slot = cmap_probe(map, table, hash, integer, key);
+    BOOL found = (0u != CATOMIC_LOAD_RELAXED(&slot->hash)) ? TRUE : FALSE;
+    if ((TRUE == found) && (NULL != value)) { *value = CATOMIC_LOAD_RELAXED(&slot->value); }
+    return found;
+}
+
+inline static BOOL cmap_upsert_int(DConcurrentMapT* map, uint64_t key, uint64_t value)
+{
+    CStringViewT none = {NULL, 0};
+    return cmap_upsert(map, cmap_hash_int(key), key, none, value);
+}
+
+inline static BOOL cmap_upsert_str(DConcurrentMapT* map, CStringViewT key, uint64_t value)
+{
+    return cmap_upsert(map, cmap_hash_str(key), 0, key, value);
+}
+
+inline static uint64_t cmap_increment_int(DConcurrentMapT* map, uint64_t key, uint64_t delta)
+{
+    CStringViewT none = {NULL, 0};
+    return cmap_increment(map, cmap_hash_int(key), key, none, delta);
+}
+
+inline static uint64_t cmap_increment_str(DConcurrentMapT* map, CStringViewT key, uint64_t delta)
+{
+    return cmap_increment(map, cmap_hash_str(key), 0, key, delta);
+}
+
+inline static BOOL cmap_get_int(DConcurrentMapT* map, uint64_t key, uint64_t* value)
+{
+    CStringViewT none = {NULL, 0};
+    return cmap_get(map, cmap_hash_int(key), key, none, value);
+}
+
+inline static BOOL cmap_get_str(DConcurrentMapT* map, CStringViewT key, uint64_t* value)
+{
+    return cmap_get(map, cmap_hash_str(key), 0, key, value);
+}
+
+inline static size_t cmap_length(DConcurrentMapT* map)
+{
+    size_t result = 0;
+    for (uint32_t i = 0; i < map->shardCount; i++)
+    {
+        result += CATOMIC_LOAD_RELAXED(&CATOMIC_LOAD_ACQUIRE(&map->shards[i].table)->length);
+    }
+    return result;
+}
+
+inline static void cmap_for_each(DConcurrentMapT* map, DConcurrentMapVisitT visit, void* argument)
+{
+    for (uint32_t i = 0; i < map->shardCount; i++)
+    {
+        DConcurrentMapShardT* shard = &map->shards[i];
+        csync_mutex_lock(&shard->lock);
+        for (size_t s = 0; s < shard->table->capacity; s++)
+        {
+            DConcurrentMapSlotT* slot = &shard->table->slots[s];
+            if (0u != slot->hash)
+            {
+                DConcurrentMapEntryT entry = {slot->integer, {slot->keyData, slot->keyLength}, slot->value};
+                visit(&entry, argument);
+            }
+        }
+        csync_mutex_unlock(&shard->lock);
+    }
+}
+
+#endif// DCONCURRENT_MAP_HEADER
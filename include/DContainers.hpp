@@ -0,0 +1,392 @@
+#ifndef DCONTAINERS_HEADER
+#define DCONTAINERS_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DContainers Header (C++ owning wrappers over DArrayT and DStringT)
+ */
+
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+/* STDTypes.h may define size_t as a macro, which the standard headers can not take. */
+#pragma push_macro("size_t")
+#undef size_t
+#include <compare>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#pragma pop_macro("size_t")
+
+#include "DArray.h"
+#include "DString.h"
+#include "STDTypes.h"
+
+namespace cutils
+{
+
+/***********************************************************************************************************************
+DArray
+***********************************************************************************************************************/
+
+/**
+ * @class DArray
+ * @brief Owns a DArrayT of T and destroys it with the wrapper.
+ *
+ * Moves hand the DArrayT over without touching the elements, copies share the data copy-on-write through
+ * darr_clone. Non-const access to the elements makes the data unique first, like the C functions that write.
+ * Elements are moved with memcpy, so T must be trivially copyable. A moved-from DArray is empty and may only be
+ * assigned to or destroyed.
+ */
+template<typename T>
+class DArray
+{
+    static_assert(std::is_trivially_copyable_v<T>, "DArrayT moves its elements with memcpy");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    DArray() : m_Array(darr_create_generic(sizeof(T))) {}
+
+    explicit DArray(size_type length) : DArray() { darr_resize(m_Array, length); }
+
+    DArray(std::initializer_list<T> values) : DArray(std::span<const T>(values.begin(), values.size())) {}
+
+    explicit DArray(std::span<const T> values) : DArray()
+    {
+        darr_resize(m_Array, values.size());
+        if (!values.empty()) { CMEMCPY(m_Array->data, values.data(), values.size() * sizeof(T)); }
+    }
+
+    /**
+     * @brief Take ownership of a dynamic array created by the C API.
+     * @param array[in] A dynamic array with elements of sizeof(T) bytes.
+     */
+    explicit DArray(DArrayT* array) noexcept : m_Array(array) {}
+
+    DArray(const DArray& other) : m_Array((nullptr != other.m_Array) ? darr_clone(other.m_Array) : nullptr) {}
+
+    DArray(DArray&& other) noexcept : m_Array(std::exchange(other.m_Array, nullptr)) {}
+
+    ~DArray()
+    {
+        if (nullptr != m_Array) { darr_destroy(m_Array); }
+    }
+
+    DArray& operator=(const DArray& other)
+    {
+        if (this != &other) { DArray(other).swap(*this); }
+        return *this;
+    }
+
+    DArray& operator=(DArray&& other) noexcept
+    {
+        DArray(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(DArray& other) noexcept { std::swap(m_Array, other.m_Array); }
+
+    /**
+     * @brief Get the wrapped dynamic array, still owned by the wrapper.
+     */
+    DArrayT* get() const noexcept { return m_Array; }
+
+    /**
+     * @brief Give up ownership, the caller destroys the dynamic array with darr_destroy.
+     */
+    DArrayT* release() noexcept { return std::exchange(m_Array, nullptr); }
+
+    size_type size() const noexcept { return (nullptr != m_Array) ? m_Array->length : 0u; }
+
+    size_type capacity() const noexcept { return (nullptr != m_Array) ? m_Array->capacity : 0u; }
+
+    bool empty() const noexcept { return 0u == size(); }
+
+    T* data()
+    {
+        darr_make_unique(m_Array);
+        return reinterpret_cast<T*>(m_Array->data);
+    }
+
+    const T* data() const noexcept
+    {
+        return (nullptr != m_Array) ? reinterpret_cast<const T*>(m_Array->data) : nullptr;
+    }
+
+    T& operator[](size_type index) { return data()[index]; }
+
+    const T& operator[](size_type index) const noexcept { return data()[index]; }
+
+    T& front() { return data()[0]; }
+
+    const T& front() const noexcept { return data()[0]; }
+
+    T& back() { return data()[size() - 1u]; }
+
+    const T& back() const noexcept { return data()[size() - 1u]; }
+
+    iterator begin() { return data(); }
+
+    iterator end() { return data() + size(); }
+
+    const_iterator begin() const noexcept { return data(); }
+
+    const_iterator end() const noexcept { return data() + size(); }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    std::span<T> span() { return std::span<T>(data(), size()); }
+
+    std::span<const T> span() const noexcept { return std::span<const T>(data(), size()); }
+
+    operator std::span<T>() { return span(); }
+
+    operator std::span<const T>() const noexcept { return span(); }
+
+    /* value may be an element of this array, which growing frees, so it is copied first. */
+    void push_back(const T& value)
+    {
+        T copy = value;
+        darr_push_generic(m_Array, &copy);
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        T value(std::forward<Args>(args)...);
+        darr_push_generic(m_Array, &value);
+        return back();
+    }
+
+    void pop_back() { darr_pop(m_Array); }
+
+    void insert(size_type index, const T& value)
+    {
+        T copy = value;
+        darr_insert_generic(m_Array, index, &copy);
+    }
+
+    void erase(size_type index) { darr_erase(m_Array, index); }
+
+    void resize(size_type length) { darr_resize(m_Array, length); }
+
+    void reserve(size_type capacity) { darr_reserve(m_Array, capacity); }
+
+    void shrink_to_fit() { darr_shrink_to_fit(m_Array); }
+
+    void clear() { darr_resize(m_Array, 0u); }
+
+private:
+    DArrayT* m_Array;
+};
+
+/***********************************************************************************************************************
+DString
+***********************************************************************************************************************/
+
+/**
+ * @class DString
+ * @brief Owns a DStringT and destroys it with the wrapper.
+ *
+ * Moves hand the DStringT over without copying, copies share the characters copy-on-write through str_clone.
+ * Converts to std::string_view for reading. A moved-from DString is empty and may only be assigned to or destroyed.
+ */
+class DString
+{
+public:
+    using value_type = char;
+    using size_type = size_t;
+    using iterator = char*;
+    using const_iterator = const char*;
+
+    DString() : m_String(str_create_empty(0u)) {}
+
+    DString(std::string_view text) : m_String(str_create(reinterpret_cast<const int8_t*>(text.data()), text.size())) {}
+
+    DString(const char* text) : DString(std::string_view(text)) {}
+
+    /**
+     * @brief Take ownership of a dynamic string created by the C API.
+     * @param string[in] The dynamic string.
+     */
+    explicit DString(DStringT* string) noexcept : m_String(string) {}
+
+    DString(const DString& other) : m_String((nullptr != other.m_String) ? str_clone(other.m_String) : nullptr) {}
+
+    DString(DString&& other) noexcept : m_String(std::exchange(other.m_String, nullptr)) {}
+
+    ~DString() { str_destroy(m_String); }
+
+    DString& operator=(const DString& other)
+    {
+        if (this != &other) { DString(other).swap(*this); }
+        return *this;
+    }
+
+    DString& operator=(DString&& other) noexcept
+    {
+        DString(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(DString& other) noexcept { std::swap(m_String, other.m_String); }
+
+    /**
+     * @brief Get the wrapped dynamic string, still owned by the wrapper.
+     */
+    DStringT* get() const noexcept { return m_String; }
+
+    /**
+     * @brief Give up ownership, the caller destroys the dynamic string with str_destroy.
+     */
+    DStringT* release() noexcept { return std::exchange(m_String, nullptr); }
+
+    size_type size() const noexcept { return (nullptr != m_String) ? m_String->length : 0u; }
+
+    size_type capacity() const noexcept { return (nullptr != m_String) ? m_String->capacity : 0u; }
+
+    bool empty() const noexcept { return 0u == size(); }
+
+    char* data()
+    {
+        str_make_unique(m_String);
+        return reinterpret_cast<char*>(m_String->data);
+    }
+
+    const char* data() const noexcept
+    {
+        return (nullptr != m_String) ? reinterpret_cast<const char*>(m_String->data) : nullptr;
+    }
+
+    std::string_view view() const noexcept { return std::string_view(data(), size()); }
+
+    operator std::string_view() const noexcept { return view(); }
+
+    char& operator[](size_type index) { return data()[index]; }
+
+    char operator[](size_type index) const noexcept { return data()[index]; }
+
+    iterator begin() { return data(); }
+
+    iterator end() { return data() + size(); }
+
+    const_iterator begin() const noexcept { return data(); }
+
+    const_iterator end() const noexcept { return data() + size(); }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    DString& append(std::string_view text)
+    {
+        if (Overlaps(text)) { append(DString(text).view()); }
+        else
+        {
+            DStringT other = Borrow(text);
+            str_append_dstring(m_String, &other);
+        }
+        return *this;
+    }
+
+    DString& operator+=(std::string_view text) { return append(text); }
+
+    DString& operator+=(char character) { return append(std::string_view(&character, 1u)); }
+
+    void push_back(char character) { append(std::string_view(&character, 1u)); }
+
+    void insert(size_type index, std::string_view text)
+    {
+        if (Overlaps(text)) { insert(index, DString(text).view()); }
+        else
+        {
+            DStringT other = Borrow(text);
+            str_insert_dstring(m_String, &other, index);
+        }
+    }
+
+    void erase(size_type index) { str_erase(m_String, index); }
+
+    void resize(size_type length) { str_resize(m_String, length); }
+
+    void reserve(size_type capacity) { str_reserve(m_String, capacity); }
+
+    void shrink_to_fit() { str_shring_to_fit(m_String); }
+
+    void clear() { str_resize(m_String, 0u); }
+
+    friend bool operator==(const DString& left, std::string_view right) noexcept { return left.view() == right; }
+
+    friend std::strong_ordering operator<=>(const DString& left, std::string_view right) noexcept
+    {
+        return left.view() <=> right;
+    }
+
+private:
+    /* A DStringT over characters it does not own, for the C functions that read another string. */
+    static DStringT Borrow(std::string_view text) noexcept
+    {
+        size_t length = static_cast<size_t>(text.size());
+        DStringT result{};
+        result.length = length;
+        result.capacity = length;
+        result.data = const_cast<int8_t*>(reinterpret_cast<const int8_t*>(text.data()));
+        return result;
+    }
+
+    /* Growing the string may move its characters, text that points into them is copied first. */
+    bool Overlaps(std::string_view text) const noexcept
+    {
+        const char* first = data();
+        return (nullptr != first) && (text.data() >= first) && (text.data() < first + capacity() + 1u);
+    }
+
+    DStringT* m_String;
+};
+
+}// namespace cutils
+
+#endif// DCONTAINERS_HEADER
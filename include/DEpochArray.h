@@ -0,0 +1,180 @@
+#ifndef DEPOCH_ARRAY_HEADER
+#define DEPOCH_ARRAY_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DEpochArray Header (dynamic arrays that lock-free readers can read while a writer grows them)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CEpoch.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DEpochArrayContextT
+ * @brief The storage context of an epoch managed dynamic array.
+ * @var writer The participant of the writing thread, it retires replaced buffers.
+ * @var data The buffer readers use, published with release semantics.
+ * @var length The length readers see, set by darr_epoch_publish.
+ */
+typedef struct {
+    DEpochParticipantT* writer;
+    int8_t* data;
+    size_t length;
+} DEpochArrayContextT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Let lock-free readers read a dynamic array while one writer appends to it.
+ *
+ * Growing the array copies it into a new buffer and retires the old one to the
+ * epoch domain of writer instead of reallocating it, so readers inside a read
+ * section keep a valid buffer. Appended elements become visible to readers with
+ * darr_epoch_publish. Elements below the published length must not be modified
+ * while readers run, and darr_destroy requires that no reader can reach the
+ * array anymore.
+ *
+ * @param darr[in] A dynamic array without storage, e.g. from darr_create_generic.
+ * @param writer[in] The participant of the only thread that will modify darr.
+ * @return TRUE on success, FALSE if the array already has a storage or on allocation failure.
+ */
+static BOOL darr_epoch_attach(DArrayT* darr, DEpochParticipantT* writer);
+
+/**
+ * @brief Make every element appended so far visible to readers. Writer only.
+ * @param darr[in] An epoch managed dynamic array.
+ */
+static void darr_epoch_publish(DArrayT* darr);
+
+/**
+ * @brief Get the published elements. Call between epoch_enter and epoch_exit, the buffer stays valid until then.
+ * @param darr[in] An epoch managed dynamic array.
+ * @param length[out] Receives the published length.
+ * @return A pointer to the first element.
+ */
+static const void* darr_epoch_read(DArrayT* darr, size_t* length);
+
+/**
+ * @brief Check whether a dynamic array is epoch managed.
+ * @param darr[in] The dynamic array.
+ * @return TRUE if darr_epoch_attach was called on it, FALSE otherwise.
+ */
+static BOOL darr_is_epoch_managed(DArrayT* darr);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static BOOL darr_epoch_reserve(DArrayT* darr, size_t newCapacity);
+inline static void darr_epoch_release(DArrayT* darr);
+
+static const DArrayStorageT darr_epoch_storage = {darr_epoch_reserve, darr_epoch_release, NULL};
+
+inline static DEpochArrayContextT* darr_epoch_context(DArrayT* darr)
+{
+    return (DEpochArrayContextT*) darr->storageContext;
+}
+
+inline static BOOL darr_epoch_reserve(DArrayT* darr, size_t newCapacity)
+{
+    BOOL result = FALSE;
+    DEpochArrayContextT* context = darr_epoch_context(darr);
+    int8_t* data = (int8_t*) CMALLOC(newCapacity * darr->elementSize);
+    if (NULL == data) { LOG_ERROR("Can not allocate dynamic darray!\n"); }
+    else
+    {
+        CMEMCPY(data, darr->data, darr->length * darr->elementSize);
+        /* Readers load the length before the buffer, so a published length always fits the buffer they get. */
+        CATOMIC_STORE_RELEASE(&context->data, data);
+        epoch_retire(context->writer, darr->data, darr->capacity * darr->elementSize);
+        darr->data = data;
+        darr->capacity = newCapacity;
+        result = TRUE;
+    }
+    return result;
+}
+
+inline static void darr_epoch_release(DArrayT* darr)
+{
+    CFREE(darr->data, darr->capacity * darr->elementSize);
+    CFREE(darr->storageContext, sizeof(DEpochArrayContextT));
+}
+
+inline static BOOL darr_epoch_attach(DArrayT* darr, DEpochParticipantT* writer)
+{
+    BOOL result = FALSE;
+    DEpochArrayContextT* context = NULL;
+    if (NULL != darr->storage) { LOG_ERROR("Dynamic array already has a storage!\n"); }
+    else if (NULL == (context = (DEpochArrayContextT*) CMALLOC(sizeof(DEpochArrayContextT))))
+    {
+        LOG_ERROR("Can not allocate!\n");
+    }
+    else
+    {
+        context->writer = writer;
+        context->data = darr->data;
+        context->length = darr->length;
+        darr->storageContext = context;
+        CATOMIC_STORE_RELEASE(&darr->storage, &darr_epoch_storage);
+        result = TRUE;
+    }
+    return result;
+}
+
+inline static void darr_epoch_publish(DArrayT* darr)
+{
+    CATOMIC_STORE_RELEASE(&darr_epoch_context(darr)->length, darr->length);
+}
+
+inline static const void* darr_epoch_read(DArrayT* darr, size_t* length)
+{
+    DEpochArrayContextT* context = darr_epoch_context(darr);
+    *length = CATOMIC_LOAD_ACQUIRE(&context->length);
+    return CATOMIC_LOAD_ACQUIRE(&context->data);
+}
+
+inline static BOOL darr_is_epoch_managed(DArrayT* darr) { return &darr_epoch_storage == darr->storage; }
+
+#endif// DEPOCH_ARRAY_HEADER
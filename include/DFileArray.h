@@ -0,0 +1,239 @@
+#ifndef DFILE_ARRAY_HEADER
+#define DFILE_ARRAY_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DFileArray Header (dynamic arrays stored in a memory-mapped file)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CFilesystem.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "CSerialize.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DFILE_ARRAY_GROWTH_BYTES
+ * @brief The file grows in multiples of this many bytes, so appends rarely remap.
+ */
+#define DFILE_ARRAY_GROWTH_BYTES (1u << 20)
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Open or create a dynamic array stored in a file.
+ *
+ * The file uses the darr_save format, so darr_load_view can map it read-only.
+ * The darr_* functions work as usual: growing the array grows the file and
+ * remaps it, which moves data. The length is written to the file by
+ * darr_file_sync and darr_destroy, elements by the OS page cache at any time.
+ *
+ * @param path[in] Path of the file, created if it does not exist.
+ * @param elementSize[in] The element size, must match the file.
+ * @return A pointer to the file backed dynamic array, or NULL if the file can not be mapped or does not match.
+ */
+static DArrayT* darr_file_open(const int8_t* path, size_t elementSize);
+
+/**
+ * @brief Write the length and the modified elements to the file.
+ *
+ * Syncing touches only dirty pages, call it once per batch of appends rather
+ * than once per element.
+ *
+ * @param darr[in] A dynamic array returned by darr_file_open.
+ * @param wait[in] TRUE to return once the data is on disk, FALSE to only schedule the write.
+ * @return FILE_OPERATION_SUCCESS, or the error.
+ */
+static FileOpResultT darr_file_sync(DArrayT* darr, BOOL wait);
+
+/**
+ * @brief Check whether a dynamic array is stored in a file.
+ * @param darr[in] The dynamic array.
+ * @return TRUE if the array was returned by darr_file_open, FALSE otherwise.
+ */
+static BOOL darr_is_file_backed(DArrayT* darr);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static BOOL darr_file_reserve(DArrayT* darr, size_t newCapacity);
+inline static void darr_file_release(DArrayT* darr);
+
+static const DArrayStorageT darr_file_storage = {darr_file_reserve, darr_file_release, NULL};
+
+inline static FileMappingT* darr_file_mapping(DArrayT* darr) { return (FileMappingT*) darr->storageContext; }
+
+inline static void darr_file_attach(DArrayT* darr)
+{
+    FileMappingT* mapping = darr_file_mapping(darr);
+    CSerializeHeaderT* header = (CSerializeHeaderT*) mapping->data;
+    darr->data = &mapping->data[header->dataOffset];
+    darr->capacity = (size_t) ((mapping->size - header->dataOffset) / darr->elementSize);
+}
+
+inline static void darr_file_write_length(DArrayT* darr)
+{
+    CSerializeHeaderT* header = (CSerializeHeaderT*) darr_file_mapping(darr)->data;
+    header->length = darr->length;
+    header->dataSize = (uint64_t) darr->length * darr->elementSize;
+}
+
+inline static BOOL darr_file_reserve(DArrayT* darr, size_t newCapacity)
+{
+    BOOL result = FALSE;
+    FileMappingT* mapping = darr_file_mapping(darr);
+    uint64_t dataOffset = 0;
+    uint64_t newSize = 0;
+
+    if (NULL == mapping->data) { LOG_ERROR("File backed dynamic array lost its mapping!\n"); }
+    else
+    {
+        dataOffset = ((CSerializeHeaderT*) mapping->data)->dataOffset;
+        newSize = dataOffset + (uint64_t) newCapacity * darr->elementSize;
+        newSize = (newSize + DFILE_ARRAY_GROWTH_BYTES - 1u) / DFILE_ARRAY_GROWTH_BYTES * DFILE_ARRAY_GROWTH_BYTES;
+        darr_file_write_length(darr);
+    }
+
+    if (NULL == mapping->data) {}
+    else if (FILE_OPERATION_SUCCESS == file_map_resize(mapping, (size_t) newSize))
+    {
+        darr_file_attach(darr);
+        result = TRUE;
+    }
+    else
+    {
+        /* Remap the old size so the array stays usable, possibly at a new address. */
+        size_t oldSize = (size_t) (dataOffset + (uint64_t) darr->capacity * darr->elementSize);
+        if (FILE_OPERATION_SUCCESS == file_map_resize(mapping, oldSize)) { darr_file_attach(darr); }
+        else
+        {
+            LOG_ERROR("Lost the mapping of a file backed dynamic array!\n");
+            darr->data = NULL;
+            darr->capacity = 0;
+            darr->length = 0;
+        }
+    }
+    return result;
+}
+
+inline static void darr_file_release(DArrayT* darr)
+{
+    FileMappingT* mapping = darr_file_mapping(darr);
+    if (NULL != mapping->data) { darr_file_write_length(darr); }
+    file_unmap(mapping);
+    CFREE(mapping, sizeof(FileMappingT));
+}
+
+inline static DArrayT* darr_file_open(const int8_t* path, size_t elementSize)
+{
+    DArrayT* result = NULL;
+    FileMappingT* mapping = (FileMappingT*) CMALLOC(sizeof(FileMappingT));
+    const CSerializeHeaderT* header = NULL;
+    BOOL mapped = FALSE;
+
+    if (0u == elementSize) { LOG_ERROR("Element size can not be 0!\n"); }
+    else if (NULL == mapping) { LOG_ERROR("Can not allocate file mapping!\n"); }
+    else
+    {
+        if (FALSE == file_exists(path))
+        {
+            DArrayT empty = {0, 0, elementSize, NULL, NULL, NULL};
+            darr_save(path, &empty);
+        }
+        mapped = (FILE_OPERATION_SUCCESS == file_map(path, TRUE, mapping)) ? TRUE : FALSE;
+    }
+
+    if (FALSE == mapped) {}
+    else if ((NULL == (header = cserialize_validate(mapping, CSERIALIZE_MAGIC_DARRAY))) ||
+             (elementSize != header->elementSize) || (0u != header->blobSize))
+    {
+        LOG_ERROR("%s is not a dynamic array file of this element size!\n", path);
+    }
+    else if (NULL == (result = (DArrayT*) CMALLOC(sizeof(DArrayT))))
+    {
+        LOG_ERROR("Can not allocate dynamic darray!\n");
+    }
+    else
+    {
+        result->length = (size_t) header->length;
+        result->elementSize = elementSize;
+        result->storage = &darr_file_storage;
+        result->storageContext = mapping;
+        darr_file_attach(result);
+    }
+
+    if (NULL != result) {}
+    else if (TRUE == mapped)
+    {
+        file_unmap(mapping);
+        CFREE(mapping, sizeof(FileMappingT));
+    }
+    else if (NULL != mapping) { CFREE(mapping, sizeof(FileMappingT)); }
+    return result;
+}
+
+inline static FileOpResultT darr_file_sync(DArrayT* darr, BOOL wait)
+{
+    FileOpResultT result = FILE_OPERATION_SUCCESS;
+    if (FALSE == darr_is_file_backed(darr))
+    {
+        LOG_ERROR("Dynamic array is not file backed!\n");
+        result = FILE_UNKNOWN_ERROR;
+    }
+    else if (NULL == darr_file_mapping(darr)->data)
+    {
+        LOG_ERROR("File backed dynamic array lost its mapping!\n");
+        result = FILE_WRITE_ERROR;
+    }
+    else
+
+    {
+        darr_file_write_length(darr);
+        result = file_map_sync(darr_file_mapping(darr), wait);
+    }
+    return result;
+}
+
+inline static BOOL darr_is_file_backed(DArrayT* darr) { return &darr_file_storage == darr->storage; }
+
+#endif// DFILE_ARRAY_HEADER
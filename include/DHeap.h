@@ -0,0 +1,690 @@
+#ifndef DHEAP_HEADER
+#define DHEAP_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DHeap Header (binary / d-ary heap priority queue)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DHEAP_BINARY
+ * @brief Arity of a classic binary heap.
+ */
+#define DHEAP_BINARY 2u
+
+/**
+ * @def DHEAP_QUATERNARY
+ * @brief Arity of a 4-ary heap. Siblings share a cache line, the tree is half as deep.
+ */
+#define DHEAP_QUATERNARY 4u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @brief Compare two heap elements.
+ * @return Negative if a has higher priority than b (is closer to the top), zero if equal, positive otherwise.
+ */
+typedef int32_t (*DHeapCompareFn)(const void* a, const void* b);
+
+/**
+ * @brief Called every time an element lands on a new index of the heap.
+ *
+ * Lets the owner of the elements remember their position, which is what
+ * heap_decrease_key needs.
+ */
+typedef void (*DHeapMoveFn)(void* element, size_t newIndex, void* userData);
+
+/**
+ * @enum DHeapKeyTypeT
+ * @brief Element type of the heap. Typed heaps compare keys inline instead of through a function pointer.
+ */
+typedef enum
+{
+    DHEAP_KEY_GENERIC = 0,
+    DHEAP_KEY_U32,
+    DHEAP_KEY_I32
+} DHeapKeyTypeT;
+
+/**
+ * @struct DHeapT
+ * @brief A d-ary heap (priority queue) stored in a dynamic array.
+ *
+ * @var data The dynamic array holding the elements in heap order.
+ * @var arity Number of children per node, DHEAP_BINARY or DHEAP_QUATERNARY.
+ * @var keyType The element type.
+ * @var compare Comparator of generic heaps, NULL for typed heaps.
+ * @var onMove Optional position tracking callback of generic heaps.
+ * @var userData User pointer passed to onMove.
+ * @var scratch One element of scratch memory used while sifting.
+ */
+typedef struct {
+    DArrayT* data;
+    size_t arity;
+    DHeapKeyTypeT keyType;
+    DHeapCompareFn compare;
+    DHeapMoveFn onMove;
+    void* userData;
+    int8_t* scratch;
+} DHeapT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a heap of arbitrary elements.
+ * @param elementSize[in] The size of an element.
+ * @param arity[in] Number of children per node (at least 2).
+ * @param compare[in] The comparator, the element for which it returns the lowest value is on top.
+ * @return A pointer to the new heap.
+ */
+static DHeapT* heap_create_generic(size_t elementSize, size_t arity, DHeapCompareFn compare);
+
+/**
+ * @brief Create a min-heap of uint32_t keys.
+ * @param arity[in] Number of children per node (at least 2).
+ * @return A pointer to the new heap.
+ */
+static DHeapT* heap_create_u32(size_t arity);
+
+/**
+ * @brief Create a min-heap of int32_t keys.
+ * @param arity[in] Number of children per node (at least 2).
+ * @return A pointer to the new heap.
+ */
+static DHeapT* heap_create_i32(size_t arity);
+
+/**
+ * @brief Build a heap in O(n) from an existing dynamic array.
+ *
+ * The heap takes ownership of darr, no element is copied. The array is
+ * reordered in place and destroyed together with the heap.
+ *
+ * @param darr[in] The dynamic array.
+ * @param arity[in] Number of children per node (at least 2).
+ * @param compare[in] The comparator.
+ * @return A pointer to the new heap.
+ */
+static DHeapT* heap_create_from_darr(DArrayT* darr, size_t arity, DHeapCompareFn compare);
+
+/**
+ * @brief Build a uint32_t min-heap in O(n) from an existing dynamic array, taking ownership of it.
+ * @param darr[in] The dynamic array.
+ * @param arity[in] Number of children per node (at least 2).
+ * @return A pointer to the new heap.
+ */
+static DHeapT* heap_create_from_darr_u32(DArrayU32T* darr, size_t arity);
+
+/**
+ * @brief Build an int32_t min-heap in O(n) from an existing dynamic array, taking ownership of it.
+ * @param darr[in] The dynamic array.
+ * @param arity[in] Number of children per node (at least 2).
+ * @return A pointer to the new heap.
+ */
+static DHeapT* heap_create_from_darr_i32(DArrayI32T* darr, size_t arity);
+
+/**
+ * @brief Destroy a heap and its storage.
+ * @param heap[in] The heap.
+ */
+static void heap_destroy(DHeapT* heap);
+
+/**
+ * @brief Install a position tracking callback (generic heaps only).
+ *
+ * The callback is called right away for every element already in the heap,
+ * so heaps built by heap_create_from_darr can be tracked as well.
+ *
+ * @param heap[in] The heap.
+ * @param onMove[in] The callback, called with the new index of every moved element.
+ * @param userData[in] User pointer passed to the callback.
+ */
+static void heap_set_move_callback(DHeapT* heap, DHeapMoveFn onMove, void* userData);
+
+/**
+ * @brief Push an element.
+ * @param heap[in] The heap.
+ * @param value[in] Pointer to the element to copy.
+ */
+static void heap_push(DHeapT* heap, const void* value);
+
+/**
+ * @brief Push a key into a uint32_t heap.
+ * @param heap[in] The heap.
+ * @param value[in] The key.
+ */
+static void heap_push_u32(DHeapT* heap, uint32_t value);
+
+/**
+ * @brief Push a key into an int32_t heap.
+ * @param heap[in] The heap.
+ * @param value[in] The key.
+ */
+static void heap_push_i32(DHeapT* heap, int32_t value);
+
+/**
+ * @brief Get a pointer to the top element.
+ * @param heap[in] The heap.
+ * @return A pointer to the top element, or NULL if the heap is empty.
+ */
+static void* heap_top(DHeapT* heap);
+
+/**
+ * @brief Get the top key of a uint32_t heap.
+ * @param heap[in] The heap.
+ * @return The top key, or 0 if the heap is empty.
+ */
+static uint32_t heap_top_u32(DHeapT* heap);
+
+/**
+ * @brief Get the top key of an int32_t heap.
+ * @param heap[in] The heap.
+ * @return The top key, or 0 if the heap is empty.
+ */
+static int32_t heap_top_i32(DHeapT* heap);
+
+/**
+ * @brief Remove the top element.
+ * @param heap[in] The heap.
+ * @param out[out] Receives a copy of the removed element, may be NULL.
+ * @return TRUE if an element was removed, FALSE if the heap was empty.
+ */
+static BOOL heap_pop(DHeapT* heap, void* out);
+
+/**
+ * @brief Remove and return the top key of a uint32_t heap.
+ * @param heap[in] The heap.
+ * @return The top key, or 0 if the heap is empty.
+ */
+static uint32_t heap_pop_u32(DHeapT* heap);
+
+/**
+ * @brief Remove and return the top key of an int32_t heap.
+ * @param heap[in] The heap.
+ * @return The top key, or 0 if the heap is empty.
+ */
+static int32_t heap_pop_i32(DHeapT* heap);
+
+/**
+ * @brief Replace the top element and restore heap order (pop + push with a single sift).
+ * @param heap[in] The heap, must not be empty.
+ * @param value[in] Pointer to the new element.
+ */
+static void heap_replace_top(DHeapT* heap, const void* value);
+
+/**
+ * @brief Replace the top key of a uint32_t heap.
+ * @param heap[in] The heap, must not be empty.
+ * @param value[in] The new key.
+ */
+static void heap_replace_top_u32(DHeapT* heap, uint32_t value);
+
+/**
+ * @brief Replace the top key of an int32_t heap.
+ * @param heap[in] The heap, must not be empty.
+ * @param value[in] The new key.
+ */
+static void heap_replace_top_i32(DHeapT* heap, int32_t value);
+
+/**
+ * @brief Overwrite the element at index with one of higher priority and move it up.
+ * @param heap[in] The heap.
+ * @param index[in] The current index of the element (see heap_set_move_callback).
+ * @param value[in] Pointer to the new element value.
+ */
+static void heap_decrease_key(DHeapT* heap, size_t index, const void* value);
+
+/**
+ * @brief Get the number of elements in the heap.
+ * @param heap[in] The heap.
+ * @return The number of elements.
+ */
+static size_t heap_length(DHeapT* heap);
+
+/**
+ * @brief Check if the heap is empty.
+ * @param heap[in] The heap.
+ * @return TRUE if the heap is empty, FALSE otherwise.
+ */
+static BOOL heap_is_empty(DHeapT* heap);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DHeapT* heap_create_from_storage(DArrayT* darr, size_t arity, DHeapKeyTypeT keyType,
+                                               DHeapCompareFn compare)
+{
+    DHeapT* result = NULL;
+
+    if ((NULL == darr) || (arity < 2u)) { LOG_ERROR("Invalid heap parameters!\n"); }
+    else if ((DHEAP_KEY_GENERIC == keyType) && (NULL == compare)) { LOG_ERROR("Generic heap needs a comparator!\n"); }
+    else
+    {
+        result = (DHeapT*) CMALLOC(sizeof(DHeapT));
+        if (NULL == result) { LOG_ERROR("Can not allocate heap!\n"); }
+        else
+        {
+            result->data = darr;
+            result->arity = arity;
+            result->keyType = keyType;
+            result->compare = compare;
+            result->onMove = NULL;
+            result->userData = NULL;
+            result->scratch = (int8_t*) CMALLOC(darr->elementSize);
+            if (NULL == result->scratch)
+            {
+                LOG_ERROR("Can not allocate heap scratch element!\n");
+                CFREE(result, sizeof(DHeapT));
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+inline static int8_t* heap_element(DHeapT* heap, size_t index)
+{
+    return &heap->data->data[index * heap->data->elementSize];
+}
+
+inline static void heap_place(DHeapT* heap, size_t index, const void* value)
+{
+    CMEMCPY(heap_element(heap, index), value, heap->data->elementSize);
+    if (NULL != heap->onMove) { heap->onMove(heap_element(heap, index), index, heap->userData); }
+}
+
+/* Generic sifts work with a hole: the moving element waits in value while others shift into the hole. */
+inline static void heap_sift_up_generic(DHeapT* heap, size_t index, const void* value)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / heap->arity;
+        if (heap->compare(value, heap_element(heap, parent)) >= 0) { break; }
+        heap_place(heap, index, heap_element(heap, parent));
+        index = parent;
+    }
+    heap_place(heap, index, value);
+}
+
+inline static void heap_sift_down_generic(DHeapT* heap, size_t index, const void* value)
+{
+    size_t length = heap->data->length;
+    for (;;)
+    {
+        size_t first = index * heap->arity + 1;
+        if (first >= length) { break; }
+        size_t last = first + heap->arity;
+        if (last > length) { last = length; }
+
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++)
+        {
+            if (heap->compare(heap_element(heap, child), heap_element(heap, best)) < 0) { best = child; }
+        }
+        if (heap->compare(heap_element(heap, best), value) >= 0) { break; }
+        heap_place(heap, index, heap_element(heap, best));
+        index = best;
+    }
+    heap_place(heap, index, value);
+}
+
+inline static void heap_sift_up_u32(uint32_t* keys, size_t arity, size_t index, uint32_t value)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / arity;
+        if (keys[parent] <= value) { break; }
+        keys[index] = keys[parent];
+        index = parent;
+    }
+    keys[index] = value;
+}
+
+inline static void heap_sift_down_u32(uint32_t* keys, size_t length, size_t arity, size_t index, uint32_t value)
+{
+    for (;;)
+    {
+        size_t first = index * arity + 1;
+        if (first >= length) { break; }
+        size_t last = first + arity;
+        if (last > length) { last = length; }
+
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++)
+        {
+            if (keys[child] < keys[best]) { best = child; }
+        }
+        if (keys[best] >= value) { break; }
+        keys[index] = keys[best];
+        index = best;
+    }
+    keys[index] = value;
+}
+
+inline static void heap_sift_up_i32(int32_t* keys, size_t arity, size_t index, int32_t value)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / arity;
+        if (keys[parent] <= value) { break; }
+        keys[index] = keys[parent];
+        index = parent;
+    }
+    keys[index] = value;
+}
+
+inline static void heap_sift_down_i32(int32_t* keys, size_t length, size_t arity, size_t index, int32_t value)
+{
+    for (;;)
+    {
+        size_t first = index * arity + 1;
+        if (first >= length) { break; }
+        size_t last = first + arity;
+        if (last > length) { last = length; }
+
+        size_t best = first;
+        for (size_t child = first + 1; child < last; child++)
+        {
+            if (keys[child] < keys[best]) { best = child; }
+        }
+        if (keys[best] >= value) { break; }
+        keys[index] = keys[best];
+        index = best;
+    }
+    keys[index] = value;
+}
+
+inline static void heap_sift_down(DHeapT* heap, size_t index, const void* value)
+{
+    switch (heap->keyType)
+    {
+        case DHEAP_KEY_U32:
+            heap_sift_down_u32((uint32_t*) heap->data->data, heap->data->length, heap->arity, index,
+                               *(const uint32_t*) value);
+            break;
+        case DHEAP_KEY_I32:
+            heap_sift_down_i32((int32_t*) heap->data->data, heap->data->length, heap->arity, index,
+                               *(const int32_t*) value);
+            break;
+        default:
+            heap_sift_down_generic(heap, index, value);
+            break;
+    }
+}
+
+inline static void heap_sift_up(DHeapT* heap, size_t index, const void* value)
+{
+    switch (heap->keyType)
+    {
+        case DHEAP_KEY_U32:
+            heap_sift_up_u32((uint32_t*) heap->data->data, heap->arity, index, *(const uint32_t*) value);
+            break;
+        case DHEAP_KEY_I32:
+            heap_sift_up_i32((int32_t*) heap->data->data, heap->arity, index, *(const int32_t*) value);
+            break;
+        default:
+            heap_sift_up_generic(heap, index, value);
+            break;
+    }
+}
+
+inline static void heap_heapify(DHeapT* heap)
+{
+    darr_make_unique(heap->data);
+    size_t length = heap->data->length;
+    if (length > 1)
+    {
+        size_t index = (length - 2) / heap->arity + 1;
+        while (index-- > 0)
+        {
+            CMEMCPY(heap->scratch, heap_element(heap, index), heap->data->elementSize);
+            heap_sift_down(heap, index, heap->scratch);
+        }
+    }
+}
+
+inline static DHeapT* heap_create_generic(size_t elementSize, size_t arity, DHeapCompareFn compare)
+{
+    DHeapT* result = NULL;
+    DArrayT* darr = darr_create_generic(elementSize);
+    if (NULL != darr)
+    {
+        result = heap_create_from_storage(darr, arity, DHEAP_KEY_GENERIC, compare);
+        if (NULL == result) { darr_destroy(darr); }
+    }
+    return result;
+}
+
+inline static DHeapT* heap_create_u32(size_t arity)
+{
+    DHeapT* result = NULL;
+    DArrayU32T* darr = darr_create_u32();
+    if (NULL != darr)
+    {
+        result = heap_create_from_storage(darr, arity, DHEAP_KEY_U32, NULL);
+        if (NULL == result) { darr_destroy(darr); }
+    }
+    return result;
+}
+
+inline static DHeapT* heap_create_i32(size_t arity)
+{
+    DHeapT* result = NULL;
+    DArrayI32T* darr = darr_create_i32();
+    if (NULL != darr)
+    {
+        result = heap_create_from_storage(darr, arity, DHEAP_KEY_I32, NULL);
+        if (NULL == result) { darr_destroy(darr); }
+    }
+    return result;
+}
+
+inline static DHeapT* heap_create_from_darr(DArrayT* darr, size_t arity, DHeapCompareFn compare)
+{
+    DHeapT* result = heap_create_from_storage(darr, arity, DHEAP_KEY_GENERIC, compare);
+    if (NULL != result) { heap_heapify(result); }
+    return result;
+}
+
+inline static DHeapT* heap_create_from_darr_u32(DArrayU32T* darr, size_t arity)
+{
+    DHeapT* result = NULL;
+    if ((NULL != darr) && (sizeof(uint32_t) != darr->elementSize)) { LOG_ERROR("Array is not a uint32_t array!\n"); }
+    else
+    {
+        result = heap_create_from_storage(darr, arity, DHEAP_KEY_U32, NULL);
+        if (NULL != result) { heap_heapify(result); }
+    }
+    return result;
+}
+
+inline static DHeapT* heap_create_from_darr_i32(DArrayI32T* darr, size_t arity)
+{
+    DHeapT* result = NULL;
+    if ((NULL != darr) && (sizeof(int32_t) != darr->elementSize)) { LOG_ERROR("Array is not an int32_t array!\n"); }
+    else
+    {
+        result = heap_create_from_storage(darr, arity, DHEAP_KEY_I32, NULL);
+        if (NULL != result) { heap_heapify(result); }
+    }
+    return result;
+}
+
+inline static void heap_destroy(DHeapT* heap)
+{
+    if (NULL != heap)
+    {
+        CFREE(heap->scratch, heap->data->elementSize);
+        darr_destroy(heap->data);
+        CFREE(heap, sizeof(DHeapT));
+    }
+}
+
+inline static void heap_set_move_callback(DHeapT* heap, DHeapMoveFn onMove, void* userData)
+{
+    heap->onMove = onMove;
+    heap->userData = userData;
+    for (size_t i = 0; (NULL != onMove) && (i < heap->data->length); i++)
+    {
+        onMove(heap_element(heap, i), i, userData);
+    }
+}
+
+inline static void heap_push(DHeapT* heap, const void* value)
+{
+    size_t index = heap->data->length;
+    /* value may point into the heap, growing frees the old storage. */
+    CMEMCPY(heap->scratch, value, heap->data->elementSize);
+    darr_resize(heap->data, index + 1);
+    if (heap->data->length > index) { heap_sift_up(heap, index, heap->scratch); }
+}
+
+
+inline static void heap_push_u32(DHeapT* heap, uint32_t value)
+{
+    size_t index = heap->data->length;
+    darr_resize(heap->data, index + 1);
+    if (heap->data->length > index) { heap_sift_up_u32((uint32_t*) heap->data->data, heap->arity, index, value); }
+}
+
+inline static void heap_push_i32(DHeapT* heap, int32_t value)
+{
+    size_t index = heap->data->length;
+    darr_resize(heap->data, index + 1);
+    if (heap->data->length > index) { heap_sift_up_i32((int32_t*) heap->data->data, heap->arity, index, value); }
+}
+
+inline static void* heap_top(DHeapT* heap) { return darr_front_ptr_safe(heap->data); }
+
+inline static uint32_t heap_top_u32(DHeapT* heap) { return darr_get_u32_safe(heap->data, 0); }
+
+inline static int32_t heap_top_i32(DHeapT* heap) { return darr_get_i32_safe(heap->data, 0); }
+
+inline static BOOL heap_pop(DHeapT* heap, void* out)
+{
+    darr_make_unique(heap->data);
+    BOOL result = FALSE;
+    size_t length = heap->data->length;
+    if (length > 0)
+    {
+        if (NULL != out) { CMEMCPY(out, heap_element(heap, 0), heap->data->elementSize); }
+        heap->data->length = length - 1;
+        if (length > 1)
+        {
+            CMEMCPY(heap->scratch, heap_element(heap, length - 1), heap->data->elementSize);
+            heap_sift_down(heap, 0, heap->scratch);
+        }
+        result = TRUE;
+    }
+    return result;
+}
+
+inline static uint32_t heap_pop_u32(DHeapT* heap)
+{
+    darr_make_unique(heap->data);
+    uint32_t result = 0;
+    size_t length = heap->data->length;
+    if (length > 0)
+    {
+        uint32_t* keys = (uint32_t*) heap->data->data;
+        result = keys[0];
+        heap->data->length = length - 1;
+        if (length > 1) { heap_sift_down_u32(keys, length - 1, heap->arity, 0, keys[length - 1]); }
+    }
+    return result;
+}
+
+inline static int32_t heap_pop_i32(DHeapT* heap)
+{
+    darr_make_unique(heap->data);
+    int32_t result = 0;
+    size_t length = heap->data->length;
+    if (length > 0)
+    {
+        int32_t* keys = (int32_t*) heap->data->data;
+        result = keys[0];
+        heap->data->length = length - 1;
+        if (length > 1) { heap_sift_down_i32(keys, length - 1, heap->arity, 0, keys[length - 1]); }
+    }
+    return result;
+}
+
+inline static void heap_replace_top(DHeapT* heap, const void* value)
+{
+    darr_make_unique(heap->data);
+    heap_sift_down(heap, 0, value);
+}
+
+inline static void heap_replace_top_u32(DHeapT* heap, uint32_t value)
+{
+    darr_make_unique(heap->data);
+    heap_sift_down_u32((uint32_t*) heap->data->data, heap->data->length, heap->arity, 0, value);
+}
+
+inline static void heap_replace_top_i32(DHeapT* heap, int32_t value)
+{
+    darr_make_unique(heap->data);
+    heap_sift_down_i32((int32_t*) heap->data->data, heap->data->length, heap->arity, 0, value);
+}
+
+inline static void heap_decrease_key(DHeapT* heap, size_t index, const void* value)
+{
+    darr_make_unique(heap->data);
+    if (index < heap->data->length)
+    {
+        CMEMCPY(heap->scratch, value, heap->data->elementSize);
+        heap_sift_up(heap, index, heap->scratch);
+    }
+    else { LOG_ERROR("Heap index out of bounds!\n"); }
+}
+
+inline static size_t heap_length(DHeapT* heap) { return heap->data->length; }
+
+inline static BOOL heap_is_empty(DHeapT* heap) { return (0u == heap->data->length); }
+
+#endif// DHEAP_HEADER
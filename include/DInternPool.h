@@ -0,0 +1,431 @@
+#ifndef DINTERN_POOL_HEADER
+#define DINTERN_POOL_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DInternPool Header (string interning with 32-bit ids)
+ */
+
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CLog.h"
+#include "CMemory.h"
+#include "CStringView.h"
+#include "CSync.h"
+#include "DConcurrentArray.h"
+#include "DConcurrentMap.h"
+#include "DString.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DINTERN_POOL_INVALID_ID
+ * @brief The id returned when a string is not in the pool or could not be added.
+ */
+#define DINTERN_POOL_INVALID_ID 0xFFFFFFFFu
+
+/**
+ * @def DINTERN_POOL_BLOCK_SIZE
+ * @brief Bytes of an arena block. Strings longer than a quarter of it get a block of their own.
+ */
+#define DINTERN_POOL_BLOCK_SIZE (64u * 1024u)
+
+/**
+ * @def DINTERN_POOL_MIN_SLOTS
+ * @brief The smallest hash table, in slots. The table doubles when it is half full.
+ */
+#define DINTERN_POOL_MIN_SLOTS 64u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DInternBlockT
+ * @brief An arena block, its bytes follow the header.
+ * @var next The block allocated before this one.
+ * @var size The number of bytes after the header.
+ * @var used The number of bytes handed out.
+ */
+typedef struct DInternBlock {
+    struct DInternBlock* next;
+    size_t size;
+    size_t used;
+} DInternBlockT;
+
+/**
+ * @struct DInternSlotT
+ * @brief A slot of the open addressing table, empty while id is DINTERN_POOL_INVALID_ID.
+ * @var hash The low 32 bits of the string hash, compared before the bytes and used to rehash.
+ * @var id The id of the string.
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t id;
+} DInternSlotT;
+
+/**
+ * @struct DInternPoolT
+ * @brief Stores every distinct string once and names it by a dense 32-bit id.
+ *
+ * Equal strings get equal ids, so comparing interned strings is an integer compare.
+ * The characters live null terminated in arena blocks that never move; views stay
+ * valid until the pool is destroyed. Lookups share a reader-writer lock and only
+ * adding a new string takes it exclusively. Ids index an append-only concurrent
+ * array, so intern_get takes no lock.
+ *
+ * @var lock Guards the hash table and the arena.
+ * @var slots The hash table, a power of two of slots.
+ * @var slotCount The number of slots.
+ * @var entries The view of each string, by id.
+ * @var blocks The arena, the block in use first.
+ * @var arenaBytes The bytes of string data stored, terminators included.
+ */
+typedef struct {
+    CRwLockT lock;
+    DInternSlotT* slots;
+    size_t slotCount;
+    DConcurrentArrayT* entries;
+    DInternBlockT* blocks;
+    size_t arenaBytes;
+} DInternPoolT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create an intern pool.
+ * @param expectedCount[in] The expected number of distinct strings, 0 if unknown.
+ * @return A pointer to the new intern pool.
+ */
+static DInternPoolT* intern_create(size_t expectedCount);
+
+/**
+ * @brief Destroy an intern pool. Views returned by intern_get become invalid.
+ * @param pool[in] The intern pool.
+ */
+static void intern_destroy(DInternPoolT* pool);
+
+/**
+ * @brief Get the id of a string, adding the string if it is new. Thread safe.
+ * @param pool[in] The intern pool.
+ * @param str[in] The string, copied into the pool.
+ * @return The id, DINTERN_POOL_INVALID_ID if the string could not be added.
+ */
+static uint32_t intern_add(DInternPoolT* pool, CStringViewT str);
+
+/**
+ * @brief Same as intern_add for a null terminated string.
+ */
+static uint32_t intern_add_cstr(DInternPoolT* pool, const int8_t* str);
+
+/**
+ * @brief Same as intern_add for a dynamic string.
+ */
+static uint32_t intern_add_dstring(DInternPoolT* pool, DStringT* str);
+
+/**
+ * @brief Intern every string of a string array (see str_arr_create). Thread safe.
+ *
+ * Strings already in the pool are resolved under the shared lock, the new ones
+ * are then added under a single exclusive lock.
+ *
+ * @param pool[in] The intern pool.
+ * @param strArray[in] The string array.
+ * @param ids[out] Receives one id per string.
+ * @return TRUE if every string has an id, FALSE if some could not be added.
+ */
+static BOOL intern_add_str_arr(DInternPoolT* pool, DArrayT* strArray, uint32_t* ids);
+
+/**
+ * @brief Get the id of a string without adding it. Thread safe.
+ * @param pool[in] The intern pool.
+ * @param str[in] The string.
+ * @return The id, DINTERN_POOL_INVALID_ID if the string is not in the pool.
+ */
+static uint32_t intern_find(DInternPoolT* pool, CStringViewT str);
+
+/**
+ * @brief Get an interned string. Thread safe, takes no lock.
+ * @param pool[in] The intern pool.
+ * @param id[in] An id returned by the pool.
+ * @return The string, null terminated, valid until the pool is destroyed.
+ */
+static CStringViewT intern_get(DInternPoolT* pool, uint32_t id);
+
+/**
+ * @brief Get the number of distinct strings.
+ * @param pool[in] The intern pool.
+ * @return The number of strings, the next id.
+ */
+static size_t intern_count(DInternPoolT* pool);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DInternSlotT* intern_slots_create(size_t slotCount)
+{
+    DInternSlotT* slots = (DInternSlotT*) CMALLOC(slotCount * sizeof(DInternSlotT));
+    if (NULL == slots) { LOG_ERROR("Can not allocate intern table!\n"); }
+    else { CMEMSET(slots, 0xFF, slotCount * sizeof(DInternSlotT)); }
+    return slots;
+}
+
+/* Returns the slot holding str, or the empty slot where it belongs. Caller holds the lock. */
+inline static DInternSlotT* intern_probe(DInternPoolT* pool, CStringViewT str, uint32_t hash)
+{
+    size_t mask = pool->slotCount - 1u;
+    size_t index = hash & mask;
+    DInternSlotT* result = NULL;
+    while (NULL == result)
+    {
+        DInternSlotT* slot = &pool->slots[index];
+        if (DINTERN_POOL_INVALID_ID == slot->id) { result = slot; }
+        else if (hash == slot->hash)
+        {
+            CStringViewT* entry = (CStringViewT*) carr_get_ptr(pool->entries, slot->id);
+            if ((entry->length == str.length) && (0 == memcmp(entry->data, str.data, str.length))) { result = slot; }
+        }
+        index = (index + 1u) & mask;
+    }
+    return result;
+}
+
+inline static uint32_t intern_lookup(DInternPoolT* pool, CStringViewT str, uint32_t hash)
+{
+    csync_rwlock_read_lock(&pool->lock);
+    uint32_t id = intern_probe(pool, str, hash)->id;
+    csync_rwlock_read_unlock(&pool->lock);
+    return id;
+}
+
+inline static BOOL intern_grow(DInternPoolT* pool)
+{
+    size_t slotCount = pool->slotCount * 2u;
+    DInternSlotT* slots = intern_slots_create(slotCount);
+    if (NULL != slots)
+    {
+        for (size_t i = 0; i < pool->slotCount; i++)
+        {
+            if (DINTERN_POOL_INVALID_ID != pool->slots[i].id)
+            {
+                size_t index = pool->slots[i].hash & (slotCount - 1u);
+                while (DINTERN_POOL_INVALID_ID != slots[index].id) { index = (index + 1u) & (slotCount - 1u); }
+                slots[index] = pool->slots[i];
+            }
+        }
+        CFREE(pool->slots, pool->slotCount * sizeof(DInternSlotT));
+        pool->slots = slots;
+        pool->slotCount = slotCount;
+    }
+    return (NULL != slots) ? TRUE : FALSE;
+}
+
+/* Copies str into the arena, null terminated. Caller holds the lock exclusively. */
+inline static const int8_t* intern_store(DInternPoolT* pool, CStringViewT str)
+{
+    size_t size = str.length + 1u;
+    DInternBlockT* block = pool->blocks;
+    if ((NULL == block) || (block->size - block->used < size))
+    {
+        /* Long strings get a block of their own behind the current one, so its free space is not wasted. */
+        BOOL dedicated = (size > DINTERN_POOL_BLOCK_SIZE / 4u) ? TRUE : FALSE;
+        size_t blockSize = (TRUE == dedicated) ? size : DINTERN_POOL_BLOCK_SIZE;
+        block = (DInternBlockT*) CMALLOC(sizeof(DInternBlockT) + blockSize);
+        if (NULL == block) { LOG_ERROR("Can not allocate intern arena!\n"); }
+        else
+        {
+            block->size = blockSize;
+            block->used = 0;
+            if ((TRUE == dedicated) && (NULL != pool->blocks))
+            {
+                block->next = pool->blocks->next;
+                pool->blocks->next = block;
+            }
+            else
+            {
+                block->next = pool->blocks;
+                pool->blocks = block;
+            }
+        }
+    }
+
+    int8_t* result = NULL;
+    if (NULL != block)
+    {
+        result = (int8_t*) (block + 1) + block->used;
+        if (0u != str.length) { CMEMCPY(result, str.data, str.length); }
+        result[str.length] = '\0';
+        block->used += size;
+        pool->arenaBytes += size;
+    }
+    return result;
+}
+
+/* Adds str unless another thread did first. Caller holds the lock exclusively. */
+inline static uint32_t intern_insert(DInternPoolT* pool, CStringViewT str, uint32_t hash)
+{
+    DInternSlotT* slot = intern_probe(pool, str, hash);
+    size_t count = carr_length(pool->entries);
+    if (DINTERN_POOL_INVALID_ID != slot->id) {}
+    else if (count >= DINTERN_POOL_INVALID_ID) { LOG_ERROR("Intern pool is full!\n"); }
+    else if (((count + 1u) * 2u > pool->slotCount) && (FALSE == intern_grow(pool))) {}
+    else
+    {
+        slot = intern_probe(pool, str, hash);
+        CStringViewT entry = {intern_store(pool, str), str.length};
+        size_t id = DCONCURRENT_ARRAY_INVALID;
+        if (NULL == entry.data) {}
+        else if (DCONCURRENT_ARRAY_INVALID == (id = carr_push(pool->entries, &entry))) {}
+        else
+        {
+            slot->hash = hash;
+            slot->id = (uint32_t) id;
+        }
+    }
+    return slot->id;
+}
+
+inline static uint32_t intern_hash(CStringViewT str) { return (uint32_t) cmap_hash_str(str); }
+
+inline static DInternPoolT* intern_create(size_t expectedCount)
+{
+    DInternPoolT* pool = (DInternPoolT*) CCALLOC(1, sizeof(DInternPoolT));
+    if (NULL == pool) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        pool->slotCount = DINTERN_POOL_MIN_SLOTS;
+        while (pool->slotCount < expectedCount * 2u) { pool->slotCount *= 2u; }
+        csync_rwlock_init(&pool->lock);
+        pool->slots = intern_slots_create(pool->slotCount);
+        pool->entries = carr_create(sizeof(CStringViewT), expectedCount);
+        if ((NULL == pool->slots) || (NULL == pool->entries))
+        {
+            LOG_ERROR("Can not allocate intern pool!\n");
+            intern_destroy(pool);
+            pool = NULL;
+        }
+    }
+    return pool;
+}
+
+inline static void intern_destroy(DInternPoolT* pool)
+{
+    if (NULL != pool)
+    {
+        while (NULL != pool->blocks)
+        {
+            DInternBlockT* next = pool->blocks->next;
+            CFREE(pool->blocks, sizeof(DInternBlockT) + pool->blocks->size);
+            pool->blocks = next;
+        }
+        if (NULL != pool->entries) { carr_destroy(pool->entries); }
+        if (NULL != pool->slots) { CFREE(pool->slots, pool->slotCount * sizeof(DInternSlotT)); }
+        CFREE(pool, sizeof(DInternPoolT));
+    }
+}
+
+inline static uint32_t intern_add(DInternPoolT* pool, CStringViewT str)
+{
+    uint32_t hash = intern_hash(str);
+    uint32_t id = intern_lookup(pool, str, hash);
+    if (DINTERN_POOL_INVALID_ID == id)
+    {
+        csync_rwlock_write_lock(&pool->lock);
+        id = intern_insert(pool, str, hash);
+        csync_rwlock_write_unlock(&pool->lock);
+    }
+    return id;
+}
+
+inline static uint32_t intern_add_cstr(DInternPoolT* pool, const int8_t* str)
+{
+    return intern_add(pool, string_view_create(str));
+}
+
+inline static uint32_t intern_add_dstring(DInternPoolT* pool, DStringT* str)
+{
+    return intern_add(pool, string_view_create_d(str));
+}
+
+inline static BOOL intern_add_str_arr(DInternPoolT* pool, DArrayT* strArray, uint32_t* ids)
+{
+    size_t count = darr_length(strArray);
+    size_t missing = 0;
+    BOOL result = TRUE;
+
+    csync_rwlock_read_lock(&pool->lock);
+    for (size_t i = 0; i < count; i++)
+    {
+        CStringViewT str = string_view_create_d(str_arr_get(strArray, i));
+        ids[i] = intern_probe(pool, str, intern_hash(str))->id;
+        if (DINTERN_POOL_INVALID_ID == ids[i]) { missing++; }
+    }
+    csync_rwlock_read_unlock(&pool->lock);
+
+    if (0u != missing)
+    {
+        csync_rwlock_write_lock(&pool->lock);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (DINTERN_POOL_INVALID_ID == ids[i])
+            {
+                CStringViewT str = string_view_create_d(str_arr_get(strArray, i));
+                ids[i] = intern_insert(pool, str, intern_hash(str));
+                if (DINTERN_POOL_INVALID_ID == ids[i]) { result = FALSE; }
+            }
+        }
+        csync_rwlock_write_unlock(&pool->lock);
+    }
+    return result;
+}
+
+inline static uint32_t intern_find(DInternPoolT* pool, CStringViewT str)
+{
+    return intern_lookup(pool, str, intern_hash(str));
+}
+
+inline static CStringViewT intern_get(DInternPoolT* pool, uint32_t id)
+{
+    return *(CStringViewT*) carr_get_ptr(pool->entries, id);
+}
+
+inline static size_t intern_count(DInternPoolT* pool) { return carr_length(pool->entries); }
+
+#endif// DINTERN_POOL_HEADER
@@ -0,0 +1,463 @@
+#ifndef DMPMC_QUEUE_HEADER
+#define DMPMC_QUEUE_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DMpmcQueue Header (bounded lock-free multi-producer/multi-consumer queue)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DMPMC_QUEUE_CELL_HEADER
+ * @brief Bytes in front of the element in every cell, holding its sequence number.
+ */
+#define DMPMC_QUEUE_CELL_HEADER sizeof(uint64_t)
+
+/**
+ * @def DMPMC_QUEUE_SEQUENCE
+ * @brief Get the sequence number of a cell.
+ */
+#define DMPMC_QUEUE_SEQUENCE(queue, position)                                                                          \
+    ((uint64_t*) &(queue)->cells[((position) & ((queue)->capacity - 1u)) * (queue)->cellSize])
+
+/**
+ * @def DMPMC_QUEUE_ELEMENT
+ * @brief Get the element of a cell.
+ */
+#define DMPMC_QUEUE_ELEMENT(queue, position)                                                                           \
+    (&(queue)->cells[((position) & ((queue)->capacity - 1u)) * (queue)->cellSize + DMPMC_QUEUE_CELL_HEADER])
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DMpmcQueueT
+ * @brief A bounded lock-free queue for any number of producer and consumer threads.
+ *
+ * Every cell carries a sequence number telling which lap of which side may use it
+ * next: a producer may fill the cell for position p when its sequence is p, a
+ * consumer may empty it when the sequence is p + 1. Producers and consumers only
+ * contend on their own position counter, each on its own cache line.
+ *
+ * @var enqueuePosition The next position to fill.
+ * @var dequeuePosition The next position to empty.
+ * @var capacity The number of cells, a power of two.
+ * @var elementSize The size of each element.
+ * @var cellSize The stride between cells, the sequence number plus the element rounded up to 8 bytes.
+ * @var cells The cells.
+ */
+typedef struct {
+    int8_t padding0[CATOMIC_CACHE_LINE];
+    uint64_t enqueuePosition;
+    int8_t padding1[CATOMIC_CACHE_LINE];
+    uint64_t dequeuePosition;
+    int8_t padding2[CATOMIC_CACHE_LINE];
+    size_t capacity;
+    size_t elementSize;
+    size_t cellSize;
+    int8_t* cells;
+} DMpmcQueueT;
+
+/**
+ * @typedef DMpmcQueueU32T
+ * @brief A queue of uint32_t.
+ */
+typedef DMpmcQueueT DMpmcQueueU32T;
+
+/**
+ * @typedef DMpmcQueueI32T
+ * @brief A queue of int32_t.
+ */
+typedef DMpmcQueueT DMpmcQueueI32T;
+
+/**
+ * @typedef DMpmcQueueU16T
+ * @brief A queue of uint16_t.
+ */
+typedef DMpmcQueueT DMpmcQueueU16T;
+
+/**
+ * @typedef DMpmcQueueI16T
+ * @brief A queue of int16_t.
+ */
+typedef DMpmcQueueT DMpmcQueueI16T;
+
+/**
+ * @typedef DMpmcQueueU8T
+ * @brief A queue of uint8_t.
+ */
+typedef DMpmcQueueT DMpmcQueueU8T;
+
+/**
+ * @typedef DMpmcQueueI8T
+ * @brief A queue of int8_t.
+ */
+typedef DMpmcQueueT DMpmcQueueI8T;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a queue.
+ * @param elementSize[in] The size of each element.
+ * @param capacity[in] The minimum number of elements, rounded up to a power of two.
+ * @return A pointer to the new queue.
+ */
+static DMpmcQueueT* mpmc_create_generic(size_t elementSize, size_t capacity);
+
+/**
+ * @brief Create a queue of uint32_t.
+ * @param capacity[in] The minimum number of elements.
+ * @return A pointer to the new queue.
+ */
+static DMpmcQueueU32T* mpmc_create_u32(size_t capacity);
+
+/**
+ * @brief Same as mpmc_create_u32 for int32_t.
+ */
+static DMpmcQueueI32T* mpmc_create_i32(size_t capacity);
+
+/**
+ * @brief Same as mpmc_create_u32 for uint16_t.
+ */
+static DMpmcQueueU16T* mpmc_create_u16(size_t capacity);
+
+/**
+ * @brief Same as mpmc_create_u32 for int16_t.
+ */
+static DMpmcQueueI16T* mpmc_create_i16(size_t capacity);
+
+/**
+ * @brief Same as mpmc_create_u32 for uint8_t.
+ */
+static DMpmcQueueU8T* mpmc_create_u8(size_t capacity);
+
+/**
+ * @brief Same as mpmc_create_u32 for int8_t.
+ */
+static DMpmcQueueI8T* mpmc_create_i8(size_t capacity);
+
+/**
+ * @brief Destroy a queue. No thread may use it anymore.
+ * @param queue[in] The queue.
+ */
+static void mpmc_destroy(DMpmcQueueT* queue);
+
+/**
+ * @brief Append an element if there is room.
+ * @param queue[in] The queue.
+ * @param value[in] Pointer to the element.
+ * @return TRUE if the element was appended, FALSE if the queue is full.
+ */
+static BOOL mpmc_try_push(DMpmcQueueT* queue, const void* value);
+
+/**
+ * @brief Remove the oldest element if there is one.
+ * @param queue[in] The queue.
+ * @param value[out] Receives the element.
+ * @return TRUE if an element was removed, FALSE if the queue is empty.
+ */
+static BOOL mpmc_try_pop(DMpmcQueueT* queue, void* value);
+
+/**
+ * @brief Append up to count elements as one contiguous run of positions, claimed with a single CAS.
+ * @param queue[in] The queue.
+ * @param values[in] The elements.
+ * @param count[in] The number of elements.
+ * @return The number of appended elements, the first ones of values.
+ */
+static size_t mpmc_push_batch(DMpmcQueueT* queue, const void* values, size_t count);
+
+/**
+ * @brief Remove up to maxCount of the oldest elements, claimed with a single CAS.
+ * @param queue[in] The queue.
+ * @param values[out] Receives the elements.
+ * @param maxCount[in] The room in values, in elements.
+ * @return The number of removed elements.
+ */
+static size_t mpmc_pop_batch(DMpmcQueueT* queue, void* values, size_t maxCount);
+
+/**
+ * @brief Same as mpmc_try_push for uint32_t queues.
+ */
+static BOOL mpmc_try_push_u32(DMpmcQueueU32T* queue, uint32_t value);
+
+/**
+ * @brief Same as mpmc_try_push for int32_t queues.
+ */
+static BOOL mpmc_try_push_i32(DMpmcQueueI32T* queue, int32_t value);
+
+/**
+ * @brief Same as mpmc_try_push for uint16_t queues.
+ */
+static BOOL mpmc_try_push_u16(DMpmcQueueU16T* queue, uint16_t value);
+
+/**
+ * @brief Same as mpmc_try_push for int16_t queues.
+ */
+static BOOL mpmc_try_push_i16(DMpmcQueueI16T* queue, int16_t value);
+
+/**
+ * @brief Same as mpmc_try_push for uint8_t queues.
+ */
+static BOOL mpmc_try_push_u8(DMpmcQueueU8T* queue, uint8_t value);
+
+/**
+ * @brief Same as mpmc_try_push for int8_t queues.
+ */
+static BOOL mpmc_try_push_i8(DMpmcQueueI8T* queue, int8_t value);
+
+/**
+ * @brief Same as mpmc_try_pop for uint32_t queues.
+ */
+static BOOL mpmc_try_pop_u32(DMpmcQueueU32T* queue, uint32_t* value);
+
+/**
+ * @brief Same as mpmc_try_pop for int32_t queues.
+ */
+static BOOL mpmc_try_pop_i32(DMpmcQueueI32T* queue, int32_t* value);
+
+/**
+ * @brief Same as mpmc_try_pop for uint16_t queues.
+ */
+static BOOL mpmc_try_pop_u16(DMpmcQueueU16T* queue, uint16_t* value);
+
+/**
+ * @brief Same as mpmc_try_pop for int16_t queues.
+ */
+static BOOL mpmc_try_pop_i16(DMpmcQueueI16T* queue, int16_t* value);
+
+/**
+ * @brief Same as mpmc_try_pop for uint8_t queues.
+ */
+static BOOL mpmc_try_pop_u8(DMpmcQueueU8T* queue, uint8_t* value);
+
+/**
+ * @brief Same as mpmc_try_pop for int8_t queues.
+ */
+static BOOL mpmc_try_pop_i8(DMpmcQueueI8T* queue, int8_t* value);
+
+/**
+ * @brief Get the number of elements. Only a snapshot while other threads use the queue.
+ * @param queue[in] The queue.
+ * @return The number of elements.
+ */
+static size_t mpmc_length(DMpmcQueueT* queue);
+
+/**
+ * @brief Get the number of cells.
+ * @param queue[in] The queue.
+ * @return The capacity.
+ */
+static size_t mpmc_capacity(DMpmcQueueT* queue);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DMpmcQueueT* mpmc_create_generic(size_t elementSize, size_t capacity)
+{
+    DMpmcQueueT* result = NULL;
+    size_t cells = 2;
+    while (cells < capacity) { cells *= 2; }
+
+    if (0u == elementSize) { LOG_ERROR("Element size can not be 0!\n"); }
+    else if (NULL == (result = (DMpmcQueueT*) CCALLOC(1, sizeof(DMpmcQueueT)))) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        result->capacity = cells;
+        result->elementSize = elementSize;
+        result->cellSize = DMPMC_QUEUE_CELL_HEADER + ((elementSize + 7u) & ~((size_t) 7u));
+        result->cells = (int8_t*) CMALLOC(cells * result->cellSize);
+        if (NULL == result->cells)
+        {
+            LOG_ERROR("Can not allocate queue cells!\n");
+            CFREE(result, sizeof(DMpmcQueueT));
+            result = NULL;
+        }
+        else
+        {
+            for (uint64_t i = 0; i < cells; i++) { *DMPMC_QUEUE_SEQUENCE(result, i) = i; }
+        }
+    }
+    return result;
+}
+
+inline static DMpmcQueueU32T* mpmc_create_u32(size_t capacity)
+{
+    return mpmc_create_generic(sizeof(uint32_t), capacity);
+}
+
+inline static DMpmcQueueI32T* mpmc_create_i32(size_t capacity)
+{
+    return mpmc_create_generic(sizeof(int32_t), capacity);
+}
+
+inline static DMpmcQueueU16T* mpmc_create_u16(size_t capacity)
+{
+    return mpmc_create_generic(sizeof(uint16_t), capacity);
+}
+
+inline static DMpmcQueueI16T* mpmc_create_i16(size_t capacity)
+{
+    return mpmc_create_generic(sizeof(int16_t), capacity);
+}
+
+inline static DMpmcQueueU8T* mpmc_create_u8(size_t capacity) { return mpmc_create_generic(sizeof(uint8_t), capacity); }
+
+inline static DMpmcQueueI8T* mpmc_create_i8(size_t capacity) { return mpmc_create_generic(sizeof(int8_t), capacity); }
+
+inline static void mpmc_destroy(DMpmcQueueT* queue)
+{
+    if (NULL != queue)
+    {
+        CFREE(queue->cells, queue->capacity * queue->cellSize);
+        CFREE(queue, sizeof(DMpmcQueueT));
+    }
+}
+
+/**
+ * Claims up to maxCount consecutive positions on counter. A cell is usable when its sequence equals the position plus
+ * lag (0 for producers, 1 for consumers). Usable cells stay usable until the counter passes them, so counting them
+ * and then moving the counter with one CAS from the position they were counted at is race free.
+ */
+inline static size_t mpmc_claim(DMpmcQueueT* queue, uint64_t* counter, uint64_t lag, size_t maxCount,
+                                uint64_t* position)
+{
+    size_t claimed = 0;
+    BOOL done = (0u == maxCount) ? TRUE : FALSE;
+    uint64_t current = CATOMIC_LOAD_RELAXED(counter);
+    while (FALSE == done)
+    {
+        int64_t difference = (int64_t) (CATOMIC_LOAD_ACQUIRE(DMPMC_QUEUE_SEQUENCE(queue, current)) - (current + lag));
+        if (difference < 0) { done = TRUE; }
+        else if (difference > 0) { current = CATOMIC_LOAD_RELAXED(counter); }
+        else
+        {
+            size_t usable = 1;
+            while ((usable < maxCount) &&
+                   (CATOMIC_LOAD_ACQUIRE(DMPMC_QUEUE_SEQUENCE(queue, current + usable)) == current + usable + lag))
+            {
+                usable++;
+            }
+            if (CATOMIC_CAS_WEAK(counter, &current, current + usable))
+            {
+                claimed = usable;
+                *position = current;
+                done = TRUE;
+            }
+            else { CATOMIC_PAUSE(); }
+        }
+    }
+    return claimed;
+}
+
+inline static size_t mpmc_push_batch(DMpmcQueueT* queue, const void* values, size_t count)
+{
+    uint64_t position = 0;
+    size_t pushed = mpmc_claim(queue, &queue->enqueuePosition, 0u, count, &position);
+    const int8_t* input = (const int8_t*) values;
+    for (size_t i = 0; i < pushed; i++)
+    {
+        CMEMCPY(DMPMC_QUEUE_ELEMENT(queue, position + i), &input[i * queue->elementSize], queue->elementSize);
+        CATOMIC_STORE_RELEASE(DMPMC_QUEUE_SEQUENCE(queue, position + i), position + i + 1u);
+    }
+    return pushed;
+}
+
+inline static size_t mpmc_pop_batch(DMpmcQueueT* queue, void* values, size_t maxCount)
+{
+    uint64_t position = 0;
+    size_t popped = mpmc_claim(queue, &queue->dequeuePosition, 1u, maxCount, &position);
+    int8_t* output = (int8_t*) values;
+    for (size_t i = 0; i < popped; i++)
+    {
+        CMEMCPY(&output[i * queue->elementSize], DMPMC_QUEUE_ELEMENT(queue, position + i), queue->elementSize);
+        CATOMIC_STORE_RELEASE(DMPMC_QUEUE_SEQUENCE(queue, position + i), position + i + queue->capacity);
+    }
+    return popped;
+}
+
+inline static BOOL mpmc_try_push(DMpmcQueueT* queue, const void* value)
+{
+    return 1u == mpmc_push_batch(queue, value, 1);
+}
+
+inline static BOOL mpmc_try_pop(DMpmcQueueT* queue, void* value) { return 1u == mpmc_pop_batch(queue, value, 1); }
+
+inline static BOOL mpmc_try_push_u32(DMpmcQueueU32T* queue, uint32_t value) { return mpmc_try_push(queue, &value); }
+
+inline static BOOL mpmc_try_push_i32(DMpmcQueueI32T* queue, int32_t value) { return mpmc_try_push(queue, &value); }
+
+inline static BOOL mpmc_try_push_u16(DMpmcQueueU16T* queue, uint16_t value) { return mpmc_try_push(queue, &value); }
+
+inline static BOOL mpmc_try_push_i16(DMpmcQueueI16T* queue, int16_t value) { return mpmc_try_push(queue, &value); }
+
+inline static BOOL mpmc_try_push_u8(DMpmcQueueU8T* queue, uint8_t value) { return mpmc_try_push(queue, &value); }
+
+inline static BOOL mpmc_try_push_i8(DMpmcQueueI8T* queue, int8_t value) { return mpmc_try_push(queue, &value); }
+
+inline static BOOL mpmc_try_pop_u32(DMpmcQueueU32T* queue, uint32_t* value) { return mpmc_try_pop(queue, value); }
+
+inline static BOOL mpmc_try_pop_i32(DMpmcQueueI32T* queue, int32_t* value) { return mpmc_try_pop(queue, value); }
+
+inline static BOOL mpmc_try_pop_u16(DMpmcQueueU16T* queue, uint16_t* value) { return mpmc_try_pop(queue, value); }
+
+inline static BOOL mpmc_try_pop_i16(DMpmcQueueI16T* queue, int16_t* value) { return mpmc_try_pop(queue, value); }
+
+inline static BOOL mpmc_try_pop_u8(DMpmcQueueU8T* queue, uint8_t* value) { return mpmc_try_pop(queue, value); }
+
+inline static BOOL mpmc_try_pop_i8(DMpmcQueueI8T* queue, int8_t* value) { return mpmc_try_pop(queue, value); }
+
+inline static size_t mpmc_length(DMpmcQueueT* queue)
+{
+    uint64_t dequeued = CATOMIC_LOAD_ACQUIRE(&queue->dequeuePosition);
+    uint64_t enqueued = CATOMIC_LOAD_ACQUIRE(&queue->enqueuePosition);
+    return (enqueued > dequeued) ? (size_t) (enqueued - dequeued) : 0u;
+}
+
+inline static size_t mpmc_capacity(DMpmcQueueT* queue) { return queue->capacity; }
+
+#endif// DMPMC_QUEUE_HEADER
@@ -0,0 +1,740 @@
+#ifndef DPACKED_ARRAY_HEADER
+#define DPACKED_ARRAY_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DPackedArray Header (compressed uint32_t arrays: bit-packing, delta and StreamVByte)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CCpu.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DPACKED_BLOCK_SIZE
+ * @brief Number of values per compressed block.
+ */
+#define DPACKED_BLOCK_SIZE 128u
+
+/**
+ * @def DPACKED_PADDING
+ * @brief Readable bytes kept after the payload so decoders can use wide unaligned loads.
+ */
+#define DPACKED_PADDING 16u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @enum DPackedEncodingT
+ * @brief Encoding of the blocks of a packed array.
+ *
+ * - `DPACKED_BITPACK_FOR`: frame of reference, value - block minimum at the minimal bit width
+ * - `DPACKED_BITPACK_DELTA`: difference to the previous value at the minimal bit width (best for sorted ids)
+ * - `DPACKED_VARINT`: StreamVByte, 2 bit length codes and 1-4 data bytes per value
+ * - `DPACKED_VARINT_DELTA`: StreamVByte of the differences to the previous value
+ */
+typedef enum
+{
+    DPACKED_BITPACK_FOR = 0,
+    DPACKED_BITPACK_DELTA,
+    DPACKED_VARINT,
+    DPACKED_VARINT_DELTA
+} DPackedEncodingT;
+
+/**
+ * @struct DPackedBlockT
+ * @brief Header of one compressed block.
+ *
+ * @var first The first value of the block, used to skip blocks in sorted arrays.
+ * @var base Block minimum (FOR) or the value preceding the block (delta encodings).
+ * @var offset Byte offset of the block payload.
+ * @var bitWidth Bits per value of bit-packed blocks.
+ */
+typedef struct {
+    uint32_t first;
+    uint32_t base;
+    uint32_t offset;
+    uint32_t bitWidth;
+} DPackedBlockT;
+
+/**
+ * @struct DPackedArrayT
+ * @brief A compressed array of uint32_t.
+ *
+ * Values are encoded in blocks of DPACKED_BLOCK_SIZE. Values pushed after the
+ * last full block wait uncompressed in pending until the block fills up.
+ *
+ * @var length The number of values.
+ * @var encoding The block encoding.
+ * @var blocks Dynamic array of DPackedBlockT.
+ * @var payload Dynamic array of the encoded bytes of all blocks.
+ * @var lastEncoded The last value of the last full block, the base of the next delta block.
+ * @var pendingLength The number of values in pending.
+ * @var pending The values of the incomplete last block.
+ */
+typedef struct {
+    size_t length;
+    DPackedEncodingT encoding;
+    DArrayT* blocks;
+    DArrayU8T* payload;
+    uint32_t lastEncoded;
+    size_t pendingLength;
+    uint32_t pending[DPACKED_BLOCK_SIZE];
+} DPackedArrayT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create an empty packed array.
+ * @param encoding[in] The block encoding.
+ * @return A pointer to the new packed array.
+ */
+static DPackedArrayT* parr_create(DPackedEncodingT encoding);
+
+/**
+ * @brief Compress a dynamic array of uint32_t.
+ * @param darr[in] The source array, left unchanged.
+ * @param encoding[in] The block encoding.
+ * @return A pointer to the new packed array.
+ */
+static DPackedArrayT* parr_create_from_darr(DArrayU32T* darr, DPackedEncodingT encoding);
+
+/**
+ * @brief Destroy a packed array.
+ * @param parr[in] The packed array.
+ */
+static void parr_destroy(DPackedArrayT* parr);
+
+/**
+ * @brief Append a value.
+ * @param parr[in] The packed array.
+ * @param value[in] The value.
+ */
+static void parr_push(DPackedArrayT* parr, uint32_t value);
+
+/**
+ * @brief Get a value.
+ *
+ * Bit-packed FOR blocks and StreamVByte blocks are read without decoding the
+ * block, delta blocks are decoded up to the index.
+ *
+ * @param parr[in] The packed array.
+ * @param index[in] The index, must be in bounds.
+ * @return The value.
+ */
+static uint32_t parr_get(DPackedArrayT* parr, size_t index);
+
+/**
+ * @brief Get a value, safely.
+ * @param parr[in] The packed array.
+ * @param index[in] The index.
+ * @return The value, or 0 if the index is out of bounds.
+ */
+static uint32_t parr_get_safe(DPackedArrayT* parr, size_t index);
+
+/**
+ * @brief Decode one block.
+ * @param parr[in] The packed array.
+ * @param block[in] The block index, the block after the last full one is the pending block.
+ * @param out[out] Receives up to DPACKED_BLOCK_SIZE values.
+ * @return The number of decoded values.
+ */
+static size_t parr_decode_block(DPackedArrayT* parr, size_t block, uint32_t* out);
+
+/**
+ * @brief Get the number of blocks, including the pending block if it is not empty.
+ * @param parr[in] The packed array.
+ * @return The number of blocks.
+ */
+static size_t parr_block_count(DPackedArrayT* parr);
+
+/**
+ * @brief Decompress into a new dynamic array.
+ * @param parr[in] The packed array.
+ * @return A new dynamic array of uint32_t.
+ */
+static DArrayU32T* parr_to_darr(DPackedArrayT* parr);
+
+/**
+ * @brief Find the first value not less than target in a sorted packed array.
+ *
+ * Binary searches the block headers and decodes a single block.
+ *
+ * @param parr[in] The packed array, sorted ascending.
+ * @param target[in] The value to search.
+ * @return The index of the first value >= target, or the length if there is none.
+ */
+static size_t parr_lower_bound(DPackedArrayT* parr, uint32_t target);
+
+/**
+ * @brief Get the number of values.
+ * @param parr[in] The packed array.
+ * @return The number of values.
+ */
+static size_t parr_length(DPackedArrayT* parr);
+
+/**
+ * @brief Get the memory used by the packed array, headers included.
+ * @param parr[in] The packed array.
+ * @return The number of bytes.
+ */
+static size_t parr_memory_bytes(DPackedArrayT* parr);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static uint64_t parr_load64(const uint8_t* bytes)
+{
+    uint64_t word;
+    CMEMCPY(&word, bytes, sizeof(uint64_t));
+    return word;
+}
+
+inline static uint32_t parr_load32(const uint8_t* bytes)
+{
+    uint32_t word;
+    CMEMCPY(&word, bytes, sizeof(uint32_t));
+    return word;
+}
+
+inline static uint32_t parr_bit_width(uint32_t value)
+{
+    uint32_t width = 0;
+    while (0u != value)
+    {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+inline static BOOL parr_is_delta(DPackedArrayT* parr)
+{
+    return (DPACKED_BITPACK_DELTA == parr->encoding) || (DPACKED_VARINT_DELTA == parr->encoding);
+}
+
+inline static BOOL parr_is_varint(DPackedArrayT* parr)
+{
+    return (DPACKED_VARINT == parr->encoding) || (DPACKED_VARINT_DELTA == parr->encoding);
+}
+
+inline static DPackedBlockT* parr_block(DPackedArrayT* parr, size_t block)
+{
+    return (DPackedBlockT*) darr_get_ptr(parr->blocks, block);
+}
+
+/* Grows the payload by byteCount zeroed bytes, keeping DPACKED_PADDING readable bytes behind it. */
+inline static uint8_t* parr_payload_extend(DPackedArrayT* parr, size_t byteCount)
+{
+    uint8_t* result = NULL;
+    size_t oldLength = parr->payload->length;
+    size_t needed = oldLength + byteCount + DPACKED_PADDING;
+    if (needed > parr->payload->capacity) { darr_reserve(parr->payload, needed * DARRAY_RESIZE_FACTOR); }
+    if (needed <= parr->payload->capacity)
+    {
+        parr->payload->length = oldLength + byteCount;
+        result = (uint8_t*) &parr->payload->data[oldLength];
+        CMEMSET(result, 0, byteCount + DPACKED_PADDING);
+    }
+    else { LOG_ERROR("Can not grow packed array payload!\n"); }
+    return result;
+}
+
+/* StreamVByte tables: per control byte, the shuffle that expands 4 varints to 4 uint32_t and their byte count. */
+typedef struct {
+    uint8_t shuffle[256][16];
+    uint8_t length[256];
+} DPackedVarintTablesT;
+
+/* Builds the tables on first use. One thread claims the build, the others wait for it to be published. */
+inline static DPackedVarintTablesT* parr_varint_tables(void)
+{
+    static DPackedVarintTablesT tables;
+    static uint32_t state = 0; /* 0 empty, 1 building, 2 ready */
+    uint32_t expected = 0;
+    if (2u == CATOMIC_LOAD_ACQUIRE(&state)) {}
+    else if (FALSE == CATOMIC_CAS(&state, &expected, 1u))
+    {
+        while (2u != CATOMIC_LOAD_ACQUIRE(&state)) { CATOMIC_PAUSE(); }
+    }
+    else
+    {
+        for (uint32_t control = 0; control < 256; control++)
+        {
+            uint8_t position = 0;
+            for (uint32_t lane = 0; lane < 4; lane++)
+            {
+                uint32_t bytes = ((control >> (lane * 2)) & 3u) + 1u;
+                for (uint32_t b = 0; b < 4; b++)
+                {
+                    tables.shuffle[control][lane * 4 + b] = (b < bytes) ? (uint8_t) (position + b) : 0xFFu;
+                }
+                position = (uint8_t) (position + bytes);
+            }
+            tables.length[control] = position;
+        }
+        CATOMIC_STORE_RELEASE(&state, 2u);
+    }
+    return &tables;
+}
+
+inline static uint32_t parr_varint_bytes(uint32_t value)
+{
+    return (value < (1u << 8)) ? 1u : ((value < (1u << 16)) ? 2u : ((value < (1u << 24)) ? 3u : 4u));
+}
+
+inline static void parr_encode_block(DPackedArrayT* parr, const uint32_t* values)
+{
+    uint32_t deltas[DPACKED_BLOCK_SIZE];
+    DPackedBlockT header;
+
+    header.first = values[0];
+    header.base = 0;
+    header.bitWidth = 0;
+    header.offset = (uint32_t) parr->payload->length;
+
+    if (TRUE == parr_is_delta(parr))
+    {
+        uint32_t previous = parr->lastEncoded;
+        header.base = previous;
+        for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i++)
+        {
+            deltas[i] = values[i] - previous;
+            previous = values[i];
+        }
+    }
+    else if (DPACKED_BITPACK_FOR == parr->encoding)
+    {
+        uint32_t minimum = values[0];
+        for (size_t i = 1; i < DPACKED_BLOCK_SIZE; i++) { minimum = (values[i] < minimum) ? values[i] : minimum; }
+        header.base = minimum;
+        for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i++) { deltas[i] = values[i] - minimum; }
+    }
+    else { CMEMCPY(deltas, values, sizeof(deltas)); }
+
+    if (TRUE == parr_is_varint(parr))
+    {
+        size_t dataBytes = 0;
+        for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i++) { dataBytes += parr_varint_bytes(deltas[i]); }
+
+        uint8_t* out = parr_payload_extend(parr, DPACKED_BLOCK_SIZE / 4 + dataBytes);
+        if (NULL != out)
+        {
+            uint8_t* data = out + DPACKED_BLOCK_SIZE / 4;
+            for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i++)
+            {
+                uint32_t bytes = parr_varint_bytes(deltas[i]);
+                out[i / 4] |= (uint8_t) ((bytes - 1u) << ((i % 4) * 2));
+                for (uint32_t b = 0; b < bytes; b++) { *data++ = (uint8_t) (deltas[i] >> (b * 8)); }
+            }
+            darr_push_generic(parr->blocks, &header);
+        }
+    }
+    else
+    {
+        uint32_t combined = 0;
+        for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i++) { combined |= deltas[i]; }
+        header.bitWidth = parr_bit_width(combined);
+
+        uint8_t* out = parr_payload_extend(parr, (DPACKED_BLOCK_SIZE / 8) * header.bitWidth);
+        if (NULL != out)
+        {
+            uint64_t accumulator = 0;
+            uint32_t bits = 0;
+            for (size_t i = 0; (i < DPACKED_BLOCK_SIZE) && (header.bitWidth > 0); i++)
+            {
+                accumulator |= ((uint64_t) deltas[i]) << bits;
+                bits += header.bitWidth;
+                while (bits >= 8)
+                {
+                    *out++ = (uint8_t) accumulator;
+                    accumulator >>= 8;
+                    bits -= 8;
+                }
+            }
+            darr_push_generic(parr->blocks, &header);
+        }
+    }
+
+    parr->lastEncoded = values[DPACKED_BLOCK_SIZE - 1];
+}
+
+inline static void parr_unpack_scalar(const uint8_t* payload, uint32_t bitWidth, size_t begin, size_t end,
+                                      uint32_t* out)
+{
+    uint64_t mask = (((uint64_t) 1u) << bitWidth) - 1u;
+    for (size_t i = begin; i < end; i++)
+    {
+        size_t position = i * bitWidth;
+        out[i] = (uint32_t) ((parr_load64(&payload[position >> 3]) >> (position & 7u)) & mask);
+    }
+}
+
+inline static size_t parr_varint_decode_scalar(const uint8_t* control, const uint8_t* data, size_t count,
+                                               uint32_t* out)
+{
+    size_t consumed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t bytes = ((control[i / 4] >> ((i % 4) * 2)) & 3u) + 1u;
+        uint32_t value = parr_load32(&data[consumed]);
+        out[i] = (bytes < 4u) ? (value & ((1u << (bytes * 8)) - 1u)) : value;
+        consumed += bytes;
+    }
+    return consumed;
+}
+
+inline static void parr_prefix_sum_scalar(uint32_t* values, size_t count, uint32_t base)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        base += values[i];
+        values[i] = base;
+    }
+}
+
+#ifdef CUTILS_SIMD_X86
+CPU_TARGET_AVX2 inline static void parr_unpack_avx2(const uint8_t* payload, uint32_t bitWidth, uint32_t* out)
+{
+    /* A 32 bit load at the value's byte offset holds the value whole while shift + width <= 32. */
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i width = _mm256_set1_epi32((int32_t) bitWidth);
+    const __m256i mask = _mm256_set1_epi32((int32_t) ((1u << bitWidth) - 1u));
+    const __m256i seven = _mm256_set1_epi32(7);
+    for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i += 8)
+    {
+        __m256i position = _mm256_mullo_epi32(_mm256_add_epi32(lanes, _mm256_set1_epi32((int32_t) i)), width);
+        __m256i words = _mm256_i32gather_epi32((const int*) payload, _mm256_srli_epi32(position, 3), 1);
+        __m256i values = _mm256_and_si256(_mm256_srlv_epi32(words, _mm256_and_si256(position, seven)), mask);
+        _mm256_storeu_si256((__m256i*) &out[i], values);
+    }
+}
+
+CPU_TARGET_SSE42 inline static size_t parr_varint_decode_ssse3(const uint8_t* control, const uint8_t* data,
+                                                               uint32_t* out)
+{
+    DPackedVarintTablesT* tables = parr_varint_tables();
+    size_t consumed = 0;
+    for (size_t i = 0; i < DPACKED_BLOCK_SIZE / 4; i++)
+    {
+        __m128i shuffle = _mm_loadu_si128((const __m128i*) tables->shuffle[control[i]]);
+        __m128i bytes = _mm_loadu_si128((const __m128i*) &data[consumed]);
+        _mm_storeu_si128((__m128i*) &out[i * 4], _mm_shuffle_epi8(bytes, shuffle));
+        consumed += tables->length[control[i]];
+    }
+    return consumed;
+}
+
+CPU_TARGET_SSE42 inline static void parr_prefix_sum_sse(uint32_t* values, uint32_t base)
+{
+    __m128i carry = _mm_set1_epi32((int32_t) base);
+    for (size_t i = 0; i < DPACKED_BLOCK_SIZE; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*) &values[i]);
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_si128((__m128i*) &values[i], x);
+        carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+}
+#endif
+
+inline static size_t parr_decode_block(DPackedArrayT* parr, size_t block, uint32_t* out)
+{
+    size_t count = 0;
+    size_t fullBlocks = parr->blocks->length;
+
+    if (block < fullBlocks)
+    {
+        DPackedBlockT* header = parr_block(parr, block);
+        const uint8_t* payload = (const uint8_t*) &parr->payload->data[header->offset];
+        BOOL decoded = FALSE;
+        count = DPACKED_BLOCK_SIZE;
+
+        if (TRUE == parr_is_varint(parr))
+        {
+#ifdef CUTILS_SIMD_X86
+            if (cpu_has_feature(CPU_FEATURE_SSE42))
+            {
+                parr_varint_decode_ssse3(payload, payload + DPACKED_BLOCK_SIZE / 4, out);
+                decoded = TRUE;
+            }
+#endif
+            if (FALSE == decoded) { parr_varint_decode_scalar(payload, payload + DPACKED_BLOCK_SIZE / 4, count, out); }
+        }
+        else if (0u == header->bitWidth) { CMEMSET(out, 0, DPACKED_BLOCK_SIZE * sizeof(uint32_t)); }
+        else
+        {
+#ifdef CUTILS_SIMD_X86
+            if ((header->bitWidth <= 25u) && cpu_has_feature(CPU_FEATURE_AVX2))
+            {
+                parr_unpack_avx2(payload, header->bitWidth, out);
+                decoded = TRUE;
+            }
+#endif
+            if (FALSE == decoded) { parr_unpack_scalar(payload, header->bitWidth, 0, count, out); }
+        }
+
+        if (TRUE == parr_is_delta(parr))
+        {
+            decoded = FALSE;
+#ifdef CUTILS_SIMD_X86
+            if (cpu_has_feature(CPU_FEATURE_SSE42))
+            {
+                parr_prefix_sum_sse(out, header->base);
+                decoded = TRUE;
+            }
+#endif
+            if (FALSE == decoded) { parr_prefix_sum_scalar(out, count, header->base); }
+        }
+        else if ((DPACKED_BITPACK_FOR == parr->encoding) && (0u != header->base))
+        {
+            for (size_t i = 0; i < count; i++) { out[i] += header->base; }
+        }
+    }
+    else if ((block == fullBlocks) && (parr->pendingLength > 0))
+    {
+        count = parr->pendingLength;
+        CMEMCPY(out, parr->pending, count * sizeof(uint32_t));
+    }
+
+    return count;
+}
+
+inline static DPackedArrayT* parr_create(DPackedEncodingT encoding)
+{
+    DPackedArrayT* result = (DPackedArrayT*) CMALLOC(sizeof(DPackedArrayT));
+    if (NULL == result) { LOG_ERROR("Can not allocate packed array!\n"); }
+    else
+    {
+        result->length = 0;
+        result->encoding = encoding;
+        result->lastEncoded = 0;
+        result->pendingLength = 0;
+        result->blocks = darr_create_generic(sizeof(DPackedBlockT));
+        result->payload = darr_create_u8();
+        if ((NULL == result->blocks) || (NULL == result->payload))
+        {
+            LOG_ERROR("Can not allocate packed array storage!\n");
+            parr_destroy(result);
+            result = NULL;
+        }
+        else { darr_reserve(result->payload, DPACKED_PADDING); }
+    }
+    return result;
+}
+
+inline static DPackedArrayT* parr_create_from_darr(DArrayU32T* darr, DPackedEncodingT encoding)
+{
+    DPackedArrayT* result = NULL;
+    if (sizeof(uint32_t) != darr->elementSize) { LOG_ERROR("Packed arrays compress uint32_t arrays!\n"); }
+    else
+    {
+        result = parr_create(encoding);
+        if (NULL != result)
+        {
+            const uint32_t* values = (const uint32_t*) darr->data;
+            size_t fullBlocks = darr->length / DPACKED_BLOCK_SIZE;
+            darr_reserve(result->blocks, fullBlocks);
+            for (size_t block = 0; block < fullBlocks; block++)
+            {
+                parr_encode_block(result, &values[block * DPACKED_BLOCK_SIZE]);
+            }
+            result->pendingLength = darr->length - fullBlocks * DPACKED_BLOCK_SIZE;
+            CMEMCPY(result->pending, &values[fullBlocks * DPACKED_BLOCK_SIZE],
+                    result->pendingLength * sizeof(uint32_t));
+            result->length = darr->length;
+        }
+    }
+    return result;
+}
+
+inline static void parr_destroy(DPackedArrayT* parr)
+{
+    if (NULL != parr)
+    {
+        if (NULL != parr->blocks) { darr_destroy(parr->blocks); }
+        if (NULL != parr->payload) { darr_destroy(parr->payload); }
+        CFREE(parr, sizeof(DPackedArrayT));
+    }
+}
+
+inline static void parr_push(DPackedArrayT* parr, uint32_t value)
+{
+    parr->pending[parr->pendingLength++] = value;
+    parr->length++;
+    if (DPACKED_BLOCK_SIZE == parr->pendingLength)
+    {
+        parr_encode_block(parr, parr->pending);
+        parr->pendingLength = 0;
+    }
+}
+
+inline static uint32_t parr_get(DPackedArrayT* parr, size_t index)
+{
+    uint32_t result = 0;
+    size_t block = index / DPACKED_BLOCK_SIZE;
+    size_t position = index % DPACKED_BLOCK_SIZE;
+
+    if (block >= parr->blocks->length) { result = parr->pending[position]; }
+    else
+    {
+        DPackedBlockT* header = parr_block(parr, block);
+        const uint8_t* payload = (const uint8_t*) &parr->payload->data[header->offset];
+
+        if (TRUE == parr_is_delta(parr))
+        {
+            uint32_t values[DPACKED_BLOCK_SIZE];
+            if (TRUE == parr_is_varint(parr))
+            {
+                parr_varint_decode_scalar(payload, payload + DPACKED_BLOCK_SIZE / 4, position + 1, values);
+            }
+            else if (header->bitWidth > 0) { parr_unpack_scalar(payload, header->bitWidth, 0, position + 1, values); }
+            else { CMEMSET(values, 0, (position + 1) * sizeof(uint32_t)); }
+            parr_prefix_sum_scalar(values, position + 1, header->base);
+            result = values[position];
+        }
+        else if (DPACKED_VARINT == parr->encoding)
+        {
+            DPackedVarintTablesT* tables = parr_varint_tables();
+            size_t skipped = 0;
+            for (size_t i = 0; i < position / 4; i++) { skipped += tables->length[payload[i]]; }
+            uint32_t values[4];
+            parr_varint_decode_scalar(&payload[position / 4], payload + DPACKED_BLOCK_SIZE / 4 + skipped,
+                                      position % 4 + 1, values);
+            result = values[position % 4];
+        }
+        else if (header->bitWidth > 0)
+        {
+            uint32_t value = 0;
+            size_t bitPosition = position * header->bitWidth;
+            uint64_t word = parr_load64(&payload[bitPosition >> 3]) >> (bitPosition & 7u);
+            value = (uint32_t) (word & ((((uint64_t) 1u) << header->bitWidth) - 1u));
+            result = value + header->base;
+        }
+        else { result = header->base; }
+    }
+
+    return result;
+}
+
+inline static uint32_t parr_get_safe(DPackedArrayT* parr, size_t index)
+{
+    uint32_t result = 0;
+    if (NULL == parr) {}
+    else if (index < parr->length) { result = parr_get(parr, index); }
+    return result;
+}
+
+inline static size_t parr_block_count(DPackedArrayT* parr)
+{
+    return parr->blocks->length + ((parr->pendingLength > 0) ? 1u : 0u);
+}
+
+inline static DArrayU32T* parr_to_darr(DPackedArrayT* parr)
+{
+    DArrayU32T* result = darr_create_u32();
+    if (NULL != result)
+    {
+        darr_reserve(result, parr->length);
+        darr_resize(result, parr->length);
+        if (result->length == parr->length)
+        {
+            uint32_t* out = (uint32_t*) result->data;
+            size_t blockCount = parr_block_count(parr);
+            for (size_t block = 0; block < blockCount; block++)
+            {
+                parr_decode_block(parr, block, &out[block * DPACKED_BLOCK_SIZE]);
+            }
+        }
+    }
+    return result;
+}
+
+inline static size_t parr_lower_bound(DPackedArrayT* parr, uint32_t target)
+{
+    size_t result = parr->length;
+    size_t low = 0;
+    size_t high = parr->blocks->length;
+
+    /* Find the last full block whose first value is below target; the answer is in it or right after it. */
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (parr_block(parr, mid)->first < target) { low = mid + 1; }
+        else { high = mid; }
+    }
+
+    size_t block = (low > 0) ? (low - 1) : 0;
+    size_t blockCount = parr_block_count(parr);
+    for (BOOL found = FALSE; (FALSE == found) && (block < blockCount); block++)
+    {
+        uint32_t values[DPACKED_BLOCK_SIZE];
+        size_t count = parr_decode_block(parr, block, values);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (values[i] >= target)
+            {
+                result = block * DPACKED_BLOCK_SIZE + i;
+                found = TRUE;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+inline static size_t parr_length(DPackedArrayT* parr) { return parr->length; }
+
+inline static size_t parr_memory_bytes(DPackedArrayT* parr)
+{
+    return sizeof(DPackedArrayT) + parr->blocks->capacity * sizeof(DPackedBlockT) + parr->payload->capacity;
+}
+
+#endif// DPACKED_ARRAY_HEADER
@@ -0,0 +1,547 @@
+#ifndef DRING_BUFFER_HEADER
+#define DRING_BUFFER_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DRingBuffer Header (lock-free single-producer/single-consumer ring buffer)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DRING_BUFFER_SPIN_COUNT
+ * @brief Polls of the other side before a blocking push or pop goes to sleep.
+ */
+#define DRING_BUFFER_SPIN_COUNT 256u
+
+/**
+ * @def DRING_BUFFER_BACKOFF_NS
+ * @brief Sleep between polls of a blocking push or pop on a ring created without blocking support.
+ */
+#define DRING_BUFFER_BACKOFF_NS 50000u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DRingBufferT
+ * @brief A bounded lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * The fields written by the producer and by the consumer live on separate cache
+ * lines. Each side caches the last seen index of the other one and only reads
+ * the shared index when the cached one says the ring is full or empty.
+ *
+ * @var head The next slot to write, written by the producer.
+ * @var cachedTail The tail last seen by the producer.
+ * @var producerWaiting 1 while the producer sleeps on popSignal.
+ * @var pushSignal Futex word bumped by the producer to wake the consumer.
+ * @var tail The next slot to read, written by the consumer.
+ * @var cachedHead The head last seen by the consumer.
+ * @var consumerWaiting 1 while the consumer sleeps on pushSignal.
+ * @var popSignal Futex word bumped by the consumer to wake the producer.
+ * @var capacity The number of slots, a power of two.
+ * @var elementSize The size of each element.
+ * @var blocking TRUE if push and pop wake a sleeping peer.
+ * @var data The slots.
+ */
+typedef struct {
+    int8_t padding0[CATOMIC_CACHE_LINE];
+    size_t head;
+    size_t cachedTail;
+    uint32_t producerWaiting;
+    uint32_t pushSignal;
+    int8_t padding1[CATOMIC_CACHE_LINE];
+    size_t tail;
+    size_t cachedHead;
+    uint32_t consumerWaiting;
+    uint32_t popSignal;
+    int8_t padding2[CATOMIC_CACHE_LINE];
+    size_t capacity;
+    size_t elementSize;
+    BOOL blocking;
+    int8_t* data;
+} DRingBufferT;
+
+/**
+ * @typedef DRingBufferU32T
+ * @brief A ring buffer of uint32_t.
+ */
+typedef DRingBufferT DRingBufferU32T;
+
+/**
+ * @typedef DRingBufferI32T
+ * @brief A ring buffer of int32_t.
+ */
+typedef DRingBufferT DRingBufferI32T;
+
+/**
+ * @typedef DRingBufferU16T
+ * @brief A ring buffer of uint16_t.
+ */
+typedef DRingBufferT DRingBufferU16T;
+
+/**
+ * @typedef DRingBufferI16T
+ * @brief A ring buffer of int16_t.
+ */
+typedef DRingBufferT DRingBufferI16T;
+
+/**
+ * @typedef DRingBufferU8T
+ * @brief A ring buffer of uint8_t.
+ */
+typedef DRingBufferT DRingBufferU8T;
+
+/**
+ * @typedef DRingBufferI8T
+ * @brief A ring buffer of int8_t.
+ */
+typedef DRingBufferT DRingBufferI8T;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a ring buffer.
+ * @param elementSize[in] The size of each element.
+ * @param capacity[in] The minimum number of elements, rounded up to a power of two.
+ * @param blocking[in] TRUE to let ring_push and ring_pop sleep on a futex until the peer wakes them, FALSE to
+ * keep both sides free of wake-up overhead (ring_push and ring_pop then poll).
+ * @return A pointer to the new ring buffer.
+ */
+static DRingBufferT* ring_create_generic(size_t elementSize, size_t capacity, BOOL blocking);
+
+/**
+ * @brief Create a ring buffer of uint32_t.
+ * @param capacity[in] The minimum number of elements.
+ * @param blocking[in] See ring_create_generic.
+ * @return A pointer to the new ring buffer.
+ */
+static DRingBufferU32T* ring_create_u32(size_t capacity, BOOL blocking);
+
+/**
+ * @brief Same as ring_create_u32 for int32_t.
+ */
+static DRingBufferI32T* ring_create_i32(size_t capacity, BOOL blocking);
+
+/**
+ * @brief Same as ring_create_u32 for uint16_t.
+ */
+static DRingBufferU16T* ring_create_u16(size_t capacity, BOOL blocking);
+
+/**
+ * @brief Same as ring_create_u32 for int16_t.
+ */
+static DRingBufferI16T* ring_create_i16(size_t capacity, BOOL blocking);
+
+/**
+ * @brief Same as ring_create_u32 for uint8_t.
+ */
+static DRingBufferU8T* ring_create_u8(size_t capacity, BOOL blocking);
+
+/**
+ * @brief Same as ring_create_u32 for int8_t.
+ */
+static DRingBufferI8T* ring_create_i8(size_t capacity, BOOL blocking);
+
+/**
+ * @brief Destroy a ring buffer. Neither side may use it anymore.
+ * @param ring[in] The ring buffer.
+ */
+static void ring_destroy(DRingBufferT* ring);
+
+/**
+ * @brief Append an element if there is room. Producer only.
+ * @param ring[in] The ring buffer.
+ * @param value[in] Pointer to the element.
+ * @return TRUE if the element was appended, FALSE if the ring is full.
+ */
+static BOOL ring_try_push(DRingBufferT* ring, const void* value);
+
+/**
+ * @brief Remove the oldest element if there is one. Consumer only.
+ * @param ring[in] The ring buffer.
+ * @param value[out] Receives the element.
+ * @return TRUE if an element was removed, FALSE if the ring is empty.
+ */
+static BOOL ring_try_pop(DRingBufferT* ring, void* value);
+
+/**
+ * @brief Append an element, waiting while the ring is full. Producer only.
+ * @param ring[in] The ring buffer.
+ * @param value[in] Pointer to the element.
+ */
+static void ring_push(DRingBufferT* ring, const void* value);
+
+/**
+ * @brief Remove the oldest element, waiting while the ring is empty. Consumer only.
+ * @param ring[in] The ring buffer.
+ * @param value[out] Receives the element.
+ */
+static void ring_pop(DRingBufferT* ring, void* value);
+
+/**
+ * @brief Append as many elements as there is room for, with one index update. Producer only.
+ * @param ring[in] The ring buffer.
+ * @param values[in] The elements.
+ * @param count[in] The number of elements.
+ * @return The number of appended elements, the first ones of values.
+ */
+static size_t ring_push_batch(DRingBufferT* ring, const void* values, size_t count);
+
+/**
+ * @brief Remove up to maxCount of the oldest elements, with one index update. Consumer only.
+ * @param ring[in] The ring buffer.
+ * @param values[out] Receives the elements.
+ * @param maxCount[in] The room in values, in elements.
+ * @return The number of removed elements.
+ */
+static size_t ring_pop_batch(DRingBufferT* ring, void* values, size_t maxCount);
+
+/**
+ * @brief Same as ring_try_push for uint32_t rings.
+ */
+static BOOL ring_try_push_u32(DRingBufferU32T* ring, uint32_t value);
+
+/**
+ * @brief Same as ring_try_push for int32_t rings.
+ */
+static BOOL ring_try_push_i32(DRingBufferI32T* ring, int32_t value);
+
+/**
+ * @brief Same as ring_try_push for uint16_t rings.
+ */
+static BOOL ring_try_push_u16(DRingBufferU16T* ring, uint16_t value);
+
+/**
+ * @brief Same as ring_try_push for int16_t rings.
+ */
+static BOOL ring_try_push_i16(DRingBufferI16T* ring, int16_t value);
+
+/**
+ * @brief Same as ring_try_push for uint8_t rings.
+ */
+static BOOL ring_try_push_u8(DRingBufferU8T* ring, uint8_t value);
+
+/**
+ * @brief Same as ring_try_push for int8_t rings.
+ */
+static BOOL ring_try_push_i8(DRingBufferI8T* ring, int8_t value);
+
+/**
+ * @brief Same as ring_try_pop for uint32_t rings.
+ */
+static BOOL ring_try_pop_u32(DRingBufferU32T* ring, uint32_t* value);
+
+/**
+ * @brief Same as ring_try_pop for int32_t rings.
+ */
+static BOOL ring_try_pop_i32(DRingBufferI32T* ring, int32_t* value);
+
+/**
+ * @brief Same as ring_try_pop for uint16_t rings.
+ */
+static BOOL ring_try_pop_u16(DRingBufferU16T* ring, uint16_t* value);
+
+/**
+ * @brief Same as ring_try_pop for int16_t rings.
+ */
+static BOOL ring_try_pop_i16(DRingBufferI16T* ring, int16_t* value);
+
+/**
+ * @brief Same as ring_try_pop for uint8_t rings.
+ */
+static BOOL ring_try_pop_u8(DRingBufferU8T* ring, uint8_t* value);
+
+/**
+ * @brief Same as ring_try_pop for int8_t rings.
+ */
+static BOOL ring_try_pop_i8(DRingBufferI8T* ring, int8_t* value);
+
+/**
+ * @brief Get the number of elements. Exact from either side when the other one is idle.
+ * @param ring[in] The ring buffer.
+ * @return The number of elements.
+ */
+static size_t ring_length(DRingBufferT* ring);
+
+/**
+ * @brief Get the number of slots.
+ * @param ring[in] The ring buffer.
+ * @return The capacity.
+ */
+static size_t ring_capacity(DRingBufferT* ring);
+
+/**
+ * @brief Check whether the ring buffer is empty.
+ * @param ring[in] The ring buffer.
+ * @return TRUE if there is no element, FALSE otherwise.
+ */
+static BOOL ring_is_empty(DRingBufferT* ring);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DRingBufferT* ring_create_generic(size_t elementSize, size_t capacity, BOOL blocking)
+{
+    DRingBufferT* result = NULL;
+    size_t slots = 2;
+    while (slots < capacity) { slots *= 2; }
+
+    if (0u == elementSize) { LOG_ERROR("Element size can not be 0!\n"); }
+    else if (NULL == (result = (DRingBufferT*) CCALLOC(1, sizeof(DRingBufferT)))) { LOG_ERROR("Can not allocate!\n"); }
+    else
+    {
+        result->capacity = slots;
+        result->elementSize = elementSize;
+        result->blocking = blocking;
+        result->data = (int8_t*) CMALLOC(slots * elementSize);
+        if (NULL == result->data)
+        {
+            LOG_ERROR("Can not allocate ring buffer slots!\n");
+            CFREE(result, sizeof(DRingBufferT));
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+inline static DRingBufferU32T* ring_create_u32(size_t capacity, BOOL blocking)
+{
+    return ring_create_generic(sizeof(uint32_t), capacity, blocking);
+}
+
+inline static DRingBufferI32T* ring_create_i32(size_t capacity, BOOL blocking)
+{
+    return ring_create_generic(sizeof(int32_t), capacity, blocking);
+}
+
+inline static DRingBufferU16T* ring_create_u16(size_t capacity, BOOL blocking)
+{
+    return ring_create_generic(sizeof(uint16_t), capacity, blocking);
+}
+
+inline static DRingBufferI16T* ring_create_i16(size_t capacity, BOOL blocking)
+{
+    return ring_create_generic(sizeof(int16_t), capacity, blocking);
+}
+
+inline static DRingBufferU8T* ring_create_u8(size_t capacity, BOOL blocking)
+{
+    return ring_create_generic(sizeof(uint8_t), capacity, blocking);
+}
+
+inline static DRingBufferI8T* ring_create_i8(size_t capacity, BOOL blocking)
+{
+    return ring_create_generic(sizeof(int8_t), capacity, blocking);
+}
+
+inline static void ring_destroy(DRingBufferT* ring)
+{
+    if (NULL != ring)
+    {
+        CFREE(ring->data, ring->capacity * ring->elementSize);
+        CFREE(ring, sizeof(DRingBufferT));
+    }
+}
+
+/* Wakes the peer if it announced that it sleeps on signal. Pairs with the seq_cst store in ring_sleep. */
+inline static void ring_notify(DRingBufferT* ring, uint32_t* waiting, uint32_t* signal)
+{
+    if (TRUE == ring->blocking)
+    {
+        CATOMIC_FENCE_SEQ_CST();
+        if (0u != CATOMIC_LOAD_RELAXED(waiting))
+        {
+            CATOMIC_FETCH_ADD(signal, 1u);
+            catomic_wake_one(signal);
+        }
+    }
+}
+
+/* Copies count elements between the slots starting at position and a linear buffer, wrapping around. */
+inline static void ring_copy(DRingBufferT* ring, size_t position, void* buffer, size_t count, BOOL toSlots)
+{
+    size_t index = position & (ring->capacity - 1u);
+    size_t first = (count < ring->capacity - index) ? count : ring->capacity - index;
+    int8_t* slots = &ring->data[index * ring->elementSize];
+    int8_t* linear = (int8_t*) buffer;
+    if (TRUE == toSlots)
+    {
+        CMEMCPY(slots, linear, first * ring->elementSize);
+        if (count > first)
+        {
+            CMEMCPY(ring->data, &linear[first * ring->elementSize], (count - first) * ring->elementSize);
+        }
+    }
+    else
+    {
+        CMEMCPY(linear, slots, first * ring->elementSize);
+        if (count > first)
+        {
+            CMEMCPY(&linear[first * ring->elementSize], ring->data, (count - first) * ring->elementSize);
+        }
+    }
+}
+
+inline static size_t ring_push_batch(DRingBufferT* ring, const void* values, size_t count)
+{
+    size_t head = CATOMIC_LOAD_RELAXED(&ring->head);
+    size_t room = ring->capacity - (head - ring->cachedTail);
+    if (room < count)
+    {
+        ring->cachedTail = CATOMIC_LOAD_ACQUIRE(&ring->tail);
+        room = ring->capacity - (head - ring->cachedTail);
+    }
+
+    size_t pushed = (count < room) ? count : room;
+    if (pushed > 0)
+    {
+        ring_copy(ring, head, (void*) values, pushed, TRUE);
+        CATOMIC_STORE_RELEASE(&ring->head, head + pushed);
+        ring_notify(ring, &ring->consumerWaiting, &ring->pushSignal);
+    }
+    return pushed;
+}
+
+inline static size_t ring_pop_batch(DRingBufferT* ring, void* values, size_t maxCount)
+{
+    size_t tail = CATOMIC_LOAD_RELAXED(&ring->tail);
+    size_t available = ring->cachedHead - tail;
+    if (available < maxCount)
+    {
+        ring->cachedHead = CATOMIC_LOAD_ACQUIRE(&ring->head);
+        available = ring->cachedHead - tail;
+    }
+
+    size_t popped = (maxCount < available) ? maxCount : available;
+    if (popped > 0)
+    {
+        ring_copy(ring, tail, values, popped, FALSE);
+        CATOMIC_STORE_RELEASE(&ring->tail, tail + popped);
+        ring_notify(ring, &ring->producerWaiting, &ring->popSignal);
+    }
+    return popped;
+}
+
+inline static BOOL ring_try_push(DRingBufferT* ring, const void* value)
+{
+    return 1u == ring_push_batch(ring, value, 1);
+}
+
+inline static BOOL ring_try_pop(DRingBufferT* ring, void* value) { return 1u == ring_pop_batch(ring, value, 1); }
+
+/* Waits for the peer to move other, the shared index it controls, past stuck: the value that blocks the caller. */
+inline static void ring_sleep(DRingBufferT* ring, size_t* other, size_t stuck, uint32_t* waiting, uint32_t* signal)
+{
+    BOOL ready = FALSE;
+    for (uint32_t spin = 0; (FALSE == ready) && (spin < DRING_BUFFER_SPIN_COUNT); spin++)
+    {
+        CATOMIC_PAUSE();
+        ready = (stuck != CATOMIC_LOAD_ACQUIRE(other)) ? TRUE : FALSE;
+    }
+
+    if (TRUE == ready) {}
+    else if (TRUE == ring->blocking)
+    {
+        uint32_t expected = CATOMIC_LOAD_ACQUIRE(signal);
+        CATOMIC_STORE_SEQ_CST(waiting, 1u);
+        if (stuck == CATOMIC_LOAD_SEQ_CST(other)) { catomic_wait(signal, expected, 0); }
+        CATOMIC_STORE_RELAXED(waiting, 0u);
+    }
+    else { catomic_wait(signal, CATOMIC_LOAD_RELAXED(signal), DRING_BUFFER_BACKOFF_NS); }
+}
+
+inline static void ring_push(DRingBufferT* ring, const void* value)
+{
+    while (FALSE == ring_try_push(ring, value))
+    {
+        ring_sleep(ring, &ring->tail, ring->cachedTail, &ring->producerWaiting, &ring->popSignal);
+    }
+}
+
+inline static void ring_pop(DRingBufferT* ring, void* value)
+{
+    while (FALSE == ring_try_pop(ring, value))
+    {
+        ring_sleep(ring, &ring->head, ring->cachedHead, &ring->consumerWaiting, &ring->pushSignal);
+    }
+}
+
+inline static BOOL ring_try_push_u32(DRingBufferU32T* ring, uint32_t value) { return ring_try_push(ring, &value); }
+
+inline static BOOL ring_try_push_i32(DRingBufferI32T* ring, int32_t value) { return ring_try_push(ring, &value); }
+
+inline static BOOL ring_try_push_u16(DRingBufferU16T* ring, uint16_t value) { return ring_try_push(ring, &value); }
+
+inline static BOOL ring_try_push_i16(DRingBufferI16T* ring, int16_t value) { return ring_try_push(ring, &value); }
+
+inline static BOOL ring_try_push_u8(DRingBufferU8T* ring, uint8_t value) { return ring_try_push(ring, &value); }
+
+inline static BOOL ring_try_push_i8(DRingBufferI8T* ring, int8_t value) { return ring_try_push(ring, &value); }
+
+inline static BOOL ring_try_pop_u32(DRingBufferU32T* ring, uint32_t* value) { return ring_try_pop(ring, value); }
+
+inline static BOOL ring_try_pop_i32(DRingBufferI32T* ring, int32_t* value) { return ring_try_pop(ring, value); }
+
+inline static BOOL ring_try_pop_u16(DRingBufferU16T* ring, uint16_t* value) { return ring_try_pop(ring, value); }
+
+inline static BOOL ring_try_pop_i16(DRingBufferI16T* ring, int16_t* value) { return ring_try_pop(ring, value); }
+
+inline static BOOL ring_try_pop_u8(DRingBufferU8T* ring, uint8_t* value) { return ring_try_pop(ring, value); }
+
+inline static BOOL ring_try_pop_i8(DRingBufferI8T* ring, int8_t* value) { return ring_try_pop(ring, value); }
+
+inline static size_t ring_length(DRingBufferT* ring)
+{
+    size_t tail = CATOMIC_LOAD_ACQUIRE(&ring->tail);
+    return CATOMIC_LOAD_ACQUIRE(&ring->head) - tail;
+}
+
+inline static size_t ring_capacity(DRingBufferT* ring) { return ring->capacity; }
+
+inline static BOOL ring_is_empty(DRingBufferT* ring) { return 0u == ring_length(ring); }
+
+#endif// DRING_BUFFER_HEADER
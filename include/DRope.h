@@ -0,0 +1,583 @@
+#ifndef DROPE_HEADER
+#define DROPE_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DRope Header (balanced tree of text chunks)
+ */
+
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CLog.h"
+#include "CMemory.h"
+#include "CStringView.h"
+#include "DString.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DROPE_CHUNK_SIZE
+ * @brief Bytes of a text chunk. Inserted text is packed into chunks of this size.
+ */
+#define DROPE_CHUNK_SIZE 1024u
+
+/**
+ * @def DROPE_IS_UTF8_CONTINUATION
+ * @brief TRUE if the byte continues a multi-byte UTF-8 sequence, a chunk never starts with one.
+ */
+#define DROPE_IS_UTF8_CONTINUATION(byte) ((0x80 == ((uint8_t) (byte) & 0xC0)) ? TRUE : FALSE)
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DRopeChunkT
+ * @brief Immutable text storage shared by the nodes that view it, its bytes follow the header.
+ * @var refCount The number of nodes and ropes holding the chunk.
+ * @var used The number of bytes written. Bytes below used never change.
+ */
+typedef struct {
+    size_t refCount;
+    size_t used;
+} DRopeChunkT;
+
+/**
+ * @struct DRopeNodeT
+ * @brief A treap node viewing a piece of a chunk, ordered by text position.
+ * @var left The text before the piece.
+ * @var right The text after the piece.
+ * @var chunk The chunk holding the piece.
+ * @var offset The offset of the piece in the chunk.
+ * @var length The length of the piece.
+ * @var size The length of the text of the whole subtree.
+ * @var priority The heap priority, higher than the priorities of the children.
+ * @var refCount The number of parents and ropes holding the node.
+ */
+typedef struct DRopeNode {
+    struct DRopeNode* left;
+    struct DRopeNode* right;
+    DRopeChunkT* chunk;
+    size_t offset;
+    size_t length;
+    size_t size;
+    uint32_t priority;
+    size_t refCount;
+} DRopeNodeT;
+
+/**
+ * @struct DRopeT
+ * @brief Editable text held as a balanced tree of chunk pieces.
+ *
+ * Insert, erase and substring split and merge the tree in O(log n) expected time
+ * instead of moving the tail of a flat buffer. Nodes and chunks are reference
+ * counted and copied only when shared, so a substring shares its text with the
+ * rope it came from. Chunks written by the rope always end on a UTF-8 code point
+ * boundary. Positions are byte offsets and edits are expected at code point
+ * boundaries. A rope is not thread safe, neither are ropes sharing text.
+ *
+ * @var root The tree.
+ * @var tail The chunk receiving inserted text.
+ * @var seed The state of the priority generator.
+ */
+typedef struct {
+    DRopeNodeT* root;
+    DRopeChunkT* tail;
+    uint32_t seed;
+} DRopeT;
+
+/**
+ * @typedef DRopeVisitT
+ * @brief Called by rope_for_each for every piece, in text order.
+ */
+typedef void (*DRopeVisitT)(CStringViewT piece, void* argument);
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create an empty rope.
+ * @return A pointer to the new rope.
+ */
+static DRopeT* rope_create(void);
+
+/**
+ * @brief Create a rope holding a copy of text.
+ * @param text[in] The text.
+ * @return A pointer to the new rope.
+ */
+static DRopeT* rope_create_from(CStringViewT text);
+
+/**
+ * @brief Destroy a rope. Ropes sharing its text are not affected.
+ * @param rope[in] The rope.
+ */
+static void rope_destroy(DRopeT* rope);
+
+/**
+ * @brief Get the length of the text.
+ * @param rope[in] The rope.
+ * @return The length in bytes.
+ */
+static size_t rope_length(DRopeT* rope);
+
+/**
+ * @brief Get a byte of the text in O(log n).
+ * @param rope[in] The rope.
+ * @param index[in] The offset of the byte, smaller than the length.
+ * @return The byte.
+ */
+static int8_t rope_get(DRopeT* rope, size_t index);
+
+/**
+ * @brief Insert a copy of text at a position.
+ * @param rope[in] The rope.
+ * @param index[in] The byte offset, at most the length.
+ * @param text[in] The text to insert.
+ * @return TRUE on success, FALSE on a bad index or allocation failure.
+ */
+static BOOL rope_insert(DRopeT* rope, size_t index, CStringViewT text);
+
+/**
+ * @brief Same as rope_insert at the end of the text.
+ */
+static BOOL rope_append(DRopeT* rope, CStringViewT text);
+
+/**
+ * @brief Erase a range of the text.
+ * @param rope[in] The rope.
+ * @param index[in] The byte offset of the range.
+ * @param count[in] The length of the range, clamped to the end of the text.
+ * @return TRUE on success, FALSE on a bad index or allocation failure.
+ */
+static BOOL rope_erase(DRopeT* rope, size_t index, size_t count);
+
+/**
+ * @brief Create a rope holding a range of the text, sharing it with the source.
+ * @param rope[in] The rope.
+ * @param index[in] The byte offset of the range.
+ * @param count[in] The length of the range, clamped to the end of the text.
+ * @return A pointer to the new rope, NULL on a bad index or allocation failure.
+ */
+static DRopeT* rope_substring(DRopeT* rope, size_t index, size_t count);
+
+/**
+ * @brief Call visit for every piece of the text, in order.
+ * @param rope[in] The rope.
+ * @param visit[in] The callback. It must not update the rope.
+ * @param argument[in] The argument passed to visit.
+ */
+static void rope_for_each(DRopeT* rope, DRopeVisitT visit, void* argument);
+
+/**
+ * @brief Copy the text into a new dynamic string.
+ * @param rope[in] The rope.
+ * @return A pointer to the new string.
+ */
+static DStringT* rope_to_dstring(DRopeT* rope);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static int8_t* rope_chunk_data(DRopeChunkT* chunk) { return (int8_t*) (chunk + 1); }
+
+inline static DRopeChunkT* rope_chunk_create(void)
+{
+    DRopeChunkT* chunk = (DRopeChunkT*) CMALLOC(sizeof(DRopeChunkT) + DROPE_CHUNK_SIZE);
+    if (NULL == chunk) { LOG_ERROR("Can not allocate rope chunk!\n"); }
+    else
+    {
+        chunk->refCount = 1;
+        chunk->used = 0;
+    }
+    return chunk;
+}
+
+inline static void rope_chunk_release(DRopeChunkT* chunk)
+{
+    if ((NULL != chunk) && (0u == --chunk->refCount)) { CFREE(chunk, sizeof(DRopeChunkT) + DROPE_CHUNK_SIZE); }
+}
+
+inline static size_t rope_node_size(DRopeNodeT* node) { return (NULL == node) ? 0u : node->size; }
+
+inline static void rope_node_update(DRopeNodeT* node)
+{
+    node->size = rope_node_size(node->left) + node->length + rope_node_size(node->right);
+}
+
+inline static void rope_node_release(DRopeNodeT* node)
+{
+    if ((NULL != node) && (0u == --node->refCount))
+    {
+        rope_node_release(node->left);
+        rope_node_release(node->right);
+        rope_chunk_release(node->chunk);
+        CFREE(node, sizeof(DRopeNodeT));
+    }
+}
+
+inline static DRopeNodeT* rope_node_create(DRopeChunkT* chunk, size_t offset, size_t length, uint32_t priority)
+{
+    DRopeNodeT* node = (DRopeNodeT*) CMALLOC(sizeof(DRopeNodeT));
+    if (NULL == node) { LOG_ERROR("Can not allocate rope node!\n"); }
+    else
+    {
+        node->left = NULL;
+        node->right = NULL;
+        node->chunk = chunk;
+        node->offset = offset;
+        node->length = length;
+        node->size = length;
+        node->priority = priority;
+        node->refCount = 1;
+        chunk->refCount++;
+    }
+    return node;
+}
+
+/* Takes over a reference to node and returns a node the caller may change, a copy if node is shared. */
+inline static DRopeNodeT* rope_node_own(DRopeNodeT* node)
+{
+    DRopeNodeT* result = node;
+    if (1u != node->refCount)
+    {
+        result = rope_node_create(node->chunk, node->offset, node->length, node->priority);
+        if (NULL != result)
+        {
+            result->left = node->left;
+            result->right = node->right;
+            result->size = node->size;
+            if (NULL != result->left) { result->left->refCount++; }
+            if (NULL != result->right) { result->right->refCount++; }
+        }
+        rope_node_release(node);
+    }
+    return result;
+}
+
+/* Treap priorities, xorshift32. */
+inline static uint32_t rope_next_priority(DRopeT* rope)
+{
+    rope->seed ^= rope->seed << 13;
+    rope->seed ^= rope->seed >> 17;
+    rope->seed ^= rope->seed << 5;
+    return rope->seed;
+}
+
+/*
+ * Splits a tree, taking over the reference to it, into its first index bytes and the rest.
+ * On allocation failure ok is cleared and the pieces no longer add up to the tree.
+ */
+inline static void rope_node_split(DRopeNodeT* node, size_t index, DRopeNodeT** left, DRopeNodeT** right, BOOL* ok)
+{
+    *left = NULL;
+    *right = NULL;
+    if (NULL == node) {}
+    else if (0u == index) { *right = node; }
+    else if (node->size <= index) { *left = node; }
+    else if (NULL == (node = rope_node_own(node))) { *ok = FALSE; }
+    else
+    {
+        size_t before = rope_node_size(node->left);
+        if (index <= before)
+        {
+            rope_node_split(node->left, index, left, &node->left, ok);
+            *right = node;
+        }
+        else if (index >= before + node->length)
+        {
+            rope_node_split(node->right, index - before - node->length, &node->right, right, ok);
+            *left = node;
+        }
+        else
+        {
+            /* The cut falls inside the piece, the second half keeps the priority and takes the right subtree. */
+            size_t cut = index - before;
+            *left = node;
+            *right = rope_node_create(node->chunk, node->offset + cut, node->length - cut, node->priority);
+            if (NULL == *right) { *ok = FALSE; }
+            else
+            {
+                (*right)->right = node->right;
+                rope_node_update(*right);
+                node->right = NULL;
+                node->length = cut;
+            }
+        }
+        rope_node_update(node);
+    }
+}
+
+/* Joins two trees, taking over the references to them. On allocation failure ok is cleared and text is lost. */
+inline static DRopeNodeT* rope_node_merge(DRopeNodeT* left, DRopeNodeT* right, BOOL* ok)
+{
+    DRopeNodeT* result = NULL;
+    if (NULL == left) { result = right; }
+    else if (NULL == right) { result = left; }
+    else if (left->priority > right->priority)
+    {
+        result = rope_node_own(left);
+        if (NULL == result)
+        {
+            *ok = FALSE;
+            result = right;
+        }
+        else
+        {
+            result->right = rope_node_merge(result->right, right, ok);
+            rope_node_update(result);
+        }
+    }
+    else
+    {
+        result = rope_node_own(right);
+        if (NULL == result)
+        {
+            *ok = FALSE;
+            result = left;
+        }
+        else
+        {
+            result->left = rope_node_merge(left, result->left, ok);
+            rope_node_update(result);
+        }
+    }
+    return result;
+}
+
+/* Copies text into the tail chunk, starting a new chunk where it is full, and returns the tree of the pieces. */
+inline static DRopeNodeT* rope_node_build(DRopeT* rope, CStringViewT text, BOOL* ok)
+{
+    DRopeNodeT* result = NULL;
+    size_t position = 0;
+    while ((position < text.length) && (TRUE == *ok))
+    {
+        size_t count = text.length - position;
+        size_t space = (NULL == rope->tail) ? 0u : DROPE_CHUNK_SIZE - rope->tail->used;
+        if (count > space)
+        {
+            /* End the piece on a code point boundary, a sequence is at most four bytes long. */
+            count = space;
+            for (uint32_t i = 0; (i < 3u) && (0u != count) && (DROPE_IS_UTF8_CONTINUATION(text.data[position + count]));
+                 i++)
+            {
+                count--;
+            }
+        }
+
+        if (0u == count)
+        {
+            DRopeChunkT* chunk = rope_chunk_create();
+            if (NULL == chunk) { *ok = FALSE; }
+            else
+            {
+                rope_chunk_release(rope->tail);
+                rope->tail = chunk;
+            }
+        }
+        else
+        {
+            DRopeNodeT* node = rope_node_create(rope->tail, rope->tail->used, count, rope_next_priority(rope));
+            if (NULL == node) { *ok = FALSE; }
+            else
+            {
+                CMEMCPY(rope_chunk_data(rope->tail) + rope->tail->used, text.data + position, count);
+                rope->tail->used += count;
+                position += count;
+                result = rope_node_merge(result, node, ok);
+            }
+        }
+    }
+    return result;
+}
+
+inline static void rope_node_visit(DRopeNodeT* node, DRopeVisitT visit, void* argument)
+{
+    if (NULL != node)
+    {
+        rope_node_visit(node->left, visit, argument);
+        CStringViewT piece = {rope_chunk_data(node->chunk) + node->offset, node->length};
+        visit(piece, argument);
+        rope_node_visit(node->right, visit, argument);
+    }
+}
+
+inline static void rope_copy_piece(CStringViewT piece, void* argument)
+{
+    int8_t** cursor = (int8_t**) argument;
+    CMEMCPY(*cursor, piece.data, piece.length);
+    *cursor += piece.length;
+}
+
+inline static DRopeT* rope_create(void)
+{
+    DRopeT* rope = (DRopeT*) CCALLOC(1, sizeof(DRopeT));
+    if (NULL == rope) { LOG_ERROR("Can not allocate!\n"); }
+    else { rope->seed = 0x9E3779B9u; }
+    return rope;
+}
+
+inline static DRopeT* rope_create_from(CStringViewT text)
+{
+    DRopeT* rope = rope_create();
+    if ((NULL != rope) && (FALSE == rope_insert(rope, 0, text)))
+    {
+        rope_destroy(rope);
+        rope = NULL;
+    }
+    return rope;
+}
+
+inline static void rope_destroy(DRopeT* rope)
+{
+    if (NULL != rope)
+    {
+        rope_node_release(rope->root);
+        rope_chunk_release(rope->tail);
+        CFREE(rope, sizeof(DRopeT));
+    }
+}
+
+inline static size_t rope_length(DRopeT* rope) { return rope_node_size(rope->root); }
+
+inline static int8_t rope_get(DRopeT* rope, size_t index)
+{
+    DRopeNodeT* node = rope->root;
+    int8_t result = 0;
+    while (NULL != node)
+    {
+        size_t before = rope_node_size(node->left);
+        if (index < before) { node = node->left; }
+        else if (index < before + node->length)
+        {
+            result = rope_chunk_data(node->chunk)[node->offset + index - before];
+            node = NULL;
+        }
+        else
+        {
+            index -= before + node->length;
+            node = node->right;
+        }
+    }
+    return result;
+}
+
+inline static BOOL rope_insert(DRopeT* rope, size_t index, CStringViewT text)
+{
+    BOOL result = TRUE;
+    if (index > rope_length(rope))
+    {
+        LOG_ERROR("Index out of range!\n");
+        result = FALSE;
+    }
+    else if (0u != text.length)
+    {
+        DRopeNodeT* left = NULL;
+        DRopeNodeT* right = NULL;
+        rope_node_split(rope->root, index, &left, &right, &result);
+        DRopeNodeT* middle = rope_node_build(rope, text, &result);
+        rope->root = rope_node_merge(rope_node_merge(left, middle, &result), right, &result);
+    }
+    return result;
+}
+
+inline static BOOL rope_append(DRopeT* rope, CStringViewT text) { return rope_insert(rope, rope_length(rope), text); }
+
+inline static BOOL rope_erase(DRopeT* rope, size_t index, size_t count)
+{
+    BOOL result = TRUE;
+    if (index > rope_length(rope))
+    {
+        LOG_ERROR("Index out of range!\n");
+        result = FALSE;
+    }
+    else if (0u != count)
+    {
+        DRopeNodeT* left = NULL;
+        DRopeNodeT* middle = NULL;
+        DRopeNodeT* right = NULL;
+        rope_node_split(rope->root, index, &left, &right, &result);
+        rope_node_split(right, count, &middle, &right, &result);
+        rope_node_release(middle);
+        rope->root = rope_node_merge(left, right, &result);
+    }
+    return result;
+}
+
+inline static DRopeT* rope_substring(DRopeT* rope, size_t index, size_t count)
+{
+    DRopeT* result = NULL;
+    if (index > rope_length(rope)) { LOG_ERROR("Index out of range!\n"); }
+    else if ((NULL != (result = rope_create())) && (0u != count) && (NULL != rope->root))
+    {
+        /* The source keeps its reference, so every node on the split paths is copied rather than changed. */
+        DRopeNodeT* left = NULL;
+        DRopeNodeT* right = NULL;
+        BOOL ok = TRUE;
+        rope->root->refCount++;
+        rope_node_split(rope->root, index, &left, &right, &ok);
+        rope_node_release(left);
+        rope_node_split(right, count, &result->root, &right, &ok);
+        rope_node_release(right);
+        if (FALSE == ok)
+        {
+            rope_destroy(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+inline static void rope_for_each(DRopeT* rope, DRopeVisitT visit, void* argument)
+{
+    rope_node_visit(rope->root, visit, argument);
+}
+
+inline static DStringT* rope_to_dstring(DRopeT* rope)
+{
+    DStringT* result = str_create_empty(rope_length(rope));
+    if (NULL != result)
+    {
+        int8_t* cursor = result->data;
+        rope_for_each(rope, rope_copy_piece, &cursor);
+    }
+    return result;
+}
+
+#endif// DROPE_HEADER
@@ -0,0 +1,435 @@
+#ifndef DSHARED_ARRAY_HEADER
+#define DSHARED_ARRAY_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DSharedArray Header (dynamic arrays in POSIX shared memory with seqlock snapshots)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CAtomic.h"
+#include "CFilesystem.h"
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DSHARED_ARRAY_MAGIC
+ * @brief Magic of shared array segments.
+ */
+#define DSHARED_ARRAY_MAGIC "CUSHMARR"
+
+/**
+ * @def DSHARED_ARRAY_VERSION
+ * @brief Version of the segment layout, segments of other versions are rejected.
+ */
+#define DSHARED_ARRAY_VERSION 1u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DSharedArrayHeaderT
+ * @brief The first 64 bytes of a shared array segment, the elements follow.
+ *
+ * @var magic DSHARED_ARRAY_MAGIC, not null terminated.
+ * @var version DSHARED_ARRAY_VERSION.
+ * @var headerSize sizeof(DSharedArrayHeaderT).
+ * @var elementSize The element size.
+ * @var capacity The number of elements the segment holds, it only grows.
+ * @var length The published number of elements.
+ * @var sequence Seqlock counter, odd while the writer modifies published elements.
+ */
+typedef struct {
+    int8_t magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t elementSize;
+    uint64_t capacity;
+    uint64_t length;
+    uint64_t sequence;
+    uint64_t reserved[2];
+} DSharedArrayHeaderT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a shared array segment and return its writer.
+ *
+ * The writer is a regular dynamic array, growing it grows the segment. Its
+ * elements become visible to readers with darr_shared_publish or
+ * darr_shared_write_end. There must be one writer per segment.
+ *
+ * @param name[in] POSIX shared memory name, e.g. "/events". It must not exist yet, see darr_shared_unlink.
+ * @param elementSize[in] The element size.
+ * @param capacity[in] The initial capacity in elements.
+ * @return A pointer to the writer, or NULL on error.
+ */
+static DArrayT* darr_shared_create(const int8_t* name, size_t elementSize, size_t capacity);
+
+/**
+ * @brief Open a shared array segment for reading.
+ *
+ * The reader is a read-only dynamic array. It is empty until
+ * darr_shared_read_begin takes a snapshot, its capacity is the length of the
+ * snapshot so pushing to it fails.
+ *
+ * @param name[in] POSIX shared memory name.
+ * @return A pointer to the reader, or NULL on error.
+ */
+static DArrayT* darr_shared_open(const int8_t* name);
+
+/**
+ * @brief Publish the length of the writer.
+ *
+ * Enough for append-only use: published elements are not modified.
+ *
+ * @param darr[in] The writer.
+ */
+static void darr_shared_publish(DArrayT* darr);
+
+/**
+ * @brief Start modifying published elements, readers of the modified snapshot retry.
+ * @param darr[in] The writer.
+ */
+static void darr_shared_write_begin(DArrayT* darr);
+
+/**
+ * @brief Finish modifying published elements and publish the length.
+ * @param darr[in] The writer.
+ */
+static void darr_shared_write_end(DArrayT* darr);
+
+/**
+ * @brief Take a snapshot: point the reader at the published elements.
+ *
+ * Waits while the writer is inside darr_shared_write_begin/end. Read the
+ * elements in place, then call darr_shared_read_retry.
+ *
+ * @param darr[in] The reader.
+ * @return The sequence of the snapshot.
+ */
+static uint64_t darr_shared_read_begin(DArrayT* darr);
+
+/**
+ * @brief Check whether the writer modified the snapshot while it was read.
+ * @param darr[in] The reader.
+ * @param sequence[in] The value returned by darr_shared_read_begin.
+ * @return TRUE if the elements read may be inconsistent and must be read again, FALSE otherwise.
+ */
+static BOOL darr_shared_read_retry(DArrayT* darr, uint64_t sequence);
+
+/**
+ * @brief Remove a shared array segment name, mapped segments stay valid until destroyed.
+ * @param name[in] POSIX shared memory name.
+ */
+static void darr_shared_unlink(const int8_t* name);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static DSharedArrayHeaderT* darr_shared_header(DArrayT* darr)
+{
+    return (DSharedArrayHeaderT*) ((FileMappingT*) darr->storageContext)->data;
+}
+
+inline static size_t darr_shared_size(size_t elementSize, size_t capacity)
+{
+    return sizeof(DSharedArrayHeaderT) + elementSize * capacity;
+}
+
+inline static void darr_shared_attach(DArrayT* darr, size_t capacity)
+{
+    darr->data = ((FileMappingT*) darr->storageContext)->data + sizeof(DSharedArrayHeaderT);
+    darr->capacity = capacity;
+}
+
+/* The number of elements the mapping covers, readers keep their capacity at the snapshot length. */
+inline static size_t darr_shared_mapped(DArrayT* darr)
+{
+    return (((FileMappingT*) darr->storageContext)->size - sizeof(DSharedArrayHeaderT)) / darr->elementSize;
+}
+
+inline static void darr_shared_release(DArrayT* darr)
+{
+    FileMappingT* mapping = (FileMappingT*) darr->storageContext;
+    file_unmap(mapping);
+    CFREE(mapping, sizeof(FileMappingT));
+}
+
+inline static BOOL darr_shared_reserve(DArrayT* darr, size_t newCapacity)
+{
+    BOOL result = FALSE;
+    FileMappingT* mapping = (FileMappingT*) darr->storageContext;
+    if (FILE_OPERATION_SUCCESS == file_map_resize(mapping, darr_shared_size(darr->elementSize, newCapacity)))
+    {
+        darr_shared_attach(darr, newCapacity);
+        /* Readers remap once they see the new capacity, the segment is already large enough. */
+        __atomic_store_n(&darr_shared_header(darr)->capacity, (uint64_t) newCapacity, __ATOMIC_RELEASE);
+        result = TRUE;
+    }
+    else
+    {
+        LOG_ERROR("Lost the mapping of a shared dynamic array!\n");
+        darr->data = NULL;
+        darr->capacity = 0;
+        darr->length = 0;
+    }
+    return result;
+}
+
+static const DArrayStorageT darr_shared_writer_storage = {darr_shared_reserve, darr_shared_release, NULL};
+
+static const DArrayStorageT darr_shared_reader_storage = {NULL, darr_shared_release, NULL};
+
+#ifndef _WIN32
+inline static DArrayT* darr_shared_create(const int8_t* name, size_t elementSize, size_t capacity)
+{
+    DArrayT* result = NULL;
+    FileMappingT* mapping = (FileMappingT*) CMALLOC(sizeof(FileMappingT));
+    int32_t fd = -1;
+
+    if (0u == elementSize) { LOG_ERROR("Element size can not be 0!\n"); }
+    else if (NULL == mapping) { LOG_ERROR("Can not allocate shared memory mapping!\n"); }
+    else if ((fd = shm_open((const char*) name, O_CREAT | O_EXCL | O_RDWR, 0600)) < 0)
+    {
+        /* Truncating a segment readers still map would crash them, so it is never reused. */
+        LOG_ERROR("Can not create shared memory %s, it may already exist!\n", name);
+    }
+    else
+    {
+        mapping->data = NULL;
+        mapping->size = 0;
+        mapping->writable = TRUE;
+        mapping->handle = fd;
+        mapping->mappingHandle = 0;
+        if (FILE_OPERATION_SUCCESS == file_map_resize(mapping, darr_shared_size(elementSize, capacity)))
+        {
+            result = (DArrayT*) CMALLOC(sizeof(DArrayT));
+        }
+    }
+
+    if (NULL != result)
+    {
+        DSharedArrayHeaderT* header = (DSharedArrayHeaderT*) mapping->data;
+        CMEMSET(header, 0, sizeof(DSharedArrayHeaderT));
+        header->version = DSHARED_ARRAY_VERSION;
+        header->headerSize = sizeof(DSharedArrayHeaderT);
+        header->elementSize = elementSize;
+        header->capacity = capacity;
+        /* The magic goes last, a reader opening the segment meanwhile rejects it. */
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        CMEMCPY(header->magic, DSHARED_ARRAY_MAGIC, sizeof(header->magic));
+
+        result->length = 0;
+        result->elementSize = elementSize;
+        result->storage = &darr_shared_writer_storage;
+        result->storageContext = mapping;
+        darr_shared_attach(result, capacity);
+    }
+    else if (NULL != mapping)
+    {
+        if (fd >= 0)
+        {
+            file_unmap(mapping);
+            shm_unlink((const char*) name);
+        }
+        CFREE(mapping, sizeof(FileMappingT));
+    }
+    return result;
+}
+
+inline static DArrayT* darr_shared_open(const int8_t* name)
+{
+    DArrayT* result = NULL;
+    FileMappingT* mapping = (FileMappingT*) CMALLOC(sizeof(FileMappingT));
+    int32_t fd = -1;
+    DSharedArrayHeaderT* header = NULL;
+
+    if (NULL == mapping) { LOG_ERROR("Can not allocate shared memory mapping!\n"); }
+    else if ((fd = shm_open((const char*) name, O_RDONLY, 0)) < 0)
+    {
+        LOG_ERROR("Can not open shared memory %s!\n", name);
+    }
+    else
+    {
+        void* address = mmap(NULL, sizeof(DSharedArrayHeaderT), PROT_READ, MAP_SHARED, fd, 0);
+        header = (MAP_FAILED == address) ? NULL : (DSharedArrayHeaderT*) address;
+        mapping->data = (int8_t*) header;
+        mapping->size = sizeof(DSharedArrayHeaderT);
+        mapping->writable = FALSE;
+        mapping->handle = fd;
+        mapping->mappingHandle = 0;
+    }
+
+    if (NULL == header) {}
+    else if ((0 != memcmp(header->magic, DSHARED_ARRAY_MAGIC, sizeof(header->magic))) ||
+             (DSHARED_ARRAY_VERSION != header->version) || (sizeof(DSharedArrayHeaderT) != header->headerSize) ||
+             (0u == header->elementSize))
+    {
+        LOG_ERROR("%s is not a shared dynamic array!\n", name);
+    }
+    else if (NULL == (result = (DArrayT*) CMALLOC(sizeof(DArrayT))))
+    {
+        LOG_ERROR("Can not allocate dynamic darray!\n");
+    }
+    else
+    {
+        result->length = 0;
+        result->elementSize = (size_t) header->elementSize;
+        result->storage = &darr_shared_reader_storage;
+        result->storageContext = mapping;
+        darr_shared_attach(result, 0);
+    }
+
+    if ((NULL == result) && (NULL != mapping))
+    {
+        if (fd >= 0) { file_unmap(mapping); }
+        CFREE(mapping, sizeof(FileMappingT));
+    }
+    return result;
+}
+
+inline static void darr_shared_unlink(const int8_t* name) { shm_unlink((const char*) name); }
+
+/* Maps the reader over the capacity published by the writer. */
+inline static void darr_shared_remap(DArrayT* darr, size_t capacity)
+{
+    FileMappingT* mapping = (FileMappingT*) darr->storageContext;
+    size_t size = darr_shared_size(darr->elementSize, capacity);
+    void* address = mmap(NULL, size, PROT_READ, MAP_SHARED, (int32_t) mapping->handle, 0);
+    if (MAP_FAILED == address) { LOG_ERROR("Can not map shared dynamic array!\n"); }
+    else
+    {
+        munmap(mapping->data, mapping->size);
+        mapping->data = (int8_t*) address;
+        mapping->size = size;
+        darr_shared_attach(darr, capacity);
+    }
+}
+#else
+inline static DArrayT* darr_shared_create(const int8_t* name, size_t elementSize, size_t capacity)
+{
+    (void) name;
+    (void) elementSize;
+    (void) capacity;
+    LOG_ERROR("Shared dynamic arrays need POSIX shared memory!\n");
+    return NULL;
+}
+
+inline static DArrayT* darr_shared_open(const int8_t* name)
+{
+    (void) name;
+    LOG_ERROR("Shared dynamic arrays need POSIX shared memory!\n");
+    return NULL;
+}
+
+inline static void darr_shared_unlink(const int8_t* name) { (void) name; }
+
+inline static void darr_shared_remap(DArrayT* darr, size_t capacity)
+{
+    (void) darr;
+    (void) capacity;
+}
+#endif
+
+inline static void darr_shared_write_begin(DArrayT* darr)
+{
+    DSharedArrayHeaderT* header = darr_shared_header(darr);
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, sequence + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+inline static void darr_shared_write_end(DArrayT* darr)
+{
+    DSharedArrayHeaderT* header = darr_shared_header(darr);
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->length, (uint64_t) darr->length, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->sequence, sequence + 1u, __ATOMIC_RELEASE);
+}
+
+inline static void darr_shared_publish(DArrayT* darr)
+{
+    darr_shared_write_begin(darr);
+    darr_shared_write_end(darr);
+}
+
+inline static uint64_t darr_shared_read_begin(DArrayT* darr)
+{
+    DSharedArrayHeaderT* header = darr_shared_header(darr);
+    uint64_t sequence = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+    while (0u != (sequence & 1u))
+    {
+        CATOMIC_PAUSE();
+        sequence = __atomic_load_n(&header->sequence, __ATOMIC_ACQUIRE);
+    }
+
+    size_t capacity = (size_t) __atomic_load_n(&header->capacity, __ATOMIC_ACQUIRE);
+    if (capacity > darr_shared_mapped(darr))
+    {
+        darr_shared_remap(darr, capacity);
+        header = darr_shared_header(darr);
+    }
+
+    size_t length = (size_t) __atomic_load_n(&header->length, __ATOMIC_RELAXED);
+    size_t mapped = darr_shared_mapped(darr);
+    darr->length = (length <= mapped) ? length : mapped;
+    darr->capacity = darr->length;
+    return sequence;
+
+}
+
+inline static BOOL darr_shared_read_retry(DArrayT* darr, uint64_t sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (__atomic_load_n(&darr_shared_header(darr)->sequence, __ATOMIC_RELAXED) != sequence) ? TRUE : FALSE;
+}
+
+#endif// DSHARED_ARRAY_HEADER
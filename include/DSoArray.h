@@ -0,0 +1,447 @@
+#ifndef DSOARRAY_HEADER
+#define DSOARRAY_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * DSoArray Header (structure of arrays container)
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CLog.h"
+#include "CMemory.h"
+#include "DArray.h"
+#include "STDTypes.h"
+/***********************************************************************************************************************
+Macro Definitions
+***********************************************************************************************************************/
+
+/**
+ * @def DSOARRAY_MAX_FIELDS
+ * @brief The maximum number of fields (columns) in a record schema.
+ */
+#define DSOARRAY_MAX_FIELDS 32u
+
+/**
+ * @def DSOARRAY_INITIAL_CAPACITY
+ * @brief The initial capacity (in records) of a structure of arrays.
+ */
+#define DSOARRAY_INITIAL_CAPACITY 1u
+
+/**
+ * @def DSOARRAY_RESIZE_FACTOR
+ * @brief The resize factor of a structure of arrays.
+ */
+#define DSOARRAY_RESIZE_FACTOR 2u
+
+/**
+ * @def DSOARRAY_COLUMN_ALIGNMENT
+ * @brief Alignment in bytes of every column. Cache line sized so column scans never share lines.
+ */
+#define DSOARRAY_COLUMN_ALIGNMENT 64u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @struct DSoArrayT
+ * @brief A dynamic structure of arrays.
+ *
+ * Every field of the record schema is stored in its own contiguous column, so a
+ * scan over one field only touches the memory of that field. All columns share
+ * one length and capacity and live in a single allocation.
+ *
+ * @var length The number of records.
+ * @var capacity The maximum number of records that fit without reallocation.
+ * @var fieldCount The number of fields in the record schema.
+ * @var fieldSizes The size in bytes of each field.
+ * @var columns Pointer to the first element of each column.
+ * @var block The allocated memory block holding all columns.
+ */
+typedef struct {
+    size_t length;
+    size_t capacity;
+    size_t fieldCount;
+    size_t fieldSizes[DSOARRAY_MAX_FIELDS];
+    int8_t* columns[DSOARRAY_MAX_FIELDS];
+    int8_t* block;
+} DSoArrayT;
+
+/***********************************************************************************************************************
+Static functions declaration
+***********************************************************************************************************************/
+
+/**
+ * @brief Create a structure of arrays from a record schema.
+ * @param fieldSizes[in] The size in bytes of each field.
+ * @param fieldCount[in] The number of fields, at most DSOARRAY_MAX_FIELDS.
+ * @return A pointer to the new structure of arrays, or NULL on invalid schema or allocation failure.
+ */
+static DSoArrayT* soa_create(const size_t* fieldSizes, size_t fieldCount);
+
+/**
+ * @brief Destroy a structure of arrays.
+ * @param soa[in] The structure of arrays to destroy.
+ */
+static void soa_destroy(DSoArrayT* soa);
+
+/**
+ * @brief Push a new record to the end of the structure of arrays.
+ * @param soa[in] The structure of arrays.
+ * @param fieldValues[in] One pointer per field to the value to copy. A NULL
+ * array or a NULL entry zero-fills the corresponding field.
+ */
+static void soa_push(DSoArrayT* soa, const void* const* fieldValues);
+
+/**
+ * @brief Get a pointer to a field of a record.
+ * @param soa[in] The structure of arrays.
+ * @param field[in] The field index.
+ * @param index[in] The record index.
+ * @return A pointer to the field value.
+ */
+static void* soa_get_ptr(DSoArrayT* soa, size_t field, size_t index);
+
+/**
+ * @brief Get a pointer to a field of a record, safely.
+ *
+ * This function is like soa_get_ptr, but it will return NULL if the field or
+ * the record index is out of bounds.
+ *
+ * @param soa[in] The structure of arrays.
+ * @param field[in] The field index.
+ * @param index[in] The record index.
+ * @return A pointer to the field value, or NULL if out of bounds.
+ */
+static void* soa_get_ptr_safe(DSoArrayT* soa, size_t field, size_t index);
+
+/**
+ * @brief Get a pointer to the first element of a column.
+ * @param soa[in] The structure of arrays.
+ * @param field[in] The field index.
+ * @return A pointer to the column, aligned to DSOARRAY_COLUMN_ALIGNMENT.
+ */
+static void* soa_column(DSoArrayT* soa, size_t field);
+
+/**
+ * @brief Copy every field of a record out of the structure of arrays.
+ * @param soa[in] The structure of arrays.
+ * @param index[in] The record index.
+ * @param fieldValues[out] One destination pointer per field. NULL entries are skipped.
+ */
+static void soa_get_record(DSoArrayT* soa, size_t index, void* const* fieldValues);
+
+/**
+ * @brief Overwrite a field of a record.
+ * @param soa[in] The structure of arrays.
+ * @param field[in] The field index.
+ * @param index[in] The record index.
+ * @param value[in] Pointer to the new value.
+ */
+static void soa_set(DSoArrayT* soa, size_t field, size_t index, const void* value);
+
+/**
+ * @brief Erase a record, shifting the following records in every column.
+ * @param soa[in] The structure of arrays.
+ * @param index[in] The record index.
+ */
+static void soa_erase(DSoArrayT* soa, size_t index);
+
+/**
+ * @brief Erase a record, safely.
+ *
+ * This function is like soa_erase, but it will do nothing if the index is out
+ * of bounds.
+ *
+ * @param soa[in] The structure of arrays.
+ * @param index[in] The record index.
+ */
+static void soa_erase_safe(DSoArrayT* soa, size_t index);
+
+/**
+ * @brief Erase a record by moving the last record into its place (O(1), does not keep order).
+ * @param soa[in] The structure of arrays.
+ * @param index[in] The record index.
+ */
+static void soa_swap_erase(DSoArrayT* soa, size_t index);
+
+/**
+ * @brief Remove the last record.
+ * @param soa[in] The structure of arrays.
+ */
+static void soa_pop(DSoArrayT* soa);
+
+/**
+ * @brief Resize the structure of arrays. New records are uninitialized.
+ * @param soa[in] The structure of arrays.
+ * @param newLength[in] The new number of records.
+ */
+static void soa_resize(DSoArrayT* soa, size_t newLength);
+
+/**
+ * @brief Reserve space for a number of records.
+ * @param soa[in] The structure of arrays.
+ * @param newCapacity[in] The new capacity in records.
+ */
+static void soa_reserve(DSoArrayT* soa, size_t newCapacity);
+
+/**
+ * @brief Get the number of records.
+ * @param soa[in] The structure of arrays.
+ * @return The number of records.
+ */
+static size_t soa_length(DSoArrayT* soa);
+
+/**
+ * @brief Get the capacity in records.
+ * @param soa[in] The structure of arrays.
+ * @return The capacity.
+ */
+static size_t soa_capacity(DSoArrayT* soa);
+
+/**
+ * @brief Check if the structure of arrays is empty.
+ * @param soa[in] The structure of arrays.
+ * @return TRUE if there are no records, FALSE otherwise.
+ */
+static BOOL soa_is_empty(DSoArrayT* soa);
+
+/**
+ * @brief Copy one column into a new dynamic array.
+ * @param soa[in] The structure of arrays.
+ * @param field[in] The field index.
+ * @return A new dynamic array with elementSize equal to the field size.
+ */
+static DArrayT* soa_column_to_darr(DSoArrayT* soa, size_t field);
+
+/***********************************************************************************************************************
+Static functions implementation
+***********************************************************************************************************************/
+
+inline static size_t soa_column_bytes(size_t fieldSize, size_t capacity)
+{
+    size_t bytes = fieldSize * capacity;
+    return (bytes + (DSOARRAY_COLUMN_ALIGNMENT - 1)) & ~((size_t) DSOARRAY_COLUMN_ALIGNMENT - 1);
+}
+
+inline static int8_t* soa_align_block(int8_t* block)
+{
+    intptr_t address = (intptr_t) block;
+    address = (address + (DSOARRAY_COLUMN_ALIGNMENT - 1)) & ~((intptr_t) DSOARRAY_COLUMN_ALIGNMENT - 1);
+    return (int8_t*) address;
+}
+
+inline static DSoArrayT* soa_create(const size_t* fieldSizes, size_t fieldCount)
+{
+    DSoArrayT* result = NULL;
+    BOOL isValid = (NULL != fieldSizes) && (fieldCount > 0) && (fieldCount <= DSOARRAY_MAX_FIELDS);
+
+    for (size_t i = 0; (TRUE == isValid) && (i < fieldCount); i++)
+    {
+        if (0u == fieldSizes[i]) { isValid = FALSE; }
+    }
+
+    if (FALSE == isValid) { LOG_ERROR("Invalid structure of arrays schema!\n"); }
+    else
+    {
+        result = (DSoArrayT*) CMALLOC(sizeof(DSoArrayT));
+        if (NULL == result) { LOG_ERROR("Can not allocate structure of arrays!\n"); }
+        else
+        {
+            CMEMSET(result, 0, sizeof(DSoArrayT));
+            result->fieldCount = fieldCount;
+            for (size_t i = 0; i < fieldCount; i++) { result->fieldSizes[i] = fieldSizes[i]; }
+            soa_reserve(result, DSOARRAY_INITIAL_CAPACITY);
+            if (result->capacity < DSOARRAY_INITIAL_CAPACITY)
+            {
+                soa_destroy(result);
+                result = NULL;
+            }
+        }
+
+    }
+
+    return result;
+}
+
+inline static void soa_destroy(DSoArrayT* soa)
+{
+    if (NULL != soa)
+    {
+        if (NULL != soa->block) { CFREE(soa->block, 0); }
+        CFREE(soa, sizeof(DSoArrayT));
+    }
+}
+
+inline static void soa_reserve(DSoArrayT* soa, size_t newCapacity)
+{
+    if (newCapacity > soa->capacity)
+    {
+        size_t totalBytes = DSOARRAY_COLUMN_ALIGNMENT;
+        for (size_t i = 0; i < soa->fieldCount; i++)
+        {
+            totalBytes += soa_column_bytes(soa->fieldSizes[i], newCapacity);
+        }
+
+        int8_t* newBlock = (int8_t*) CMALLOC(totalBytes);
+        if (NULL == newBlock) { LOG_ERROR("Can not allocate structure of arrays columns!\n"); }
+        else
+        {
+            int8_t* column = soa_align_block(newBlock);
+            for (size_t i = 0; i < soa->fieldCount; i++)
+            {
+                if ((NULL != soa->columns[i]) && (soa->length > 0))
+                {
+                    CMEMCPY(column, soa->columns[i], soa->length * soa->fieldSizes[i]);
+                }
+                soa->columns[i] = column;
+                column += soa_column_bytes(soa->fieldSizes[i], newCapacity);
+            }
+            if (NULL != soa->block) { CFREE(soa->block, 0); }
+            soa->block = newBlock;
+            soa->capacity = newCapacity;
+        }
+    }
+}
+
+inline static void soa_resize(DSoArrayT* soa, size_t newLength)
+{
+    if (newLength > soa->capacity) { soa_reserve(soa, newLength * DSOARRAY_RESIZE_FACTOR); }
+    if (newLength <= soa->capacity) { soa->length = newLength; }
+}
+
+inline static void* soa_get_ptr(DSoArrayT* soa, size_t field, size_t index)
+{
+    return &soa->columns[field][index * soa->fieldSizes[field]];
+}
+
+inline static void* soa_get_ptr_safe(DSoArrayT* soa, size_t field, size_t index)
+{
+    void* result = NULL;
+    if (NULL == soa) {}
+    else if ((field < soa->fieldCount) && (index < soa->length)) { result = soa_get_ptr(soa, field, index); }
+    return result;
+}
+
+inline static void* soa_column(DSoArrayT* soa, size_t field) { return soa->columns[field]; }
+
+inline static void soa_push(DSoArrayT* soa, const void* const* fieldValues)
+{
+    size_t oldLength = soa->length;
+    soa_resize(soa, oldLength + 1);
+    if (soa->length > oldLength)
+    {
+        for (size_t i = 0; i < soa->fieldCount; i++)
+        {
+            void* dest = soa_get_ptr(soa, i, oldLength);
+            if ((NULL == fieldValues) || (NULL == fieldValues[i])) { CMEMSET(dest, 0, soa->fieldSizes[i]); }
+            else { CMEMCPY(dest, fieldValues[i], soa->fieldSizes[i]); }
+        }
+    }
+}
+
+inline static void soa_get_record(DSoArrayT* soa, size_t index, void* const* fieldValues)
+{
+    for (size_t i = 0; i < soa->fieldCount; i++)
+    {
+        if (NULL != fieldValues[i]) { CMEMCPY(fieldValues[i], soa_get_ptr(soa, i, index), soa->fieldSizes[i]); }
+    }
+}
+
+inline static void soa_set(DSoArrayT* soa, size_t field, size_t index, const void* value)
+{
+    CMEMCPY(soa_get_ptr(soa, field, index), value, soa->fieldSizes[field]);
+}
+
+inline static void soa_erase(DSoArrayT* soa, size_t index)
+{
+    size_t tailLength = soa->length - index - 1;
+    if (tailLength > 0)
+    {
+        for (size_t i = 0; i < soa->fieldCount; i++)
+        {
+            CMEMMOVE(soa_get_ptr(soa, i, index), soa_get_ptr(soa, i, index + 1), tailLength * soa->fieldSizes[i]);
+        }
+    }
+    soa->length -= 1;
+}
+
+inline static void soa_erase_safe(DSoArrayT* soa, size_t index)
+{
+    if (NULL == soa) {}
+    else if (index < soa->length) { soa_erase(soa, index); }
+}
+
+inline static void soa_swap_erase(DSoArrayT* soa, size_t index)
+{
+    size_t last = soa->length - 1;
+    if (index != last)
+    {
+        for (size_t i = 0; i < soa->fieldCount; i++)
+        {
+            CMEMCPY(soa_get_ptr(soa, i, index), soa_get_ptr(soa, i, last), soa->fieldSizes[i]);
+        }
+    }
+    soa->length -= 1;
+}
+
+inline static void soa_pop(DSoArrayT* soa)
+{
+    if (soa->length > 0) { soa->length -= 1; }
+    else { LOG_ERROR("Can not pop from empty structure of arrays!\n"); }
+}
+
+inline static size_t soa_length(DSoArrayT* soa) { return soa->length; }
+
+inline static size_t soa_capacity(DSoArrayT* soa) { return soa->capacity; }
+
+inline static BOOL soa_is_empty(DSoArrayT* soa) { return (0u == soa->length); }
+
+inline static DArrayT* soa_column_to_darr(DSoArrayT* soa, size_t field)
+{
+    DArrayT* result = darr_create_generic(soa->fieldSizes[field]);
+    if (NULL != result)
+    {
+        darr_reserve(result, soa->length);
+        darr_resize(result, soa->length);
+        if ((soa->length > 0) && (result->length == soa->length))
+        {
+            CMEMCPY(result->data, soa->columns[field], soa->length * soa->fieldSizes[field]);
+        }
+    }
+    return result;
+}
+
+#endif// DSOARRAY_HEADER
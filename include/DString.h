@@ -39,6 +39,7 @@
 /***********************************************************************************************************************
 Includes
 ***********************************************************************************************************************/
+#include "CCpu.h"
 #include "CLog.h"
 #include "STDTypes.h"
 
@@ -70,6 +71,10 @@ Macro Definitions
  * @brief Null terminator character
  */
 #define DSTRING_NULL_TERMINATOR '\0';
+/**
+ * @brief Strings with a capacity up to this many bytes keep their data inside the DStringT
+ */
+#define DSTRING_INLINE_CAPACITY 23u
 
 /**
  * @brief Maximum ASCII value for a single byte in UTF-8
@@ -92,9 +97,39 @@ Macro Definitions
  */
 #define UNICODE_UTF8_BYTE4_MASK 0xF8
 
+/**
+ * @brief Error classes of a byte pair, used by the SIMD UTF-8 validators
+ *
+ * Each pair of consecutive bytes is classified through three 16 entry tables
+ * indexed by the high and low nibble of the first byte and the high nibble of
+ * the second byte. A class survives the AND of the three lookups only if the
+ * pair belongs to it. Sequences of three and four bytes are checked by
+ * UNICODE_UTF8_TWO_CONTS against the leads two and three bytes back.
+ */
+#define UNICODE_UTF8_TOO_SHORT (1u << 0)     /* 11______ 0_______, 11______ 11______ */
+#define UNICODE_UTF8_TOO_LONG (1u << 1)      /* 0_______ 10______ */
+#define UNICODE_UTF8_OVERLONG_3 (1u << 2)    /* 11100000 100_____ */
+#define UNICODE_UTF8_TOO_LARGE (1u << 3)     /* 11110100 1001____, 11110100 101_____ */
+#define UNICODE_UTF8_SURROGATE (1u << 4)     /* 11101101 101_____ */
+#define UNICODE_UTF8_OVERLONG_2 (1u << 5)    /* 1100000_ 10______ */
+#define UNICODE_UTF8_TOO_LARGE_1000 (1u << 6)/* 11110101 1000____, 1111011_ 1000____, 11111___ 1000____ */
+#define UNICODE_UTF8_OVERLONG_4 (1u << 6)    /* 11110000 1000____ */
+#define UNICODE_UTF8_TWO_CONTS (1u << 7)     /* 10______ 10______ */
+#define UNICODE_UTF8_CARRY (UNICODE_UTF8_TOO_SHORT | UNICODE_UTF8_TOO_LONG | UNICODE_UTF8_TWO_CONTS)
+
 /***********************************************************************************************************************
 Type definitions
 ***********************************************************************************************************************/
+/**
+ * @typedef DStringWordT
+ * @brief A word for scanning strings eight bytes at a time, allowed to alias the characters.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint64_t __attribute__((__may_alias__)) DStringWordT;
+#else
+typedef uint64_t DStringWordT;
+#endif
+
 /**
  * @struct DStringT
  * @brief Dynamic String Type
@@ -102,11 +137,16 @@ Type definitions
  * @var length is the number of bytes in the string without the NULL termination.
  * @var capacity is the maximum number of bytes that can be stored in the string.
  * @var data is a pointer to the first character of the string.
+ * @var refCount is the reference count of data shared with clones, NULL if data has a single owner.
+ * @var inlineData holds the data of short strings, data then points here and the string takes a single allocation.
+ * Inline data is never shared, str_clone copies it.
  */
 typedef struct {
     size_t length;
     size_t capacity;
     int8_t* data;
+    uint32_t* refCount;
+    int8_t inlineData[DSTRING_INLINE_CAPACITY + DSTRING_NULL_TERMINATION_LENGTH];
 } DStringT;
 
 /***********************************************************************************************************************
@@ -135,6 +175,32 @@ static DStringT* str_create(const int8_t* str, size_t size);
  * @param str to be destroyed
  */
 static void str_destroy(DStringT* str);
+/**
+ * @brief Clones a dynamic string without copying its data
+ *
+ * The clone and the original share the data until one of them is modified
+ * through str_resize, str_erase, str_insert, str_reserve, str_shring_to_fit or
+ * the append/insert functions, which gives the modified string a private copy.
+ * The reference count is atomic. Call str_make_unique before writing through
+ * str_get_ptr and friends.
+ *
+ * @param str the dynamic string
+ * @return DStringT*: the clone, destroy it with str_destroy
+ */
+static DStringT* str_clone(DStringT* str);
+/**
+ * @brief Gives a dynamic string a private copy of data shared with clones
+ *
+ * @param str the dynamic string
+ */
+static void str_make_unique(DStringT* str);
+/**
+ * @brief Checks whether the data of a dynamic string is stored inside the DStringT
+ *
+ * @param str the dynamic string
+ * @return BOOL: TRUE if the string has no separate data allocation
+ */
+static BOOL str_is_inline(DStringT* str);
 /**
  * @brief Creates and array of Dynamic Strings
  * 
@@ -285,6 +351,20 @@ static BOOL cstr_is_utf8(const int8_t* str);
  * @return BOOL: if UTF-8 string is valid UTF-8
  */
 static BOOL cstr_is_valid_utf8(const int8_t* input, size_t length);
+/**
+ * @brief Validates UTF-8 and finds the first invalid sequence
+ *
+ * Rejects overlong encodings, surrogates and code points above U+10FFFF. Uses
+ * the widest SIMD kernel the CPU supports, see cpu_has_feature.
+ *
+ * @param input: input UTF-8 string
+ * @param length: length of UTF-8 string
+ * @param errorOffset: receives the offset of the first byte of the first invalid sequence, length if valid.
+ * May be NULL.
+ *
+ * @return BOOL: if UTF-8 string is valid UTF-8
+ */
+static BOOL cstr_validate_utf8(const int8_t* input, size_t length, size_t* errorOffset);
 /**
  * @brief Checks if byte is a continuation byte in UTF-8
  * 
@@ -437,8 +517,15 @@ inline static DStringT* str_create_empty(size_t size)
             result->length = 0;  // set length to 0
             result->capacity = 0;// set capacity to DARRAY_INITIAL_CAPACITY
             result->data = NULL;
+            result->refCount = NULL;
 
-            int8_t* memory = (int8_t*) CCALLOC(size + 1, sizeof(int8_t));
+            int8_t* memory = NULL;
+            if (size <= DSTRING_INLINE_CAPACITY)
+            {
+                memory = result->inlineData;
+                CMEMSET(memory, 0, sizeof(result->inlineData));
+            }
+            else { memory = (int8_t*) CCALLOC(size + 1, sizeof(int8_t)); }
             if (NULL == memory) { LOG_ERROR("Can not allocate dynamic string data!\n"); }
             else
             {
@@ -462,69 +549,119 @@ inline static DStringT* str_create(const int8_t* str, size_t size)
     return result;
 }
 
-inline static size_t cstr_length(const int8_t* str)
+/*
+ * The cstr_length kernels round the string down to an aligned block and ignore the bytes before it. Aligned
+ * reads never cross a page, so reading past the terminator can not fault.
+ */
+CPU_NO_SANITIZE_ADDRESS inline static size_t cstr_length_swar(const int8_t* str)
 {
-    const int8_t* int8_t_ptr;
-    const uint32_t* longword_ptr;
-    uint32_t longword, himagic, lomagic;
-
-    /* Handle the first few characters by reading one character at a time.
-     Do this until CHAR_PTR is aligned on a longword boundary.  */
-    for (int8_t_ptr = str; ((size_t) int8_t_ptr & (sizeof(longword) - 1)) != 0; ++int8_t_ptr)
-        if (*int8_t_ptr == '\0') return int8_t_ptr - str;
-
-    /* All these elucidatory comments refer to 4-byte longwords,
-     but the theory applies equally well to 8-byte longwords.  */
-
-    longword_ptr = (uint32_t*) int8_t_ptr;
-
-    /* Bits 31, 24, 16, and 8 of this number are zero.  Call these bits
-     the "holes."  Note that there is a hole just to the left of
-     each byte, with an extra at the end:
-
-     bits:  01111110 11111110 11111110 11111111
-     bytes: AAAAAAAA BBBBBBBB CCCCCCCC DDDDDDDD
+    const uint64_t lowMagic = 0x0101010101010101ull;
+    const uint64_t highMagic = 0x8080808080808080ull;
+    size_t misalignment = (size_t) ((uintptr_t) str & (sizeof(DStringWordT) - 1u));
+    const DStringWordT* word = (const DStringWordT*) (str - misalignment);
+
+    /* Bytes before the string are forced to non zero. */
+    uint64_t value = *word;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    value |= (0u == misalignment) ? 0u : ~0ull << (64u - 8u * misalignment);
+#else
+    value |= (0u == misalignment) ? 0u : ~0ull >> (64u - 8u * misalignment);
+#endif
+    while (0u == ((value - lowMagic) & ~value & highMagic)) { value = *++word; }
+
+    /* The test above can flag a 0x01 byte next to a zero byte, this mask flags zero bytes only. */
+    uint64_t zeros = ~(((value & ~highMagic) + ~highMagic) | value | ~highMagic);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    size_t index = CPU_CLZ64(zeros) / 8u;
+#else
+    size_t index = CPU_CTZ64(zeros) / 8u;
+#endif
+    return (size_t) ((const int8_t*) word - str) + index;
+}
 
-     The 1-bits make sure that carries propagate to the next 0-bit.
-     The 0-bits provide holes for carries to fall into.  */
-    himagic = 0x80808080L;
-    lomagic = 0x01010101L;
-    if (sizeof(longword) > 4)
+#ifdef CUTILS_SIMD_X86
+CPU_NO_SANITIZE_ADDRESS CPU_TARGET_SSE42 inline static size_t cstr_length_sse2(const int8_t* str)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t misalignment = (size_t) ((uintptr_t) str & 15u);
+    const __m128i* block = (const __m128i*) (str - misalignment);
+    uint32_t zeros = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero)) >> misalignment;
+    if (0u == zeros)
     {
-        /* 64-bit version of the magic.  */
-        /* Do the shift in two steps to avoid a warning if long has 32 bits.  */
-        himagic = ((himagic << 16) << 16) | himagic;
-        lomagic = ((lomagic << 16) << 16) | lomagic;
+        do {
+            zeros = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(++block), zero));
+        } while (0u == zeros);
+        misalignment = 0;
     }
-    if (sizeof(longword) > 8) abort();
+    return (size_t) ((const int8_t*) block - str) + misalignment + CPU_CTZ32(zeros);
+}
 
-    /* Instead of the traditional loop which tests each character,
-     we will test a longword at a time.  The tricky part is testing
-     if *any of the four* bytes in the longword in question are zero.  */
-    for (;;)
+CPU_NO_SANITIZE_ADDRESS CPU_TARGET_AVX2 inline static size_t cstr_length_avx2(const int8_t* str)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t misalignment = (size_t) ((uintptr_t) str & 31u);
+    const __m256i* block = (const __m256i*) (str - misalignment);
+    uint32_t zeros = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero)) >> misalignment;
+    if (0u == zeros)
     {
-        longword = *longword_ptr++;
-
-        if (((longword - lomagic) & ~longword & himagic) != 0)
+        /* Step to a 64 byte boundary, then test two blocks at a time through their minimum. */
+        block++;
+        if (0u != ((uintptr_t) block & 32u))
         {
-            /* Which of the bytes was the zero?  If none of them were, it was
-         a misfire; continue the search.  */
-
-            const int8_t* cp = (const int8_t*) (longword_ptr - 1);
-
-            if (cp[0] == 0) return cp - str;
-            if (cp[1] == 0) return cp - str + 1;
-            if (cp[2] == 0) return cp - str + 2;
-            if (cp[3] == 0) return cp - str + 3;
-            if (sizeof(longword) > 4)
+            zeros = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero));
+            if (0u == zeros) { block++; }
+        }
+        while (0u == zeros)
+        {
+            __m256i low = _mm256_load_si256(block);
+            __m256i high = _mm256_load_si256(block + 1);
+            if (0 == _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(low, high), zero))) { block += 2; }
+            else
             {
-                if (cp[4] == 0) return cp - str + 4;
-                if (cp[5] == 0) return cp - str + 5;
-                if (cp[6] == 0) return cp - str + 6;
-                if (cp[7] == 0) return cp - str + 7;
+                zeros = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, zero));
+                if (0u == zeros)
+                {
+                    block++;
+                    zeros = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, zero));
+                }
             }
         }
+        misalignment = 0;
+    }
+    return (size_t) ((const int8_t*) block - str) + misalignment + CPU_CTZ32(zeros);
+}
+
+CPU_NO_SANITIZE_ADDRESS CPU_TARGET_AVX512 inline static size_t cstr_length_avx512(const int8_t* str)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    size_t misalignment = (size_t) ((uintptr_t) str & 63u);
+    const __m512i* block = (const __m512i*) (str - misalignment);
+    uint64_t zeros = _mm512_cmpeq_epi8_mask(_mm512_load_si512((const void*) block), zero) >> misalignment;
+    if (0u == zeros)
+    {
+        do {
+            zeros = _mm512_cmpeq_epi8_mask(_mm512_load_si512((const void*) ++block), zero);
+        } while (0u == zeros);
+        misalignment = 0;
     }
+    return (size_t) ((const int8_t*) block - str) + misalignment + CPU_CTZ64(zeros);
+}
+#endif
+
+inline static size_t cstr_length(const int8_t* str)
+{
+    size_t result = 0;
+#ifdef CUTILS_SIMD_X86
+    /* Called for every short string, so the features are read once. */
+    uint32_t features = cpu_get_features();
+    if (0u != (features & CPU_FEATURE_AVX512)) { result = cstr_length_avx512(str); }
+    else if (0u != (features & CPU_FEATURE_AVX2)) { result = cstr_length_avx2(str); }
+    else if (0u != (features & CPU_FEATURE_SSE42)) { result = cstr_length_sse2(str); }
+    else { result = cstr_length_swar(str); }
+#else
+    result = cstr_length_swar(str);
+#endif
+    return result;
 }
 
 inline static size_t cstr_utf8_length(const int8_t* str)
@@ -566,96 +703,274 @@ inline static BOOL utf8_is_continuation_byte3(int8_t byte) { return (byte & UNIC
 
 inline static BOOL utf8_is_byte_ascii(int8_t byte) { return byte <= UNICODE_UTF8_ASCII_RANGE_MAX && byte >= 0; }
 
-inline static BOOL cstr_is_valid_utf8(const int8_t* input, size_t length)
+/* Returns the offset of the first invalid sequence at or after index, which starts a sequence. */
+inline static size_t cstr_utf8_scan_scalar(const int8_t* input, size_t index, size_t length)
 {
-    BOOL is_valid = TRUE;// Accumulates result
-    size_t index = 0;
-
-    while (index < length)
+    const uint8_t* bytes = (const uint8_t*) input;
+    size_t error = length;
+    while ((index < length) && (length == error))
     {
-        uint8_t byte = input[index];
+        uint64_t word = 0x8080808080808080ull;
+        if (index + sizeof(word) <= length) { CMEMCPY(&word, &bytes[index], sizeof(word)); }
 
-        // Check for 1-byte sequence (ASCII, 0xxxxxxx)
-        if (utf8_is_byte_ascii(byte))
-        {
-            index++;
-            continue;
-        }
-
-        // Check for 2-byte sequence (110xxxxx 10xxxxxx)
-        if ((byte & UNICODE_UTF8_BYTE2_MASK) == UNICODE_UTF8_BYTE1_MASK)
+        if (0u == (word & 0x8080808080808080ull)) { index += sizeof(word); }
+        else
         {
-            if (index + 1 >= length || !utf8_is_continuation_byte(input[index + 1]))
+            uint8_t byte = bytes[index];
+            uint8_t low = 0x80;
+            uint8_t high = 0xBF;
+            size_t count = 0;
+            if (byte <= UNICODE_UTF8_ASCII_RANGE_MAX) { count = 1; }
+            else if ((byte >= 0xC2) && (byte <= 0xDF)) { count = 2; }
+            else if ((byte >= 0xE0) && (byte <= 0xEF))
             {
-                is_valid = FALSE;
-                break;
+                count = 3;
+                if (0xE0 == byte) { low = 0xA0; } // overlong encoding
+                else if (0xED == byte) { high = 0x9F; }// surrogates U+D800 to U+DFFF
             }
-            // Overlong encoding: code points that should be in 1 byte
-            if (byte <= 0xC1)
+            else if ((byte >= 0xF0) && (byte <= 0xF4))
             {
-                is_valid = FALSE;
-                break;
+                count = 4;
+                if (0xF0 == byte) { low = 0x90; } // overlong encoding
+                else if (0xF4 == byte) { high = 0x8F; }// code points greater than U+10FFFF
             }
-            index += 2;
-            continue;
-        }
 
-        // Check for 3-byte sequence (1110xxxx 10xxxxxx 10xxxxxx)
-        if ((byte & UNICODE_UTF8_BYTE3_MASK) == UNICODE_UTF8_BYTE2_MASK)
-        {
-            if (index + 2 >= length || !utf8_is_continuation_byte(input[index + 1]) ||
-                !utf8_is_continuation_byte(input[index + 2]))
-            {
-                is_valid = FALSE;
-                break;
-            }
-            // Overlong encoding: code points that should be in 2 bytes
-            if (byte == UNICODE_UTF8_BYTE2_MASK && utf8_is_continuation_byte2(input[index + 1]))
+            BOOL valid = ((0u != count) && (count <= length - index)) ? TRUE : FALSE;
+            if ((TRUE == valid) && (count > 1u)) { valid = ((bytes[index + 1] >= low) && (bytes[index + 1] <= high)); }
+            for (size_t i = 2; (TRUE == valid) && (i < count); i++)
             {
-                is_valid = FALSE;
-                break;
+                valid = utf8_is_continuation_byte((int8_t) bytes[index + i]);
             }
-            // Invalid surrogates (U+D800 to U+DFFF)
-            if (byte == 0xED && (input[index + 1] & 0xE0) == 0xA0)
-            {
-                is_valid = FALSE;
-                break;
-            }
-            index += 3;
-            continue;
+
+            if (TRUE == valid) { index += count; }
+            else { error = index; }
         }
+    }
+    return error;
+}
 
-        // Check for 4-byte sequence (11110xxx 10xxxxxx 10xxxxxx 10xxxxxx)
-        if ((byte & UNICODE_UTF8_BYTE4_MASK) == UNICODE_UTF8_BYTE3_MASK)
+/* The SIMD kernels stop at a block boundary, a sequence crossing it starts at most three bytes earlier. */
+inline static size_t cstr_utf8_restart(const int8_t* input, size_t index)
+{
+    size_t result = index;
+    for (size_t back = 1; (back <= 3u) && (back <= index); back++)
+    {
+        uint8_t byte = (uint8_t) input[index - back];
+        if (byte >= UNICODE_UTF8_BYTE1_MASK)
         {
-            if (index + 3 >= length || !utf8_is_continuation_byte(input[index + 1]) ||
-                !utf8_is_continuation_byte(input[index + 2]) || !utf8_is_continuation_byte(input[index + 3]))
-            {
-                is_valid = FALSE;
-                break;
-            }
-            // Overlong encoding: code points that should be in 3 bytes
-            if (byte == UNICODE_UTF8_BYTE3_MASK && utf8_is_continuation_byte3(input[index + 1]))
-            {
-                is_valid = FALSE;
-                break;
-            }
-            // Code points greater than U+10FFFF
-            if (byte > 0xF4 || (byte == 0xF4 && (input[index + 1] & 0xF0) > 0x8F))
-            {
-                is_valid = FALSE;
-                break;
-            }
-            index += 4;
-            continue;
+            result = index - back;
+            break;
         }
+        if (byte <= UNICODE_UTF8_ASCII_RANGE_MAX) { break; }
+    }
+    return result;
+}
+
+/* The byte 1 high nibble, byte 1 low nibble and byte 2 high nibble tables of the SIMD validators. */
+inline static const uint8_t* cstr_utf8_tables(void)
+{
+    // clang-format off
+    static const uint8_t tables[3 * 16] = {
+        /* 0_______ */
+        UNICODE_UTF8_TOO_LONG, UNICODE_UTF8_TOO_LONG, UNICODE_UTF8_TOO_LONG, UNICODE_UTF8_TOO_LONG,
+        UNICODE_UTF8_TOO_LONG, UNICODE_UTF8_TOO_LONG, UNICODE_UTF8_TOO_LONG, UNICODE_UTF8_TOO_LONG,
+        /* 10______ */
+        UNICODE_UTF8_TWO_CONTS, UNICODE_UTF8_TWO_CONTS, UNICODE_UTF8_TWO_CONTS, UNICODE_UTF8_TWO_CONTS,
+        /* 1100____, 1101____, 1110____, 1111____ */
+        UNICODE_UTF8_TOO_SHORT | UNICODE_UTF8_OVERLONG_2,
+        UNICODE_UTF8_TOO_SHORT,
+        UNICODE_UTF8_TOO_SHORT | UNICODE_UTF8_OVERLONG_3 | UNICODE_UTF8_SURROGATE,
+        UNICODE_UTF8_TOO_SHORT | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000 | UNICODE_UTF8_OVERLONG_4,
+
+        /* ____0000, ____0001 */
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_OVERLONG_3 | UNICODE_UTF8_OVERLONG_2 | UNICODE_UTF8_OVERLONG_4,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_OVERLONG_2,
+        /* ____001_ */
+        UNICODE_UTF8_CARRY, UNICODE_UTF8_CARRY,
+        /* ____0100, ____0101 */
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        /* ____011_ */
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        /* ____1___, ____1101 */
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000 | UNICODE_UTF8_SURROGATE,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+        UNICODE_UTF8_CARRY | UNICODE_UTF8_TOO_LARGE | UNICODE_UTF8_TOO_LARGE_1000,
+
+        /* ________ 0_______ */
+        UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT,
+        UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT,
+        /* ________ 1000____ */
+        UNICODE_UTF8_TOO_LONG | UNICODE_UTF8_OVERLONG_2 | UNICODE_UTF8_TWO_CONTS | UNICODE_UTF8_OVERLONG_3 |
+            UNICODE_UTF8_TOO_LARGE_1000 | UNICODE_UTF8_OVERLONG_4,
+        /* ________ 1001____ */
+        UNICODE_UTF8_TOO_LONG | UNICODE_UTF8_OVERLONG_2 | UNICODE_UTF8_TWO_CONTS | UNICODE_UTF8_OVERLONG_3 |
+            UNICODE_UTF8_TOO_LARGE,
+        /* ________ 101_____ */
+        UNICODE_UTF8_TOO_LONG | UNICODE_UTF8_OVERLONG_2 | UNICODE_UTF8_TWO_CONTS | UNICODE_UTF8_SURROGATE |
+            UNICODE_UTF8_TOO_LARGE,
+        UNICODE_UTF8_TOO_LONG | UNICODE_UTF8_OVERLONG_2 | UNICODE_UTF8_TWO_CONTS | UNICODE_UTF8_SURROGATE |
+            UNICODE_UTF8_TOO_LARGE,
+        /* ________ 11______ */
+        UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT, UNICODE_UTF8_TOO_SHORT
+    };
+    // clang-format on
+    return tables;
+}
 
-        // Any other byte patterns are invalid
-        is_valid = FALSE;
-        break;
+#ifdef CUTILS_SIMD_X86
+/*
+ * The kernels validate whole blocks and return the offset of the first block that is not valid, or of the
+ * tail. Errors are reported per block so the scalar scan only reruns the block that holds the first one.
+ */
+CPU_TARGET_SSE42 inline static size_t cstr_utf8_scan_sse42(const int8_t* input, size_t length)
+{
+    const uint8_t* tables = cstr_utf8_tables();
+    const __m128i byte1High = _mm_loadu_si128((const __m128i*) &tables[0]);
+    const __m128i byte1Low = _mm_loadu_si128((const __m128i*) &tables[16]);
+    const __m128i byte2High = _mm_loadu_si128((const __m128i*) &tables[32]);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    /* Bytes above these can not end a block: leads of sequences that continue into the next one. */
+    const __m128i lastMax = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char) 0xEF,
+                                          (char) 0xDF, (char) 0xBF);
+    __m128i previous = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16u <= length; i += 16u)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*) (input + i));
+        __m128i error = incomplete;
+        if (0 != _mm_movemask_epi8(block))
+        {
+            __m128i prev1 = _mm_alignr_epi8(block, previous, 15);
+            __m128i special = _mm_and_si128(
+                    _mm_and_si128(_mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+                                  _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+                    _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(block, 4), nibble)));
+            __m128i third = _mm_subs_epu8(_mm_alignr_epi8(block, previous, 14), _mm_set1_epi8(0xE0 - 0x80));
+            __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(block, previous, 13), _mm_set1_epi8(0xF0 - 0x80));
+            __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char) 0x80));
+            error = _mm_xor_si128(must23, special);
+            incomplete = _mm_subs_epu8(block, lastMax);
+        }
+        else { incomplete = _mm_setzero_si128(); }
+        if (0 == _mm_testz_si128(error, error)) { break; }
+        previous = block;
+    }
+    return i;
+}
+
+CPU_TARGET_AVX2 inline static size_t cstr_utf8_scan_avx2(const int8_t* input, size_t length)
+{
+    const uint8_t* tables = cstr_utf8_tables();
+    const __m256i byte1High = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) &tables[0]));
+    const __m256i byte1Low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) &tables[16]));
+    const __m256i byte2High = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) &tables[32]));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i lastMax = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char) 0xEF, (char) 0xDF,
+                                             (char) 0xBF);
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32u <= length; i += 32u)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*) (input + i));
+        __m256i error = incomplete;
+        if (0 != _mm256_movemask_epi8(block))
+        {
+            /* The upper half of previous and the lower half of block, for the byte shifts across lanes. */
+            __m256i carried = _mm256_permute2x128_si256(previous, block, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(block, carried, 15);
+            __m256i special = _mm256_and_si256(
+                    _mm256_and_si256(
+                            _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                            _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+                    _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble)));
+            __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(block, carried, 14), _mm256_set1_epi8(0xE0 - 0x80));
+            __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(block, carried, 13), _mm256_set1_epi8(0xF0 - 0x80));
+            __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char) 0x80));
+            error = _mm256_xor_si256(must23, special);
+            incomplete = _mm256_subs_epu8(block, lastMax);
+        }
+        else { incomplete = _mm256_setzero_si256(); }
+        if (0 == _mm256_testz_si256(error, error)) { break; }
+        previous = block;
     }
+    return i;
+}
+
+CPU_TARGET_AVX512 inline static size_t cstr_utf8_scan_avx512(const int8_t* input, size_t length)
+{
+    /* Full width copies of the tables, the 128 bit broadcasts start from an undefined register. */
+    const uint8_t* tables = cstr_utf8_tables();
+    uint8_t wide[3][64];
+    for (uint32_t t = 0; t < 3; t++)
+    {
+        for (uint32_t lane = 0; lane < 4; lane++) { CMEMCPY(&wide[t][lane * 16], &tables[t * 16], 16); }
+    }
+    const __m512i byte1High = _mm512_loadu_si512((const void*) wide[0]);
+    const __m512i byte1Low = _mm512_loadu_si512((const void*) wide[1]);
+    const __m512i byte2High = _mm512_loadu_si512((const void*) wide[2]);
+
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    const __m512i lastMax = _mm512_mask_blend_epi8(0xE000000000000000ull, _mm512_set1_epi8(-1),
+                                                   _mm512_set_epi32((int) 0xBFDFEF00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                                    0, 0, 0, 0, 0));
+    /* Lane 3 of previous followed by lanes 0 to 2 of block. */
+    const __m512i carry = _mm512_setr_epi32(28, 29, 30, 31, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11);
+    __m512i previous = _mm512_setzero_si512();
+    __m512i incomplete = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64u <= length; i += 64u)
+    {
+        __m512i block = _mm512_loadu_si512((const void*) (input + i));
+        __m512i error = incomplete;
+        if (0u != _mm512_movepi8_mask(block))
+        {
+            __m512i carried = _mm512_permutex2var_epi32(block, carry, previous);
+            __m512i prev1 = _mm512_alignr_epi8(block, carried, 15);
+            __m512i special = _mm512_and_si512(
+                    _mm512_and_si512(
+                            _mm512_shuffle_epi8(byte1High, _mm512_and_si512(_mm512_srli_epi16(prev1, 4), nibble)),
+                            _mm512_shuffle_epi8(byte1Low, _mm512_and_si512(prev1, nibble))),
+                    _mm512_shuffle_epi8(byte2High, _mm512_and_si512(_mm512_srli_epi16(block, 4), nibble)));
+            __m512i third = _mm512_subs_epu8(_mm512_alignr_epi8(block, carried, 14), _mm512_set1_epi8(0xE0 - 0x80));
+            __m512i fourth = _mm512_subs_epu8(_mm512_alignr_epi8(block, carried, 13), _mm512_set1_epi8(0xF0 - 0x80));
+            __m512i must23 = _mm512_and_si512(_mm512_or_si512(third, fourth), _mm512_set1_epi8((char) 0x80));
+            error = _mm512_xor_si512(must23, special);
+            incomplete = _mm512_subs_epu8(block, lastMax);
+        }
+        else { incomplete = _mm512_setzero_si512(); }
+        if (0u != _mm512_test_epi8_mask(error, error)) { break; }
+        previous = block;
+    }
+    return i;
+}
+#endif
 
-    return is_valid;// Single return point
+inline static BOOL cstr_validate_utf8(const int8_t* input, size_t length, size_t* errorOffset)
+{
+    size_t index = 0;
+#ifdef CUTILS_SIMD_X86
+    if (cpu_has_feature(CPU_FEATURE_AVX512)) { index = cstr_utf8_scan_avx512(input, length); }
+    else if (cpu_has_feature(CPU_FEATURE_AVX2)) { index = cstr_utf8_scan_avx2(input, length); }
+    else if (cpu_has_feature(CPU_FEATURE_SSE42)) { index = cstr_utf8_scan_sse42(input, length); }
+#endif
+    size_t error = cstr_utf8_scan_scalar(input, cstr_utf8_restart(input, index), length);
+    if (NULL != errorOffset) { *errorOffset = error; }
+    return (length == error) ? TRUE : FALSE;
+}
+
+inline static BOOL cstr_is_valid_utf8(const int8_t* input, size_t length)
+{
+    return cstr_validate_utf8(input, length, NULL);
 }
 
 inline static uint8_t utf8_get_char_length(int8_t byte)
@@ -708,22 +1023,50 @@ inline static wchar_t utf8_to_unicode(const int8_t* utf8_data)
 
 inline static BOOL str_is_valid_utf8(DStringT* str) { return cstr_is_valid_utf8(str->data, str->length); }
 
+inline static BOOL str_is_inline(DStringT* str) { return (str->data == str->inlineData) ? TRUE : FALSE; }
+
+/* Moves the data to a buffer of newCapacity bytes: the inline buffer when it fits and the data is not on the heap
+ * already, else a heap buffer. The caller updates capacity. */
+inline static int8_t* str_reallocate(DStringT* str, size_t newCapacity)
+{
+    int8_t* resultPtr = NULL;
+    if ((newCapacity <= DSTRING_INLINE_CAPACITY) && ((NULL == str->data) || (TRUE == str_is_inline(str))))
+    {
+        resultPtr = str->inlineData;
+    }
+    else if (NULL == str->data) { resultPtr = (int8_t*) CMALLOC(newCapacity); }
+    else if (TRUE == str_is_inline(str))
+    {
+        resultPtr = (int8_t*) CMALLOC(newCapacity);
+        if (NULL != resultPtr)
+        {
+            size_t size = (newCapacity < sizeof(str->inlineData)) ? newCapacity : sizeof(str->inlineData);
+            CMEMCPY(resultPtr, str->inlineData, size);
+        }
+    }
+    else { resultPtr = (int8_t*) CREALLOC(str->data, newCapacity); }
+
+    if (NULL != resultPtr) { str->data = resultPtr; }
+    return resultPtr;
+}
+
 inline static void str_resize(DStringT* str, size_t newLength)
 {
+    str_make_unique(str);
     if (newLength > str->length)
     {
         if (newLength > str->capacity)
         {
-            void* resultPtr;
             size_t newCapacity = newLength * 2;
-
-            if (NULL == str->data) { resultPtr = CMALLOC(newCapacity); }
-            else { resultPtr = CREALLOC(str->data, newCapacity); }
-            if (NULL == resultPtr) { LOG_ERROR("Can not allocate dynamic string!\n"); }
-
-            if (NULL != resultPtr)
+            /* Stay inline while the string still fits. */
+            if ((newLength <= DSTRING_INLINE_CAPACITY) && (newCapacity > DSTRING_INLINE_CAPACITY) &&
+                ((NULL == str->data) || (TRUE == str_is_inline(str))))
+            {
+                newCapacity = DSTRING_INLINE_CAPACITY;
+            }
+            if (NULL == str_reallocate(str, newCapacity)) { LOG_ERROR("Can not allocate dynamic string!\n"); }
+            else
             {
-                str->data = (int8_t*) resultPtr;
                 str->length = newLength;
                 str->capacity = newCapacity;
             }
@@ -737,13 +1080,19 @@ inline static void str_destroy(DStringT* str)
 {
     if (NULL != str)
     {
-        if (str->data) { CFREE(str->data, str->length); }
+        if ((NULL != str->refCount) && (0u != __atomic_sub_fetch(str->refCount, 1u, __ATOMIC_ACQ_REL))) {}
+        else
+        {
+            if ((NULL != str->data) && (FALSE == str_is_inline(str))) { CFREE(str->data, str->length); }
+            if (NULL != str->refCount) { CFREE(str->refCount, sizeof(uint32_t)); }
+        }
         CFREE((void*) str, sizeof(DStringT*));
     }
 }
 
 inline static void str_erase(DStringT* str, size_t index)
 {
+    str_make_unique(str);
     if (index < str->length)
     {
         void* resultPtr = NULL;
@@ -751,7 +1100,7 @@ inline static void str_erase(DStringT* str, size_t index)
         {
             void* dest = &(str->data[index]);
             void* src = &(str->data[index + 1]);
-            resultPtr = CMEMCPY(dest, src, (str->length - index));
+            resultPtr = CMEMMOVE(dest, src, (str->length - index));
             if (NULL == resultPtr) { LOG_ERROR("Can not copy string array!\n"); }
         }
         if (NULL != resultPtr) { str->length -= 1; }
@@ -760,12 +1109,13 @@ inline static void str_erase(DStringT* str, size_t index)
 
 inline static void str_insert(DStringT* str, uint32_t index, int8_t* element)
 {
-    void* src = &(str->data[index]);
-    void* dest = &(str->data[index + 1]);
     void* resultPtr = NULL;
-
     str_resize(str, str->length + 1);
-    resultPtr = CMEMCPY(dest, src, (str->length - index - 1));
+
+    /* Resizing may move the data, inline data to the heap in particular. */
+    void* src = &(str->data[index]);
+    void* dest = &(str->data[index + 1]);
+    resultPtr = CMEMMOVE(dest, src, (str->length - index - 1));
 
     if (NULL == resultPtr) { LOG_ERROR("Can not copy string array!\n"); }
     if (NULL != resultPtr) { resultPtr = CMEMCPY(src, element, 1); }
@@ -773,7 +1123,20 @@ inline static void str_insert(DStringT* str, uint32_t index, int8_t* element)
 
 inline static void str_shring_to_fit(DStringT* str)
 {
-    if (str->capacity > str->length)
+    str_make_unique(str);
+    if ((str->capacity > str->length) && (str->length <= DSTRING_INLINE_CAPACITY) && (NULL != str->data))
+    {
+        /* Short enough to move back into the DStringT. */
+        if (FALSE == str_is_inline(str))
+        {
+            CMEMCPY(str->inlineData, str->data, str->length);
+            str->inlineData[str->length] = '\0';
+            CFREE(str->data, str->capacity);
+            str->data = str->inlineData;
+        }
+        str->capacity = str->length;
+    }
+    else if (str->capacity > str->length)
     {
         void* resultPtr = NULL;
         if (NULL != str->data) { resultPtr = CREALLOC(str->data, str->length); }
@@ -788,19 +1151,11 @@ inline static void str_shring_to_fit(DStringT* str)
 
 inline static void str_reserve(DStringT* str, size_t newCapacity)
 {
+    str_make_unique(str);
     if (newCapacity > str->capacity)
     {
-        void* resultPtr;
-
-        if (NULL == str->data) { resultPtr = CMALLOC(newCapacity); }
-        else { resultPtr = CREALLOC(str->data, newCapacity); }
-
-        if (NULL == resultPtr) { LOG_ERROR("Can not allocate string array!\n"); }
-        if (NULL != resultPtr)
-        {
-            str->data = (int8_t*) resultPtr;
-            str->capacity = newCapacity;
-        }
+        if (NULL == str_reallocate(str, newCapacity)) { LOG_ERROR("Can not allocate string array!\n"); }
+        else { str->capacity = newCapacity; }
     }
 }
 
@@ -817,6 +1172,8 @@ inline static DArrayT* str_arr_create(void)
         result->capacity = 0;                 // set capacity to 0
         result->elementSize = sizeof(int8_t*);// set element size to stride
         result->data = NULL;
+        result->storage = NULL;
+        result->storageContext = NULL;
     }
 
     return result;
@@ -874,7 +1231,7 @@ inline static DStringT* str_insert_dstring(DStringT* str, DStringT* another, siz
     size_t oldLength = str->length;
     str_resize(str, str->length + another->length + DSTRING_NULL_TERMINATION_LENGTH);
 
-    int8_t* resultData = (int8_t*) CMEMCPY(&str->data[index + another->length], &str->data[index], oldLength - index);
+    int8_t* resultData = (int8_t*) CMEMMOVE(&str->data[index + another->length], &str->data[index], oldLength - index);
     if (NULL != resultData) { resultData = (int8_t*) CMEMCPY(&str->data[index], another->data, another->length); }
     if (NULL != resultData)
     {
@@ -886,4 +1243,62 @@ inline static DStringT* str_insert_dstring(DStringT* str, DStringT* another, siz
 
     return (DStringT*) resultData;
 }
+
+inline static DStringT* str_clone(DStringT* str)
+{
+    DStringT* result = (DStringT*) CMALLOC(sizeof(DStringT));
+    if (NULL == result) { LOG_ERROR("Can not allocate dynamic string!\n"); }
+    else if (TRUE == str_is_inline(str))
+    {
+        /* Copying inline data is cheaper than sharing it. */
+        *result = *str;
+        result->data = result->inlineData;
+    }
+    else if (NULL != str->refCount)
+    {
+        __atomic_add_fetch(str->refCount, 1u, __ATOMIC_RELAXED);
+        *result = *str;
+    }
+    else if (NULL == (str->refCount = (uint32_t*) CMALLOC(sizeof(uint32_t))))
+    {
+        LOG_ERROR("Can not allocate reference count!\n");
+        CFREE(result, sizeof(DStringT));
+        result = NULL;
+    }
+    else
+    {
+        *str->refCount = 2u;
+        *result = *str;
+    }
+    return result;
+}
+
+inline static void str_make_unique(DStringT* str)
+{
+    if (NULL == str->refCount) {}
+    else if (1u == __atomic_load_n(str->refCount, __ATOMIC_ACQUIRE))
+    {
+        CFREE(str->refCount, sizeof(uint32_t));
+        str->refCount = NULL;
+    }
+    else
+    {
+        /* One spare byte keeps the copy null terminated like str_create_empty. */
+        int8_t* data = (str->capacity <= DSTRING_INLINE_CAPACITY) ? str->inlineData
+                                                                    : (int8_t*) CMALLOC(str->capacity + 1);
+        if (NULL == data) { LOG_ERROR("Can not allocate dynamic string data!\n"); }
+        else
+        {
+            CMEMCPY(data, str->data, str->length);
+            data[str->length] = '\0';
+            if (0u == __atomic_sub_fetch(str->refCount, 1u, __ATOMIC_ACQ_REL))
+            {
+                CFREE(str->data, str->length);
+                CFREE(str->refCount, sizeof(uint32_t));
+            }
+            str->data = data;
+            str->refCount = NULL;
+        }
+    }
+}
 #endif// DSTRING_HEADER
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include "DBitmap.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+/* Sorted values mixing sparse, dense and clustered chunks. */
+static std::vector<uint32_t> bitmap_test_values(uint32_t seed)
+{
+    std::vector<uint32_t> values;
+    for (uint32_t i = 0; i < 3000; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        values.push_back(seed % (1u << 16));
+    }
+    for (uint32_t i = 0; i < 30000; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        values.push_back((1u << 16) + seed % (1u << 16));
+    }
+    for (uint32_t i = 0; i < 20000; i++) { values.push_back((5u << 16) + 1000 + i + (seed % 7)); }
+    values.push_back(0xFFFFFFFFu);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+static DArrayU32T* bitmap_test_darr(const std::vector<uint32_t>& values)
+{
+    DArrayU32T* arr = darr_create_u32();
+    for (uint32_t value : values) { darr_push_u32(arr, value); }
+    return arr;
+}
+
+static std::vector<uint32_t> bitmap_test_vector(DBitmapT* bitmap)
+{
+    DArrayU32T* arr = bitmap_to_darr(bitmap);
+    std::vector<uint32_t> result((uint32_t*) arr->data, (uint32_t*) arr->data + arr->length);
+    darr_destroy(arr);
+    return result;
+}
+
+static const uint32_t bitmap_test_feature_masks[] = {~0u, CPU_FEATURE_AVX2, CPU_FEATURE_NONE};
+
+TEST(Bitmap_Tests, Bitmap_Test1)
+{
+    using namespace testing;
+    std::vector<uint32_t> values = bitmap_test_values(1);
+    DArrayU32T* arr = bitmap_test_darr(values);
+    DBitmapT* bitmap = bitmap_create_from_darr(arr);
+
+    ASSERT_EQ(bitmap_cardinality(bitmap), values.size());
+    ASSERT_EQ(bitmap_test_vector(bitmap), values);
+    ASSERT_EQ(bitmap_container(bitmap, 0)->type, DBITMAP_ARRAY);
+    ASSERT_EQ(bitmap_container(bitmap, 1)->type, DBITMAP_BITSET);
+    ASSERT_EQ(bitmap_container(bitmap, 2)->type, DBITMAP_RUN);
+    ASSERT_TRUE(bitmap_contains(bitmap, 0xFFFFFFFFu));
+    ASSERT_TRUE(bitmap_contains(bitmap, (5u << 16) + 1010));
+    ASSERT_FALSE(bitmap_contains(bitmap, (5u << 16) + 999));
+    ASSERT_FALSE(bitmap_contains(bitmap, 7u << 16));
+    ASSERT_LT(bitmap_memory_bytes(bitmap), values.size() * sizeof(uint32_t) / 2);
+
+    DBitmapIteratorT iterator;
+    uint32_t value = 0;
+    size_t count = 0;
+    bitmap_iterator_init(&iterator, bitmap);
+    while (TRUE == bitmap_iterator_next(&iterator, &value)) { ASSERT_EQ(value, values[count++]); }
+    ASSERT_EQ(count, values.size());
+
+    bitmap_destroy(bitmap);
+    darr_destroy(arr);
+}
+
+TEST(Bitmap_Tests, Bitmap_Test2)
+{
+    using namespace testing;
+    DBitmapT* bitmap = bitmap_create();
+    std::vector<uint32_t> expected;
+    ASSERT_TRUE(bitmap_is_empty(bitmap));
+
+    for (uint32_t i = 0; i < 6000; i++)
+    {
+        uint32_t value = (i * 7u) % 9000u + ((i % 3u) << 20);
+        bool added = std::find(expected.begin(), expected.end(), value) == expected.end();
+        ASSERT_EQ(bitmap_add(bitmap, value), added ? TRUE : FALSE);
+        if (added) { expected.push_back(value); }
+    }
+    ASSERT_FALSE(bitmap_add(bitmap, expected[0]));
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(bitmap_test_vector(bitmap), expected);
+
+    for (size_t i = 0; i < expected.size(); i += 2) { ASSERT_TRUE(bitmap_remove(bitmap, expected[i])); }
+    ASSERT_FALSE(bitmap_remove(bitmap, expected[0]));
+    std::vector<uint32_t> remaining;
+    for (size_t i = 1; i < expected.size(); i += 2) { remaining.push_back(expected[i]); }
+    ASSERT_EQ(bitmap_test_vector(bitmap), remaining);
+
+    for (uint32_t value : remaining) { ASSERT_TRUE(bitmap_remove(bitmap, value)); }
+    ASSERT_TRUE(bitmap_is_empty(bitmap));
+    bitmap_destroy(bitmap);
+}
+
+TEST(Bitmap_Tests, Bitmap_Test3)
+{
+    using namespace testing;
+    std::vector<uint32_t> va = bitmap_test_values(1);
+    std::vector<uint32_t> vb = bitmap_test_values(2);
+    vb.erase(vb.begin() + vb.size() / 3, vb.begin() + vb.size() / 2);
+    for (uint32_t i = 0; i < 500; i++) { vb.push_back((9u << 16) + i * 3); }
+    DArrayU32T* arrA = bitmap_test_darr(va);
+    DArrayU32T* arrB = bitmap_test_darr(vb);
+
+    std::vector<uint32_t> expectedAnd;
+    std::vector<uint32_t> expectedOr;
+    std::vector<uint32_t> expectedAndNot;
+    std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expectedAnd));
+    std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expectedOr));
+    std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expectedAndNot));
+
+    for (uint32_t features : bitmap_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        for (int optimize = 0; optimize < 2; optimize++)
+        {
+            DBitmapT* a = bitmap_create_from_darr(arrA);
+            DBitmapT* b = bitmap_create_from_darr(arrB);
+            if (0 == optimize)
+            {
+                /* Round trip through unoptimized containers to exercise the bitset and array paths. */
+                bitmap_add(b, 5u << 16);
+                bitmap_remove(b, 5u << 16);
+            }
+            else { bitmap_run_optimize(a); }
+
+            DBitmapT* result = bitmap_and(a, b);
+            ASSERT_EQ(bitmap_test_vector(result), expectedAnd);
+            ASSERT_EQ(bitmap_cardinality(result), expectedAnd.size());
+            bitmap_destroy(result);
+
+            result = bitmap_or(a, b);
+            ASSERT_EQ(bitmap_test_vector(result), expectedOr);
+            ASSERT_EQ(bitmap_cardinality(result), expectedOr.size());
+            bitmap_destroy(result);
+
+            result = bitmap_andnot(a, b);
+            ASSERT_EQ(bitmap_test_vector(result), expectedAndNot);
+            ASSERT_EQ(bitmap_cardinality(result), expectedAndNot.size());
+            bitmap_destroy(result);
+
+            result = bitmap_andnot(a, a);
+            ASSERT_TRUE(bitmap_is_empty(result));
+            bitmap_destroy(result);
+
+            bitmap_destroy(a);
+            bitmap_destroy(b);
+        }
+    }
+    cpu_restrict_features(~0u);
+    darr_destroy(arrA);
+    darr_destroy(arrB);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DConcurrentArray.h"
+
+TEST(ConcurrentArray_Tests, ConcurrentArray_Test1)
+{
+    using namespace testing;
+    /* Within the expected length the pre-grown segment is handed over. */
+    DConcurrentArrayT* carr = carr_create(sizeof(uint32_t), 100);
+    ASSERT_NE(carr, nullptr);
+    for (uint32_t i = 0; i < 100; i++) { ASSERT_EQ(carr_push(carr, &i), i); }
+    ASSERT_EQ(carr_length(carr), 100u);
+    ASSERT_EQ(*(uint32_t*) carr_get_ptr(carr, 42), 42u);
+    DArrayU32T* darr = carr_finalize(carr);
+    ASSERT_EQ(darr_length(darr), 100u);
+    ASSERT_GE(darr_capacity(darr), 100u);
+    for (uint32_t i = 0; i < 100; i++) { ASSERT_EQ(darr_get_u32(darr, i), i); }
+    darr_push_u32(darr, 100);
+    ASSERT_EQ(darr_get_u32(darr, 100), 100u);
+    darr_destroy(darr);
+
+    /* Ranges spanning several segments, filled in place. */
+    carr = carr_create(sizeof(uint64_t), 0);
+    uint64_t values[1000];
+    for (uint64_t i = 0; i < 1000; i++) { values[i] = i * 7u; }
+    ASSERT_EQ(carr_append(carr, values, 10), 0u);
+    ASSERT_EQ(carr_append(carr, &values[10], 990), 10u);
+    size_t first = carr_reserve(carr, 500);
+    ASSERT_EQ(first, 1000u);
+    for (size_t i = 0; i < 500; i++) { *(uint64_t*) carr_get_ptr(carr, first + i) = (first + i) * 7u; }
+    darr = carr_finalize(carr);
+    ASSERT_EQ(darr_length(darr), 1500u);
+    for (size_t i = 0; i < 1500; i++) { ASSERT_EQ(*(uint64_t*) darr_get_ptr(darr, i), (uint64_t) i * 7u); }
+    darr_destroy(darr);
+
+    carr = carr_create(sizeof(uint8_t), 0);
+    darr = carr_finalize(carr);
+    ASSERT_EQ(darr_length(darr), 0u);
+    darr_destroy(darr);
+}
+
+TEST(ConcurrentArray_Tests, ConcurrentArray_Test2)
+{
+    using namespace testing;
+    const uint32_t threads = 4;
+    const uint32_t perThread = 50000;
+    DConcurrentArrayT* carr = carr_create(sizeof(uint32_t), 1000);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([carr, t, perThread]() {
+            uint32_t batch[13];
+            for (uint32_t i = 0; i < perThread;)
+            {
+                uint32_t count = (t % 2 == 0) ? 1u : ((perThread - i < 13) ? perThread - i : 13u);
+                for (uint32_t j = 0; j < count; j++) { batch[j] = t * perThread + i + j; }
+                carr_append(carr, batch, count);
+                i += count;
+            }
+        });
+    }
+    for (std::thread& worker: workers) { worker.join(); }
+
+    DArrayU32T* darr = carr_finalize(carr);
+    ASSERT_EQ(darr_length(darr), threads * perThread);
+    std::vector<uint8_t> seen(threads * perThread, 0);
+    for (size_t i = 0; i < darr_length(darr); i++) { seen[darr_get_u32(darr, i)]++; }
+    for (uint8_t hits: seen) { ASSERT_EQ(hits, 1u); }
+    darr_destroy(darr);
+}
+
+TEST(ConcurrentArray_Tests, ConcurrentArray_Test3)
+{
+    using namespace testing;
+    /* A range reserved while its segment failed to allocate finalizes as zeros. */
+    DConcurrentArrayT* carr = carr_create(sizeof(uint32_t), 16);
+    ASSERT_NE(carr, nullptr);
+    carr->reserved = 5;
+    ASSERT_EQ(carr->segments[0], nullptr);
+    DArrayU32T* darr = carr_finalize(carr);
+    ASSERT_NE(darr, nullptr);
+    ASSERT_EQ(darr_length(darr), 5u);
+    for (size_t i = 0; i < 5; i++) { ASSERT_EQ(darr_get_u32(darr, i), 0u); }
+    darr_destroy(darr);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <string>
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DConcurrentMap.h"
+
+static void concurrent_map_test_sum(const DConcurrentMapEntryT* entry, void* argument)
+{
+    *(uint64_t*) argument += entry->value;
+}
+
+TEST(ConcurrentMap_Tests, ConcurrentMap_Test1)
+{
+    using namespace testing;
+    DConcurrentMapT* map = cmap_create(DCONCURRENT_MAP_INTEGER, 3);
+    ASSERT_NE(map, nullptr);
+    ASSERT_EQ(map->shardCount, 4u);
+
+    uint64_t value = 0;
+    ASSERT_FALSE(cmap_get_int(map, 5, &value));
+    ASSERT_TRUE(cmap_upsert_int(map, 5, 50));
+    ASSERT_FALSE(cmap_upsert_int(map, 5, 55));
+    ASSERT_TRUE(cmap_get_int(map, 5, &value));
+    ASSERT_EQ(value, 55u);
+    ASSERT_EQ(cmap_increment_int(map, 5, 5), 60u);
+    ASSERT_EQ(cmap_increment_int(map, 0, 3), 3u);
+
+    /* Enough keys to grow every shard several times. */
+    for (uint64_t key = 100; key < 10100; key++) { cmap_upsert_int(map, key, key * 2u); }
+    ASSERT_EQ(cmap_length(map), 10002u);
+    for (uint64_t key = 100; key < 10100; key++)
+    {
+        ASSERT_TRUE(cmap_get_int(map, key, &value));
+        ASSERT_EQ(value, key * 2u);
+    }
+    ASSERT_FALSE(cmap_get_int(map, 10100, NULL));
+
+    uint64_t sum = 0;
+    cmap_for_each(map, concurrent_map_test_sum, &sum);
+    ASSERT_EQ(sum, 60u + 3u + 2u * (100u + 10099u) * 10000u / 2u);
+    cmap_destroy(map);
+}
+
+TEST(ConcurrentMap_Tests, ConcurrentMap_Test2)
+{
+    using namespace testing;
+    DConcurrentMapT* map = cmap_create(DCONCURRENT_MAP_STRING, 0);
+    ASSERT_NE(map, nullptr);
+
+    const int8_t* line = (const int8_t*) "GET /index.html GET /about.html GET";
+    CStringViewT get = {line, 3};
+    CStringViewT index = {&line[4], 11};
+    CStringViewT empty = {line, 0};
+    ASSERT_EQ(cmap_increment_str(map, get, 1), 1u);
+    ASSERT_EQ(cmap_increment_str(map, CStringViewT{&line[16], 3}, 1), 2u);
+    ASSERT_EQ(cmap_increment_str(map, CStringViewT{&line[32], 3}, 1), 3u);
+    ASSERT_TRUE(cmap_upsert_str(map, index, 7));
+    ASSERT_TRUE(cmap_upsert_str(map, empty, 9));
+
+    uint64_t value = 0;
+    ASSERT_TRUE(cmap_get_str(map, string_view_create((const int8_t*) "GET"), &value));
+    ASSERT_EQ(value, 3u);
+    ASSERT_TRUE(cmap_get_str(map, string_view_create((const int8_t*) "/index.html"), &value));
+    ASSERT_EQ(value, 7u);
+    ASSERT_TRUE(cmap_get_str(map, string_view_create((const int8_t*) ""), &value));
+    ASSERT_EQ(value, 9u);
+    ASSERT_FALSE(cmap_get_str(map, string_view_create((const int8_t*) "/index.htm"), &value));
+    ASSERT_EQ(cmap_length(map), 3u);
+    cmap_destroy(map);
+}
+
+TEST(ConcurrentMap_Tests, ConcurrentMap_Test3)
+{
+    using namespace testing;
+    const uint32_t threads = 4;
+    const uint32_t keys = 5000;
+    DConcurrentMapT* map = cmap_create(DCONCURRENT_MAP_STRING, 8);
+    std::vector<std::string> names;
+    for (uint32_t k = 0; k < keys; k++) { names.push_back("user-" + std::to_string(k)); }
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([map, t, &names]() {
+            for (uint32_t round = 0; round < 4; round++)
+            {
+                for (uint32_t k = 0; k < names.size(); k++)
+                {
+                    CStringViewT key = {(const int8_t*) names[(k + t * 997u) % names.size()].c_str(),
+                                        (size_t) names[(k + t * 997u) % names.size()].size()};
+                    cmap_increment_str(map, key, 1);
+                    uint64_t value = 0;
+                    cmap_get_str(map, key, &value);
+                }
+            }
+        });
+    }
+    for (std::thread& worker: workers) { worker.join(); }
+
+    ASSERT_EQ(cmap_length(map), keys);
+    for (const std::string& name: names)
+    {
+        uint64_t value = 0;
+        CStringViewT key = {(const int8_t*) name.c_str(), (size_t) name.size()};
+        ASSERT_TRUE(cmap_get_str(map, key, &value));
+        ASSERT_EQ(value, 4u * threads);
+    }
+    cmap_destroy(map);
+}
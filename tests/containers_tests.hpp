@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DContainers.hpp"
+
+static uint32_t containers_test_sum(std::span<const uint32_t> values)
+{
+    return std::accumulate(values.begin(), values.end(), 0u);
+}
+
+TEST(Containers_Tests, Containers_Test1)
+{
+    using namespace testing;
+    cutils::DArray<uint32_t> values = {5, 3, 9, 1};
+    ASSERT_EQ(values.size(), 4u);
+    ASSERT_EQ(values.get()->elementSize, sizeof(uint32_t));
+
+    /* Standard algorithms work on the iterators and spans. */
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(values[0], 1u);
+    ASSERT_EQ(values.back(), 9u);
+    ASSERT_EQ(containers_test_sum(values), 18u);
+    ASSERT_TRUE(std::ranges::is_sorted(values.span()));
+
+    values.push_back(10);
+    values.emplace_back(11u);
+    values.insert(0, 0);
+    values.erase(1);
+    ASSERT_EQ(std::vector<uint32_t>(values.begin(), values.end()), (std::vector<uint32_t>{0, 3, 5, 9, 10, 11}));
+    values.pop_back();
+    ASSERT_EQ(values.size(), 5u);
+
+    /* Moving hands the same DArrayT over. */
+    DArrayT* array = values.get();
+    cutils::DArray<uint32_t> moved = std::move(values);
+    ASSERT_EQ(moved.get(), array);
+    ASSERT_EQ(values.get(), nullptr);
+    ASSERT_TRUE(values.empty());
+    values = std::move(moved);
+    ASSERT_EQ(values.get(), array);
+
+    values.clear();
+    ASSERT_TRUE(values.empty());
+    values.resize(3);
+    ASSERT_EQ(values.size(), 3u);
+}
+
+TEST(Containers_Tests, Containers_Test2)
+{
+    using namespace testing;
+    cutils::DArray<uint64_t> values;
+    values.reserve(1000);
+    for (uint64_t i = 0; i < 1000; i++) { values.push_back(i); }
+
+    /* Copies share the data until one of them writes. */
+    cutils::DArray<uint64_t> copy = values;
+    const cutils::DArray<uint64_t>& constCopy = copy;
+    ASSERT_EQ(constCopy.data(), std::as_const(values).data());
+    copy[0] = 42;
+    ASSERT_NE(std::as_const(copy).data(), std::as_const(values).data());
+    ASSERT_EQ(values[0], 0u);
+    ASSERT_EQ(copy[0], 42u);
+    ASSERT_EQ(copy[999], 999u);
+
+    copy = values;
+    ASSERT_EQ(copy[0], 0u);
+
+    /* Adopting and releasing a C array. */
+    DArrayT* raw = darr_create_u32();
+    darr_push_u32(raw, 7);
+    cutils::DArray<uint32_t> adopted(raw);
+    ASSERT_EQ(adopted[0], 7u);
+    DArrayT* released = adopted.release();
+    ASSERT_EQ(released, raw);
+    darr_destroy(released);
+}
+
+TEST(Containers_Tests, Containers_Test3)
+{
+    using namespace testing;
+    cutils::DString text = "hello";
+    ASSERT_EQ(text.size(), 5u);
+    ASSERT_EQ(text, "hello");
+    ASSERT_EQ(text.get()->data[5], '\0');
+
+    text += ' ';
+    text += std::string("world");
+    ASSERT_EQ(text.view(), "hello world");
+    ASSERT_EQ(text.get()->data[text.size()], '\0');
+
+    /* Appending a view into the string itself. */
+    text.append(std::string_view(text).substr(0, 5));
+    ASSERT_EQ(text, "hello worldhello");
+    text.insert(5, ",");
+    ASSERT_EQ(text, "hello, worldhello");
+    text.erase(0);
+    ASSERT_EQ(text, "ello, worldhello");
+
+    std::transform(text.begin(), text.end(), text.begin(), [](char c) { return (char) toupper(c); });
+    ASSERT_EQ(text, "ELLO, WORLDHELLO");
+    ASSERT_EQ(std::count(text.begin(), text.end(), 'L'), 5);
+    ASSERT_LT(text, cutils::DString("F"));
+    ASSERT_GT(text, std::string_view("A"));
+
+    /* Copies of heap strings share the data, short strings are copied. */
+    cutils::DString copy = text;
+    ASSERT_NE(copy.get()->data, text.get()->data);
+    copy[0] = 'e';
+    ASSERT_EQ(text[0], 'E');
+    cutils::DString longText = "a string too long to be stored inline";
+    cutils::DString longCopy = longText;
+    ASSERT_EQ(longCopy.get()->data, longText.get()->data);
+    longCopy[0] = 'A';
+    ASSERT_NE(longCopy.get()->data, longText.get()->data);
+    ASSERT_EQ(longText[0], 'a');
+
+    DStringT* raw = text.get();
+    cutils::DString moved = std::move(text);
+    ASSERT_EQ(moved.get(), raw);
+    ASSERT_TRUE(text.empty());
+    text = std::move(copy);
+    ASSERT_EQ(text, "eLLO, WORLDHELLO");
+
+    cutils::DString empty;
+    ASSERT_TRUE(empty.empty());
+    empty.push_back('x');
+    ASSERT_EQ(empty, "x");
+    empty.clear();
+    ASSERT_EQ(empty.view(), "");
+}
+
+TEST(Containers_Tests, Containers_Test4)
+{
+    using namespace testing;
+    /* Elements of the array itself survive the reallocation they cause. */
+    cutils::DArray<uint64_t> values = {7};
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        values.shrink_to_fit();
+        values.push_back(values[0]);
+        values.shrink_to_fit();
+        values.insert(0, values[values.size() - 1u]);
+    }
+    ASSERT_EQ(values.size(), 25u);
+    for (uint64_t value: values) { ASSERT_EQ(value, 7u); }
+}
@@ -822,4 +822,54 @@ TEST(DArr_Tests, DArr_Test57)
     ASSERT_EQ(arr->length, 0);
 
     darr_destroy(arr);
-}
\ No newline at end of file
+}
+
+TEST(DArr_Tests, DArr_Test58)
+{
+    using namespace testing;
+    DArrayU32T* arr = darr_create_u32();
+    for (uint32_t i = 0; i < 100; i++) { darr_push_u32(arr, i); }
+
+    DArrayU32T* first = darr_clone(arr);
+    DArrayU32T* second = darr_clone(first);
+    ASSERT_EQ(first->data, arr->data);
+    ASSERT_EQ(second->data, arr->data);
+    ASSERT_EQ(*((uint32_t*) arr->storageContext), 3u);
+
+    darr_push_u32(first, 100);
+    ASSERT_NE(first->data, arr->data);
+    ASSERT_EQ(first->length, 101);
+    ASSERT_EQ(arr->length, 100);
+    ASSERT_EQ(darr_get_u32(first, 100), 100u);
+    ASSERT_EQ(*((uint32_t*) arr->storageContext), 2u);
+
+    darr_make_unique(second);
+    *darr_get_u32_ptr(second, 0) = 42u;
+    ASSERT_EQ(darr_get_u32(arr, 0), 0u);
+    ASSERT_EQ(darr_get_u32(second, 0), 42u);
+
+    /* The last owner takes the data back without copying. */
+    int8_t* data = arr->data;
+    darr_erase(arr, 0);
+    ASSERT_EQ(arr->data, data);
+    ASSERT_EQ(arr->storage, nullptr);
+
+    darr_destroy(first);
+    darr_destroy(second);
+    darr_destroy(arr);
+}
+
+TEST(DArr_Tests, DArr_Test59)
+{
+    using namespace testing;
+    /* A view over memory it can not grow, like a loaded file. Pushing must fail without touching it. */
+    static const DArrayStorageT storage = {NULL, NULL, NULL};
+    uint32_t backing[5] = {1, 2, 3, 4, 0xBAADF00D};
+    DArrayU32T view = {4, 4, sizeof(uint32_t), (int8_t*) backing, &storage, NULL};
+
+    darr_push_u32(&view, 5);
+    ASSERT_EQ(view.length, 4);
+    ASSERT_EQ(view.capacity, 4);
+    ASSERT_EQ(backing[3], 4u);
+    ASSERT_EQ(backing[4], 0xBAADF00D);
+}
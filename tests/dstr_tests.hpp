@@ -445,3 +445,191 @@ TEST(DString_Tests, DString_Test38)
 
     str_arr_destroy(arr);
 }
+
+TEST(DString_Tests, DString_Test39)
+{
+    using namespace testing;
+    /* Longer than DSTRING_INLINE_CAPACITY, so the data is on the heap and shared. */
+    DStringT* str = str_create("shared payload on the heap", 26);
+    DStringT* first = str_clone(str);
+    DStringT* second = str_clone(str);
+    ASSERT_EQ(first->data, str->data);
+    ASSERT_EQ(*str->refCount, 3u);
+
+    str_append_cstring(first, " copy");
+    ASSERT_NE(first->data, str->data);
+    ASSERT_STREQ(first->data, "shared payload on the heap copy");
+    ASSERT_EQ(str->length, 26);
+    ASSERT_EQ(memcmp(str->data, "shared payload on the heap", 26), 0);
+    ASSERT_EQ(*str->refCount, 2u);
+
+    str_destroy(str);
+    ASSERT_EQ(*second->refCount, 1u);
+    int8_t* data = second->data;
+    str_erase(second, 0);
+    ASSERT_EQ(second->data, data);
+    ASSERT_EQ(second->refCount, nullptr);
+    ASSERT_EQ(memcmp(second->data, "hared payload on the heap", 25), 0);
+
+    str_destroy(first);
+    str_destroy(second);
+}
+
+TEST(DString_Tests, DString_Test40)
+{
+    using namespace testing;
+    /* Short strings live inside the DStringT. */
+    DStringT* str = str_create("token", 5);
+    ASSERT_TRUE(str_is_inline(str));
+    ASSERT_EQ(str->capacity, 5);
+    ASSERT_STREQ(str->data, "token");
+
+    DStringT* clone = str_clone(str);
+    ASSERT_TRUE(str_is_inline(clone));
+    ASSERT_NE(clone->data, str->data);
+    ASSERT_EQ(clone->refCount, nullptr);
+    ASSERT_STREQ(clone->data, "token");
+
+    /* Growing past the inline capacity moves the data to the heap and keeps it intact. */
+    str_append_cstring(str, "_0123456789");
+    ASSERT_TRUE(str_is_inline(str));
+    ASSERT_STREQ(str->data, "token_0123456789");
+    str_append_cstring(str, "abcdefghij");
+    ASSERT_FALSE(str_is_inline(str));
+    ASSERT_STREQ(str->data, "token_0123456789abcdefghij");
+    int8_t c = 'X';
+    str_insert(str, 0, &c);
+    ASSERT_EQ(memcmp(str->data, "Xtoken_0123456789abcdefghij", 27), 0);
+
+    /* Shrinking a short heap string moves it back inline. */
+    str_resize(str, 6);
+    str_shring_to_fit(str);
+    ASSERT_TRUE(str_is_inline(str));
+    ASSERT_EQ(str->capacity, 6);
+    ASSERT_EQ(memcmp(str->data, "Xtoken", 6), 0);
+
+    DStringT* empty = str_create_empty(DSTRING_INLINE_CAPACITY);
+    ASSERT_TRUE(str_is_inline(empty));
+    str_reserve(empty, DSTRING_INLINE_CAPACITY + 1);
+    ASSERT_FALSE(str_is_inline(empty));
+
+    str_destroy(empty);
+    str_destroy(clone);
+    str_destroy(str);
+}
+
+static const uint32_t dstr_test_feature_masks[] = {~0u, CPU_FEATURE_AVX2 | CPU_FEATURE_SSE42, CPU_FEATURE_SSE42,
+                                                   CPU_FEATURE_NONE};
+
+TEST(DString_Tests, DString_Test41)
+{
+    using namespace testing;
+    /* Each case is placed so the invalid sequence crosses a 16, 32 and 64 byte block boundary. */
+    struct {
+        const char* bytes;
+        uint32_t length;
+        BOOL valid;
+    } cases[] = {
+            {"\xC3\xA9", 2, TRUE},          {"\xE2\x82\xAC", 3, TRUE},  {"\xF0\x9F\x98\x80", 4, TRUE},
+            {"\xF4\x8F\xBF\xBF", 4, TRUE},  {"\xED\x9F\xBF", 3, TRUE},  {"\xC0\xAF", 2, FALSE},
+            {"\xC1\xBF", 2, FALSE},         {"\xE0\x9F\xBF", 3, FALSE}, {"\xF0\x8F\xBF\xBF", 4, FALSE},
+            {"\xED\xA0\x80", 3, FALSE},     {"\xF4\x90\x80\x80", 4, FALSE}, {"\xF5\x80\x80\x80", 4, FALSE},
+            {"\xFF", 1, FALSE},             {"\x80", 1, FALSE},         {"\xC3\x28", 2, FALSE},
+            {"\xE2\x82\x28", 3, FALSE},     {"\xF0\x9F\x98\x28", 4, FALSE}, {"\xE2\x82", 2, FALSE},
+            {"\xF0\x9F\x98", 3, FALSE},
+    };
+
+    for (uint32_t features: dstr_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        for (const auto& test: cases)
+        {
+            for (uint32_t offset = 0; offset < 140; offset++)
+            {
+                int8_t buffer[256];
+                memset(buffer, 'a', sizeof(buffer));
+                memcpy(&buffer[offset], test.bytes, test.length);
+                size_t error = 0;
+                /* Truncated sequences are also checked at the very end of the input. */
+                size_t length = (offset + test.length < 70u) ? offset + test.length : sizeof(buffer);
+                ASSERT_EQ(cstr_validate_utf8(buffer, length, &error), test.valid);
+                ASSERT_EQ(error, (TRUE == test.valid) ? length : offset);
+            }
+        }
+    }
+    cpu_restrict_features(~0u);
+
+    size_t error = 1;
+    ASSERT_TRUE(cstr_validate_utf8("", 0, &error));
+    ASSERT_EQ(error, 0u);
+}
+
+TEST(DString_Tests, DString_Test42)
+{
+    using namespace testing;
+    /* Valid text, then the same text with single bytes replaced, checked against the scalar scan. */
+    const char* symbols[] = {"a", "bc", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF"};
+    uint32_t seed = 12345;
+    int8_t text[4096];
+    size_t length = 0;
+    while (length + 4u <= sizeof(text))
+    {
+        seed = seed * 1103515245u + 12345u;
+        const char* symbol = symbols[(seed >> 16) % 6u];
+        size_t size = strlen(symbol);
+        memcpy(&text[length], symbol, size);
+        length += size;
+    }
+
+    for (uint32_t features: dstr_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        size_t error = 0;
+        ASSERT_TRUE(cstr_validate_utf8(text, length, &error));
+        ASSERT_EQ(error, length);
+    }
+
+    for (uint32_t round = 0; round < 300; round++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        size_t position = (seed >> 8) % length;
+        int8_t saved = text[position];
+        text[position] = (int8_t) (seed >> 24);
+
+        cpu_restrict_features(CPU_FEATURE_NONE);
+        size_t expected = 0;
+        BOOL valid = cstr_validate_utf8(text, length, &expected);
+        for (uint32_t features: dstr_test_feature_masks)
+        {
+            cpu_restrict_features(features);
+            size_t error = 0;
+            ASSERT_EQ(cstr_validate_utf8(text, length, &error), valid);
+            ASSERT_EQ(error, expected);
+        }
+        text[position] = saved;
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(DString_Tests, DString_Test43)
+{
+    using namespace testing;
+    /* Every start alignment and a terminator at the end of the last aligned block. 0x01 bytes before a zero
+     * byte are the false positive of the SWAR test. */
+    alignas(64) int8_t buffer[512];
+    for (uint32_t features: dstr_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        for (uint32_t length = 0; length < 300; length++)
+        {
+            for (uint32_t start = 0; start < 70; start++)
+            {
+                int8_t* str = &buffer[sizeof(buffer) - 1u - length - start];
+                memset(buffer, (0u == (start & 1u)) ? 0x01 : 'a', sizeof(buffer));
+                str[length] = '\0';
+                ASSERT_EQ(cstr_length(str), length);
+            }
+        }
+    }
+    cpu_restrict_features(~0u);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DEpochArray.h"
+
+TEST(EpochArray_Tests, EpochArray_Test1)
+{
+    using namespace testing;
+    DEpochDomainT* domain = epoch_domain_create(8);
+    DEpochParticipantT* writer = epoch_register(domain);
+    DArrayT* darr = darr_create_generic(sizeof(uint64_t));
+    ASSERT_TRUE(darr_epoch_attach(darr, writer));
+    ASSERT_TRUE(darr_is_epoch_managed(darr));
+    ASSERT_FALSE(darr_epoch_attach(darr, writer));
+
+    const uint64_t count = 100000;
+    uint32_t done = 0;
+    std::vector<std::thread> readers;
+    std::vector<uint64_t> errors(3, 0);
+    for (uint32_t r = 0; r < 3; r++)
+    {
+        readers.emplace_back([domain, darr, &done, &errors, r]() {
+            DEpochParticipantT* self = epoch_register(domain);
+            size_t seen = 0;
+            while (0u == CATOMIC_LOAD_ACQUIRE(&done))
+            {
+                size_t length = 0;
+                epoch_enter(self);
+                const uint64_t* values = (const uint64_t*) darr_epoch_read(darr, &length);
+                if (length < seen) { errors[r]++; }
+                if ((length > 0) && ((values[0] != 0) || (values[length - 1] != length - 1u) ||
+                                     (values[length / 2] != length / 2))) { errors[r]++; }
+                seen = length;
+                epoch_exit(self);
+            }
+            epoch_unregister(self);
+        });
+    }
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        darr_push_generic(darr, &i);
+        if (i % 64 == 0) { darr_epoch_publish(darr); }
+    }
+    darr_epoch_publish(darr);
+    CATOMIC_STORE_RELEASE(&done, 1u);
+    for (std::thread& reader: readers) { reader.join(); }
+
+    size_t length = 0;
+    const uint64_t* values = (const uint64_t*) darr_epoch_read(darr, &length);
+    ASSERT_EQ(length, count);
+    ASSERT_EQ(values[count - 1], count - 1);
+    for (uint64_t errorCount: errors) { ASSERT_EQ(errorCount, 0u); }
+
+    darr_destroy(darr);
+    epoch_unregister(writer);
+    epoch_domain_destroy(domain);
+}
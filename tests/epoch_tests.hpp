@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "CEpoch.h"
+
+static uint32_t epoch_test_freed = 0;
+
+static void epoch_test_release(void* pointer, size_t size)
+{
+    epoch_test_freed++;
+    CFREE(pointer, size);
+}
+
+TEST(Epoch_Tests, Epoch_Test1)
+{
+    using namespace testing;
+    DEpochDomainT* domain = epoch_domain_create(2);
+    ASSERT_NE(domain, nullptr);
+    DEpochParticipantT* writer = epoch_register(domain);
+    DEpochParticipantT* reader = epoch_register(domain);
+    ASSERT_NE(writer, nullptr);
+    ASSERT_NE(reader, nullptr);
+    ASSERT_EQ(epoch_register(domain), nullptr);
+
+    /* A reader inside a read section keeps the block alive however often the writer reclaims. */
+    epoch_test_freed = 0;
+    epoch_enter(reader);
+    epoch_enter(reader);
+    epoch_exit(reader);
+    epoch_retire_with(writer, CMALLOC(16), 16, epoch_test_release);
+    for (uint32_t i = 0; i < 10; i++) { epoch_reclaim(writer); }
+    ASSERT_EQ(epoch_test_freed, 0u);
+
+    epoch_exit(reader);
+    size_t freed = 0;
+    for (uint32_t i = 0; i < 3; i++) { freed += epoch_reclaim(writer); }
+    ASSERT_EQ(freed, 1u);
+    ASSERT_EQ(epoch_test_freed, 1u);
+
+    /* Crossing the threshold reclaims on its own. */
+    for (uint32_t i = 0; i < 3 * CEPOCH_RECLAIM_THRESHOLD; i++)
+    {
+        epoch_retire_with(writer, CMALLOC(8), 8, epoch_test_release);
+    }
+    ASSERT_GT(epoch_test_freed, 1u);
+
+    /* Blocks of unregistered participants are freed by others or by the domain. */
+    epoch_enter(reader);
+    epoch_retire_with(writer, CMALLOC(8), 8, epoch_test_release);
+    epoch_unregister(writer);
+    DEpochParticipantT* next = epoch_register(domain);
+    ASSERT_EQ(next, writer);
+    epoch_exit(reader);
+    epoch_retire(next, CMALLOC(32), 32);
+    epoch_unregister(next);
+    epoch_unregister(reader);
+    epoch_domain_destroy(domain);
+    ASSERT_EQ(epoch_test_freed, 3u * CEPOCH_RECLAIM_THRESHOLD + 2u);
+}
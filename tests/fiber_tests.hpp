@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "CFiber.h"
+
+typedef struct {
+    uint32_t counter;
+    uint32_t order[8];
+    uint32_t next;
+} FiberTestState;
+
+static void fiber_test_ping(void* argument)
+{
+    FiberTestState* state = (FiberTestState*) argument;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        CATOMIC_FETCH_ADD(&state->counter, 1u);
+        fiber_yield();
+    }
+}
+
+static void fiber_test_record(void* argument)
+{
+    FiberTestState* state = (FiberTestState*) argument;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        state->order[state->next++] = (fiber_current() != NULL) ? i : 99u;
+        fiber_yield();
+    }
+}
+
+/* Spawns both recorders from a worker so they are queued before either runs. */
+static void fiber_test_spawn_records(void* argument)
+{
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        EXPECT_TRUE(fiber_spawn(fiber_current()->scheduler, fiber_test_record, argument));
+    }
+}
+
+static void fiber_test_child(void* argument) { CATOMIC_FETCH_ADD((uint32_t*) argument, 1u); }
+
+static void fiber_test_parent(void* argument)
+{
+    FiberTestState* state = (FiberTestState*) argument;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(fiber_spawn(fiber_current()->scheduler, fiber_test_child, &state->counter));
+    }
+}
+
+typedef struct {
+    CMutexT lock;
+    std::vector<DFiberT*> parked;
+    uint32_t resumed;
+} FiberTestParking;
+
+static void fiber_test_publish(DFiberT* fiber, void* argument)
+{
+    FiberTestParking* parking = (FiberTestParking*) argument;
+    csync_mutex_lock(&parking->lock);
+    parking->parked.push_back(fiber);
+    csync_mutex_unlock(&parking->lock);
+}
+
+static void fiber_test_park(void* argument)
+{
+    FiberTestParking* parking = (FiberTestParking*) argument;
+    fiber_suspend(fiber_test_publish, parking);
+    CATOMIC_FETCH_ADD(&parking->resumed, 1u);
+}
+
+static void fiber_test_read(void* argument) { *(uint32_t*) argument = 42u; }
+
+static void fiber_test_blocking(void* argument)
+{
+    uint32_t value = 0;
+    fiber_blocking_call(fiber_test_read, &value);
+    if (42u == value) { CATOMIC_FETCH_ADD((uint32_t*) argument, 1u); }
+}
+
+TEST(Fiber_Tests, Fiber_Test1)
+{
+    using namespace testing;
+    ASSERT_EQ(fiber_current(), nullptr);
+    fiber_yield();
+
+    /* One worker runs its fibers round robin. */
+    DFiberSchedulerT* scheduler = fiber_scheduler_create(1, 0, 0);
+    ASSERT_NE(scheduler, nullptr);
+    ASSERT_EQ(fiber_scheduler_worker_count(scheduler), 1u);
+    FiberTestState state = {};
+    ASSERT_TRUE(fiber_spawn(scheduler, fiber_test_spawn_records, &state));
+    fiber_scheduler_wait_idle(scheduler);
+    ASSERT_EQ(state.next, 4u);
+    ASSERT_EQ(state.order[0], 0u);
+    ASSERT_EQ(state.order[1], 0u);
+    ASSERT_EQ(state.order[2], 1u);
+    ASSERT_EQ(state.order[3], 1u);
+    fiber_scheduler_destroy(scheduler);
+
+    scheduler = fiber_scheduler_create(4, 16 * 1024, 0);
+    ASSERT_NE(scheduler, nullptr);
+    for (uint32_t i = 0; i < 100; i++) { ASSERT_TRUE(fiber_spawn(scheduler, fiber_test_ping, &state)); }
+    fiber_scheduler_destroy(scheduler);
+    ASSERT_EQ(state.counter, 100000u);
+}
+
+TEST(Fiber_Tests, Fiber_Test2)
+{
+    using namespace testing;
+    DFiberSchedulerT* scheduler = fiber_scheduler_create(0, 0, 0);
+    ASSERT_NE(scheduler, nullptr);
+    ASSERT_EQ(scheduler->stacks.stackSize % scheduler->stacks.guardSize, 0u);
+
+    /* Fibers spawning fibers, stacks of finished fibers are reused. */
+    FiberTestState state = {};
+    for (uint32_t round = 0; round < 3; round++)
+    {
+        for (uint32_t i = 0; i < 100; i++) { ASSERT_TRUE(fiber_spawn(scheduler, fiber_test_parent, &state)); }
+        fiber_scheduler_wait_idle(scheduler);
+    }
+    ASSERT_EQ(state.counter, 3000u);
+    ASSERT_LE(scheduler->stacks.mapped, CFIBER_STACK_POOL_LIMIT);
+    ASSERT_EQ(scheduler->stacks.freeCount, scheduler->stacks.mapped);
+    fiber_scheduler_destroy(scheduler);
+
+    DFiberStackPoolT pool;
+    fiber_stack_pool_init(&pool, 1000);
+    ASSERT_EQ(pool.stackSize, pool.guardSize);
+    int8_t* stack = fiber_stack_acquire(&pool);
+    ASSERT_NE(stack, nullptr);
+    stack[pool.guardSize] = 1;
+    stack[pool.guardSize + pool.stackSize - 1] = 1;
+    fiber_stack_release(&pool, stack);
+    ASSERT_EQ(fiber_stack_acquire(&pool), stack);
+    fiber_stack_release(&pool, stack);
+    fiber_stack_pool_destroy(&pool);
+    ASSERT_EQ(pool.mapped, 0u);
+}
+
+TEST(Fiber_Tests, Fiber_Test3)
+{
+    using namespace testing;
+    DFiberSchedulerT* scheduler = fiber_scheduler_create(2, 0, 0);
+    ASSERT_NE(scheduler, nullptr);
+
+    /* Suspended fibers resumed from another thread, as an I/O completion handler would. */
+    FiberTestParking parking;
+    csync_mutex_init(&parking.lock);
+    parking.resumed = 0;
+    std::thread completer([&parking]() {
+        size_t done = 0;
+        while (done < 1000)
+        {
+            csync_mutex_lock(&parking.lock);
+            std::vector<DFiberT*> ready(parking.parked.begin() + done, parking.parked.end());
+            csync_mutex_unlock(&parking.lock);
+            for (DFiberT* fiber: ready) { fiber_resume(fiber); }
+            done += ready.size();
+            if (ready.empty()) { cthread_yield(); }
+        }
+    });
+    for (uint32_t i = 0; i < 1000; i++) { ASSERT_TRUE(fiber_spawn(scheduler, fiber_test_park, &parking)); }
+    completer.join();
+    fiber_scheduler_destroy(scheduler);
+    ASSERT_EQ(parking.resumed, 1000u);
+}
+
+TEST(Fiber_Tests, Fiber_Test4)
+{
+    using namespace testing;
+    /* Blocking calls on blocking threads, and inline when there are none. */
+    for (uint32_t blockingThreads: {2u, 0u})
+    {
+        DFiberSchedulerT* scheduler = fiber_scheduler_create(2, 0, blockingThreads);
+        ASSERT_NE(scheduler, nullptr);
+        uint32_t counter = 0;
+        for (uint32_t i = 0; i < 500; i++) { ASSERT_TRUE(fiber_spawn(scheduler, fiber_test_blocking, &counter)); }
+        fiber_scheduler_destroy(scheduler);
+        ASSERT_EQ(counter, 500u);
+    }
+
+    uint32_t value = 0;
+    fiber_blocking_call(fiber_test_read, &value);
+    ASSERT_EQ(value, 42u);
+}
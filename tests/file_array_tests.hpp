@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include "DFileArray.h"
+#include <cstdio>
+
+static const int8_t* file_array_test_path = (const int8_t*) "file_array_test.bin";
+
+TEST(FileArray_Tests, FileArray_Test1)
+{
+    using namespace testing;
+    std::remove((const char*) file_array_test_path);
+
+    DArrayU32T* arr = darr_file_open(file_array_test_path, sizeof(uint32_t));
+    ASSERT_NE(arr, nullptr);
+    ASSERT_TRUE(darr_is_file_backed(arr));
+    ASSERT_EQ(darr_length(arr), 0u);
+
+    /* Enough elements to grow the file past several growth steps. */
+    for (uint32_t i = 0; i < 700000; i++) { darr_push_u32(arr, i * 3u); }
+    ASSERT_EQ(darr_length(arr), 700000u);
+    ASSERT_GE(darr_capacity(arr), 700000u);
+    ASSERT_EQ(darr_get_u32(arr, 123456), 123456u * 3u);
+    ASSERT_EQ(darr_file_sync(arr, FALSE), FILE_OPERATION_SUCCESS);
+
+    darr_resize(arr, 500000);
+    darr_shrink_to_fit(arr);
+    ASSERT_EQ(darr_file_sync(arr, TRUE), FILE_OPERATION_SUCCESS);
+    darr_destroy(arr);
+
+    /* The data survives reopening, the file is also a read-only view. */
+    arr = darr_file_open(file_array_test_path, sizeof(uint32_t));
+    ASSERT_NE(arr, nullptr);
+    ASSERT_EQ(darr_length(arr), 500000u);
+    ASSERT_EQ(darr_get_u32(arr, 499999), 499999u * 3u);
+    darr_push_u32(arr, 7u);
+    darr_destroy(arr);
+
+    DArrayU32T* view = darr_load_view(file_array_test_path);
+    ASSERT_NE(view, nullptr);
+    ASSERT_EQ(darr_length(view), 500001u);
+    ASSERT_EQ(darr_get_u32(view, 500000), 7u);
+    ASSERT_FALSE(darr_is_file_backed(view));
+    darr_destroy(view);
+
+    ASSERT_EQ(darr_file_open(file_array_test_path, sizeof(uint16_t)), nullptr);
+    std::remove((const char*) file_array_test_path);
+}
+
+TEST(FileArray_Tests, FileArray_Test2)
+{
+    using namespace testing;
+    std::remove((const char*) file_array_test_path);
+    DArrayU32T* arr = darr_file_open(file_array_test_path, sizeof(uint32_t));
+    ASSERT_NE(arr, nullptr);
+    darr_push_u32(arr, 1u);
+
+    /* The state a failed remap leaves behind, later growth and syncs must fail instead of crashing. */
+    FileMappingT* mapping = (FileMappingT*) arr->storageContext;
+    munmap(mapping->data, mapping->size);
+    mapping->data = NULL;
+    mapping->size = 0;
+    arr->data = NULL;
+    arr->capacity = 0;
+    arr->length = 0;
+
+    darr_push_u32(arr, 2u);
+    ASSERT_EQ(darr_length(arr), 0u);
+    ASSERT_EQ(darr_file_sync(arr, FALSE), FILE_WRITE_ERROR);
+    darr_destroy(arr);
+    std::remove((const char*) file_array_test_path);
+}
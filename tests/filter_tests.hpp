@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include "DArrayFilter.h"
+#include <vector>
+
+static BOOL filter_test_is_odd(const void* element, void* userData)
+{
+    (void) userData;
+    return (0u != (*(const uint32_t*) element & 1u));
+}
+
+static BOOL filter_test_is_short_multiple(const void* element, void* userData)
+{
+    return (0 == (*(const uint16_t*) element % *(uint16_t*) userData));
+}
+
+static const uint32_t filter_test_feature_masks[] = {~0u, CPU_FEATURE_AVX2 | CPU_FEATURE_BMI2, CPU_FEATURE_NONE};
+
+TEST(Filter_Tests, Filter_Test1)
+{
+    using namespace testing;
+    for (uint32_t features : filter_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        for (size_t count : {0u, 5u, 64u, 200u, 1000u})
+        {
+            DArrayU32T* src = darr_create_u32();
+            std::vector<uint64_t> mask(DARRAY_MASK_WORDS(count) + 1, 0);
+            std::vector<uint32_t> expected;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                darr_push_u32(src, i * 3u);
+                if (0u != ((i * 2654435761u) & 0x10000u))
+                {
+                    mask[i / 64] |= 1ull << (i % 64);
+                    expected.push_back(i * 3u);
+                }
+            }
+
+            DArrayU32T* dest = darr_create_u32();
+            ASSERT_EQ(darr_filter_by_mask(dest, src, mask.data()), expected.size());
+            ASSERT_EQ(darr_length(dest), expected.size());
+            for (size_t i = 0; i < expected.size(); i++) { ASSERT_EQ(darr_get_u32(dest, i), expected[i]); }
+
+            ASSERT_EQ(darr_filter_by_mask(src, src, mask.data()), expected.size());
+            for (size_t i = 0; i < expected.size(); i++) { ASSERT_EQ(darr_get_u32(src, i), expected[i]); }
+
+            darr_destroy(dest);
+            darr_destroy(src);
+        }
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Filter_Tests, Filter_Test2)
+{
+    using namespace testing;
+    DArrayT* src = darr_create_generic(3);
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        uint8_t triple[3] = {i, (uint8_t) (i + 1), (uint8_t) (i + 2)};
+        darr_push_generic(src, triple);
+    }
+    uint64_t mask = 0x2A5;// elements 0, 2, 5, 7, 9
+    DArrayT* dest = darr_create_generic(3);
+    ASSERT_EQ(darr_filter_by_mask(dest, src, &mask), 5);
+    ASSERT_EQ(((uint8_t*) darr_get_ptr(dest, 2))[0], 5);
+    ASSERT_EQ(((uint8_t*) darr_get_ptr(dest, 4))[2], 11);
+
+    DArrayU32T* wrong = darr_create_u32();
+    ASSERT_EQ(darr_filter_by_mask(wrong, src, &mask), 0);
+    darr_destroy(wrong);
+    darr_destroy(dest);
+    darr_destroy(src);
+}
+
+TEST(Filter_Tests, Filter_Test3)
+{
+    using namespace testing;
+    DArrayU32T* arr = darr_create_u32();
+    for (uint32_t i = 0; i < 101; i++) { darr_push_u32(arr, i); }
+    ASSERT_EQ(darr_compact(arr, filter_test_is_odd, NULL), 50);
+    ASSERT_EQ(darr_length(arr), 51);
+    for (uint32_t i = 0; i < 51; i++) { ASSERT_EQ(darr_get_u32(arr, i), i * 2); }
+    darr_destroy(arr);
+
+    DArrayU16T* shorts = darr_create_u16();
+    for (uint16_t i = 0; i < 30; i++) { darr_push_u16(shorts, i); }
+    uint16_t divisor = 3;
+    ASSERT_EQ(darr_compact(shorts, filter_test_is_short_multiple, &divisor), 10);
+    ASSERT_EQ(darr_get_u16(shorts, 0), 1);
+    ASSERT_EQ(darr_get_u16(shorts, 1), 2);
+    ASSERT_EQ(darr_get_u16(shorts, 2), 4);
+    darr_destroy(shorts);
+}
+
+TEST(Filter_Tests, Filter_Test4)
+{
+    using namespace testing;
+    for (uint32_t features : filter_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        DArrayU32T* src = darr_create_u32();
+        for (uint32_t i = 0; i < 300; i++) { darr_push_u32(src, (i * 2654435761u) >> 24); }
+        std::vector<uint64_t> mask(DARRAY_MASK_WORDS(300), 0);
+
+        size_t expected = 0;
+        for (uint32_t i = 0; i < 300; i++) { expected += (darr_get_u32(src, i) >= 10 && darr_get_u32(src, i) <= 100); }
+        ASSERT_EQ(darr_mask_range_u32(src, 10, 100, mask.data()), expected);
+        for (uint32_t i = 0; i < 300; i++)
+        {
+            BOOL inRange = darr_get_u32(src, i) >= 10 && darr_get_u32(src, i) <= 100;
+            ASSERT_EQ(((mask[i / 64] >> (i % 64)) & 1u) != 0, inRange);
+        }
+        ASSERT_EQ(darr_mask_range_u32(src, 0, 0xFFFFFFFFu, mask.data()), 300);
+        ASSERT_EQ(darr_mask_range_u32(src, 5, 4, mask.data()), 0);
+        darr_destroy(src);
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Filter_Tests, Filter_Test5)
+{
+    using namespace testing;
+    for (uint32_t features : filter_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        DArrayU32T* src = darr_create_u32();
+        for (uint32_t i = 0; i < 100; i++) { darr_push_u32(src, i * 10u); }
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i < 37; i++) { indices.push_back((i * 31u) % 100u); }
+
+        DArrayU32T* gathered = darr_create_u32();
+        darr_gather(gathered, src, indices.data(), indices.size());
+        ASSERT_EQ(darr_length(gathered), 37);
+        for (uint32_t i = 0; i < 37; i++) { ASSERT_EQ(darr_get_u32(gathered, i), indices[i] * 10u); }
+
+        DArrayU32T* scattered = darr_create_u32();
+        darr_resize(scattered, 100);
+        for (uint32_t i = 0; i < 100; i++) { *darr_get_u32_ptr(scattered, i) = 0xFFFFFFFFu; }
+        darr_scatter(scattered, gathered, indices.data());
+        for (uint32_t i = 0; i < 37; i++) { ASSERT_EQ(darr_get_u32(scattered, indices[i]), indices[i] * 10u); }
+
+        darr_destroy(scattered);
+        darr_destroy(gathered);
+        darr_destroy(src);
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Filter_Tests, Filter_Test6)
+{
+    using namespace testing;
+    DArrayI16T* src = darr_create_i16();
+    for (int16_t i = 0; i < 20; i++) { darr_push_i16(src, (int16_t) -i); }
+    uint32_t indices[] = {19, 0, 7, 7};
+    DArrayI16T* gathered = darr_create_i16();
+    darr_gather(gathered, src, indices, 4);
+    ASSERT_EQ(darr_get_i16(gathered, 0), -19);
+    ASSERT_EQ(darr_get_i16(gathered, 1), 0);
+    ASSERT_EQ(darr_get_i16(gathered, 3), -7);
+
+    uint32_t targets[] = {3, 2, 1, 1};
+    DArrayI16T* scattered = darr_create_i16();
+    darr_resize(scattered, 4);
+    darr_scatter(scattered, gathered, targets);
+    ASSERT_EQ(darr_get_i16(scattered, 3), -19);
+    ASSERT_EQ(darr_get_i16(scattered, 2), 0);
+    ASSERT_EQ(darr_get_i16(scattered, 1), -7);
+
+    darr_gather(src, src, indices, 4);
+    ASSERT_EQ(darr_length(src), 20);
+    darr_destroy(scattered);
+    darr_destroy(gathered);
+    darr_destroy(src);
+}
+
+TEST(Filter_Tests, Filter_Test7)
+{
+    using namespace testing;
+    /* Filtering, compacting or scattering into a clone leaves the array it was cloned from alone. */
+    const uint32_t values[] = {9, 4, 7, 2, 5, 6, 3, 8};
+    DArrayU32T* source = darr_create_u32();
+    for (uint32_t value: values) { darr_push_u32(source, value); }
+
+    DArrayU32T* compacted = darr_clone(source);
+    ASSERT_EQ(darr_compact(compacted, filter_test_is_odd, NULL), 4u);
+    ASSERT_EQ(darr_get_u32(compacted, 0), 4u);
+
+    DArrayU32T* filtered = darr_clone(source);
+    uint64_t mask = 0x0Fu;
+    ASSERT_EQ(darr_filter_by_mask(filtered, filtered, &mask), 4u);
+
+    DArrayU32T* scattered = darr_clone(source);
+    DArrayU32T* updates = darr_create_u32();
+    darr_push_u32(updates, 0);
+    const uint32_t index = 0;
+    darr_scatter(scattered, updates, &index);
+    ASSERT_EQ(darr_get_u32(scattered, 0), 0u);
+
+    ASSERT_EQ(darr_length(source), 8u);
+    for (size_t i = 0; i < 8; i++) { ASSERT_EQ(darr_get_u32(source, i), values[i]); }
+    darr_destroy(updates);
+    darr_destroy(scattered);
+    darr_destroy(filtered);
+    darr_destroy(compacted);
+    darr_destroy(source);
+}
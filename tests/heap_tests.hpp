@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include "DHeap.h"
+
+typedef struct {
+    uint32_t priority;
+    uint32_t id;
+} HeapTestTaskT;
+
+static int32_t heap_test_compare_task(const void* a, const void* b)
+{
+    uint32_t pa = ((const HeapTestTaskT*) a)->priority;
+    uint32_t pb = ((const HeapTestTaskT*) b)->priority;
+    return (pa < pb) ? -1 : ((pa > pb) ? 1 : 0);
+}
+
+static void heap_test_track_position(void* element, size_t newIndex, void* userData)
+{
+    size_t* positions = (size_t*) userData;
+    positions[((HeapTestTaskT*) element)->id] = newIndex;
+}
+
+TEST(Heap_Tests, Heap_Test1)
+{
+    using namespace testing;
+    DHeapT* heap = heap_create_u32(DHEAP_BINARY);
+    ASSERT_NE(NULL, heap);
+    ASSERT_TRUE(heap_is_empty(heap));
+    ASSERT_EQ(heap_pop_u32(heap), 0);
+    ASSERT_EQ(NULL, heap_top(heap));
+    heap_destroy(heap);
+
+    ASSERT_EQ(NULL, heap_create_u32(1));
+    ASSERT_EQ(NULL, heap_create_generic(4, DHEAP_BINARY, NULL));
+}
+
+TEST(Heap_Tests, Heap_Test2)
+{
+    using namespace testing;
+    for (size_t arity = 2; arity <= 5; arity++)
+    {
+        DHeapT* heap = heap_create_u32(arity);
+        uint32_t seed = 12345;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            heap_push_u32(heap, seed >> 8);
+        }
+        ASSERT_EQ(heap_length(heap), 1000);
+
+        uint32_t previous = 0;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            uint32_t top = heap_top_u32(heap);
+            uint32_t value = heap_pop_u32(heap);
+            ASSERT_EQ(top, value);
+            ASSERT_LE(previous, value);
+            previous = value;
+        }
+        ASSERT_TRUE(heap_is_empty(heap));
+        heap_destroy(heap);
+    }
+}
+
+TEST(Heap_Tests, Heap_Test3)
+{
+    using namespace testing;
+    DArrayI32T* arr = darr_create_i32();
+    for (int32_t i = 0; i < 200; i++) { darr_push_i32(arr, (i * 37) % 101 - 50); }
+
+    DHeapT* heap = heap_create_from_darr_i32(arr, DHEAP_QUATERNARY);
+    ASSERT_NE(NULL, heap);
+    ASSERT_EQ(heap_length(heap), 200);
+    ASSERT_EQ(heap_top_i32(heap), -50);
+
+    heap_replace_top_i32(heap, 1000);
+    int32_t previous = heap_pop_i32(heap);
+    ASSERT_EQ(previous, -50);
+    while (FALSE == heap_is_empty(heap))
+    {
+        int32_t value = heap_pop_i32(heap);
+        ASSERT_LE(previous, value);
+        previous = value;
+    }
+    ASSERT_EQ(previous, 1000);
+    heap_destroy(heap);
+}
+
+TEST(Heap_Tests, Heap_Test4)
+{
+    using namespace testing;
+    size_t positions[16];
+    DHeapT* heap = heap_create_generic(sizeof(HeapTestTaskT), DHEAP_QUATERNARY, heap_test_compare_task);
+    heap_set_move_callback(heap, heap_test_track_position, positions);
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        HeapTestTaskT task = {100u + i, i};
+        heap_push(heap, &task);
+    }
+    for (uint32_t i = 0; i < 16; i++) { ASSERT_EQ(((HeapTestTaskT*) darr_get_ptr(heap->data, positions[i]))->id, i); }
+
+    HeapTestTaskT urgent = {1, 9};
+    heap_decrease_key(heap, positions[9], &urgent);
+    ASSERT_EQ(((HeapTestTaskT*) heap_top(heap))->id, 9);
+    ASSERT_EQ(positions[9], 0);
+
+    HeapTestTaskT out;
+    ASSERT_TRUE(heap_pop(heap, &out));
+    ASSERT_EQ(out.id, 9);
+    ASSERT_TRUE(heap_pop(heap, &out));
+    ASSERT_EQ(out.id, 0);
+    for (uint32_t i = 1; i < 16; i++)
+    {
+        if (9 != i) { ASSERT_EQ(((HeapTestTaskT*) darr_get_ptr(heap->data, positions[i]))->id, i); }
+    }
+    heap_destroy(heap);
+}
+
+TEST(Heap_Tests, Heap_Test5)
+{
+    using namespace testing;
+    DArrayT* arr = darr_create_generic(sizeof(HeapTestTaskT));
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        HeapTestTaskT task = {(i * 7u) % 50u, i};
+        darr_push_generic(arr, &task);
+    }
+    DHeapT* heap = heap_create_from_darr(arr, DHEAP_BINARY, heap_test_compare_task);
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        HeapTestTaskT out;
+        ASSERT_TRUE(heap_pop(heap, &out));
+        ASSERT_EQ(out.priority, i);
+    }
+    ASSERT_FALSE(heap_pop(heap, NULL));
+    heap_destroy(heap);
+}
+
+TEST(Heap_Tests, Heap_Test6)
+{
+    using namespace testing;
+    /* A heap built over a clone leaves the array it was cloned from alone. */
+    const uint32_t values[] = {9, 3, 7, 1, 5};
+    DArrayU32T* source = darr_create_u32();
+    for (uint32_t value: values) { darr_push_u32(source, value); }
+
+    DHeapT* heap = heap_create_from_darr_u32(darr_clone(source), DHEAP_BINARY);
+    ASSERT_NE(heap, nullptr);
+    ASSERT_EQ(heap_pop_u32(heap), 1u);
+    ASSERT_EQ(heap_pop_u32(heap), 3u);
+    heap_replace_top_u32(heap, 2);
+    ASSERT_EQ(heap_top_u32(heap), 2u);
+
+    for (size_t i = 0; i < 5; i++) { ASSERT_EQ(darr_get_u32(source, i), values[i]); }
+    heap_destroy(heap);
+    darr_destroy(source);
+}
+
+TEST(Heap_Tests, Heap_Test7)
+{
+    using namespace testing;
+    /* Heaps built in bulk report every position once the callback is installed. */
+    size_t positions[32];
+    DArrayT* arr = darr_create_generic(sizeof(HeapTestTaskT));
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        HeapTestTaskT task = {100u + (i * 5u) % 16u, i};
+        darr_push_generic(arr, &task);
+    }
+    DHeapT* heap = heap_create_from_darr(arr, DHEAP_QUATERNARY, heap_test_compare_task);
+    ASSERT_NE(heap, nullptr);
+    heap_set_move_callback(heap, heap_test_track_position, positions);
+    for (uint32_t i = 0; i < 16; i++) { ASSERT_EQ(((HeapTestTaskT*) darr_get_ptr(heap->data, positions[i]))->id, i); }
+
+    HeapTestTaskT urgent = {1, 12};
+    heap_decrease_key(heap, positions[12], &urgent);
+    ASSERT_EQ(((HeapTestTaskT*) heap_top(heap))->id, 12u);
+    ASSERT_EQ(positions[12], 0u);
+
+    /* Pushing an element of the heap itself survives the storage growing. */
+    while (heap->data->length < heap->data->capacity)
+    {
+        HeapTestTaskT filler = {500u, 16u};
+        heap_push(heap, &filler);
+    }
+    heap_push(heap, heap_top(heap));
+    HeapTestTaskT out;
+    ASSERT_TRUE(heap_pop(heap, &out));
+    ASSERT_EQ(out.id, 12u);
+    ASSERT_TRUE(heap_pop(heap, &out));
+    ASSERT_EQ(out.id, 12u);
+    ASSERT_EQ(out.priority, 1u);
+    heap_destroy(heap);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <string>
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DInternPool.h"
+
+TEST(InternPool_Tests, InternPool_Test1)
+{
+    using namespace testing;
+    DInternPoolT* pool = intern_create(0);
+    ASSERT_NE(pool, nullptr);
+    ASSERT_EQ(intern_count(pool), 0u);
+
+    uint32_t apple = intern_add_cstr(pool, "apple");
+    uint32_t pear = intern_add_cstr(pool, "pear");
+    uint32_t empty = intern_add_cstr(pool, "");
+    ASSERT_EQ(apple, 0u);
+    ASSERT_EQ(pear, 1u);
+    ASSERT_EQ(empty, 2u);
+    ASSERT_EQ(intern_count(pool), 3u);
+
+    /* Same bytes from another buffer give the same id. */
+    std::string copy = "apple";
+    CStringViewT view = {copy.c_str(), (size_t) copy.size()};
+    ASSERT_EQ(intern_add(pool, view), apple);
+    ASSERT_EQ(intern_find(pool, view), apple);
+    ASSERT_EQ(intern_count(pool), 3u);
+
+    /* Prefixes are distinct strings. */
+    CStringViewT prefix = {copy.c_str(), 3};
+    ASSERT_EQ(intern_find(pool, prefix), DINTERN_POOL_INVALID_ID);
+    ASSERT_EQ(intern_add(pool, prefix), 3u);
+
+    CStringViewT stored = intern_get(pool, apple);
+    ASSERT_NE(stored.data, view.data);
+    ASSERT_EQ(stored.length, 5u);
+    ASSERT_STREQ(stored.data, "apple");
+    ASSERT_STREQ(intern_get(pool, 3).data, "app");
+    ASSERT_EQ(intern_get(pool, empty).length, 0u);
+
+    DStringT* str = str_create("pear", 4);
+    ASSERT_EQ(intern_add_dstring(pool, str), pear);
+    str_destroy(str);
+    intern_destroy(pool);
+}
+
+TEST(InternPool_Tests, InternPool_Test2)
+{
+    using namespace testing;
+    DInternPoolT* pool = intern_create(16);
+    ASSERT_NE(pool, nullptr);
+
+    /* Enough strings to grow the table and fill several arena blocks. */
+    const uint32_t count = 20000;
+    std::vector<const int8_t*> views;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string key = "key-" + std::to_string(i);
+        CStringViewT view = {key.c_str(), (size_t) key.size()};
+        ASSERT_EQ(intern_add(pool, view), i);
+        views.push_back(intern_get(pool, i).data);
+    }
+
+    /* A string larger than a block gets one of its own. */
+    std::string large(DINTERN_POOL_BLOCK_SIZE, 'x');
+    CStringViewT largeView = {large.c_str(), (size_t) large.size()};
+    ASSERT_EQ(intern_add(pool, largeView), count);
+    ASSERT_EQ(intern_add_cstr(pool, "after-large"), count + 1u);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string key = "key-" + std::to_string(i);
+        CStringViewT view = {key.c_str(), (size_t) key.size()};
+        ASSERT_EQ(intern_find(pool, view), i);
+        /* Stored strings never move. */
+        ASSERT_EQ(intern_get(pool, i).data, views[i]);
+        ASSERT_EQ(key, std::string(views[i]));
+    }
+    ASSERT_EQ(intern_get(pool, count).length, (size_t) DINTERN_POOL_BLOCK_SIZE);
+    ASSERT_EQ(intern_count(pool), count + 2u);
+    intern_destroy(pool);
+}
+
+TEST(InternPool_Tests, InternPool_Test3)
+{
+    using namespace testing;
+    DInternPoolT* pool = intern_create(0);
+    ASSERT_NE(pool, nullptr);
+    ASSERT_EQ(intern_add_cstr(pool, "beta"), 0u);
+
+    DArrayT* arr = str_arr_create();
+    const char* words[] = {"alpha", "beta", "alpha", "gamma", "beta", "delta"};
+    for (const char* word: words) { str_arr_push_back(arr, str_create(word, (size_t) strlen(word))); }
+
+    uint32_t ids[6];
+    ASSERT_TRUE(intern_add_str_arr(pool, arr, ids));
+    ASSERT_EQ(ids[0], 1u);
+    ASSERT_EQ(ids[1], 0u);
+    ASSERT_EQ(ids[2], 1u);
+    ASSERT_EQ(ids[3], 2u);
+    ASSERT_EQ(ids[4], 0u);
+    ASSERT_EQ(ids[5], 3u);
+    ASSERT_EQ(intern_count(pool), 4u);
+    ASSERT_STREQ(intern_get(pool, ids[5]).data, "delta");
+
+    str_arr_destroy(arr);
+    intern_destroy(pool);
+}
+
+TEST(InternPool_Tests, InternPool_Test4)
+{
+    using namespace testing;
+    DInternPoolT* pool = intern_create(0);
+    ASSERT_NE(pool, nullptr);
+
+    /* Every thread interns the same keys in a different order, all must agree on the ids. */
+    const uint32_t threads = 4;
+    const uint32_t keys = 5000;
+    std::vector<std::vector<uint32_t>> results(threads, std::vector<uint32_t>(keys));
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            for (uint32_t i = 0; i < keys; i++)
+            {
+                uint32_t key = (i * 7919u + t * 1237u) % keys;
+                std::string str = "word-" + std::to_string(key);
+                CStringViewT view = {str.c_str(), (size_t) str.size()};
+                results[t][key] = intern_add(pool, view);
+                CStringViewT stored = intern_get(pool, results[t][key]);
+                ASSERT_EQ(std::string(stored.data, stored.length), str);
+            }
+        });
+    }
+    for (std::thread& worker: workers) { worker.join(); }
+
+    ASSERT_EQ(intern_count(pool), keys);
+    for (uint32_t t = 1; t < threads; t++) { ASSERT_EQ(results[t], results[0]); }
+    intern_destroy(pool);
+}
@@ -3,6 +3,28 @@
 
 #include "darr_tests.hpp"
 #include "dstr_tests.hpp"
+#include "soa_tests.hpp"
+#include "heap_tests.hpp"
+#include "select_tests.hpp"
+#include "filter_tests.hpp"
+#include "set_tests.hpp"
+#include "packed_tests.hpp"
+#include "bitmap_tests.hpp"
+#include "serialize_tests.hpp"
+#include "file_array_tests.hpp"
+#include "shared_array_tests.hpp"
+#include "ring_tests.hpp"
+#include "mpmc_tests.hpp"
+#include "thread_pool_tests.hpp"
+#include "concurrent_array_tests.hpp"
+#include "concurrent_map_tests.hpp"
+#include "epoch_tests.hpp"
+#include "epoch_array_tests.hpp"
+#include "sync_tests.hpp"
+#include "fiber_tests.hpp"
+#include "containers_tests.hpp"
+#include "intern_tests.hpp"
+#include "rope_tests.hpp"
 
 int main(int argc, char** argv)
 {
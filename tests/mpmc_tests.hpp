@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DMpmcQueue.h"
+
+TEST(Mpmc_Tests, Mpmc_Test1)
+{
+    using namespace testing;
+    DMpmcQueueI32T* queue = mpmc_create_i32(3);
+    ASSERT_NE(queue, nullptr);
+    ASSERT_EQ(mpmc_capacity(queue), 4u);
+
+    int32_t value = 0;
+    ASSERT_FALSE(mpmc_try_pop_i32(queue, &value));
+    for (int32_t i = 0; i < 4; i++) { ASSERT_TRUE(mpmc_try_push_i32(queue, -i)); }
+    ASSERT_FALSE(mpmc_try_push_i32(queue, 100));
+    ASSERT_EQ(mpmc_length(queue), 4u);
+    for (int32_t round = 0; round < 50; round++)
+    {
+        ASSERT_TRUE(mpmc_try_pop_i32(queue, &value));
+        ASSERT_EQ(value, -round);
+        ASSERT_TRUE(mpmc_try_push_i32(queue, -(round + 4)));
+    }
+    mpmc_destroy(queue);
+
+    /* Elements that are not a multiple of 8 bytes, batches cut at the free room. */
+    struct Triple {
+        uint8_t bytes[3];
+    };
+    queue = mpmc_create_generic(sizeof(Triple), 8);
+    Triple input[12];
+    Triple output[12];
+    for (uint8_t i = 0; i < 12; i++) { input[i] = Triple{{i, (uint8_t) (i + 1), (uint8_t) (i + 2)}}; }
+    ASSERT_EQ(mpmc_push_batch(queue, input, 5), 5u);
+    ASSERT_EQ(mpmc_pop_batch(queue, output, 2), 2u);
+    ASSERT_EQ(mpmc_push_batch(queue, &input[5], 7), 5u);
+    ASSERT_EQ(mpmc_pop_batch(queue, &output[2], 12), 8u);
+    ASSERT_EQ(mpmc_pop_batch(queue, output, 12), 0u);
+    for (uint8_t i = 0; i < 10; i++) { ASSERT_EQ(0, memcmp(&output[i], &input[i], sizeof(Triple))); }
+    mpmc_destroy(queue);
+}
+
+TEST(Mpmc_Tests, Mpmc_Test2)
+{
+    using namespace testing;
+    const uint32_t threads = 4;
+    const uint32_t perProducer = 50000;
+    DMpmcQueueU32T* queue = mpmc_create_u32(128);
+    ASSERT_NE(queue, nullptr);
+
+    std::vector<uint8_t> seen(threads * perProducer, 0);
+    std::vector<uint64_t> sums(threads, 0);
+    uint32_t consumed = 0;
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([queue, t, perProducer]() {
+            uint32_t batch[4];
+            uint32_t next = 0;
+            while (next < perProducer)
+            {
+                uint32_t wanted = (perProducer - next < 4) ? perProducer - next : 4;
+                for (uint32_t i = 0; i < wanted; i++) { batch[i] = t * perProducer + next + i; }
+                size_t pushed = mpmc_push_batch(queue, batch, wanted);
+                if (0u == pushed) { std::this_thread::yield(); }
+                next += (uint32_t) pushed;
+            }
+        });
+        workers.emplace_back([queue, t, &seen, &sums, &consumed, threads, perProducer]() {
+            uint32_t batch[3];
+            while (CATOMIC_LOAD_RELAXED(&consumed) < threads * perProducer)
+            {
+                size_t popped = (t % 2 == 0) ? mpmc_pop_batch(queue, batch, 3) : mpmc_pop_batch(queue, batch, 1);
+                for (size_t i = 0; i < popped; i++)
+                {
+                    seen[batch[i]]++;
+                    sums[t] += batch[i];
+                }
+                if (0u == popped) { std::this_thread::yield(); }
+                else { CATOMIC_FETCH_ADD(&consumed, (uint32_t) popped); }
+            }
+        });
+    }
+    for (std::thread& worker: workers) { worker.join(); }
+
+    uint64_t total = 0;
+    for (uint64_t sum: sums) { total += sum; }
+    uint64_t count = (uint64_t) threads * perProducer;
+    ASSERT_EQ(total, count * (count - 1u) / 2u);
+    for (uint8_t hits: seen) { ASSERT_EQ(hits, 1u); }
+    ASSERT_EQ(mpmc_length(queue), 0u);
+    mpmc_destroy(queue);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "DPackedArray.h"
+#include <vector>
+
+static DArrayU32T* packed_test_create(size_t count, uint32_t range, BOOL sorted, uint32_t seed)
+{
+    DArrayU32T* arr = darr_create_u32();
+    uint32_t value = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        value = (TRUE == sorted) ? value + (seed >> 8) % range : (seed >> 4) % range;
+        darr_push_u32(arr, value);
+    }
+    return arr;
+}
+
+static std::vector<uint32_t> packed_test_vector(DArrayU32T* arr)
+{
+    return std::vector<uint32_t>((uint32_t*) arr->data, (uint32_t*) arr->data + arr->length);
+}
+
+static const uint32_t packed_test_feature_masks[] = {~0u, CPU_FEATURE_NONE};
+static const DPackedEncodingT packed_test_encodings[] = {DPACKED_BITPACK_FOR, DPACKED_BITPACK_DELTA, DPACKED_VARINT,
+                                                         DPACKED_VARINT_DELTA};
+
+TEST(Packed_Tests, Packed_Test1)
+{
+    using namespace testing;
+    const uint32_t ranges[] = {1, 2, 200, 70000, 1u << 25, 1u << 27, 0xFFFFFFFFu};
+    for (uint32_t features : packed_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        for (DPackedEncodingT encoding : packed_test_encodings)
+        {
+            for (uint32_t range : ranges)
+            {
+                DArrayU32T* arr = packed_test_create(1000, range, FALSE, range);
+                DPackedArrayT* parr = parr_create_from_darr(arr, encoding);
+                ASSERT_EQ(parr_length(parr), 1000u);
+                ASSERT_EQ(parr_block_count(parr), 8u);
+
+                DArrayU32T* decoded = parr_to_darr(parr);
+                ASSERT_EQ(packed_test_vector(decoded), packed_test_vector(arr));
+                for (size_t i = 0; i < arr->length; i++) { ASSERT_EQ(parr_get(parr, i), ((uint32_t*) arr->data)[i]); }
+                ASSERT_EQ(parr_get_safe(parr, 1000), 0u);
+
+                darr_destroy(decoded);
+                parr_destroy(parr);
+                darr_destroy(arr);
+            }
+        }
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Packed_Tests, Packed_Test2)
+{
+    using namespace testing;
+    for (DPackedEncodingT encoding : packed_test_encodings)
+    {
+        DArrayU32T* arr = packed_test_create(777, 50, TRUE, 3);
+        DPackedArrayT* parr = parr_create(encoding);
+        for (size_t i = 0; i < arr->length; i++)
+        {
+            parr_push(parr, ((uint32_t*) arr->data)[i]);
+            ASSERT_EQ(parr_get(parr, i), ((uint32_t*) arr->data)[i]);
+        }
+        ASSERT_EQ(parr_length(parr), 777u);
+
+        DArrayU32T* decoded = parr_to_darr(parr);
+        ASSERT_EQ(packed_test_vector(decoded), packed_test_vector(arr));
+
+        std::vector<uint32_t> block(DPACKED_BLOCK_SIZE);
+        ASSERT_EQ(parr_decode_block(parr, 6, block.data()), 777u - 6u * DPACKED_BLOCK_SIZE);
+        ASSERT_EQ(block[0], ((uint32_t*) arr->data)[6 * DPACKED_BLOCK_SIZE]);
+        ASSERT_EQ(parr_decode_block(parr, 7, block.data()), 0u);
+
+        darr_destroy(decoded);
+        parr_destroy(parr);
+        darr_destroy(arr);
+    }
+}
+
+TEST(Packed_Tests, Packed_Test3)
+{
+    using namespace testing;
+    DArrayU32T* arr = packed_test_create(5000, 20, TRUE, 9);
+    std::vector<uint32_t> values = packed_test_vector(arr);
+    for (DPackedEncodingT encoding : packed_test_encodings)
+    {
+        DPackedArrayT* parr = parr_create_from_darr(arr, encoding);
+        const uint32_t targets[] = {0, 1, values[127], values[128] + 1, values[2500], values.back(), values.back() + 1};
+        for (uint32_t target : targets)
+        {
+            size_t expected = std::lower_bound(values.begin(), values.end(), target) - values.begin();
+            ASSERT_EQ(parr_lower_bound(parr, target), expected);
+        }
+        parr_destroy(parr);
+    }
+
+    DPackedArrayT* delta = parr_create_from_darr(arr, DPACKED_BITPACK_DELTA);
+    ASSERT_LT(parr_memory_bytes(delta), arr->length * sizeof(uint32_t) / 3);
+    parr_destroy(delta);
+    darr_destroy(arr);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <thread>
+#pragma pop_macro("size_t")
+#include "DRingBuffer.h"
+
+TEST(Ring_Tests, Ring_Test1)
+{
+    using namespace testing;
+    DRingBufferU32T* ring = ring_create_u32(5, TRUE);
+    ASSERT_NE(ring, nullptr);
+    ASSERT_EQ(ring_capacity(ring), 8u);
+    ASSERT_TRUE(ring_is_empty(ring));
+
+    uint32_t value = 0;
+    ASSERT_FALSE(ring_try_pop_u32(ring, &value));
+    for (uint32_t i = 0; i < 8; i++) { ASSERT_TRUE(ring_try_push_u32(ring, i)); }
+    ASSERT_FALSE(ring_try_push_u32(ring, 8));
+    ASSERT_EQ(ring_length(ring), 8u);
+
+    /* Indices keep growing past the capacity, the slots wrap. */
+    for (uint32_t round = 0; round < 100; round++)
+    {
+        ASSERT_TRUE(ring_try_pop_u32(ring, &value));
+        ASSERT_EQ(value, round);
+        ASSERT_TRUE(ring_try_push_u32(ring, round + 8));
+    }
+    ASSERT_EQ(ring_length(ring), 8u);
+    ring_destroy(ring);
+}
+
+TEST(Ring_Tests, Ring_Test2)
+{
+    using namespace testing;
+    DRingBufferT* ring = ring_create_generic(sizeof(uint64_t), 16, FALSE);
+    ASSERT_NE(ring, nullptr);
+
+    uint64_t input[40];
+    uint64_t output[40];
+    for (uint64_t i = 0; i < 40; i++) { input[i] = i * 1000003u; }
+
+    ASSERT_EQ(ring_push_batch(ring, input, 10), 10u);
+    ASSERT_EQ(ring_pop_batch(ring, output, 7), 7u);
+    /* Only 13 slots are free, the batch is cut and copied in two segments. */
+    ASSERT_EQ(ring_push_batch(ring, &input[10], 30), 13u);
+    ASSERT_EQ(ring_pop_batch(ring, &output[7], 40), 16u);
+    ASSERT_EQ(ring_pop_batch(ring, output, 40), 0u);
+    for (uint64_t i = 0; i < 23; i++) { ASSERT_EQ(output[i], input[i]); }
+    ring_destroy(ring);
+}
+
+TEST(Ring_Tests, Ring_Test3)
+{
+    using namespace testing;
+    const uint32_t count = 200000;
+    BOOL modes[] = {TRUE, FALSE};
+    for (BOOL blocking: modes)
+    {
+        DRingBufferU32T* ring = ring_create_u32(64, blocking);
+        ASSERT_NE(ring, nullptr);
+        std::thread producer([ring, count]() {
+            uint32_t batch[7];
+            uint32_t next = 0;
+            while (next < count)
+            {
+                if (next % 3 == 0) { ring_push(ring, &next); next++; }
+                else
+                {
+                    uint32_t wanted = (count - next < 7) ? count - next : 7;
+                    for (uint32_t i = 0; i < wanted; i++) { batch[i] = next + i; }
+                    size_t pushed = ring_push_batch(ring, batch, wanted);
+                    if (0u == pushed) { ring_push(ring, &batch[pushed++]); }
+                    next += (uint32_t) pushed;
+                }
+            }
+        });
+
+        uint32_t expected = 0;
+        uint32_t batch[5];
+        BOOL ordered = TRUE;
+        while (expected < count)
+        {
+            uint32_t value = 0;
+            if (expected % 2 == 0)
+            {
+                ring_pop(ring, &value);
+                ordered = (ordered && value == expected) ? TRUE : FALSE;
+                expected++;
+            }
+            else
+            {
+                size_t popped = ring_pop_batch(ring, batch, 5);
+                if (0u == popped) { ring_pop(ring, &batch[popped++]); }
+                for (size_t i = 0; i < popped; i++) { ordered = (ordered && batch[i] == expected + i) ? TRUE : FALSE; }
+                expected += (uint32_t) popped;
+            }
+        }
+        producer.join();
+        ASSERT_TRUE(ordered);
+        ASSERT_TRUE(ring_is_empty(ring));
+        ring_destroy(ring);
+    }
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <random>
+#include <string>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "DRope.h"
+
+static CStringViewT rope_test_view(const std::string& text)
+{
+    CStringViewT view = {text.c_str(), (size_t) text.size()};
+    return view;
+}
+
+static std::string rope_test_string(DRopeT* rope)
+{
+    DStringT* flat = rope_to_dstring(rope);
+    std::string result(flat->data, flat->length);
+    str_destroy(flat);
+    return result;
+}
+
+static void rope_test_collect(CStringViewT piece, void* argument)
+{
+    ((std::vector<std::string>*) argument)->emplace_back(piece.data, piece.length);
+}
+
+TEST(Rope_Tests, Rope_Test1)
+{
+    using namespace testing;
+    DRopeT* rope = rope_create();
+    ASSERT_NE(rope, nullptr);
+    ASSERT_EQ(rope_length(rope), 0u);
+    ASSERT_EQ(rope_test_string(rope), "");
+
+    ASSERT_TRUE(rope_append(rope, rope_test_view("hello world")));
+    ASSERT_TRUE(rope_insert(rope, 5, rope_test_view(",")));
+    ASSERT_TRUE(rope_insert(rope, 0, rope_test_view(">> ")));
+    ASSERT_TRUE(rope_append(rope, rope_test_view("!")));
+    ASSERT_EQ(rope_test_string(rope), ">> hello, world!");
+    ASSERT_EQ(rope_length(rope), 16u);
+    ASSERT_EQ(rope_get(rope, 3), 'h');
+    ASSERT_EQ(rope_get(rope, 15), '!');
+
+    ASSERT_TRUE(rope_erase(rope, 0, 3));
+    ASSERT_TRUE(rope_erase(rope, 5, 1));
+    ASSERT_TRUE(rope_erase(rope, 11, 100));
+    ASSERT_EQ(rope_test_string(rope), "hello world");
+    ASSERT_FALSE(rope_insert(rope, 12, rope_test_view("x")));
+    ASSERT_FALSE(rope_erase(rope, 12, 1));
+    rope_destroy(rope);
+}
+
+TEST(Rope_Tests, Rope_Test2)
+{
+    using namespace testing;
+    std::mt19937 random(7);
+    std::string expected;
+    DRopeT* rope = rope_create();
+    ASSERT_NE(rope, nullptr);
+
+    for (uint32_t edit = 0; edit < 5000; edit++)
+    {
+        size_t index = (size_t) (random() % (expected.size() + 1u));
+        if ((0u == random() % 3u) && (false == expected.empty()))
+        {
+            size_t count = (size_t) (random() % 64u);
+            ASSERT_TRUE(rope_erase(rope, index, count));
+            expected.erase(index, count);
+        }
+        else
+        {
+            std::string text(1u + random() % ((0u == edit % 100u) ? 3000u : 16u), (char) ('a' + edit % 26u));
+            ASSERT_TRUE(rope_insert(rope, index, rope_test_view(text)));
+            expected.insert(index, text);
+        }
+        ASSERT_EQ(rope_length(rope), expected.size());
+    }
+    ASSERT_EQ(rope_test_string(rope), expected);
+    for (size_t i = 0; i < expected.size(); i += 97u) { ASSERT_EQ(rope_get(rope, i), expected[i]); }
+    rope_destroy(rope);
+}
+
+TEST(Rope_Tests, Rope_Test3)
+{
+    using namespace testing;
+    std::string text;
+    for (uint32_t i = 0; i < 2000; i++) { text += "line " + std::to_string(i) + "\n"; }
+    DRopeT* rope = rope_create_from(rope_test_view(text));
+    ASSERT_NE(rope, nullptr);
+
+    DRopeT* middle = rope_substring(rope, 100, 5000);
+    DRopeT* tail = rope_substring(rope, text.size() - 10u, 100);
+    ASSERT_NE(middle, nullptr);
+    ASSERT_NE(tail, nullptr);
+    ASSERT_EQ(rope_test_string(middle), text.substr(100, 5000));
+    ASSERT_EQ(rope_test_string(tail), text.substr(text.size() - 10u));
+    ASSERT_EQ(rope_substring(rope, text.size() + 1u, 1), nullptr);
+
+    /* The ropes share text, editing one leaves the others alone. */
+    ASSERT_TRUE(rope_insert(middle, 10, rope_test_view("[edit]")));
+    ASSERT_TRUE(rope_erase(rope, 0, 4000));
+    ASSERT_TRUE(rope_append(tail, rope_test_view("end")));
+    ASSERT_EQ(rope_test_string(rope), text.substr(4000));
+    ASSERT_EQ(rope_test_string(middle), text.substr(100, 10) + "[edit]" + text.substr(110, 4990));
+    ASSERT_EQ(rope_test_string(tail), text.substr(text.size() - 10u) + "end");
+
+    rope_destroy(rope);
+    ASSERT_EQ(rope_test_string(middle).size(), 5006u);
+    rope_destroy(middle);
+    rope_destroy(tail);
+}
+
+TEST(Rope_Tests, Rope_Test4)
+{
+    using namespace testing;
+    /* Two, three and four byte code points never straddle a piece. */
+    std::string text;
+    const char* symbols[] = {"a", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"};
+    for (uint32_t i = 0; i < 3000; i++) { text += symbols[i % 4u]; }
+
+    DRopeT* rope = rope_create();
+    ASSERT_NE(rope, nullptr);
+    ASSERT_TRUE(rope_append(rope, rope_test_view("xy")));
+    ASSERT_TRUE(rope_insert(rope, 1, rope_test_view(text)));
+    ASSERT_EQ(rope_test_string(rope), "x" + text + "y");
+
+    std::vector<std::string> pieces;
+    rope_for_each(rope, rope_test_collect, &pieces);
+    ASSERT_GT(pieces.size(), 3u);
+    for (const std::string& piece: pieces)
+    {
+        ASSERT_LE(piece.size(), (size_t) DROPE_CHUNK_SIZE);
+        ASSERT_FALSE(DROPE_IS_UTF8_CONTINUATION(piece.front()));
+        ASSERT_TRUE(cstr_is_valid_utf8(piece.c_str(), (size_t) piece.size()));
+    }
+    rope_destroy(rope);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include "DArraySelect.h"
+#include <algorithm>
+#include <vector>
+
+static DArrayU32T* select_test_random_u32(size_t count, uint32_t seed, uint32_t modulo)
+{
+    DArrayU32T* arr = darr_create_u32();
+    for (size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        darr_push_u32(arr, (seed >> 4) % modulo);
+    }
+    return arr;
+}
+
+TEST(Select_Tests, Select_Test1)
+{
+    using namespace testing;
+    const uint32_t modulos[] = {0xFFFFFFFu, 16u, 1u};
+    for (uint32_t modulo : modulos)
+    {
+        for (size_t nth : {0u, 1u, 500u, 4998u, 4999u})
+        {
+            DArrayU32T* arr = select_test_random_u32(5000, 7, modulo);
+            std::vector<uint32_t> expected((uint32_t*) arr->data, (uint32_t*) arr->data + arr->length);
+            std::sort(expected.begin(), expected.end());
+
+            darr_nth_element_u32(arr, nth);
+            ASSERT_EQ(darr_get_u32(arr, nth), expected[nth]);
+            for (size_t i = 0; i < nth; i++) { ASSERT_LE(darr_get_u32(arr, i), darr_get_u32(arr, nth)); }
+            for (size_t i = nth + 1; i < arr->length; i++) { ASSERT_GE(darr_get_u32(arr, i), darr_get_u32(arr, nth)); }
+            darr_destroy(arr);
+        }
+    }
+}
+
+TEST(Select_Tests, Select_Test2)
+{
+    using namespace testing;
+    DArrayI16T* arr = darr_create_i16();
+    for (int32_t i = 0; i < 1000; i++) { darr_push_i16(arr, (int16_t) (((i * 7919) % 2003) - 1000)); }
+    std::vector<int16_t> expected((int16_t*) arr->data, (int16_t*) arr->data + arr->length);
+    std::sort(expected.begin(), expected.end());
+
+    darr_partial_sort_i16(arr, 100);
+    for (size_t i = 0; i < 100; i++) { ASSERT_EQ(darr_get_i16(arr, i), expected[i]); }
+
+    darr_partial_sort_i16(arr, 5000);
+    for (size_t i = 0; i < arr->length; i++) { ASSERT_EQ(darr_get_i16(arr, i), expected[i]); }
+    darr_destroy(arr);
+}
+
+TEST(Select_Tests, Select_Test3)
+{
+    using namespace testing;
+    DArrayU8T* arr = darr_create_u8();
+    darr_nth_element_u8(arr, 0);
+    darr_partial_sort_u8(arr, 3);
+    ASSERT_EQ(darr_length(arr), 0);
+    for (uint32_t i = 0; i < 40; i++) { darr_push_u8(arr, (uint8_t) (40 - i)); }
+    darr_partial_sort_u8(arr, 40);
+    for (uint32_t i = 0; i < 40; i++) { ASSERT_EQ(darr_get_u8(arr, i), i + 1); }
+    darr_destroy(arr);
+
+    DArrayU32T* wrong = darr_create_u16();
+    darr_push_u16(wrong, 2);
+    darr_push_u16(wrong, 1);
+    darr_partial_sort_u32(wrong, 2);
+    ASSERT_EQ(darr_get_u16(wrong, 0), 2);
+    darr_destroy(wrong);
+}
+
+TEST(Select_Tests, Select_Test4)
+{
+    using namespace testing;
+    const uint32_t masks[] = {~0u, CPU_FEATURE_AVX2, CPU_FEATURE_NONE};
+    for (uint32_t mask : masks)
+    {
+        cpu_restrict_features(mask);
+        DArrayU32T* arr = select_test_random_u32(100000, 99, 0xFFFFFFFFu);
+        std::vector<uint32_t> expected((uint32_t*) arr->data, (uint32_t*) arr->data + arr->length);
+        std::sort(expected.begin(), expected.end(), std::greater<uint32_t>());
+
+        DArrayU32T* top = darr_top_k_u32(arr, 100);
+        ASSERT_EQ(darr_length(top), 100);
+        for (size_t i = 0; i < 100; i++) { ASSERT_EQ(darr_get_u32(top, i), expected[i]); }
+        darr_destroy(top);
+        darr_destroy(arr);
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Select_Tests, Select_Test5)
+{
+    using namespace testing;
+    const uint32_t masks[] = {~0u, CPU_FEATURE_AVX2, CPU_FEATURE_NONE};
+    for (uint32_t mask : masks)
+    {
+        cpu_restrict_features(mask);
+        DTopKT* topk = topk_create_i32(10);
+        ASSERT_EQ(topk_threshold_i32(topk), (int32_t) 0x80000000u);
+
+        std::vector<int32_t> values;
+        for (int32_t i = 0; i < 5000; i++) { values.push_back(((i * 104729) % 10007) - 5000); }
+        topk_push_batch_i32(topk, values.data(), 2500);
+        topk_push_batch_i32(topk, values.data() + 2500, 2500);
+        topk_push_i32(topk, 100000);
+
+        std::sort(values.begin(), values.end(), std::greater<int32_t>());
+        DArrayI32T* top = topk_result_i32(topk);
+        ASSERT_EQ(darr_length(top), 10);
+        ASSERT_EQ(darr_get_i32(top, 0), 100000);
+        for (size_t i = 1; i < 10; i++) { ASSERT_EQ(darr_get_i32(top, i), values[i - 1]); }
+        ASSERT_EQ(topk_threshold_i32(topk), values[8]);
+        darr_destroy(top);
+        topk_destroy(topk);
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Select_Tests, Select_Test6)
+{
+    using namespace testing;
+    DTopKT* topk = topk_create_u32(0);
+    const uint32_t values[] = {1, 2, 3};
+    topk_push_batch_u32(topk, values, 3);
+    DArrayU32T* top = topk_result_u32(topk);
+    ASSERT_EQ(darr_length(top), 0);
+    darr_destroy(top);
+    topk_destroy(topk);
+
+    topk = topk_create_u32(8);
+    topk_push_batch_u32(topk, values, 3);
+    ASSERT_EQ(topk_threshold_u32(topk), 0);
+    top = topk_result_u32(topk);
+    ASSERT_EQ(darr_length(top), 3);
+    ASSERT_EQ(darr_get_u32(top, 0), 3);
+    ASSERT_EQ(darr_get_u32(top, 2), 1);
+    darr_destroy(top);
+    topk_destroy(topk);
+}
+
+TEST(Select_Tests, Select_Test7)
+{
+    using namespace testing;
+    /* Selecting in a clone leaves the array it was cloned from alone. */
+    const uint32_t values[] = {9, 3, 7, 1, 5, 8, 2};
+    DArrayU32T* source = darr_create_u32();
+    for (uint32_t value: values) { darr_push_u32(source, value); }
+
+    DArrayU32T* nth = darr_clone(source);
+    darr_nth_element_u32(nth, 0);
+    ASSERT_EQ(darr_get_u32(nth, 0), 1u);
+    DArrayU32T* partial = darr_clone(source);
+    darr_partial_sort_u32(partial, 3);
+    ASSERT_EQ(darr_get_u32(partial, 2), 3u);
+
+    for (size_t i = 0; i < 7; i++) { ASSERT_EQ(darr_get_u32(source, i), values[i]); }
+    darr_destroy(partial);
+    darr_destroy(nth);
+    darr_destroy(source);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "CSerialize.h"
+#include <cstdio>
+#include <cstring>
+
+static const int8_t* serialize_test_path = (const int8_t*) "serialize_test.bin";
+
+TEST(Serialize_Tests, Serialize_Test1)
+{
+    using namespace testing;
+    DArrayU32T* arr = darr_create_u32();
+    for (uint32_t i = 0; i < 10000; i++) { darr_push_u32(arr, i * 2654435761u); }
+    ASSERT_EQ(darr_save(serialize_test_path, arr), FILE_WROTE_SUCCESFULLY);
+
+    DArrayU32T* view = darr_load_view(serialize_test_path);
+    ASSERT_NE(view, nullptr);
+    ASSERT_EQ(darr_length(view), 10000u);
+    ASSERT_EQ(view->elementSize, sizeof(uint32_t));
+    ASSERT_EQ(((uintptr_t) view->data) % CSERIALIZE_ALIGNMENT, 0u);
+    ASSERT_EQ(memcmp(view->data, arr->data, 10000 * sizeof(uint32_t)), 0);
+    ASSERT_EQ(darr_get_u32(view, 9999), darr_get_u32(arr, 9999));
+
+    /* The view is read-only, growing it fails without touching the mapping. */
+    darr_resize(view, 10001);
+    ASSERT_EQ(darr_length(view), 10000u);
+    darr_push_u32(view, 1u);
+    ASSERT_EQ(darr_length(view), 10000u);
+
+    darr_shrink_to_fit(view);
+    ASSERT_EQ(darr_get_u32(view, 0), 0u);
+
+    darr_destroy(view);
+    darr_destroy(arr);
+
+    DArrayT* empty = darr_create_generic(24);
+    ASSERT_EQ(darr_save(serialize_test_path, empty), FILE_WROTE_SUCCESFULLY);
+    view = darr_load_view(serialize_test_path);
+    ASSERT_NE(view, nullptr);
+    ASSERT_EQ(darr_length(view), 0u);
+    ASSERT_EQ(view->elementSize, 24u);
+    darr_destroy(view);
+    darr_destroy(empty);
+    std::remove((const char*) serialize_test_path);
+}
+
+TEST(Serialize_Tests, Serialize_Test2)
+{
+    using namespace testing;
+    const char* words[] = {"alpha", "", "gamma delta", "\xD0\xB6\xD0\xB8\xD0\xB2\xD0\xBE"};
+    DArrayT* strArray = str_arr_create();
+    for (const char* word : words) { str_arr_push_back(strArray, str_create((const int8_t*) word, strlen(word))); }
+    ASSERT_EQ(str_arr_save(serialize_test_path, strArray), FILE_WROTE_SUCCESFULLY);
+
+    CStringTableT table;
+    ASSERT_EQ(str_table_load(serialize_test_path, &table), FILE_READ_SUCCESFULLY);
+    ASSERT_EQ(str_table_length(&table), 4u);
+    for (size_t i = 0; i < 4; i++)
+    {
+        CStringViewT view = str_table_get(&table, i);
+        ASSERT_EQ(view.length, strlen(words[i]));
+        ASSERT_STREQ((const char*) view.data, words[i]);
+    }
+    str_table_close(&table);
+    str_arr_destroy(strArray);
+
+    /* A string file is not a DArrayT file and vice versa. */
+    ASSERT_EQ(darr_load_view(serialize_test_path), nullptr);
+    DArrayU8T* bytes = darr_create_u8();
+    darr_push_u8(bytes, 1);
+    ASSERT_EQ(darr_save(serialize_test_path, bytes), FILE_WROTE_SUCCESFULLY);
+    ASSERT_EQ(str_table_load(serialize_test_path, &table), FILE_CORRUPTED_OR_WRONG_ENCODING);
+    darr_destroy(bytes);
+
+    std::remove((const char*) serialize_test_path);
+    ASSERT_EQ(str_table_load(serialize_test_path, &table), FILE_OPEN_ERROR);
+    ASSERT_EQ(darr_load_view(serialize_test_path), nullptr);
+}
+
+static void serialize_test_patch(const void* bytes, size_t size, uint64_t position)
+{
+    FILE* file = fopen((const char*) serialize_test_path, "r+b");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fseek(file, (long) position, SEEK_SET), 0);
+    ASSERT_EQ(fwrite(bytes, 1, size, file), size);
+    fclose(file);
+}
+
+TEST(Serialize_Tests, Serialize_Test3)
+{
+    using namespace testing;
+    /* Crafted offsets and lengths are rejected instead of read out of bounds. */
+    const char* words[] = {"alpha", "beta", "gamma"};
+    DArrayT* strArray = str_arr_create();
+    for (const char* word : words) { str_arr_push_back(strArray, str_create((const int8_t*) word, strlen(word))); }
+
+    CSerializeHeaderT header;
+    const uint64_t equal[] = {0, 6, 6};
+    const uint64_t decreasing[] = {0, 11, 6};
+    const uint64_t unterminated[] = {0, 5};
+    const uint64_t* patches[] = {equal, decreasing, unterminated};
+    const size_t sizes[] = {sizeof(equal), sizeof(decreasing), sizeof(unterminated)};
+    CStringTableT table;
+    for (size_t i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(str_arr_save(serialize_test_path, strArray), FILE_WROTE_SUCCESFULLY);
+        FILE* file = fopen((const char*) serialize_test_path, "rb");
+        ASSERT_NE(file, nullptr);
+        ASSERT_EQ(fread(&header, sizeof(header), 1, file), 1u);
+        fclose(file);
+        serialize_test_patch(patches[i], sizes[i], header.dataOffset);
+        ASSERT_EQ(str_table_load(serialize_test_path, &table), FILE_CORRUPTED_OR_WRONG_ENCODING);
+    }
+
+    /* A length whose offset table size wraps around. */
+    ASSERT_EQ(str_arr_save(serialize_test_path, strArray), FILE_WROTE_SUCCESFULLY);
+    header.length = 0x2000000000000000ull - 1u;
+    header.dataSize = 0;
+    serialize_test_patch(&header.length, sizeof(header.length), offsetof(CSerializeHeaderT, length));
+    serialize_test_patch(&header.dataSize, sizeof(header.dataSize), offsetof(CSerializeHeaderT, dataSize));
+    ASSERT_EQ(str_table_load(serialize_test_path, &table), FILE_CORRUPTED_OR_WRONG_ENCODING);
+
+    str_arr_destroy(strArray);
+    std::remove((const char*) serialize_test_path);
+}
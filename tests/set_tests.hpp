@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include "DArraySet.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+static DArrayU32T* set_test_create(size_t count, uint32_t step, uint32_t seed)
+{
+    DArrayU32T* arr = darr_create_u32();
+    uint32_t value = seed % step;
+    for (size_t i = 0; i < count; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        value += 1u + (seed >> 8) % step;
+        darr_push_u32(arr, value);
+    }
+    return arr;
+}
+
+static std::vector<uint32_t> set_test_vector(DArrayU32T* arr)
+{
+    return std::vector<uint32_t>((uint32_t*) arr->data, (uint32_t*) arr->data + arr->length);
+}
+
+static const uint32_t set_test_feature_masks[] = {~0u, CPU_FEATURE_NONE};
+
+TEST(Set_Tests, Set_Test1)
+{
+    using namespace testing;
+    const size_t sizes[][2] = {{0, 10}, {1000, 1000}, {1000, 1500}, {20, 5000}, {5000, 7}, {9, 8}};
+    for (uint32_t features : set_test_feature_masks)
+    {
+        cpu_restrict_features(features);
+        for (const auto& size : sizes)
+        {
+            DArrayU32T* a = set_test_create(size[0], 4, 1);
+            DArrayU32T* b = set_test_create(size[1], 3, 2);
+            std::vector<uint32_t> va = set_test_vector(a);
+            std::vector<uint32_t> vb = set_test_vector(b);
+            std::vector<uint32_t> expected;
+            std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expected));
+
+            DArrayU32T* dest = darr_create_u32();
+            ASSERT_EQ(darr_intersect_sorted(dest, a, b), expected.size());
+            ASSERT_EQ(set_test_vector(dest), expected);
+            ASSERT_EQ(darr_intersect_sorted(dest, b, a), expected.size());
+            ASSERT_EQ(set_test_vector(dest), expected);
+
+            darr_destroy(dest);
+            darr_destroy(a);
+            darr_destroy(b);
+        }
+    }
+    cpu_restrict_features(~0u);
+}
+
+TEST(Set_Tests, Set_Test2)
+{
+    using namespace testing;
+    const size_t sizes[][2] = {{0, 10}, {1000, 1000}, {20, 5000}, {5000, 7}, {0, 0}};
+    for (const auto& size : sizes)
+    {
+        DArrayU32T* a = set_test_create(size[0], 4, 3);
+        DArrayU32T* b = set_test_create(size[1], 5, 4);
+        std::vector<uint32_t> va = set_test_vector(a);
+        std::vector<uint32_t> vb = set_test_vector(b);
+        std::vector<uint32_t> expectedUnion;
+        std::vector<uint32_t> expectedDifference;
+        std::vector<uint32_t> expectedReverse;
+        std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expectedUnion));
+        std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), std::back_inserter(expectedDifference));
+        std::set_difference(vb.begin(), vb.end(), va.begin(), va.end(), std::back_inserter(expectedReverse));
+
+        DArrayU32T* dest = darr_create_u32();
+        ASSERT_EQ(darr_union_sorted(dest, a, b), expectedUnion.size());
+        ASSERT_EQ(set_test_vector(dest), expectedUnion);
+        ASSERT_EQ(darr_union_sorted(dest, b, a), expectedUnion.size());
+        ASSERT_EQ(set_test_vector(dest), expectedUnion);
+        ASSERT_EQ(darr_difference_sorted(dest, a, b), expectedDifference.size());
+        ASSERT_EQ(set_test_vector(dest), expectedDifference);
+        ASSERT_EQ(darr_difference_sorted(dest, b, a), expectedReverse.size());
+        ASSERT_EQ(set_test_vector(dest), expectedReverse);
+
+        darr_destroy(dest);
+        darr_destroy(a);
+        darr_destroy(b);
+    }
+}
+
+TEST(Set_Tests, Set_Test3)
+{
+    using namespace testing;
+    DArrayU32T* arrays[4] = {set_test_create(3000, 2, 5), set_test_create(800, 6, 6), set_test_create(2000, 3, 7),
+                             set_test_create(50, 40, 8)};
+    std::vector<uint32_t> expectedIntersection = set_test_vector(arrays[0]);
+    std::vector<uint32_t> expectedUnion = set_test_vector(arrays[0]);
+    for (size_t i = 1; i < 4; i++)
+    {
+        std::vector<uint32_t> next = set_test_vector(arrays[i]);
+        std::vector<uint32_t> intersection;
+        std::vector<uint32_t> united;
+        std::set_intersection(expectedIntersection.begin(), expectedIntersection.end(), next.begin(), next.end(),
+                              std::back_inserter(intersection));
+        std::set_union(expectedUnion.begin(), expectedUnion.end(), next.begin(), next.end(),
+                       std::back_inserter(united));
+        expectedIntersection = intersection;
+        expectedUnion = united;
+    }
+
+    DArrayU32T* dest = darr_create_u32();
+    ASSERT_EQ(darr_intersect_sorted_many(dest, arrays, 4), expectedIntersection.size());
+    ASSERT_EQ(set_test_vector(dest), expectedIntersection);
+    ASSERT_EQ(darr_union_sorted_many(dest, arrays, 4), expectedUnion.size());
+    ASSERT_EQ(set_test_vector(dest), expectedUnion);
+    ASSERT_EQ(darr_intersect_sorted_many(dest, arrays, 1), darr_length(arrays[0]));
+    ASSERT_EQ(darr_intersect_sorted_many(dest, arrays, 0), 0);
+    ASSERT_EQ(darr_union_sorted_many(dest, arrays, 0), 0);
+
+    darr_destroy(dest);
+    for (size_t i = 0; i < 4; i++) { darr_destroy(arrays[i]); }
+}
+
+TEST(Set_Tests, Set_Test4)
+{
+    using namespace testing;
+    DArrayU32T* a = set_test_create(10, 2, 1);
+    DArrayU16T* shorts = darr_create_u16();
+    ASSERT_EQ(darr_intersect_sorted(a, a, a), 0);
+    ASSERT_EQ(darr_length(a), 10);
+    DArrayU32T* dest = darr_create_u32();
+    ASSERT_EQ(darr_union_sorted(dest, a, shorts), 0);
+
+    /* The k-way variants reject the same inputs. */
+    DArrayU32T* mixed[2] = {a, shorts};
+    DArrayU32T* aliased[2] = {a, dest};
+    ASSERT_EQ(darr_intersect_sorted_many(dest, mixed, 2), 0);
+    ASSERT_EQ(darr_union_sorted_many(dest, mixed, 2), 0);
+    ASSERT_EQ(darr_intersect_sorted_many(shorts, aliased, 1), 0);
+    ASSERT_EQ(darr_union_sorted_many(shorts, aliased, 1), 0);
+    ASSERT_EQ(darr_union_sorted_many(dest, aliased, 2), 0);
+    ASSERT_EQ(darr_length(a), 10);
+    darr_destroy(dest);
+    darr_destroy(shorts);
+    darr_destroy(a);
+}
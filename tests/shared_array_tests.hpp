@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "DSharedArray.h"
+#include <string>
+#include <sys/wait.h>
+
+static std::string shared_array_test_name()
+{
+    return "/cutils_shared_test_" + std::to_string((unsigned long) getpid());
+}
+
+TEST(SharedArray_Tests, SharedArray_Test1)
+{
+    using namespace testing;
+    std::string name = shared_array_test_name();
+    DArrayU32T* writer = darr_shared_create((const int8_t*) name.c_str(), sizeof(uint32_t), 16);
+    ASSERT_NE(writer, nullptr);
+    DArrayU32T* reader = darr_shared_open((const int8_t*) name.c_str());
+    ASSERT_NE(reader, nullptr);
+    ASSERT_EQ(reader->elementSize, sizeof(uint32_t));
+    /* A live segment is never reset under its readers. */
+    ASSERT_EQ(darr_shared_create((const int8_t*) name.c_str(), sizeof(uint32_t), 16), nullptr);
+
+    uint64_t sequence = darr_shared_read_begin(reader);
+    ASSERT_EQ(darr_length(reader), 0u);
+    ASSERT_FALSE(darr_shared_read_retry(reader, sequence));
+
+    /* Unpublished elements are invisible, growth past the initial capacity remaps the reader. */
+    for (uint32_t i = 0; i < 10000; i++) { darr_push_u32(writer, i); }
+    sequence = darr_shared_read_begin(reader);
+    ASSERT_EQ(darr_length(reader), 0u);
+    darr_shared_publish(writer);
+    ASSERT_TRUE(darr_shared_read_retry(reader, sequence));
+
+    sequence = darr_shared_read_begin(reader);
+    ASSERT_EQ(darr_length(reader), 10000u);
+    ASSERT_GE(darr_capacity(reader), 10000u);
+    ASSERT_EQ(darr_get_u32(reader, 9999), 9999u);
+    ASSERT_FALSE(darr_shared_read_retry(reader, sequence));
+
+    darr_shared_write_begin(writer);
+    *darr_get_u32_ptr(writer, 0) = 42u;
+    ASSERT_TRUE(darr_shared_read_retry(reader, sequence));
+    darr_shared_write_end(writer);
+    sequence = darr_shared_read_begin(reader);
+    ASSERT_EQ(darr_get_u32(reader, 0), 42u);
+    ASSERT_FALSE(darr_shared_read_retry(reader, sequence));
+
+    /* Readers can not grow the segment. */
+    darr_resize(reader, darr_capacity(reader) + 1);
+    ASSERT_EQ(darr_length(reader), 10000u);
+    darr_push_u32(reader, 1u);
+    ASSERT_EQ(darr_length(reader), 10000u);
+    ASSERT_EQ(darr_get_u32(reader, 9999), 9999u);
+
+
+    darr_destroy(reader);
+    darr_destroy(writer);
+    darr_shared_unlink((const int8_t*) name.c_str());
+    ASSERT_EQ(darr_shared_open((const int8_t*) name.c_str()), nullptr);
+}
+
+TEST(SharedArray_Tests, SharedArray_Test2)
+{
+    using namespace testing;
+    std::string name = shared_array_test_name();
+    const uint32_t total = 200000;
+    DArrayU32T* writer = darr_shared_create((const int8_t*) name.c_str(), sizeof(uint32_t), 1);
+    ASSERT_NE(writer, nullptr);
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (0 == child)
+    {
+        /* The reader process checks that every snapshot is a consistent prefix. */
+        int32_t status = 0;
+        DArrayU32T* reader = darr_shared_open((const int8_t*) name.c_str());
+        size_t length = 0;
+        while ((NULL != reader) && (0 == status) && (length < total))
+        {
+            uint64_t sequence = darr_shared_read_begin(reader);
+            BOOL valid = TRUE;
+            for (size_t i = 0; i < darr_length(reader); i++) { valid &= (darr_get_u32(reader, i) == i * 7u); }
+            if (TRUE == darr_shared_read_retry(reader, sequence)) { continue; }
+            status = (TRUE == valid) ? 0 : 1;
+            length = darr_length(reader);
+        }
+        _exit((NULL == reader) ? 2 : status);
+    }
+
+    for (uint32_t i = 0; i < total; i++)
+    {
+        darr_push_u32(writer, i * 7u);
+        if (0u == i % 4096u) { darr_shared_publish(writer); }
+    }
+    darr_shared_publish(writer);
+
+    int status = -1;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+
+    darr_destroy(writer);
+    darr_shared_unlink((const int8_t*) name.c_str());
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "DSoArray.h"
+
+typedef struct {
+    uint32_t id;
+    uint64_t timestamp;
+    uint8_t flag;
+} SoATestRecordT;
+
+TEST(SoA_Tests, SoA_Test1)
+{
+    using namespace testing;
+    size_t fields[] = {sizeof(uint32_t), sizeof(uint64_t), sizeof(uint8_t)};
+    DSoArrayT* soa = soa_create(fields, 3);
+    ASSERT_NE(NULL, soa);
+    ASSERT_EQ(soa->fieldCount, 3);
+    ASSERT_EQ(soa->length, 0);
+    ASSERT_EQ(soa->capacity, DSOARRAY_INITIAL_CAPACITY);
+    soa_destroy(soa);
+}
+
+TEST(SoA_Tests, SoA_Test2)
+{
+    using namespace testing;
+    size_t fields[] = {sizeof(uint32_t), 0};
+    ASSERT_EQ(NULL, soa_create(fields, 2));
+    ASSERT_EQ(NULL, soa_create(fields, 0));
+    ASSERT_EQ(NULL, soa_create(NULL, 1));
+}
+
+TEST(SoA_Tests, SoA_Test3)
+{
+    using namespace testing;
+    size_t fields[] = {sizeof(uint32_t), sizeof(uint64_t), sizeof(uint8_t)};
+    DSoArrayT* soa = soa_create(fields, 3);
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        uint64_t timestamp = 1000u + i;
+        uint8_t flag = (uint8_t) (i & 1u);
+        const void* values[] = {&i, &timestamp, &flag};
+        soa_push(soa, values);
+    }
+    ASSERT_EQ(soa_length(soa), 100);
+    ASSERT_GE(soa_capacity(soa), 100);
+
+    for (size_t f = 0; f < 3; f++) { ASSERT_EQ(((intptr_t) soa_column(soa, f)) % DSOARRAY_COLUMN_ALIGNMENT, 0); }
+
+    uint32_t* ids = (uint32_t*) soa_column(soa, 0);
+    uint64_t* timestamps = (uint64_t*) soa_column(soa, 1);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(ids[i], i);
+        ASSERT_EQ(timestamps[i], 1000u + i);
+        ASSERT_EQ(*(uint8_t*) soa_get_ptr(soa, 2, i), i & 1u);
+    }
+    soa_destroy(soa);
+}
+
+TEST(SoA_Tests, SoA_Test4)
+{
+    using namespace testing;
+    size_t fields[] = {sizeof(uint32_t), sizeof(uint64_t), sizeof(uint8_t)};
+    DSoArrayT* soa = soa_create(fields, 3);
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        uint64_t timestamp = 10u * i;
+        const void* values[] = {&i, &timestamp, NULL};
+        soa_push(soa, values);
+    }
+
+    soa_erase(soa, 1);
+    ASSERT_EQ(soa_length(soa), 4);
+    ASSERT_EQ(*(uint32_t*) soa_get_ptr(soa, 0, 1), 2);
+    ASSERT_EQ(*(uint64_t*) soa_get_ptr(soa, 1, 1), 20);
+    ASSERT_EQ(*(uint8_t*) soa_get_ptr(soa, 2, 1), 0);
+
+    soa_swap_erase(soa, 0);
+    ASSERT_EQ(soa_length(soa), 3);
+    ASSERT_EQ(*(uint32_t*) soa_get_ptr(soa, 0, 0), 4);
+    ASSERT_EQ(*(uint64_t*) soa_get_ptr(soa, 1, 0), 40);
+
+    soa_erase_safe(soa, 10);
+    ASSERT_EQ(soa_length(soa), 3);
+    ASSERT_EQ(NULL, soa_get_ptr_safe(soa, 0, 3));
+    ASSERT_EQ(NULL, soa_get_ptr_safe(soa, 3, 0));
+
+    soa_pop(soa);
+    ASSERT_EQ(soa_length(soa), 2);
+    soa_destroy(soa);
+}
+
+TEST(SoA_Tests, SoA_Test5)
+{
+    using namespace testing;
+    size_t fields[] = {sizeof(uint32_t), sizeof(uint64_t), sizeof(uint8_t)};
+    DSoArrayT* soa = soa_create(fields, 3);
+    SoATestRecordT record = {7, 77, 1};
+    const void* values[] = {&record.id, &record.timestamp, &record.flag};
+    soa_push(soa, values);
+
+    uint64_t newTimestamp = 99;
+    soa_set(soa, 1, 0, &newTimestamp);
+
+    SoATestRecordT out = {0, 0, 0};
+    void* outValues[] = {&out.id, &out.timestamp, &out.flag};
+    soa_get_record(soa, 0, outValues);
+    ASSERT_EQ(out.id, 7);
+    ASSERT_EQ(out.timestamp, 99);
+    ASSERT_EQ(out.flag, 1);
+    soa_destroy(soa);
+}
+
+TEST(SoA_Tests, SoA_Test6)
+{
+    using namespace testing;
+    size_t fields[] = {sizeof(uint16_t), sizeof(uint32_t)};
+    DSoArrayT* soa = soa_create(fields, 2);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        uint16_t key = (uint16_t) i;
+        uint32_t value = i * i;
+        const void* values[] = {&key, &value};
+        soa_push(soa, values);
+    }
+
+    DArrayU32T* column = soa_column_to_darr(soa, 1);
+    ASSERT_NE(NULL, column);
+    ASSERT_EQ(column->elementSize, sizeof(uint32_t));
+    ASSERT_EQ(darr_length(column), 10);
+    for (uint32_t i = 0; i < 10; i++) { ASSERT_EQ(darr_get_u32(column, i), i * i); }
+
+    darr_destroy(column);
+    soa_destroy(soa);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#pragma push_macro("size_t")
+#undef size_t
+#include <thread>
+#include <vector>
+#pragma pop_macro("size_t")
+#include "CSync.h"
+
+TEST(Sync_Tests, Sync_Test1)
+{
+    using namespace testing;
+    CMutexT mutex;
+    csync_mutex_init(&mutex);
+    ASSERT_TRUE(csync_mutex_try_lock(&mutex));
+    ASSERT_FALSE(csync_mutex_try_lock(&mutex));
+    csync_mutex_unlock(&mutex);
+
+    uint64_t counter = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&mutex, &counter]() {
+            for (uint32_t i = 0; i < 20000; i++)
+            {
+                csync_mutex_lock(&mutex);
+                counter++;
+                csync_mutex_unlock(&mutex);
+            }
+        });
+    }
+    for (std::thread& thread: threads) { thread.join(); }
+    ASSERT_EQ(counter, 80000u);
+    ASSERT_EQ(mutex.stats.acquisitions, 80001u);
+    ASSERT_LE(mutex.stats.contentions, 80000u);
+    csync_stats_reset(&mutex.stats);
+    ASSERT_EQ(mutex.stats.acquisitions, 0u);
+}
+
+TEST(Sync_Tests, Sync_Test2)
+{
+    using namespace testing;
+    /* Writers keep both halves equal, readers under the lock must never see them differ. */
+    CRwLockT lock;
+    CSeqLockT seqlock;
+    csync_rwlock_init(&lock);
+    csync_seqlock_init(&seqlock);
+    uint64_t pair[2] = {0, 0};
+    uint64_t seqPair[2] = {0, 0};
+    uint32_t torn = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (uint32_t i = 0; i < 5000; i++)
+            {
+                if ((t == 0) && (i % 4 == 0))
+                {
+                    csync_rwlock_write_lock(&lock);
+                    pair[0]++;
+                    pair[1]++;
+                    csync_rwlock_write_unlock(&lock);
+
+                    csync_seqlock_write_begin(&seqlock);
+                    CATOMIC_STORE_RELAXED(&seqPair[0], seqPair[0] + 1u);
+                    CATOMIC_STORE_RELAXED(&seqPair[1], seqPair[1] + 1u);
+                    csync_seqlock_write_end(&seqlock);
+                }
+                else
+                {
+                    csync_rwlock_read_lock(&lock);
+                    if (pair[0] != pair[1]) { CATOMIC_FETCH_ADD(&torn, 1u); }
+                    csync_rwlock_read_unlock(&lock);
+
+                    uint64_t first = 0;
+                    uint64_t second = 0;
+                    uint32_t sequence = 0;
+                    do {
+                        sequence = csync_seqlock_read_begin(&seqlock);
+                        first = CATOMIC_LOAD_RELAXED(&seqPair[0]);
+                        second = CATOMIC_LOAD_RELAXED(&seqPair[1]);
+                    } while (csync_seqlock_read_retry(&seqlock, sequence));
+                    if (first != second) { CATOMIC_FETCH_ADD(&torn, 1u); }
+                }
+            }
+        });
+    }
+    for (std::thread& thread: threads) { thread.join(); }
+    ASSERT_EQ(torn, 0u);
+    ASSERT_EQ(pair[0], 1250u);
+    ASSERT_EQ(seqPair[1], 1250u);
+    ASSERT_EQ(lock.stats.acquisitions, 3u * 5000u + 3750u);
+}
+
+TEST(Sync_Tests, Sync_Test3)
+{
+    using namespace testing;
+    const uint32_t threadCount = 4;
+    const uint32_t rounds = 200;
+    CBarrierT barrier;
+    CEventT start;
+    csync_barrier_init(&barrier, threadCount);
+    csync_event_init(&start);
+    ASSERT_FALSE(csync_event_is_set(&start));
+
+    std::vector<uint32_t> progress(threadCount, 0);
+    uint32_t serial = 0;
+    uint32_t mismatches = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]() {
+            csync_event_wait(&start);
+            for (uint32_t round = 0; round < rounds; round++)
+            {
+                CATOMIC_STORE_RELEASE(&progress[t], round + 1u);
+                if (TRUE == csync_barrier_wait(&barrier)) { CATOMIC_FETCH_ADD(&serial, 1u); }
+                /* Past the barrier everybody finished this round. */
+                for (uint32_t other = 0; other < threadCount; other++)
+                {
+                    if (CATOMIC_LOAD_ACQUIRE(&progress[other]) < round + 1u) { CATOMIC_FETCH_ADD(&mismatches, 1u); }
+                }
+                csync_barrier_wait(&barrier);
+            }
+        });
+    }
+    csync_event_set(&start);
+    ASSERT_TRUE(csync_event_is_set(&start));
+    csync_event_wait(&start);
+    for (std::thread& thread: threads) { thread.join(); }
+    ASSERT_EQ(serial, rounds);
+    ASSERT_EQ(mismatches, 0u);
+    ASSERT_EQ(barrier.stats.acquisitions, 2u * rounds * threadCount);
+}
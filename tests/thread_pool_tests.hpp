@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "CThreadPool.h"
+#include <vector>
+
+static void thread_pool_test_increment(void* argument) { CATOMIC_FETCH_ADD((uint32_t*) argument, 1u); }
+
+static void thread_pool_test_square(size_t begin, size_t end, void* argument)
+{
+    uint64_t* values = (uint64_t*) argument;
+    for (size_t i = begin; i < end; i++) { values[i] = (uint64_t) i * i; }
+}
+
+typedef struct {
+    DThreadPoolT* pool;
+    uint64_t* rows;
+    uint32_t columns;
+} ThreadPoolTestMatrix;
+
+static void thread_pool_test_column(size_t begin, size_t end, void* argument)
+{
+    uint64_t* row = (uint64_t*) argument;
+    for (size_t i = begin; i < end; i++) { row[i] += 1u; }
+}
+
+/* Nested parallel for: every row spawns a parallel for over its columns. */
+static void thread_pool_test_row(size_t begin, size_t end, void* argument)
+{
+    ThreadPoolTestMatrix* matrix = (ThreadPoolTestMatrix*) argument;
+    for (size_t r = begin; r < end; r++)
+    {
+        tpool_parallel_for(matrix->pool, 0, matrix->columns, 16, thread_pool_test_column,
+                           &matrix->rows[r * matrix->columns]);
+    }
+}
+
+TEST(ThreadPool_Tests, ThreadPool_Test1)
+{
+    using namespace testing;
+    DThreadPoolT* pool = tpool_create(4);
+    ASSERT_NE(pool, nullptr);
+    ASSERT_EQ(tpool_worker_count(pool), 4u);
+    ASSERT_EQ(tpool_current_worker(pool), -1);
+
+    /* More tasks than the injection queue holds, the rest runs inline. */
+    uint32_t counter = 0;
+    DTaskGroupT group;
+    tpool_group_init(&group);
+    for (uint32_t i = 0; i < 10000; i++) { tpool_submit(pool, &group, thread_pool_test_increment, &counter); }
+    tpool_group_wait(pool, &group);
+    ASSERT_EQ(counter, 10000u);
+
+    /* Waiting on an empty group returns at once. */
+    tpool_group_wait(pool, &group);
+
+    /* Ungrouped tasks still run before the pool is gone. */
+    for (uint32_t i = 0; i < 100; i++) { tpool_submit(pool, NULL, thread_pool_test_increment, &counter); }
+    tpool_destroy(pool);
+    ASSERT_EQ(counter, 10100u);
+}
+
+TEST(ThreadPool_Tests, ThreadPool_Test2)
+{
+    using namespace testing;
+    DThreadPoolT* pool = tpool_create(0);
+    ASSERT_NE(pool, nullptr);
+    ASSERT_GE(tpool_worker_count(pool), 1u);
+
+    std::vector<uint64_t> values(100003, 0);
+    tpool_parallel_for(pool, 0, values.size(), 0, thread_pool_test_square, values.data());
+    for (size_t i = 0; i < values.size(); i++) { ASSERT_EQ(values[i], (uint64_t) i * i); }
+
+    /* Empty ranges do nothing, grain larger than the range runs one chunk. */
+    tpool_parallel_for(pool, 10, 10, 0, thread_pool_test_square, values.data());
+    tpool_parallel_for(pool, 0, 5, 1000, thread_pool_test_square, values.data());
+    tpool_destroy(pool);
+
+    pool = tpool_create(3);
+    std::vector<uint64_t> cells(64 * 100, 0);
+    ThreadPoolTestMatrix matrix = {pool, cells.data(), 100};
+    for (uint32_t round = 0; round < 5; round++) { tpool_parallel_for(pool, 0, 64, 1, thread_pool_test_row, &matrix); }
+    for (uint64_t cell: cells) { ASSERT_EQ(cell, 5u); }
+    tpool_destroy(pool);
+}